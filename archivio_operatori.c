@@ -0,0 +1,323 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "archivio_operatori.h"
+
+/* Tentativi di aprire un segmento appena creato da un altro processo, prima che ne abbia preso il flock */
+#define TENTATIVI_SEGMENTO 100
+#define ATTESA_SEGMENTO_NS 1000000
+
+/* Intestazione di un segmento condiviso (64 byte), seguita dalle righe della matrice come complesso_t */
+typedef struct {
+    char magia[8];                  // "QSIMOP1", scritta per ultima
+    uint64_t chiave;                // FNV-1a della matrice
+    int32_t dimensione;             // Righe e colonne
+    int32_t dimensione_elemento;    // sizeof(complesso_t) di chi ha scritto il segmento
+    char spazio[40];
+} intestazione_segmento_t;
+
+/* Segmento di memoria condivisa che contiene la matrice di un operatore */
+struct segmento_condiviso {
+    char nome[64];                  // Nome POSIX del segmento
+    int descrittore;                // Aperto finché l'operatore lo usa, con il flock condiviso
+    void* mappa;                    // Mappatura in sola lettura
+    size_t lunghezza;
+};
+
+/* Voce della tabella: chiave e indice dell'operatore originale */
+typedef struct {
+    uint64_t chiave;
+    int indice;                     // -1 se la voce è libera
+} voce_archivio_t;
+
+struct archivio_operatori {
+    voce_archivio_t* voci;          // Tabella a indirizzamento aperto (capacità potenza di 2)
+    int capacita;
+    int numero;
+    int condiviso;
+};
+
+/* Statistiche accumulate dal thread chiamante (lette solo da stampa_archivio_operatori) */
+static __thread struct {
+    long archiviati;        // Operatori con matrice passati dall'archivio
+    long duplicati;         // Operatori con la matrice di un operatore precedente
+    long byte_risparmiati;  // Memoria delle matrici duplicate liberate
+    long creati;            // Segmenti condivisi creati da questo processo
+    long mappati;           // Segmenti già creati da un altro processo e mappati
+    long non_condivisi;     // Matrici rimaste in memoria propria con la condivisione attiva
+} g_statistiche;
+
+
+/* Funzione di supporto: aggiorna l'hash FNV-1a a 64 bit con n byte */
+static uint64_t fnv1a(uint64_t h, const void* dati, size_t n) {
+    const unsigned char* p = (const unsigned char*)dati;
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* Funzione di supporto: chiave della matrice, dalle parti reali e immaginarie delle righe presenti */
+static uint64_t chiave_matrice(const matrice_t* m) {
+    int32_t d = m->dimensione;
+    uint64_t h = fnv1a(14695981039346656037ULL, "QSIMOP1", 7);
+    h = fnv1a(h, &d, sizeof(d));
+    for (int i = 0; i < m->dimensione; i++) {
+        h = fnv1a(h, &i, sizeof(i));            // Distingue le righe assenti (leggi_input_righe)
+        if (!m->dati[i]) continue;
+        for (int j = 0; j < m->dimensione; j++) {
+            h = fnv1a(h, &m->dati[i][j].parte_reale, sizeof(double));
+            h = fnv1a(h, &m->dati[i][j].parte_immaginaria, sizeof(double));
+        }
+    }
+    return h;
+}
+
+/* Funzione di supporto: 1 se le righe hanno le stesse parti reali e immaginarie bit per bit (il campo
+ * segno e il riempimento di complesso_t non contano) */
+static int righe_identiche(const complesso_t* a, const complesso_t* b, int n) {
+    for (int j = 0; j < n; j++) {
+        if (memcmp(&a[j].parte_reale, &b[j].parte_reale, sizeof(double)) != 0 ||
+            memcmp(&a[j].parte_immaginaria, &b[j].parte_immaginaria, sizeof(double)) != 0) return 0;
+    }
+    return 1;
+}
+
+static int matrici_identiche(const matrice_t* a, const matrice_t* b) {
+    if (a->dimensione != b->dimensione) return 0;
+    for (int i = 0; i < a->dimensione; i++) {
+        if (!a->dati[i] != !b->dati[i]) return 0;
+        if (a->dati[i] && !righe_identiche(a->dati[i], b->dati[i], a->dimensione)) return 0;
+    }
+    return 1;
+}
+
+/* Funzione di supporto: raddoppia la tabella e reinserisce le voci. Ritorna 0 se ok, -1 se errore. */
+static int ingrandisci(archivio_operatori_t* a) {
+    int capacita = a->capacita ? 2 * a->capacita : 64;
+    voce_archivio_t* voci = (voce_archivio_t*)malloc(capacita * sizeof(voce_archivio_t));
+    if (!voci) return -1;
+    for (int k = 0; k < capacita; k++) voci[k].indice = -1;
+
+    for (int k = 0; k < a->capacita; k++) {
+        if (a->voci[k].indice < 0) continue;
+        int p = (int)(a->voci[k].chiave & (capacita - 1));
+        while (voci[p].indice >= 0) p = (p + 1) & (capacita - 1);
+        voci[p] = a->voci[k];
+    }
+    free(a->voci);
+    a->voci = voci;
+    a->capacita = capacita;
+    return 0;
+}
+
+/* Funzione di supporto: matrice con le righe che puntano negli elementi mappati. NULL se errore. */
+static matrice_t* matrice_mappata(void* mappa, int d) {
+    matrice_t* m = (matrice_t*)malloc(sizeof(matrice_t));
+    complesso_t** righe = m ? (complesso_t**)malloc(d * sizeof(complesso_t*)) : NULL;
+    if (!righe) {
+        free(m);
+        return NULL;
+    }
+    complesso_t* elementi = (complesso_t*)((char*)mappa + sizeof(intestazione_segmento_t));
+    for (int i = 0; i < d; i++) righe[i] = &elementi[(size_t)i * d];
+    m->dimensione = d;
+    m->dati = righe;
+    return m;
+}
+
+/*
+ * Funzione di supporto: crea il segmento e vi copia la matrice, tenendo il flock esclusivo durante la
+ * scrittura e passando poi a quello condiviso. Ritorna la mappatura in sola lettura, MAP_FAILED se errore
+ * (il nome viene rimosso).
+ */
+static void* crea_segmento(int fd, const char* nome, const matrice_t* m, uint64_t chiave, size_t lunghezza) {
+    int d = m->dimensione;
+    void* mappa = MAP_FAILED;
+    if (flock(fd, LOCK_EX) == 0 && ftruncate(fd, lunghezza) == 0) {
+        mappa = mmap(NULL, lunghezza, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (mappa == MAP_FAILED) {
+        shm_unlink(nome);
+        return MAP_FAILED;
+    }
+
+    intestazione_segmento_t* h = (intestazione_segmento_t*)mappa;
+    complesso_t* elementi = (complesso_t*)((char*)mappa + sizeof(intestazione_segmento_t));
+    for (int i = 0; i < d; i++) memcpy(&elementi[(size_t)i * d], m->dati[i], d * sizeof(complesso_t));
+    h->chiave = chiave;
+    h->dimensione = d;
+    h->dimensione_elemento = (int32_t)sizeof(complesso_t);
+    memcpy(h->magia, "QSIMOP1", 8);             // Per ultima: un segmento senza magia è incompleto
+
+    mprotect(mappa, lunghezza, PROT_READ);
+    flock(fd, LOCK_SH);                         // Scrittura finita: da qui solo lettori
+    return mappa;
+}
+
+/*
+ * Funzione di supporto: mappa un segmento creato da un altro processo, attendendo con il flock condiviso
+ * che la scrittura sia finita, e ne verifica intestazione e contenuto. Ritorna la mappatura, MAP_FAILED se
+ * il segmento non è utilizzabile.
+ */
+static void* apri_segmento(int fd, const matrice_t* m, uint64_t chiave, size_t lunghezza) {
+    struct stat st;
+    for (int t = 0; ; t++) {
+        if (flock(fd, LOCK_SH) != 0 || fstat(fd, &st) != 0) return MAP_FAILED;
+        if (st.st_size != 0 || t == TENTATIVI_SEGMENTO) break;
+        flock(fd, LOCK_UN);                     // Appena creato: il creatore non ha ancora preso il flock
+        struct timespec attesa = {0, ATTESA_SEGMENTO_NS};
+        nanosleep(&attesa, NULL);
+    }
+    if ((size_t)st.st_size != lunghezza) return MAP_FAILED;
+
+    void* mappa = mmap(NULL, lunghezza, PROT_READ, MAP_SHARED, fd, 0);
+    if (mappa == MAP_FAILED) return MAP_FAILED;
+
+    const intestazione_segmento_t* h = (const intestazione_segmento_t*)mappa;
+    const complesso_t* elementi = (const complesso_t*)((const char*)mappa + sizeof(intestazione_segmento_t));
+    int d = m->dimensione;
+    int valido = memcmp(h->magia, "QSIMOP1", 8) == 0 && h->chiave == chiave && h->dimensione == d &&
+                 h->dimensione_elemento == (int32_t)sizeof(complesso_t);
+    for (int i = 0; valido && i < d; i++) valido = righe_identiche(&elementi[(size_t)i * d], m->dati[i], d);
+    if (!valido) {
+        munmap(mappa, lunghezza);
+        return MAP_FAILED;
+    }
+    return mappa;
+}
+
+/* Funzione di supporto: sposta la matrice dell'operatore in un segmento condiviso (creato o già esistente).
+ * Ritorna 0 se spostata, -1 se resta in memoria propria. */
+static int condividi_matrice(operatore_quantistico_t* op, uint64_t chiave) {
+    const matrice_t* m = op->matrice;
+    int d = m->dimensione;
+    for (int i = 0; i < d; i++) {
+        if (!m->dati[i]) return -1;             // Solo blocchi di righe (simulazione distribuita)
+    }
+
+    struct segmento_condiviso* s = (struct segmento_condiviso*)calloc(1, sizeof(struct segmento_condiviso));
+    if (!s) return -1;
+    snprintf(s->nome, sizeof(s->nome), "/qsim_op_%016llx_%d_%d", (unsigned long long)chiave, d, (int)sizeof(complesso_t));
+    s->lunghezza = sizeof(intestazione_segmento_t) + (size_t)d * d * sizeof(complesso_t);
+    s->mappa = MAP_FAILED;
+
+    /* Prima si prova a crearlo; se esiste già lo si apre in lettura */
+    int creato = 0;
+    s->descrittore = shm_open(s->nome, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (s->descrittore >= 0) {
+        creato = 1;
+        s->mappa = crea_segmento(s->descrittore, s->nome, m, chiave, s->lunghezza);
+    } else if (errno == EEXIST) {
+        s->descrittore = shm_open(s->nome, O_RDONLY | O_CLOEXEC, 0);
+        if (s->descrittore >= 0) s->mappa = apri_segmento(s->descrittore, m, chiave, s->lunghezza);
+    }
+
+    matrice_t* mappata = s->mappa != MAP_FAILED ? matrice_mappata(s->mappa, d) : NULL;
+    if (!mappata) {
+        if (s->mappa != MAP_FAILED) munmap(s->mappa, s->lunghezza);
+        if (s->descrittore >= 0) close(s->descrittore);
+        free(s);
+        return -1;
+    }
+
+    distruggi_matrice(op->matrice);             // La copia letta dal file non serve più
+    op->matrice = mappata;
+    op->segmento = s;
+    if (creato) g_statistiche.creati++;
+    else g_statistiche.mappati++;
+    return 0;
+}
+
+archivio_operatori_t* crea_archivio_operatori(int condiviso) {
+    archivio_operatori_t* a = (archivio_operatori_t*)calloc(1, sizeof(archivio_operatori_t));
+    if (!a) return NULL;
+    a->condiviso = condiviso;
+    return a;
+}
+
+int archivia_operatore(archivio_operatori_t* archivio, dati_input_t* dati, int indice) {
+    if (!archivio || !dati || indice < 0 || indice >= dati->numero_operatori) return -1;
+    operatore_quantistico_t* op = &dati->operatori[indice];
+    if (!op->matrice) return -1;
+
+    if (2 * (archivio->numero + 1) > archivio->capacita && ingrandisci(archivio) != 0) return -1;
+    g_statistiche.archiviati++;
+
+    /* Cerca un operatore precedente con la stessa chiave e la stessa matrice */
+    uint64_t chiave = chiave_matrice(op->matrice);
+    int p = (int)(chiave & (archivio->capacita - 1));
+    for (; archivio->voci[p].indice >= 0; p = (p + 1) & (archivio->capacita - 1)) {
+        operatore_quantistico_t* originale = &dati->operatori[archivio->voci[p].indice];
+        if (archivio->voci[p].chiave != chiave || !matrici_identiche(originale->matrice, op->matrice)) continue;
+
+        int d = op->matrice->dimensione;
+        for (int i = 0; i < d; i++) {
+            if (op->matrice->dati[i]) g_statistiche.byte_risparmiati += (long)d * sizeof(complesso_t);
+        }
+        libera_matrice_operatore(op);
+        op->originale = archivio->voci[p].indice;
+        g_statistiche.duplicati++;
+        return 0;
+    }
+
+    /* Nuova matrice: registrata (e condivisa se richiesto) */
+    archivio->voci[p].chiave = chiave;
+    archivio->voci[p].indice = indice;
+    archivio->numero++;
+    if (archivio->condiviso && condividi_matrice(op, chiave) != 0) g_statistiche.non_condivisi++;
+    return 0;
+}
+
+void libera_matrice_operatore(operatore_quantistico_t* op) {
+    if (!op) return;
+    struct segmento_condiviso* s = op->segmento;
+    if (!s) {
+        distruggi_matrice(op->matrice);
+        op->matrice = NULL;
+        return;
+    }
+
+    /* Segmento condiviso: solo le righe sono della matrice; il nome viene rimosso dall'ultimo processo
+     * che lo usa (nessun altro flock condiviso), se si riferisce ancora a questo segmento */
+    free(op->matrice->dati);
+    free(op->matrice);
+    op->matrice = NULL;
+    munmap(s->mappa, s->lunghezza);
+    if (flock(s->descrittore, LOCK_EX | LOCK_NB) == 0) {
+        int fd = shm_open(s->nome, O_RDONLY | O_CLOEXEC, 0);
+        struct stat nostro, attuale;
+        if (fd >= 0 && fstat(s->descrittore, &nostro) == 0 && fstat(fd, &attuale) == 0 &&
+            nostro.st_dev == attuale.st_dev && nostro.st_ino == attuale.st_ino) {
+            shm_unlink(s->nome);
+        }
+        if (fd >= 0) close(fd);
+    }
+    close(s->descrittore);
+    free(s);
+    op->segmento = NULL;
+}
+
+void distruggi_archivio_operatori(archivio_operatori_t* archivio) {
+    if (!archivio) return;
+    free(archivio->voci);
+    free(archivio);
+}
+
+void stampa_archivio_operatori(FILE* out) {
+    fprintf(out, "\n=== Archivio degli operatori ===\n");
+    fprintf(out, "Matrici archiviate: %ld, duplicati: %ld (%.1f MiB risparmiati)\n",
+            g_statistiche.archiviati, g_statistiche.duplicati, g_statistiche.byte_risparmiati / 1048576.0);
+    if (g_statistiche.creati + g_statistiche.mappati + g_statistiche.non_condivisi > 0) {
+        fprintf(out, "Segmenti condivisi creati: %ld, mappati da altri processi: %ld, matrici non condivise: %ld\n",
+                g_statistiche.creati, g_statistiche.mappati, g_statistiche.non_condivisi);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef ARCHIVIO_OPERATORI_H
+#define ARCHIVIO_OPERATORI_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+
+/*
+ * Archivio degli operatori letti con #define: ogni matrice viene identificata da una chiave FNV-1a a 64 bit
+ * del contenuto (parti reali e immaginarie), così le definizioni con matrici identiche (frequenti nelle
+ * librerie di circuiti generate) diventano duplicati del primo operatore invece di tenere ognuna la propria
+ * copia. Un duplicato non ha matrice né porte: trova_operatore lo risolve nell'operatore originale, che
+ * viene fattorizzato, fuso e contato una sola volta.
+ * Con la condivisione attiva la matrice di ogni operatore originale viene spostata in un segmento di
+ * memoria condivisa POSIX (shm_open) con il nome derivato dalla chiave: i processi progetto_qsim
+ * contemporanei sullo stesso host mappano le stesse pagine fisiche invece di tenerne una copia ciascuno.
+ * Chi crea il segmento lo scrive con un flock esclusivo; ogni processo che lo usa tiene un flock condiviso
+ * e l'ultimo a rilasciarlo rimuove il nome. Il contenuto mappato viene sempre confrontato con la matrice
+ * letta, quindi un segmento diverso (collisione della chiave, file incompleto) viene ignorato.
+ */
+typedef struct archivio_operatori archivio_operatori_t;
+
+/*
+ * Crea un archivio vuoto.
+ * Parametri: condiviso → 1 per spostare le matrici in memoria condivisa tra processi
+ * Ritorna: puntatore all'archivio, NULL in caso di errore di allocazione
+ */
+archivio_operatori_t* crea_archivio_operatori(int condiviso);
+
+/*
+ * Archivia l'operatore appena letto dati->operatori[indice] (con matrice, senza porte): se un operatore
+ * precedente ha una matrice identica la nuova viene liberata e l'operatore diventa un suo duplicato,
+ * altrimenti la matrice viene registrata (e, con la condivisione e tutte le righe presenti, spostata in
+ * memoria condivisa; se il segmento non è utilizzabile la matrice resta in memoria propria).
+ * Parametri: archivio → archivio del circuito, dati → operatori letti, indice → operatore da archiviare
+ * Ritorna: 0 se tutto ok, -1 in caso di errore di allocazione
+ */
+int archivia_operatore(archivio_operatori_t* archivio, dati_input_t* dati, int indice);
+
+/*
+ * Libera la matrice di un operatore (memoria propria o segmento condiviso) e la imposta a NULL.
+ */
+void libera_matrice_operatore(operatore_quantistico_t* op);
+
+/*
+ * Distrugge l'archivio (le matrici appartengono agli operatori e vanno liberate a parte).
+ */
+void distruggi_archivio_operatori(archivio_operatori_t* archivio);
+
+/*
+ * Stampa il riepilogo dell'archivio del thread chiamante: operatori archiviati, duplicati e memoria
+ * risparmiata, segmenti condivisi creati, mappati da altri processi e non utilizzabili.
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_archivio_operatori(FILE* out);
+
+#endif
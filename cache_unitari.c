@@ -0,0 +1,402 @@
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cache_unitari.h"
+
+/* File temporanei più vecchi di così (secondi) sono resti di processi interrotti e vengono rimossi */
+#define ETA_TEMPORANEI 3600
+
+/* Intestazione di un file della cache (64 byte), seguita dalle righe dell'unitario come complesso_t */
+typedef struct {
+    char magia[8];                  // "QSIMUF2"
+    uint64_t chiave;                // FNV-1a del tratto (nome del file)
+    int32_t dimensione;             // Righe e colonne dell'unitario
+    int32_t numero_istruzioni;      // Istruzioni fuse
+    int32_t dimensione_elemento;    // sizeof(complesso_t) di chi ha scritto il file
+    int32_t riservato;
+    uint64_t impronta[2];           // Impronta a 128 bit del contenuto del tratto, verificata alla lettura
+    char spazio[16];
+} intestazione_cache_t;
+
+/* File della cache trovato nella cartella, candidato alla rimozione */
+typedef struct {
+    char percorso[4096];
+    off_t dimensione;
+    struct timespec uso;            // Ultima modifica: aggiornata a ogni uso (LRU)
+} voce_cache_t;
+
+/* Statistiche accumulate dal thread chiamante (lette solo da stampa_cache_unitari) */
+static __thread struct {
+    long tratti;            // Tratti fusi
+    long istruzioni;        // Istruzioni sostituite dai tratti
+    long trovati;           // Unitari mappati dalla cache
+    long calcolati;         // Unitari calcolati
+    long salvati;           // Unitari salvati nella cache
+    long rimossi;           // File rimossi per rispettare il limite
+} g_statistiche;
+
+
+/* Funzione di supporto: aggiorna l'hash FNV-1a a 64 bit con n byte */
+static uint64_t fnv1a(uint64_t h, const void* dati, size_t n) {
+    const unsigned char* p = (const unsigned char*)dati;
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* Funzione di supporto: chiave del tratto, dalle parti reali e immaginarie delle matrici nell'ordine del circuito */
+static uint64_t chiave_tratto(matrice_t* const* matrici, int numero) {
+    int32_t intestazione[2] = {matrici[0]->dimensione, numero};
+    uint64_t h = fnv1a(14695981039346656037ULL, "QSIMUF2", 7);
+    h = fnv1a(h, intestazione, sizeof(intestazione));
+    for (int k = 0; k < numero; k++) {
+        const matrice_t* m = matrici[k];
+        for (int i = 0; i < m->dimensione; i++) {
+            for (int j = 0; j < m->dimensione; j++) {
+                h = fnv1a(h, &m->dati[i][j].parte_reale, sizeof(double));
+                h = fnv1a(h, &m->dati[i][j].parte_immaginaria, sizeof(double));
+            }
+        }
+    }
+    return h;
+}
+
+/* Funzione di supporto: rimescola i bit di h (finalizzatore di MurmurHash3) */
+static uint64_t rimescola(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/*
+ * Funzione di supporto: impronta a 128 bit del tratto, da due hash a 64 bit con semi e moltiplicatori diversi
+ * (e diversi da FNV-1a) sulle stesse parole delle matrici. Un file viene accettato solo se chiave e impronta
+ * coincidono entrambe, quindi una collisione della chiave a 64 bit non restituisce l'unitario di un altro tratto.
+ */
+static void impronta_tratto(matrice_t* const* matrici, int numero, uint64_t impronta[2]) {
+    uint64_t a = 0x9e3779b97f4a7c15ULL ^ (uint64_t)matrici[0]->dimensione;
+    uint64_t b = 0x6a09e667f3bcc909ULL ^ ((uint64_t)numero << 32);
+    for (int k = 0; k < numero; k++) {
+        const matrice_t* m = matrici[k];
+        for (int i = 0; i < m->dimensione; i++) {
+            for (int j = 0; j < m->dimensione; j++) {
+                uint64_t parole[2];
+                memcpy(&parole[0], &m->dati[i][j].parte_reale, sizeof(double));
+                memcpy(&parole[1], &m->dati[i][j].parte_immaginaria, sizeof(double));
+                for (int p = 0; p < 2; p++) {
+                    a = (a ^ rimescola(parole[p])) * 0x87c37b91114253d5ULL;
+                    a = (a << 31) | (a >> 33);
+                    b = (b + (parole[p] ^ 0xbb67ae8584caa73bULL)) * 0x4cf5ad432745937fULL;
+                    b ^= b >> 29;
+                }
+            }
+        }
+    }
+    impronta[0] = rimescola(a ^ b);
+    impronta[1] = rimescola(b + 0x3c6ef372fe94f82bULL * (a | 1));
+}
+
+/* Funzione di supporto: byte occupati dal file di un unitario di dimensione d */
+static size_t lunghezza_file(int d) {
+    return sizeof(intestazione_cache_t) + (size_t)d * d * sizeof(complesso_t);
+}
+
+/*
+ * Funzione di supporto: mappa il file della cache in sola lettura, dopo averne verificato intestazione
+ * (chiave e impronta del tratto) e lunghezza, e ne aggiorna l'istante di ultimo uso.
+ * Ritorna l'unitario, NULL se il file manca o non è valido.
+ */
+static unitario_fuso_t* mappa_file(const char* percorso, uint64_t chiave, const uint64_t impronta[2], int d, int numero) {
+    int fd = open(percorso, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    size_t lunghezza = lunghezza_file(d);
+    void* mappa = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == lunghezza) {
+        mappa = mmap(NULL, lunghezza, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (mappa != MAP_FAILED) futimens(fd, NULL);    // Ultimo uso: decide l'ordine di rimozione
+    close(fd);                                      // La mappatura resta valida anche se il file viene rimosso
+    if (mappa == MAP_FAILED) return NULL;
+
+    const intestazione_cache_t* h = (const intestazione_cache_t*)mappa;
+    unitario_fuso_t* u = NULL;
+    if (memcmp(h->magia, "QSIMUF2", 8) == 0 && h->chiave == chiave && h->dimensione == d &&
+        h->impronta[0] == impronta[0] && h->impronta[1] == impronta[1] &&
+        h->numero_istruzioni == numero && h->dimensione_elemento == (int32_t)sizeof(complesso_t)) {
+        u = (unitario_fuso_t*)calloc(1, sizeof(unitario_fuso_t));
+    }
+    matrice_t* m = u ? (matrice_t*)malloc(sizeof(matrice_t)) : NULL;
+    complesso_t** righe = m ? (complesso_t**)malloc(d * sizeof(complesso_t*)) : NULL;
+    if (!righe) {
+        free(m);
+        free(u);
+        munmap(mappa, lunghezza);
+        return NULL;
+    }
+
+    complesso_t* elementi = (complesso_t*)((char*)mappa + sizeof(intestazione_cache_t));
+    for (int i = 0; i < d; i++) righe[i] = &elementi[(size_t)i * d];
+    m->dimensione = d;
+    m->dati = righe;
+    u->matrice = m;
+    u->numero_istruzioni = numero;
+    u->mappa = mappa;
+    u->lunghezza_mappa = lunghezza;
+    return u;
+}
+
+/* Funzione di supporto: calcola M_ultima · ... · M_prima. Ritorna l'unitario, NULL in caso di errore. */
+static unitario_fuso_t* calcola_tratto(matrice_t* const* matrici, int numero) {
+    matrice_t* prodotto = moltiplica_matrici(matrici[1], matrici[0]);
+    for (int k = 2; prodotto && k < numero; k++) {
+        matrice_t* successivo = moltiplica_matrici(matrici[k], prodotto);
+        distruggi_matrice(prodotto);
+        prodotto = successivo;
+    }
+    if (!prodotto) return NULL;
+
+    unitario_fuso_t* u = (unitario_fuso_t*)calloc(1, sizeof(unitario_fuso_t));
+    if (!u) {
+        distruggi_matrice(prodotto);
+        return NULL;
+    }
+    u->matrice = prodotto;
+    u->numero_istruzioni = numero;
+    return u;
+}
+
+/* Funzione di confronto per qsort: file usati meno di recente per primi */
+static int confronta_uso(const void* a, const void* b) {
+    const struct timespec* x = &((const voce_cache_t*)a)->uso;
+    const struct timespec* y = &((const voce_cache_t*)b)->uso;
+    if (x->tv_sec != y->tv_sec) return x->tv_sec < y->tv_sec ? -1 : 1;
+    if (x->tv_nsec != y->tv_nsec) return x->tv_nsec < y->tv_nsec ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Funzione di supporto: rimuove i file usati meno di recente finché la cartella non supera il limite
+ * (escluso il file appena salvato) e i file temporanei abbandonati. Va chiamata con il flock preso.
+ */
+static void rimuovi_vecchi(const char* cartella, const char* percorso_nuovo, long long limite) {
+    DIR* dir = opendir(cartella);
+    if (!dir) return;
+
+    voce_cache_t* voci = NULL;
+    int numero = 0, capacita = 0;
+    long long totale = 0;
+    time_t adesso = time(NULL);
+    struct dirent* e;
+
+    while ((e = readdir(dir)) != NULL) {
+        size_t n = strlen(e->d_name);
+        int finale = n > 4 && strcmp(e->d_name + n - 4, ".qsu") == 0;
+        int temporaneo = n > 5 && strcmp(e->d_name + n - 5, ".part") == 0;
+        if (!finale && !temporaneo) continue;
+
+        char percorso[4096];
+        struct stat st;
+        if (snprintf(percorso, sizeof(percorso), "%s/%s", cartella, e->d_name) >= (int)sizeof(percorso)) continue;
+        if (stat(percorso, &st) != 0) continue;
+
+        if (temporaneo) {
+            if (adesso - st.st_mtime > ETA_TEMPORANEI) unlink(percorso);
+            continue;
+        }
+        totale += st.st_size;
+        if (strcmp(percorso, percorso_nuovo) == 0) continue;
+
+        if (numero == capacita) {
+            capacita = capacita ? 2 * capacita : 16;
+            voce_cache_t* tmp = (voce_cache_t*)realloc(voci, capacita * sizeof(voce_cache_t));
+            if (!tmp) break;
+            voci = tmp;
+        }
+        strcpy(voci[numero].percorso, percorso);
+        voci[numero].dimensione = st.st_size;
+        voci[numero].uso = st.st_mtim;
+        numero++;
+    }
+    closedir(dir);
+
+    if (voci) qsort(voci, numero, sizeof(voce_cache_t), confronta_uso);
+    for (int i = 0; i < numero && totale > limite; i++) {
+        if (unlink(voci[i].percorso) == 0) {
+            totale -= voci[i].dimensione;
+            g_statistiche.rimossi++;
+        }
+    }
+    free(voci);
+}
+
+/*
+ * Funzione di supporto: salva l'unitario nella cache. Il file viene scritto con un nome temporaneo e poi
+ * rinominato, con il flock della cartella preso per la rinomina e la rimozione dei file in eccesso.
+ * Ritorna 0 se salvato, -1 se il file supera il limite o la cartella non è scrivibile.
+ */
+static int salva_file(const char* cartella, const char* percorso, uint64_t chiave, const uint64_t impronta[2],
+                      const unitario_fuso_t* u, long long limite) {
+    int d = u->matrice->dimensione;
+    if ((long long)lunghezza_file(d) > limite) return -1;
+
+    char temporaneo[4096];
+    if (snprintf(temporaneo, sizeof(temporaneo), "%s/.%016llx-%ld-%lx.part", cartella, (unsigned long long)chiave,
+                 (long)getpid(), (unsigned long)pthread_self()) >= (int)sizeof(temporaneo)) return -1;
+
+    FILE* f = fopen(temporaneo, "wb");
+    complesso_t* riga = (complesso_t*)calloc(d, sizeof(complesso_t));   // Byte di riempimento azzerati
+    int ok = f != NULL && riga != NULL;
+
+    intestazione_cache_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magia, "QSIMUF2", 8);
+    h.chiave = chiave;
+    h.impronta[0] = impronta[0];
+    h.impronta[1] = impronta[1];
+    h.dimensione = d;
+    h.numero_istruzioni = u->numero_istruzioni;
+    h.dimensione_elemento = sizeof(complesso_t);
+    if (ok) ok = fwrite(&h, sizeof(h), 1, f) == 1;
+
+    for (int i = 0; ok && i < d; i++) {
+        for (int j = 0; j < d; j++) {
+            riga[j].parte_reale = u->matrice->dati[i][j].parte_reale;
+            riga[j].parte_immaginaria = u->matrice->dati[i][j].parte_immaginaria;
+            riga[j].segno = u->matrice->dati[i][j].segno;
+        }
+        ok = fwrite(riga, sizeof(complesso_t), d, f) == (size_t)d;
+    }
+    free(riga);
+    if (f) {
+        ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+        ok = fclose(f) == 0 && ok;
+    }
+    if (!ok) {
+        unlink(temporaneo);
+        return -1;
+    }
+
+    char blocco[4096];
+    snprintf(blocco, sizeof(blocco), "%s/.lock", cartella);
+    int fd = open(blocco, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || flock(fd, LOCK_EX) != 0) {
+        if (fd >= 0) close(fd);
+        unlink(temporaneo);
+        return -1;
+    }
+    int ret = rename(temporaneo, percorso) == 0 ? 0 : -1;
+    if (ret == 0) rimuovi_vecchi(cartella, percorso, limite);
+    else unlink(temporaneo);
+    flock(fd, LOCK_UN);
+    close(fd);
+    return ret;
+}
+
+unitario_fuso_t** fondi_istruzioni(const dati_input_t* dati, const char* cartella, long limite_mib) {
+    if (!dati || dati->numero_istruzioni <= 0) return NULL;
+
+    unitario_fuso_t** fusi = (unitario_fuso_t**)calloc(dati->numero_istruzioni, sizeof(unitario_fuso_t*));
+    matrice_t** matrici = (matrice_t**)malloc(dati->numero_istruzioni * sizeof(matrice_t*));
+    if (!fusi || !matrici) {
+        free(fusi);
+        free(matrici);
+        return NULL;
+    }
+
+    int cache_usabile = cartella != NULL && (mkdir(cartella, 0755) == 0 || access(cartella, W_OK | X_OK) == 0);
+    struct stat st;
+    if (cache_usabile && (stat(cartella, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != geteuid())) {
+        /* Un altro utente potrebbe scrivere nella cartella unitari che verrebbero poi mappati ed eseguiti */
+        fprintf(stderr, "Attenzione: la cartella della cache %s non appartiene all'utente, la cache non viene usata\n",
+                cartella);
+        cache_usabile = 0;
+    }
+    long long limite = (long long)limite_mib << 20;
+
+    for (int i = 0; i < dati->numero_istruzioni; ) {
+        /* Tratto di istruzioni consecutive con matrice densa a partire da i */
+        int numero = 0;
+        while (i + numero < dati->numero_istruzioni) {
+            operatore_quantistico_t* op = trova_operatore((dati_input_t*)dati, dati->circuito[i + numero].nome_operatore);
+            if (!op || !op->matrice || op->porte) break;
+            matrici[numero++] = op->matrice;
+        }
+        if (numero < 2) {
+            i += numero > 0 ? numero : 1;
+            continue;
+        }
+
+        uint64_t chiave = chiave_tratto(matrici, numero);
+        uint64_t impronta[2];
+        impronta_tratto(matrici, numero, impronta);
+        char percorso[4096];
+        int ha_percorso = cache_usabile && snprintf(percorso, sizeof(percorso), "%s/%016llx.qsu", cartella,
+                                                    (unsigned long long)chiave) < (int)sizeof(percorso);
+
+        unitario_fuso_t* u = ha_percorso ? mappa_file(percorso, chiave, impronta, matrici[0]->dimensione, numero) : NULL;
+        if (u) {
+            g_statistiche.trovati++;
+        } else {
+            u = calcola_tratto(matrici, numero);
+            if (!u) {
+                libera_unitari_fusi(fusi, dati->numero_istruzioni);
+                free(matrici);
+                return NULL;
+            }
+            g_statistiche.calcolati++;
+            if (ha_percorso && salva_file(cartella, percorso, chiave, impronta, u, limite) == 0) g_statistiche.salvati++;
+        }
+
+        fusi[i] = u;
+        g_statistiche.tratti++;
+        g_statistiche.istruzioni += numero;
+        i += numero;
+    }
+
+    free(matrici);
+    return fusi;
+}
+
+void libera_unitari_fusi(unitario_fuso_t** fusi, int numero_istruzioni) {
+    if (!fusi) return;
+    for (int i = 0; i < numero_istruzioni; i++) {
+        unitario_fuso_t* u = fusi[i];
+        if (!u) continue;
+        if (u->mappa) {                     // Solo l'array delle righe è memoria propria
+            free(u->matrice->dati);
+            free(u->matrice);
+            munmap(u->mappa, u->lunghezza_mappa);
+        } else {
+            distruggi_matrice(u->matrice);
+        }
+        free(u);
+    }
+    free(fusi);
+}
+
+void stampa_cache_unitari(FILE* out) {
+    fprintf(out, "\n=== Cache degli unitari fusi ===\n");
+    if (g_statistiche.tratti == 0) {
+        fprintf(out, "Nessun tratto di almeno due istruzioni con matrice densa consecutive\n");
+        return;
+    }
+    fprintf(out, "Tratti fusi: %ld (%ld istruzioni)\n", g_statistiche.tratti, g_statistiche.istruzioni);
+    fprintf(out, "Unitari mappati dalla cache: %ld, calcolati: %ld, salvati: %ld\n",
+            g_statistiche.trovati, g_statistiche.calcolati, g_statistiche.salvati);
+    fprintf(out, "File rimossi per il limite di dimensione: %ld\n", g_statistiche.rimossi);
+}
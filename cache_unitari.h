@@ -0,0 +1,47 @@
+#ifndef CACHE_UNITARI_H
+#define CACHE_UNITARI_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+
+/* Dimensione massima di default della cache su disco, in MiB */
+#define LIMITE_CACHE_MIB 1024
+
+/*
+ * Unitario di un tratto di istruzioni consecutive con matrice densa, fuso in un'unica matrice
+ * (M_ultima · ... · M_prima): il tratto costa una sola moltiplicazione matrice × vettore per esecuzione.
+ * Le righe della matrice puntano nel file della cache mappato in memoria, oppure in memoria propria.
+ */
+typedef struct {
+    matrice_t* matrice;         // Unitario del tratto
+    int numero_istruzioni;      // Istruzioni del circuito sostituite (>= 2)
+    void* mappa;                // File della cache mappato (sola lettura), NULL se calcolato in memoria
+    size_t lunghezza_mappa;
+} unitario_fuso_t;
+
+/*
+ * Fonde i tratti di almeno due istruzioni consecutive con matrice densa. Ogni tratto viene cercato nella
+ * cartella della cache con una chiave FNV-1a a 64 bit del contenuto delle matrici nell'ordine del circuito.
+ * Il file viene mappato in memoria solo se esiste e se anche l'impronta a 128 bit salvata nell'intestazione
+ * coincide; altrimenti il prodotto viene calcolato (in parallelo con la squadra corrente) e salvato. Il salvataggio scrive un file temporaneo e lo rinomina, quindi chi legge
+ * non vede mai file incompleti; rinomina e rimozione dei file usati meno di recente (oltre limite_mib) sono
+ * serializzate tra processi con un flock sul file ".lock" della cartella. Se la cartella non è utilizzabile,
+ * o non appartiene all'utente, il prodotto viene solo calcolato.
+ * Parametri: dati → circuito con gli operatori già letti, cartella → cartella della cache, limite_mib → dimensione massima
+ * Ritorna: array di dati->numero_istruzioni puntatori (l'unitario all'indice della prima istruzione di
+ * ogni tratto, NULL altrove), NULL in caso di errore di allocazione
+ */
+unitario_fuso_t** fondi_istruzioni(const dati_input_t* dati, const char* cartella, long limite_mib);
+
+/*
+ * Libera gli unitari restituiti da fondi_istruzioni (e le loro mappature).
+ */
+void libera_unitari_fusi(unitario_fuso_t** fusi, int numero_istruzioni);
+
+/*
+ * Stampa il riepilogo della cache (tratti fusi, file trovati, calcolati, salvati, rimossi) del thread chiamante.
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_cache_unitari(FILE* out);
+
+#endif
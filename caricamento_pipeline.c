@@ -0,0 +1,95 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "caricamento_pipeline.h"
+#include "coda.h"
+#include "kronecker.h"
+
+#define CAPACITA_CODA 8     // Istruzioni pronte in anticipo rispetto all'esecuzione
+
+struct caricamento {
+    dati_input_t* dati;          // Dati indicizzati
+    const char* file_circuito;   // File da cui leggere le matrici
+    double tolleranza;           // Tolleranza della fattorizzazione di Kronecker
+    coda_t coda;                 // Operatori delle istruzioni pronte, nell'ordine di #circ
+    pthread_t thread;            // Thread di caricamento
+    int errore;                  // 1 se il caricamento è fallito (scritto prima di chiudere la coda)
+};
+
+
+/*
+ * Funzione eseguita dal thread di caricamento: per ogni istruzione legge, se non è già stata letta,
+ * la matrice dell'operatore e lo inserisce nella coda (attendendo se l'esecuzione è indietro).
+ */
+static void* funzione_caricamento(void* arg) {
+    caricamento_t* c = (caricamento_t*)arg;
+    dati_input_t* dati = c->dati;
+
+    FILE* file = fopen(c->file_circuito, "r");
+    if (!file) {
+        perror(c->file_circuito);
+        c->errore = 1;
+        coda_chiudi(&c->coda);
+        return NULL;
+    }
+
+    for (int i = 0; i < dati->numero_istruzioni; i++) {
+        operatore_quantistico_t* op = trova_operatore(dati, dati->circuito[i].nome_operatore);
+
+        if (!op) {                                   // Operatore usato in #circ ma mai definito
+            c->errore = 1;
+            break;
+        }
+        if (!op->matrice && !op->porte) {            // Prima istruzione che usa l'operatore: legge la matrice
+            if (carica_operatore(file, dati->numero_qubit, op) != 0 ||
+                fattorizza_operatore(op, dati->numero_qubit, c->tolleranza) < 0) {
+                c->errore = 1;
+                break;
+            }
+        }
+        if (coda_inserisci(&c->coda, op) != 0) break;   // Coda chiusa: l'esecuzione si è interrotta
+    }
+
+    fclose(file);
+    coda_chiudi(&c->coda);      // L'esecuzione estrae le istruzioni rimaste e poi riceve la fine
+    return NULL;
+}
+
+caricamento_t* avvia_caricamento(dati_input_t* dati, const char* file_circuito, double tolleranza) {
+    if (!dati || !file_circuito) return NULL;
+
+    caricamento_t* c = (caricamento_t*)calloc(1, sizeof(caricamento_t));
+    if (!c) return NULL;
+
+    c->dati = dati;
+    c->file_circuito = file_circuito;
+    c->tolleranza = tolleranza;
+    if (coda_inizializza(&c->coda, CAPACITA_CODA) != 0) {
+        free(c);
+        return NULL;
+    }
+    if (pthread_create(&c->thread, NULL, funzione_caricamento, c) != 0) {
+        coda_distruggi(&c->coda);
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+operatore_quantistico_t* prossimo_operatore(caricamento_t* c) {
+    void* op = NULL;
+    if (coda_estrai(&c->coda, &op) != 0) return NULL;
+    return (operatore_quantistico_t*)op;
+}
+
+int termina_caricamento(caricamento_t* c) {
+    if (!c) return -1;
+
+    coda_chiudi(&c->coda);              // Sblocca il thread se è in attesa di spazio nella coda
+    pthread_join(c->thread, NULL);
+
+    int ret = c->errore ? -1 : 0;
+    coda_distruggi(&c->coda);
+    free(c);
+    return ret;
+}
@@ -0,0 +1,37 @@
+#ifndef CARICAMENTO_PIPELINE_H
+#define CARICAMENTO_PIPELINE_H
+
+#include "lettore_input.h"
+
+/*
+ * Caricamento in pipeline degli operatori del circuito.
+ * Un thread di caricamento legge le matrici degli operatori nell'ordine in cui compaiono in #circ
+ * e le passa all'esecuzione attraverso una coda limitata, così la squadra di thread calcola le
+ * prime istruzioni mentre le successive vengono ancora lette dal file.
+ * I dati devono essere stati preparati con indicizza_input (nomi, posizioni e circuito).
+ */
+typedef struct caricamento caricamento_t;
+
+/*
+ * Avvia il thread di caricamento.
+ * Parametri: dati → dati indicizzati (l'array degli operatori non deve più essere riallocato),
+ * file_circuito → file da cui leggere le matrici,
+ * tolleranza → tolleranza della fattorizzazione di Kronecker applicata a ogni matrice letta (negativa: nessuna)
+ * Ritorna: puntatore al caricamento, NULL in caso di errore
+ */
+caricamento_t* avvia_caricamento(dati_input_t* dati, const char* file_circuito, double tolleranza);
+
+/*
+ * Ritorna l'operatore della prossima istruzione del circuito, attendendo che la sua matrice sia letta.
+ * Ritorna: puntatore all'operatore, NULL se il caricamento è fallito (operatore non definito o
+ * matrice non valida) o il circuito è terminato
+ */
+operatore_quantistico_t* prossimo_operatore(caricamento_t* c);
+
+/*
+ * Ferma il thread di caricamento (anche se non ha finito), attende la sua terminazione e libera le risorse.
+ * Ritorna: 0 se il caricamento si è concluso senza errori, -1 altrimenti
+ */
+int termina_caricamento(caricamento_t* c);
+
+#endif
@@ -0,0 +1,149 @@
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include "coda.h"
+
+int coda_inizializza(coda_t* c, int capacita) {
+    if (c == NULL || capacita <= 0) return -1;
+
+    c->elementi = (void**)malloc(capacita * sizeof(void*));
+    if (!c->elementi) return -1;
+
+    c->capacita = capacita;
+    c->testa = 0;
+    c->quanti = 0;
+    c->chiusa = 0;
+    pthread_mutex_init(&c->mutex, NULL);
+    pthread_cond_init(&c->non_piena, NULL);
+    pthread_cond_init(&c->non_vuota, NULL);
+    return 0;
+}
+
+int coda_inserisci(coda_t* c, void* elemento) {
+    pthread_mutex_lock(&c->mutex);
+
+    while (c->quanti == c->capacita && !c->chiusa) {       // Coda piena: attende che il consumatore estragga
+        pthread_cond_wait(&c->non_piena, &c->mutex);
+    }
+    if (c->chiusa) {
+        pthread_mutex_unlock(&c->mutex);
+        return -1;
+    }
+
+    c->elementi[(c->testa + c->quanti) % c->capacita] = elemento;
+    c->quanti++;
+    pthread_cond_signal(&c->non_vuota);
+
+    pthread_mutex_unlock(&c->mutex);
+    return 0;
+}
+
+int coda_estrai(coda_t* c, void** elemento) {
+    pthread_mutex_lock(&c->mutex);
+
+    while (c->quanti == 0 && !c->chiusa) {                 // Coda vuota: attende il produttore
+        pthread_cond_wait(&c->non_vuota, &c->mutex);
+    }
+    if (c->quanti == 0) {                                  // Chiusa e vuota
+        pthread_mutex_unlock(&c->mutex);
+        return -1;
+    }
+
+    *elemento = c->elementi[c->testa];
+    c->testa = (c->testa + 1) % c->capacita;
+    c->quanti--;
+    pthread_cond_signal(&c->non_piena);
+
+    pthread_mutex_unlock(&c->mutex);
+    return 0;
+}
+
+void coda_chiudi(coda_t* c) {
+    pthread_mutex_lock(&c->mutex);
+    c->chiusa = 1;
+    pthread_cond_broadcast(&c->non_piena);
+    pthread_cond_broadcast(&c->non_vuota);
+    pthread_mutex_unlock(&c->mutex);
+}
+
+void coda_distruggi(coda_t* c) {
+    if (c == NULL) return;
+
+    free(c->elementi);
+    c->elementi = NULL;
+    pthread_mutex_destroy(&c->mutex);
+    pthread_cond_destroy(&c->non_piena);
+    pthread_cond_destroy(&c->non_vuota);
+}
+
+
+/* Attesa attiva della coda senza lock: giri prima di cedere la CPU, cessioni prima di dormire */
+#define GIRI_PRIMA_DI_CEDERE 256
+#define CESSIONI_PRIMA_DI_DORMIRE 64
+#define ATTESA_DORMIENTE_NS 50000
+
+/* Funzione di supporto: un giro di attesa. Dopo molti giri cede la CPU, dopo molte cessioni dorme
+ * qualche decina di microsecondi, così un lato fermo a lungo non occupa un core */
+static void attendi_giro(int* giri) {
+    (*giri)++;
+    if (*giri < GIRI_PRIMA_DI_CEDERE) return;
+    if (*giri < GIRI_PRIMA_DI_CEDERE + CESSIONI_PRIMA_DI_DORMIRE) {
+        sched_yield();
+        return;
+    }
+    struct timespec attesa = {0, ATTESA_DORMIENTE_NS};
+    nanosleep(&attesa, NULL);
+}
+
+int coda_spsc_inizializza(coda_spsc_t* c, long capacita) {
+    if (c == NULL || capacita <= 0) return -1;
+
+    c->elementi = (void**)malloc(capacita * sizeof(void*));
+    if (!c->elementi) return -1;
+
+    c->capacita = capacita;
+    c->testa = 0;
+    c->attese_vuota = 0;
+    c->fondo = 0;
+    c->attese_piena = 0;
+    c->chiusa = 0;
+    return 0;
+}
+
+void coda_spsc_inserisci(coda_spsc_t* c, void* elemento) {
+    long fondo = c->fondo;                              // Scritto solo da questo thread
+    int giri = 0;
+    while (fondo - __atomic_load_n(&c->testa, __ATOMIC_ACQUIRE) == c->capacita) {   // Piena: il consumatore deve estrarre
+        if (giri == 0) c->attese_piena++;
+        attendi_giro(&giri);
+    }
+
+    c->elementi[fondo % c->capacita] = elemento;
+    __atomic_store_n(&c->fondo, fondo + 1, __ATOMIC_RELEASE);  // L'elemento è visibile prima del nuovo fondo
+}
+
+int coda_spsc_estrai(coda_spsc_t* c, void** elemento) {
+    long testa = c->testa;                              // Scritto solo da questo thread
+    int giri = 0;
+    while (__atomic_load_n(&c->fondo, __ATOMIC_ACQUIRE) == testa) {     // Vuota: attende il produttore
+        /* La chiusura va riletta dopo il fondo: un inserimento precedente alla chiusura è già visibile */
+        if (__atomic_load_n(&c->chiusa, __ATOMIC_ACQUIRE) && __atomic_load_n(&c->fondo, __ATOMIC_ACQUIRE) == testa) return -1;
+        if (giri == 0) c->attese_vuota++;
+        attendi_giro(&giri);
+    }
+
+    *elemento = c->elementi[testa % c->capacita];
+    __atomic_store_n(&c->testa, testa + 1, __ATOMIC_RELEASE);  // Il posto si libera dopo la lettura
+    return 0;
+}
+
+void coda_spsc_chiudi(coda_spsc_t* c) {
+    __atomic_store_n(&c->chiusa, 1, __ATOMIC_RELEASE);
+}
+
+void coda_spsc_distruggi(coda_spsc_t* c) {
+    if (c == NULL) return;
+
+    free(c->elementi);
+    c->elementi = NULL;
+}
@@ -0,0 +1,101 @@
+#ifndef CODA_H
+#define CODA_H
+
+#include <pthread.h>
+
+/* Dimensione di una linea di cache: gli indici della coda senza lock stanno in linee diverse */
+#define LINEA_CACHE 64
+
+/*
+ * Nuovo tipo che rappresenta una coda FIFO limitata di puntatori, condivisa tra thread.
+ * Chi inserisce attende se la coda è piena, chi estrae attende se è vuota.
+ * Dopo la chiusura gli inserimenti falliscono e le estrazioni svuotano gli elementi rimasti.
+ */
+typedef struct {
+    void** elementi;             // Buffer circolare
+    int capacita;                // Numero massimo di elementi
+    int testa;                   // Posizione del prossimo elemento da estrarre
+    int quanti;                  // Elementi presenti
+    int chiusa;                  // 1 dopo coda_chiudi
+    pthread_mutex_t mutex;       // Protegge lo stato della coda
+    pthread_cond_t non_piena;    // Segnale: si è liberato un posto
+    pthread_cond_t non_vuota;    // Segnale: è arrivato un elemento (o la coda è stata chiusa)
+} coda_t;
+
+/*
+ * Inizializza una coda vuota.
+ * Parametri: c → coda da inizializzare, capacita → numero massimo di elementi (> 0)
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int coda_inizializza(coda_t* c, int capacita);
+
+/*
+ * Inserisce un elemento in fondo alla coda, attendendo se è piena.
+ * Ritorna: 0 se inserito, -1 se la coda è stata chiusa
+ */
+int coda_inserisci(coda_t* c, void* elemento);
+
+/*
+ * Estrae l'elemento in testa alla coda, attendendo se è vuota.
+ * Parametri: elemento → valorizzato con l'elemento estratto
+ * Ritorna: 0 se estratto, -1 se la coda è chiusa e vuota
+ */
+int coda_estrai(coda_t* c, void** elemento);
+
+/*
+ * Chiude la coda e sveglia tutti i thread in attesa.
+ */
+void coda_chiudi(coda_t* c);
+
+/*
+ * Libera le risorse della coda (nessun thread deve più usarla).
+ */
+void coda_distruggi(coda_t* c);
+
+/*
+ * Coda FIFO limitata di puntatori senza lock, per un solo produttore e un solo consumatore.
+ * testa e fondo sono contatori crescenti: ognuno è scritto da un solo lato e letto dall'altro con
+ * operazioni atomiche acquire/release, e sta in una propria linea di cache così che i due core non se la
+ * contendano. Chi trova la coda piena o vuota ripete l'operazione, cedendo la CPU se l'attesa si allunga.
+ * Va allocata allineata a LINEA_CACHE (ad esempio con posix_memalign).
+ */
+typedef struct {
+    void** elementi;                            // Buffer circolare
+    long capacita;                              // Numero massimo di elementi
+    _Alignas(LINEA_CACHE) long testa;           // Elementi estratti (scritto solo dal consumatore)
+    long attese_vuota;                          // Estrazioni che hanno trovato la coda vuota
+    _Alignas(LINEA_CACHE) long fondo;           // Elementi inseriti (scritto solo dal produttore)
+    long attese_piena;                          // Inserimenti che hanno trovato la coda piena
+    int chiusa;                                 // 1 dopo coda_spsc_chiudi (scritto solo dal produttore)
+} coda_spsc_t;
+
+/*
+ * Inizializza una coda senza lock vuota.
+ * Parametri: c → coda da inizializzare, capacita → numero massimo di elementi (> 0)
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int coda_spsc_inizializza(coda_spsc_t* c, long capacita);
+
+/*
+ * Inserisce un elemento in fondo alla coda, attendendo se è piena. Solo dal thread produttore.
+ */
+void coda_spsc_inserisci(coda_spsc_t* c, void* elemento);
+
+/*
+ * Estrae l'elemento in testa alla coda, attendendo se è vuota. Solo dal thread consumatore.
+ * Parametri: elemento → valorizzato con l'elemento estratto
+ * Ritorna: 0 se estratto, -1 se la coda è chiusa e vuota
+ */
+int coda_spsc_estrai(coda_spsc_t* c, void** elemento);
+
+/*
+ * Chiude la coda: il consumatore estrae gli elementi rimasti e poi riceve -1. Solo dal thread produttore.
+ */
+void coda_spsc_chiudi(coda_spsc_t* c);
+
+/*
+ * Libera le risorse della coda (nessun thread deve più usarla).
+ */
+void coda_spsc_distruggi(coda_spsc_t* c);
+
+#endif
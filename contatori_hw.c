@@ -0,0 +1,237 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "contatori_hw.h"
+
+#define NUMERO_CONTATORI 4      // Cicli, istruzioni, miss LLC, stalli di memoria
+#define BYTE_LINEA_CACHE 64.0   // Byte trasferiti dalla memoria per ogni miss di ultimo livello
+
+enum { CICLI = 0, ISTRUZIONI = 1, MISS_LLC = 2, STALLI = 3 };
+
+/* Eventi richiesti per ogni thread, nello stesso ordine dell'enum */
+static const uint64_t g_eventi[NUMERO_CONTATORI] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_STALLED_CYCLES_BACKEND
+};
+
+/* Nuovo tipo con i descrittori di un thread della squadra */
+typedef struct {
+    int stato;                      // 0 non ancora aperto, 1 aperto, -1 non disponibile
+    int fd[NUMERO_CONTATORI];       // Descrittori (-1 se l'evento non è supportato)
+    int numero_aperti;              // Eventi effettivamente nel gruppo
+    int posizione[NUMERO_CONTATORI];// Posizione di ogni evento nel buffer di lettura del gruppo
+} contatori_thread_t;
+
+/* Nuovo tipo con i valori accumulati per una coppia (thread, operatore) */
+typedef struct {
+    double valore[NUMERO_CONTATORI];
+    int misurato[NUMERO_CONTATORI];  // 1 se almeno un job ha misurato l'evento
+    double flop;
+    double byte;
+    unsigned long job;
+} accumulo_t;
+
+int contatori_attivi = 0;
+
+static accumulo_t* g_accumuli = NULL;         // Matrice numero_thread × numero_operatori
+static int g_numero_thread = 0;
+static int g_numero_operatori = 0;
+static int g_operatore_corrente = -1;         // Scritto dal thread principale prima di avviare il job
+static int g_errore_segnalato = 0;            // Evita di ripetere l'avviso di contatori non disponibili
+
+/* Descrittori del thread chiamante: appartengono al thread che li apre, che li chiude prima di terminare */
+static __thread contatori_thread_t g_descrittori;
+
+
+/*
+ * Funzione di supporto che invoca la system call perf_event_open (non ha wrapper in glibc).
+ */
+static int apri_evento(uint64_t config, int leader) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = (leader == -1);         // Solo il leader parte disabilitato, gli altri seguono il gruppo
+    attr.exclude_kernel = 1;                // Richiesto con perf_event_paranoid >= 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);  // pid 0, cpu -1: thread chiamante su ogni CPU
+}
+
+/*
+ * Funzione di supporto che apre il gruppo di contatori del thread chiamante.
+ * Il leader (cicli) è indispensabile, gli altri eventi sono facoltativi.
+ */
+static void apri_thread(contatori_thread_t* c) {
+    for (int k = 0; k < NUMERO_CONTATORI; k++) {
+        c->fd[k] = -1;
+        c->posizione[k] = -1;
+    }
+    c->numero_aperti = 0;
+
+    c->fd[CICLI] = apri_evento(g_eventi[CICLI], -1);
+    if (c->fd[CICLI] < 0) {
+        c->stato = -1;
+        if (!g_errore_segnalato) {      // Più thread possono arrivare qui, l'avviso è solo indicativo
+            g_errore_segnalato = 1;
+            fprintf(stderr, "Attenzione: contatori hardware non disponibili (%s), verificare "
+                            "/proc/sys/kernel/perf_event_paranoid; si prosegue senza misure\n", strerror(errno));
+        }
+        return;
+    }
+    c->posizione[CICLI] = c->numero_aperti++;
+
+    for (int k = 1; k < NUMERO_CONTATORI; k++) {
+        c->fd[k] = apri_evento(g_eventi[k], c->fd[CICLI]);
+        if (c->fd[k] >= 0) c->posizione[k] = c->numero_aperti++;
+    }
+    c->stato = 1;
+}
+
+int contatori_attiva(int numero_operatori) {
+    if (numero_operatori <= 0) return -1;
+
+    g_numero_operatori = numero_operatori;
+    contatori_attivi = 1;
+    return 0;
+}
+
+int contatori_inizializza_squadra(int numero_thread) {
+    if (!contatori_attivi) return 0;
+
+    /* I thread della squadra precedente possono essere ancora vivi (le squadre di prova della taratura):
+     * se ne liberano solo gli accumulatori, i descrittori li chiude ogni thread quando termina */
+    free(g_accumuli);
+    g_numero_thread = 0;
+    g_accumuli = (accumulo_t*)calloc((size_t)numero_thread * g_numero_operatori, sizeof(accumulo_t));
+    if (!g_accumuli) return -1;
+    g_numero_thread = numero_thread;
+    return 0;
+}
+
+void contatori_imposta_operatore(int operatore) {
+    g_operatore_corrente = operatore;
+}
+
+void contatori_inizio_job(int thread) {
+    if (!contatori_attivi || thread < 0 || thread >= g_numero_thread) return;
+
+    contatori_thread_t* c = &g_descrittori;
+    if (c->stato == 0) apri_thread(c);      // Apertura pigra: i contatori appartengono al thread che li apre
+    if (c->stato != 1) return;
+
+    ioctl(c->fd[CICLI], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(c->fd[CICLI], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void contatori_fine_job(int thread, double flop, double byte) {
+    if (!contatori_attivi || thread < 0 || thread >= g_numero_thread) return;
+
+    contatori_thread_t* c = &g_descrittori;
+    if (c->stato != 1) return;
+
+    ioctl(c->fd[CICLI], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    /* Formato di lettura del gruppo: nr, time_enabled, time_running, valori[nr] */
+    uint64_t buffer[3 + NUMERO_CONTATORI];
+    ssize_t letti = read(c->fd[CICLI], buffer, sizeof(buffer));
+    if (letti < (ssize_t)(3 * sizeof(uint64_t))) return;
+
+    int operatore = g_operatore_corrente;
+    if (operatore < 0 || operatore >= g_numero_operatori) return;
+
+    /* Se il gruppo è stato multiplexato con altri eventi, riporta i valori al tempo totale */
+    double scala = (buffer[2] > 0) ? (double)buffer[1] / (double)buffer[2] : 0.0;
+
+    accumulo_t* a = &g_accumuli[thread * g_numero_operatori + operatore];   // Slot privato del thread
+    for (int k = 0; k < NUMERO_CONTATORI; k++) {
+        int p = c->posizione[k];
+        if (p < 0 || (uint64_t)p >= buffer[0]) continue;
+        a->valore[k] += buffer[3 + p] * scala;
+        a->misurato[k] = 1;
+    }
+    a->flop += flop;
+    a->byte += byte;
+    a->job++;
+}
+
+void contatori_chiudi_thread(void) {
+    contatori_thread_t* c = &g_descrittori;     // Anche dopo contatori_termina: i descrittori restano aperti fino a qui
+    if (c->stato != 1) return;
+
+    for (int k = NUMERO_CONTATORI - 1; k >= 0; k--) {   // Prima i membri, poi il leader
+        if (c->fd[k] >= 0) close(c->fd[k]);
+        c->fd[k] = -1;
+    }
+    c->stato = 0;
+}
+
+void contatori_termina(FILE* out, const dati_input_t* dati) {
+    if (!contatori_attivi) return;
+
+    int disponibili = 0;
+    for (int i = 0; g_accumuli && i < g_numero_thread * g_numero_operatori; i++) {
+        if (g_accumuli[i].job > 0) disponibili = 1;     // Almeno un job misurato
+    }
+
+    fprintf(out, "\n=== Contatori hardware ===\n");
+    if (!disponibili || g_accumuli == NULL) {
+        fprintf(out, "Nessuna misura disponibile\n");
+    } else {
+        fprintf(out, "%-20s %6s %8s %12s %12s %10s %12s  %s\n",
+                "operatore", "job", "IPC", "miss LLC", "stalli (%)", "B/flop", "B/flop LLC", "limite");
+
+        for (int o = 0; o < g_numero_operatori; o++) {
+            accumulo_t totale;
+            memset(&totale, 0, sizeof(totale));
+            for (int t = 0; t < g_numero_thread; t++) {     // Somma gli slot di tutti i thread per l'operatore
+                accumulo_t* a = &g_accumuli[t * g_numero_operatori + o];
+                for (int k = 0; k < NUMERO_CONTATORI; k++) {
+                    totale.valore[k] += a->valore[k];
+                    totale.misurato[k] |= a->misurato[k];
+                }
+                totale.flop += a->flop;
+                totale.byte += a->byte;
+                totale.job += a->job;
+            }
+            if (totale.job == 0) continue;
+
+            const char* nome = (dati && o < dati->numero_operatori) ? dati->operatori[o].nome : "?";
+            double cicli = totale.valore[CICLI];
+            double ipc = (cicli > 0 && totale.misurato[ISTRUZIONI]) ? totale.valore[ISTRUZIONI] / cicli : -1.0;
+            double stalli = (cicli > 0 && totale.misurato[STALLI]) ? 100.0 * totale.valore[STALLI] / cicli : -1.0;
+            double byte_flop = totale.flop > 0 ? totale.byte / totale.flop : -1.0;          // Intensità nominale
+            double byte_flop_llc = (totale.flop > 0 && totale.misurato[MISS_LLC])          // Traffico effettivo verso la memoria
+                                   ? totale.valore[MISS_LLC] * BYTE_LINEA_CACHE / totale.flop : -1.0;
+
+            /* Classificazione indicativa: molti stalli di memoria o traffico DRAM elevato → limitato dalla banda */
+            const char* limite = "n.d.";
+            if (stalli >= 0.0) limite = stalli > 50.0 ? "memoria" : "calcolo";
+            else if (byte_flop_llc >= 0.0) limite = byte_flop_llc > 0.5 ? "memoria" : "calcolo";
+
+            fprintf(out, "%-20s %6lu ", nome, totale.job);
+            if (ipc >= 0.0) fprintf(out, "%8.2f ", ipc); else fprintf(out, "%8s ", "n.d.");
+            if (totale.misurato[MISS_LLC]) fprintf(out, "%12.0f ", totale.valore[MISS_LLC]); else fprintf(out, "%12s ", "n.d.");
+            if (stalli >= 0.0) fprintf(out, "%12.1f ", stalli); else fprintf(out, "%12s ", "n.d.");
+            if (byte_flop >= 0.0) fprintf(out, "%10.2f ", byte_flop); else fprintf(out, "%10s ", "n.d.");
+            if (byte_flop_llc >= 0.0) fprintf(out, "%12.3f ", byte_flop_llc); else fprintf(out, "%12s ", "n.d.");
+            fprintf(out, " %s\n", limite);
+        }
+    }
+
+    free(g_accumuli);
+    g_accumuli = NULL;
+    g_numero_thread = 0;
+    g_numero_operatori = 0;
+    contatori_attivi = 0;
+}
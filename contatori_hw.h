@@ -0,0 +1,65 @@
+#ifndef CONTATORI_HW_H
+#define CONTATORI_HW_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+
+/*
+ * Modulo dei contatori hardware (perf_event_open, solo Linux).
+ * Ogni thread della squadra apre un gruppo di contatori (cicli, istruzioni, miss della cache
+ * di ultimo livello, cicli di stallo in attesa della memoria) e li legge attorno a ogni job
+ * matrice × vettore. I valori sono aggregati per operatore del circuito e riassunti in IPC
+ * e byte per flop, per capire se un operatore è limitato dalla banda di memoria o dal calcolo.
+ * Se i contatori non sono permessi (perf_event_paranoid, container, VM) il programma prosegue
+ * senza misure, segnalandolo una sola volta.
+ */
+
+/* 1 se la misura dei contatori è attiva, 0 altrimenti */
+extern int contatori_attivi;
+
+/*
+ * Attiva i contatori per un circuito con numero_operatori operatori.
+ * Ritorna: 0 se tutto ok, -1 in caso di errore di allocazione
+ */
+int contatori_attiva(int numero_operatori);
+
+/*
+ * Prepara gli accumulatori per una squadra di numero_thread thread. Gli accumulatori della squadra precedente
+ * vengono liberati: le misure sono sempre quelle dell'ultima squadra creata. I descrittori dei suoi thread
+ * restano aperti finché ogni thread non chiama contatori_chiudi_thread.
+ * Ritorna: 0 se tutto ok, -1 in caso di errore di allocazione
+ */
+int contatori_inizializza_squadra(int numero_thread);
+
+/*
+ * Indica l'operatore (indice nell'array degli operatori) a cui attribuire i prossimi job.
+ * Va chiamata dal thread principale prima di avviare il job.
+ */
+void contatori_imposta_operatore(int operatore);
+
+/*
+ * Azzera e avvia i contatori del thread (li apre al primo utilizzo).
+ * Parametri: thread → indice del thread nella squadra
+ */
+void contatori_inizio_job(int thread);
+
+/*
+ * Ferma i contatori del thread e accumula i valori sull'operatore corrente.
+ * Parametri: thread → indice del thread, flop → operazioni in virgola mobile eseguite nel job,
+ * byte → byte di operandi letti dal job (matrice e vettore)
+ */
+void contatori_fine_job(int thread, double flop, double byte);
+
+/*
+ * Chiude i descrittori del thread chiamante, aperti da contatori_inizio_job. Va chiamata dal thread stesso
+ * prima di terminare, anche dopo contatori_termina.
+ */
+void contatori_chiudi_thread(void);
+
+/*
+ * Stampa il riepilogo per operatore e libera gli accumulatori.
+ * Parametri: out → stream di uscita, dati → dati di input da cui prendere i nomi degli operatori
+ */
+void contatori_termina(FILE* out, const dati_input_t* dati);
+
+#endif
@@ -0,0 +1,359 @@
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "distribuito.h"
+#include "trasporto.h"
+#include "porte.h"
+#include "memoria.h"
+
+/* Trasporti disponibili: per aggiungerne uno basta una nuova riga */
+static const struct {
+    const char* nome;
+    trasporto_t* (*crea)(int numero_processi, long dimensione, const long* confini);
+} g_trasporti[] = {
+    {"shm", crea_trasporto_memoria_condivisa},
+    {"socket", crea_trasporto_socket}
+};
+
+#define NUMERO_TRASPORTI ((int)(sizeof(g_trasporti) / sizeof(g_trasporti[0])))
+
+/* Intervallo tra due controlli dei processi figli ancora in esecuzione (1 ms) */
+#define ATTESA_FIGLI_NS 1000000L
+
+
+int trasporto_disponibile(const char* nome_trasporto) {
+    for (int k = 0; nome_trasporto && k < NUMERO_TRASPORTI; k++) {
+        if (strcmp(g_trasporti[k].nome, nome_trasporto) == 0) return 1;
+    }
+    return 0;
+}
+
+/*
+ * Funzione di supporto che accumula in out il contributo delle colonne [colonna_inizio, colonna_fine)
+ * per le righe [riga_inizio, riga_fine): out[i] += somma_j m[i][j] * blocco[j - colonna_inizio].
+ */
+static void accumula_blocco(const matrice_t* m, long riga_inizio, long riga_fine,
+                            long colonna_inizio, long colonna_fine, const complesso_t* blocco, complesso_t* out) {
+    for (long i = riga_inizio; i < riga_fine; i++) {
+        complesso_t somma = out[i - riga_inizio];
+        const complesso_t* riga = m->dati[i];
+
+        for (long j = colonna_inizio; j < colonna_fine; j++) {
+            complesso_t prodotto = moltiplica_complessi(riga[j], blocco[j - colonna_inizio]);
+            somma = somma_complessi(somma, prodotto);
+        }
+
+        out[i - riga_inizio] = somma;
+    }
+}
+
+/*
+ * Funzione di supporto: processo che possiede l'indice j del vettore (confini[r] <= j < confini[r + 1]).
+ */
+static int processo_di(const long* confini, int P, long j) {
+    int basso = 0, alto = P - 1;
+    while (basso < alto) {
+        int medio = (basso + alto + 1) / 2;
+        if (confini[medio] <= j) basso = medio;
+        else alto = medio - 1;
+    }
+    return basso;
+}
+
+/*
+ * Funzione di supporto che segna in letti[s] i processi s che possiedono almeno un'ampiezza letta dalla porta
+ * per calcolare le righe [riga_inizio, riga_fine). L'intervallo viene diviso in blocchi allineati di 2^k righe:
+ * le righe di un blocco leggono, per ogni combinazione c dei bersagli, il blocco allineato di 2^k ampiezze che
+ * ha i bit dei bersagli sopra k fissati a c. Costo O(log(dimensione) * 2^bersagli * log P), senza scorrere le righe.
+ */
+static void blocchi_letti(const porta_t* p, long riga_inizio, long riga_fine, const long* confini, int P, char* letti) {
+    int d = 1 << p->numero_bersagli;
+    long maschera = p->offset[d - 1];               // Tutti i bit dei bersagli
+
+    memset(letti, 0, P);
+    for (long x = riga_inizio; x < riga_fine; ) {
+        long ampiezza = 1;                          // Blocco allineato più grande che parte da x e resta nell'intervallo
+        while ((x & (2 * ampiezza - 1)) == 0 && x + 2 * ampiezza <= riga_fine) ampiezza *= 2;
+
+        for (int c = 0; c < d; c++) {
+            long base = ((x & ~maschera) | p->offset[c]) & ~(ampiezza - 1);
+            for (int s = processo_di(confini, P, base); s < P && confini[s] < base + ampiezza; s++) letti[s] = 1;
+        }
+        x += ampiezza;
+    }
+}
+
+/*
+ * Funzione di supporto: indirizzo dell'ampiezza di indice j nel blocco del processo che la possiede.
+ * s contiene l'ultimo processo trovato, che di solito è anche quello dell'ampiezza successiva.
+ */
+static inline const complesso_t* ampiezza_blocchi(const complesso_t* const* blocchi, const long* confini, int P,
+                                                  long j, int* s) {
+    if (j < confini[*s] || j >= confini[*s + 1]) *s = processo_di(confini, P, j);
+    return &blocchi[*s][j - confini[*s]];
+}
+
+/*
+ * Calcola le righe [riga_inizio, riga_fine) del risultato di una porta, come applica_porta_righe, leggendo le
+ * ampiezze direttamente dai blocchi dei processi (blocchi[s] contiene le righe [confini[s], confini[s + 1]))
+ * invece che da un vettore completo.
+ */
+static void applica_porta_blocchi(const porta_t* p, const complesso_t* const* blocchi, const long* confini, int P,
+                                  complesso_t* out, long riga_inizio, long riga_fine) {
+    int d = 1 << p->numero_bersagli;
+    long maschera = p->offset[d - 1];
+    int s = processo_di(confini, P, riga_inizio);
+
+    for (long i = riga_inizio; i < riga_fine; i++) {
+        if ((i & p->maschera_controlli) != p->maschera_controlli) {     // Fuori dal sottospazio attivo: invariata
+            out[i - riga_inizio] = *ampiezza_blocchi(blocchi, confini, P, i, &s);
+            continue;
+        }
+        long base = i & ~maschera;
+        int b = 0;                                  // Indice locale della riga
+        for (int j = 0; j < p->numero_bersagli; j++) {
+            if (i & (1L << p->bersagli[j])) b |= 1 << j;
+        }
+
+        double re, im;
+        if (p->tipo == PORTA_LOCALE) {
+            re = 0.0;
+            im = 0.0;
+            for (int c = 0; c < d; c++) {
+                const complesso_t* u = &p->matrice[b][c];
+                const complesso_t* z = ampiezza_blocchi(blocchi, confini, P, base + p->offset[c], &s);
+                re += u->parte_reale * z->parte_reale - u->parte_immaginaria * z->parte_immaginaria;
+                im += u->parte_reale * z->parte_immaginaria + u->parte_immaginaria * z->parte_reale;
+            }
+        } else {
+            int c = p->tipo == PORTA_PERMUTAZIONE ? p->permutazione[b] : b;
+            const complesso_t* z = ampiezza_blocchi(blocchi, confini, P, base + p->offset[c], &s);
+            re = p->fase[b].parte_reale * z->parte_reale - p->fase[b].parte_immaginaria * z->parte_immaginaria;
+            im = p->fase[b].parte_reale * z->parte_immaginaria + p->fase[b].parte_immaginaria * z->parte_reale;
+        }
+        out[i - riga_inizio] = (complesso_t){re, im, signbit(im) ? '-' : '+'};
+    }
+}
+
+/*
+ * Corpo di un processo figlio: legge il proprio blocco di righe degli operatori, esegue il circuito
+ * scambiando i blocchi del vettore con gli altri processi e scrive il proprio blocco finale in risultato.
+ * Ogni processo tiene solo il proprio blocco: per una porta riceve soltanto i blocchi dei processi che
+ * possiedono ampiezze lette dalle sue righe (per un bersaglio tra i qubit alti, il blocco del partner)
+ * e li legge dove il trasporto li ha depositati, senza ricomporre lo stato completo.
+ * Ritorna 0 se tutto ok, -1 in caso di errore.
+ */
+static int processo_figlio(trasporto_t* t, int rank, const dati_input_t* iniziale,
+                           const char* file_circuito, complesso_t* risultato) {
+    int ret = -1;
+    int P = t->numero_processi;
+    long riga_inizio = t->confini[rank];
+    long riga_fine = t->confini[rank + 1];
+    long righe = riga_fine - riga_inizio;
+
+    dati_input_t dati = (dati_input_t){0};
+    dati.numero_qubit = iniziale->numero_qubit;
+    complesso_t* locale = (complesso_t*)malloc(righe * sizeof(complesso_t));     // Blocco corrente dello stato
+    complesso_t* nuovo = (complesso_t*)malloc(righe * sizeof(complesso_t));      // Blocco in calcolo
+    const complesso_t** blocchi = (const complesso_t**)calloc(P, sizeof(complesso_t*));   // Blocchi letti da una porta
+    char* letti = (char*)malloc(P);                 // Processi di cui le proprie righe leggono il blocco
+    char* destinatari = (char*)malloc(P);           // Processi le cui righe leggono il proprio blocco
+    char* altri = (char*)malloc(P);
+    long passo = 0;                                 // Scambi eseguiti: uno per istruzione densa, uno per porta
+    int aperto = 0;
+
+    if (!locale || !nuovo || !blocchi || !letti || !destinatari || !altri) goto fine;
+    if (leggi_input_righe(file_circuito, &dati, riga_inizio, riga_fine) != 0) goto fine;
+    if (!(dati.numero_operatori > 0 && dati.circuito != NULL)) goto fine;
+
+    if (t->apri(t, rank) != 0) goto fine;
+    aperto = 1;
+
+    memcpy(locale, &iniziale->stato_iniziale[riga_inizio], righe * sizeof(complesso_t));
+
+    for (long k = 0; k < dati.numero_istruzioni; k++) {
+        operatore_quantistico_t* op = trova_operatore(&dati, dati.circuito[k].nome_operatore);
+        if (!op || (!op->matrice && !op->porte)) {
+            fprintf(stderr, "Processo %d: operatore %s non definito\n", rank, dati.circuito[k].nome_operatore);
+            goto fine;
+        }
+
+        if (op->porte) {
+            for (int g = 0; g < op->numero_porte; g++) {
+                const porta_t* p = &op->porte[g];
+
+                /* Il blocco va solo ai processi che ne leggono le ampiezze: per un bersaglio tra i qubit bassi
+                   nessuno, per uno tra i qubit alti il processo che possiede le righe partner */
+                for (int r = 0; r < P; r++) {
+                    blocchi_letti(p, t->confini[r], t->confini[r + 1], t->confini, P, altri);
+                    destinatari[r] = r != rank && altri[rank];
+                }
+                if (t->pubblica(t, rank, passo, locale, destinatari) != 0) goto fine;
+
+                /* Si attende ogni processo, anche quelli di cui non si legge il blocco: chi arriva al passo
+                   successivo ha finito di leggere i blocchi di questo, quindi il trasporto può riusarne le aree */
+                blocchi_letti(p, riga_inizio, riga_fine, t->confini, P, letti);
+                for (int d = 1; d < P; d++) {
+                    int sorgente = (rank + d) % P;
+                    const complesso_t* blocco = t->attendi(t, rank, passo, sorgente);
+                    if (!blocco) goto fine;
+                    blocchi[sorgente] = letti[sorgente] ? blocco : NULL;
+                }
+                blocchi[rank] = locale;
+
+                applica_porta_blocchi(p, blocchi, t->confini, P, nuovo, riga_inizio, riga_fine);
+                passo++;
+
+                complesso_t* tmp = locale;          // Il nuovo blocco diventa lo stato corrente
+                locale = nuovo;
+                nuovo = tmp;
+            }
+        } else {
+            if (t->pubblica(t, rank, passo, locale, NULL) != 0) goto fine;     // Ogni riga legge tutte le colonne
+            for (long i = 0; i < righe; i++) nuovo[i] = (complesso_t){0.0, 0.0, '+'};
+
+            /* Prima le colonne del proprio blocco, già disponibili: intanto arrivano quelle degli altri */
+            accumula_blocco(op->matrice, riga_inizio, riga_fine, riga_inizio, riga_fine, locale, nuovo);
+
+            for (int d = 1; d < P; d++) {
+                int sorgente = (rank + d) % P;          // Ordine ruotato: i processi non attendono tutti lo stesso blocco
+                const complesso_t* blocco = t->attendi(t, rank, passo, sorgente);
+                if (!blocco) goto fine;
+                accumula_blocco(op->matrice, riga_inizio, riga_fine,
+                                t->confini[sorgente], t->confini[sorgente + 1], blocco, nuovo);
+            }
+            passo++;
+
+            complesso_t* tmp = locale;              // Il nuovo blocco diventa lo stato corrente
+            locale = nuovo;
+            nuovo = tmp;
+        }
+    }
+
+    memcpy(&risultato[riga_inizio], locale, righe * sizeof(complesso_t));
+    ret = 0;
+
+fine:
+    if (aperto) t->chiudi(t, rank);
+    free(locale);
+    free(nuovo);
+    free(blocchi);
+    free(letti);
+    free(destinatari);
+    free(altri);
+    libera_dati_input(&dati);
+    return ret;
+}
+
+int esegui_circuito_distribuito(const dati_input_t* dati, const char* file_circuito, int numero_processi,
+                                const char* nome_trasporto, complesso_t** stato_finale) {
+    if (!dati || !dati->stato_iniziale || !file_circuito || !stato_finale || numero_processi <= 0) return -1;
+
+    int ret = -1;
+    long dimensione = 1L << dati->numero_qubit;
+    if (numero_processi > dimensione) numero_processi = dimensione;   // Almeno una riga per processo
+
+    int k_trasporto = -1;
+    for (int k = 0; nome_trasporto && k < NUMERO_TRASPORTI; k++) {
+        if (strcmp(g_trasporti[k].nome, nome_trasporto) == 0) k_trasporto = k;
+    }
+    if (k_trasporto < 0) return -1;
+
+    /* Vettori allocati oltre allo stato iniziale: area del risultato, stato finale, blocchi corrente e nuovo
+       dei processi (in tutto due vettori) e i due vettori del trasporto, uno solo condiviso con la memoria
+       condivisa, uno per processo con i socket (che ricevono i blocchi di tutti per le matrici dense) */
+    int copie = 4 + 2 * (strcmp(g_trasporti[k_trasporto].nome, "shm") == 0 ? 1 : numero_processi);
+    if (verifica_memoria(dati->numero_qubit, copie) != 0) return -1;
+
+    /* Suddivide le righe tra i processi come la squadra di thread le suddivide tra i thread */
+    long* confini = (long*)malloc((numero_processi + 1) * sizeof(long));
+    pid_t* figli = (pid_t*)calloc(numero_processi, sizeof(pid_t));
+    trasporto_t* t = NULL;
+    size_t byte_risultato = dimensione * sizeof(complesso_t);
+    complesso_t* risultato = MAP_FAILED;
+    int creati = 0;
+
+    if (!confini || !figli) goto fine;
+    for (int p = 0; p <= numero_processi; p++) {
+        confini[p] = dimensione * p / numero_processi;
+    }
+
+    t = g_trasporti[k_trasporto].crea(numero_processi, dimensione, confini);
+    if (!t) goto fine;
+
+    /* Area condivisa in cui ogni processo scrive il proprio blocco dello stato finale */
+    risultato = (complesso_t*)mmap(NULL, byte_risultato, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (risultato == MAP_FAILED) goto fine;
+
+    fflush(stdout);     // Evita che i buffer non ancora scritti vengano duplicati nei figli
+    fflush(stderr);
+
+    for (int p = 0; p < numero_processi; p++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            goto fine;
+        }
+        if (pid == 0) {                             // Processo figlio: esegue il proprio blocco e termina
+            int esito = processo_figlio(t, p, dati, file_circuito, risultato);
+            _exit(esito == 0 ? 0 : 1);
+        }
+        figli[p] = pid;
+        creati++;
+    }
+
+    /* I figli hanno ereditato il trasporto: il padre rilascia la propria copia */
+    t->distruggi(t);
+    t = NULL;
+
+    /* Attende i propri figli con waitpid (gli altri figli del processo che usa la libreria non vengono toccati).
+       L'attesa non è bloccante: se un figlio fallisce, gli altri resterebbero in attesa dei suoi blocchi e vanno
+       terminati subito, qualunque sia l'ordine in cui i figli escono */
+    ret = 0;
+    for (int attivi = creati; attivi > 0; ) {
+        int terminati = 0;
+        for (int p = 0; p < numero_processi; p++) {
+            if (figli[p] <= 0) continue;
+            int stato;
+            pid_t pid = waitpid(figli[p], &stato, WNOHANG);
+            if (pid == 0 || (pid < 0 && errno == EINTR)) continue;
+
+            figli[p] = 0;
+            attivi--;
+            terminati++;
+            if (pid < 0 || !WIFEXITED(stato) || WEXITSTATUS(stato) != 0) {
+                ret = -1;
+                for (int q = 0; q < numero_processi; q++) {
+                    if (figli[q] > 0) kill(figli[q], SIGKILL);
+                }
+            }
+        }
+        if (terminati == 0) nanosleep(&(struct timespec){0, ATTESA_FIGLI_NS}, NULL);
+    }
+    creati = 0;
+
+    if (ret == 0) {
+        *stato_finale = alloca_stato(dimensione, 0);
+        if (*stato_finale) memcpy(*stato_finale, risultato, byte_risultato);
+        else ret = -1;
+    }
+
+fine:
+    if (creati > 0) {                               // Errore durante la creazione: termina i figli già creati
+        for (int p = 0; p < creati; p++) kill(figli[p], SIGKILL);
+        for (int p = 0; p < creati; p++) waitpid(figli[p], NULL, 0);
+        ret = -1;
+    }
+    if (t) t->distruggi(t);
+    if (risultato != MAP_FAILED) munmap(risultato, byte_risultato);
+    free(confini);
+    free(figli);
+    return ret;
+}
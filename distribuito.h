@@ -0,0 +1,29 @@
+#ifndef DISTRIBUITO_H
+#define DISTRIBUITO_H
+
+#include "lettore_input.h"
+
+/*
+ * Esegue il circuito suddividendo il vettore di stato e le righe degli operatori tra più processi.
+ * Il processo k possiede un blocco contiguo di righe: legge dal file del circuito solo quelle righe
+ * di ogni operatore e, ad ogni istruzione, calcola il proprio blocco del nuovo stato. Prima usa la
+ * parte del vettore che possiede già, poi i blocchi degli altri processi man mano che arrivano
+ * attraverso il trasporto, così la comunicazione si sovrappone al calcolo.
+ * Parametri:
+ * dati → dati con #qubits e #init già letti dal processo padre
+ * file_circuito → file con #define e #circ, letto da ogni processo
+ * numero_processi → processi da creare (limitato alla dimensione del vettore)
+ * nome_trasporto → "shm" (memoria condivisa) oppure "socket" (socket Unix)
+ * stato_finale → valorizzato con un nuovo vettore contenente lo stato finale
+ * Ritorna 0 se tutto ok, -1 in caso di errore (trasporto sconosciuto, fork fallita, processo fallito).
+ */
+int esegui_circuito_distribuito(const dati_input_t* dati, const char* file_circuito, int numero_processi,
+                                const char* nome_trasporto, complesso_t** stato_finale);
+
+/*
+ * Verifica che il nome indichi un trasporto disponibile.
+ * Ritorna: 1 se disponibile, 0 altrimenti
+ */
+int trasporto_disponibile(const char* nome_trasporto);
+
+#endif
@@ -0,0 +1,273 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include "flusso.h"
+#include "coda.h"
+#include "memoria.h"
+#include "matrice.h"
+#include "thread_matrice.h"
+#include "profilo.h"
+
+/* Dati di un thread di stadio: esegue il proprio tratto su ogni stato della coda di ingresso */
+typedef struct {
+    const istruzione_circuito_t* istruzioni;    // Prima istruzione del tratto
+    int numero_istruzioni;
+    squadra_t* squadra;                         // Squadra dello stadio, NULL per eseguire nel thread dello stadio
+    coda_spsc_t* ingresso;
+    coda_spsc_t* uscita;
+    esegui_tratto_t esegui;
+    void* argomento;
+    int* errore;                                // Condiviso: 1 dopo il primo errore di qualsiasi thread
+    double lavoro;                              // Microsecondi passati a eseguire il tratto
+} stadio_t;
+
+/* Dati del thread che legge il flusso degli stati iniziali */
+typedef struct {
+    FILE* file;
+    long dimensione;
+    coda_spsc_t* uscita;
+    int* errore;
+    long letti;
+} lettore_t;
+
+/* Statistiche dell'ultima esecuzione di un flusso del thread chiamante (lette solo da stampa_flusso) */
+static __thread struct {
+    int eseguito;           // 1 dopo la prima esecuzione
+    long stati;             // Stati scritti
+    double tempo;           // Microsecondi dall'avvio all'ultimo stato scritto
+    int stadi;
+    struct {
+        int prima;          // Prima istruzione dello stadio
+        int istruzioni;
+        int thread;         // Thread della squadra (0 senza squadra)
+        double lavoro;
+        long attese_vuota;  // Estrazioni che hanno trovato vuota la coda di ingresso
+        long attese_piena;  // Inserimenti che hanno trovato piena la coda di uscita
+    } stadio[MAX_STADI_FLUSSO];
+} g_statistiche;
+
+
+/* Funzione di supporto: segnala un errore a tutti i thread del flusso */
+static void segnala_errore(int* errore) {
+    __atomic_store_n(errore, 1, __ATOMIC_RELAXED);
+}
+
+static int errore_segnalato(int* errore) {
+    return __atomic_load_n(errore, __ATOMIC_RELAXED);
+}
+
+/*
+ * Funzione di supporto: divide le istruzioni in al più stadi tratti consecutivi di costo simile, senza
+ * iniziare un tratto su un'istruzione di costo 0. Ogni stadio prende istruzioni finché non raggiunge la sua
+ * quota del costo rimasto, lasciando almeno un'istruzione divisibile a ciascuno degli stadi successivi.
+ * inizi riceve stadi + 1 valori (l'ultimo è numero_istruzioni). Ritorna il numero di stadi usati.
+ */
+static int dividi_in_stadi(const long* costi, int numero_istruzioni, int stadi, int* inizi) {
+    int divisibili = 0;                         // Istruzioni da cui può iniziare uno stadio
+    long totale = 0;
+    for (int i = 0; i < numero_istruzioni; i++) {
+        if (i == 0 || costi[i] > 0) divisibili++;
+        totale += costi[i];
+    }
+    if (stadi > divisibili) stadi = divisibili;
+    if (stadi == 0) {
+        inizi[0] = 0;
+        return 0;
+    }
+
+    int s = 0;
+    long costo_stadio = 0;
+    long residuo = totale;                      // Costo dallo stadio corrente in poi
+    inizi[0] = 0;
+    for (int i = 0; i < numero_istruzioni; i++) {
+        int divisibile = (i == 0 || costi[i] > 0);
+        if (divisibile && i > 0 && s + 1 < stadi &&
+            (costo_stadio * (stadi - s) >= residuo || divisibili == stadi - s - 1)) {
+            residuo -= costo_stadio;
+            costo_stadio = 0;
+            inizi[++s] = i;
+        }
+        if (divisibile) divisibili--;           // Da qui: divisibili dopo la i-esima
+        costo_stadio += costi[i];
+    }
+    inizi[stadi] = numero_istruzioni;
+    return stadi;
+}
+
+/* Thread del lettore: legge gli stati dal flusso e li passa al primo stadio finché il flusso non finisce */
+static void* thread_lettore(void* arg) {
+    lettore_t* l = (lettore_t*)arg;
+
+    while (!errore_segnalato(l->errore)) {
+        complesso_t* stato = alloca_stato(l->dimensione, 0);
+        if (!stato) {
+            segnala_errore(l->errore);
+            break;
+        }
+        int esito = leggi_stato(l->file, l->dimensione, stato);
+        if (esito != 0) {                       // Fine del flusso o stato non valido
+            free(stato);
+            if (esito < 0) {
+                fprintf(stderr, "Errore: stato %ld del flusso non valido\n", l->letti + 1);
+                segnala_errore(l->errore);
+            }
+            break;
+        }
+        coda_spsc_inserisci(l->uscita, stato);
+        l->letti++;
+    }
+
+    coda_spsc_chiudi(l->uscita);
+    return NULL;
+}
+
+/* Thread di uno stadio: dopo un errore continua a svuotare la coda di ingresso, così nessun thread resta bloccato */
+static void* thread_stadio(void* arg) {
+    stadio_t* s = (stadio_t*)arg;
+    imposta_squadra_corrente(s->squadra);
+
+    void* elemento;
+    while (coda_spsc_estrai(s->ingresso, &elemento) == 0) {
+        complesso_t* stato = (complesso_t*)elemento;
+        if (errore_segnalato(s->errore)) {
+            free(stato);
+            continue;
+        }
+
+        double inizio = profilo_adesso();
+        complesso_t* nuovo = NULL;
+        if (s->esegui(s->argomento, s->istruzioni, s->numero_istruzioni, stato, &nuovo) != 0) {
+            segnala_errore(s->errore);
+            free(stato);
+            continue;
+        }
+        s->lavoro += profilo_adesso() - inizio;
+
+        if (nuovo != stato) free(stato);
+        coda_spsc_inserisci(s->uscita, nuovo);
+    }
+
+    coda_spsc_chiudi(s->uscita);
+    return NULL;
+}
+
+int esegui_flusso(FILE* ingresso, FILE* uscita, long dimensione, const istruzione_circuito_t* istruzioni,
+                  int numero_istruzioni, const long* costi, int stadi, int thread_per_stadio,
+                  esegui_tratto_t esegui, void* argomento, long* numero_stati) {
+    if (!ingresso || !uscita || dimensione <= 0 || numero_istruzioni < 0 || (numero_istruzioni > 0 && (!istruzioni || !costi)) ||
+        stadi <= 0 || stadi > MAX_STADI_FLUSSO || thread_per_stadio < 0 || !esegui) return -1;
+
+    int inizi[MAX_STADI_FLUSSO + 1];
+    stadi = dividi_in_stadi(costi, numero_istruzioni, stadi, inizi);
+
+    /* Code tra i thread: lettore → stadio 0 → ... → stadio stadi-1 → chiamante */
+    int numero_code = stadi + 1;
+    coda_spsc_t* code = NULL;
+    stadio_t* dati_stadi = (stadio_t*)calloc(stadi > 0 ? stadi : 1, sizeof(stadio_t));
+    pthread_t* thread = (pthread_t*)malloc((stadi + 1) * sizeof(pthread_t));
+    int errore = 0;
+    int code_pronte = 0, avviati = 0;
+    if (posix_memalign((void**)&code, LINEA_CACHE, numero_code * sizeof(coda_spsc_t)) != 0) code = NULL;
+    if (!code || !dati_stadi || !thread) goto fine;
+
+    for (; code_pronte < numero_code; code_pronte++) {
+        if (coda_spsc_inizializza(&code[code_pronte], CAPACITA_FLUSSO) != 0) goto fine;
+    }
+
+    /* Squadre degli stadi, create prima di avviare qualsiasi thread */
+    for (int s = 0; s < stadi; s++) {
+        dati_stadi[s] = (stadio_t){&istruzioni[inizi[s]], inizi[s + 1] - inizi[s], NULL, &code[s], &code[s + 1],
+                                   esegui, argomento, &errore, 0.0};
+        if (thread_per_stadio > 0) {
+            dati_stadi[s].squadra = crea_squadra(thread_per_stadio, dimensione);
+            if (!dati_stadi[s].squadra) {
+                errore = 1;
+                goto fine;
+            }
+        }
+    }
+
+    double inizio = profilo_adesso();
+    lettore_t lettore = {ingresso, dimensione, &code[0], &errore, 0};
+    for (int s = 0; s < stadi; s++) {
+        if (pthread_create(&thread[avviati], NULL, thread_stadio, &dati_stadi[s]) != 0) {
+            segnala_errore(&errore);
+            coda_spsc_chiudi(&code[0]);         // Senza lettore gli stadi già avviati si fermano a catena
+            break;
+        }
+        avviati++;
+    }
+    if (avviati == stadi) {
+        if (pthread_create(&thread[avviati], NULL, thread_lettore, &lettore) != 0) {
+            segnala_errore(&errore);
+            coda_spsc_chiudi(&code[0]);
+        } else {
+            avviati++;
+        }
+    }
+
+    /* Il chiamante scrive gli stati finali: le code sono FIFO e ogni stadio ha un solo thread, quindi
+     * arrivano nell'ordine di ingresso. Con uno stadio non avviato la coda finale resta vuota e chiusa */
+    if (avviati < stadi) coda_spsc_chiudi(&code[stadi]);
+    long scritti = 0;
+    void* elemento;
+    while (coda_spsc_estrai(&code[stadi], &elemento) == 0) {
+        complesso_t* stato = (complesso_t*)elemento;
+        if (!errore_segnalato(&errore)) {
+            fprintf(uscita, "\nStato finale (stato %ld):\n", scritti + 1);
+            if (scrivi_vettore(uscita, stato, dimensione) != 0 || fprintf(uscita, "\n") < 0 || fflush(uscita) != 0) {
+                segnala_errore(&errore);
+            } else {
+                scritti++;
+            }
+        }
+        free(stato);
+    }
+    for (int t = 0; t < avviati; t++) pthread_join(thread[t], NULL);
+
+    g_statistiche.eseguito = 1;
+    g_statistiche.stati = scritti;
+    g_statistiche.tempo = profilo_adesso() - inizio;
+    g_statistiche.stadi = stadi;
+    for (int s = 0; s < stadi; s++) {
+        g_statistiche.stadio[s].prima = inizi[s];
+        g_statistiche.stadio[s].istruzioni = inizi[s + 1] - inizi[s];
+        g_statistiche.stadio[s].thread = thread_per_stadio;
+        g_statistiche.stadio[s].lavoro = dati_stadi[s].lavoro;
+        g_statistiche.stadio[s].attese_vuota = code[s].attese_vuota;
+        g_statistiche.stadio[s].attese_piena = code[s + 1].attese_piena;
+    }
+    if (numero_stati) *numero_stati = scritti;
+    if (avviati < stadi + 1) errore = 1;        // Qualche thread non è stato avviato
+
+fine:
+    if (!code || !dati_stadi || !thread || code_pronte < numero_code) errore = 1;
+    if (dati_stadi) {
+        for (int s = 0; s < stadi; s++) distruggi_squadra(dati_stadi[s].squadra);
+    }
+    if (code) {
+        for (int k = 0; k < code_pronte; k++) coda_spsc_distruggi(&code[k]);
+    }
+    free(code);
+    free(dati_stadi);
+    free(thread);
+    return errore ? -1 : 0;
+}
+
+void stampa_flusso(FILE* out) {
+    fprintf(out, "\n=== Flusso di stati ===\n");
+    if (!g_statistiche.eseguito) {
+        fprintf(out, "Nessun flusso eseguito\n");
+        return;
+    }
+    double secondi = g_statistiche.tempo / 1e6;
+    fprintf(out, "Stati elaborati: %ld in %.3f s (%.1f stati/s), stadi: %d, capacita' delle code: %d\n",
+            g_statistiche.stati, secondi, secondi > 0 ? g_statistiche.stati / secondi : 0.0,
+            g_statistiche.stadi, CAPACITA_FLUSSO);
+    for (int s = 0; s < g_statistiche.stadi; s++) {
+        fprintf(out, "Stadio %d: istruzioni %d..%d, thread %d, lavoro %.3f s (%.1f%%), ingresso vuoto %ld volte, uscita piena %ld volte\n",
+                s + 1, g_statistiche.stadio[s].prima + 1, g_statistiche.stadio[s].prima + g_statistiche.stadio[s].istruzioni,
+                g_statistiche.stadio[s].thread, g_statistiche.stadio[s].lavoro / 1e6,
+                g_statistiche.tempo > 0 ? 100.0 * g_statistiche.stadio[s].lavoro / g_statistiche.tempo : 0.0,
+                g_statistiche.stadio[s].attese_vuota, g_statistiche.stadio[s].attese_piena);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef FLUSSO_H
+#define FLUSSO_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+#include "prefissi.h"
+
+/* Stati in attesa al massimo in ogni coda tra due stadi consecutivi */
+#define CAPACITA_FLUSSO 4
+
+/* Stadi al massimo della pipeline del flusso */
+#define MAX_STADI_FLUSSO 64
+
+/* Vettori di stato presenti insieme al massimo con stadi stadi: le code piene, più lo stato di partenza e
+ * quello prodotto da ogni stadio, quello in lettura e quello in scrittura */
+#define COPIE_STATO_FLUSSO(stadi) (((stadi) + 1) * CAPACITA_FLUSSO + 2 * (stadi) + 2)
+
+/*
+ * Esegue il circuito su un flusso di stati iniziali letti uno alla volta (leggi_stato), senza conoscerne
+ * prima il numero. Le istruzioni vengono divise in stadi di istruzioni consecutive con costo simile; ogni
+ * stadio ha un proprio thread (e una propria squadra) e usa sempre gli stessi operatori, che così restano
+ * nella cache del suo core. Gli stati passano da uno stadio al successivo attraverso code senza lock
+ * limitate (coda_spsc_t): un thread legge il flusso, il thread chiamante scrive gli stati finali
+ * nell'ordine di ingresso, ognuno preceduto dall'intestazione "Stato finale (stato k):".
+ * Parametri:
+ * ingresso → flusso degli stati iniziali, uscita → file degli stati finali (svuotato dopo ogni stato)
+ * dimensione → lunghezza degli stati, istruzioni → circuito, numero_istruzioni → sua lunghezza
+ * costi → costo stimato di ogni istruzione; 0 per un'istruzione che non può iniziare uno stadio (ad
+ * esempio l'interno di un tratto fuso, che va eseguito insieme alla prima istruzione del tratto)
+ * stadi → stadi richiesti (1..MAX_STADI_FLUSSO, ridotti se le istruzioni divisibili sono meno)
+ * thread_per_stadio → thread della squadra di ogni stadio, 0 per eseguire senza squadra
+ * esegui → funzione che esegue un tratto (chiamata dai thread degli stadi), argomento → passato a esegui
+ * numero_stati → valorizzato con il numero di stati scritti (può essere NULL)
+ * Ritorna: 0 se tutto ok, -1 in caso di errore (stato non valido nel flusso, esecuzione o scrittura fallita)
+ */
+int esegui_flusso(FILE* ingresso, FILE* uscita, long dimensione, const istruzione_circuito_t* istruzioni,
+                  int numero_istruzioni, const long* costi, int stadi, int thread_per_stadio,
+                  esegui_tratto_t esegui, void* argomento, long* numero_stati);
+
+/*
+ * Stampa il riepilogo dell'ultima esecuzione di un flusso del thread chiamante: stati elaborati, e per ogni
+ * stadio istruzioni, thread, tempo di lavoro e attese sulle code (vuota in ingresso, piena in uscita).
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_flusso(FILE* out);
+
+#endif
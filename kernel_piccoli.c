@@ -0,0 +1,97 @@
+#include <math.h>
+#include <stdlib.h>
+#include "kernel_piccoli.h"
+
+/*
+ * Genera un kernel matrice × vettore per la dimensione fissa D.
+ * Essendo D una costante, il compilatore srotola completamente il ciclo sulle colonne
+ * (e quello sulle righe fino a SROTOLA_RIGHE) e tiene il vettore di ingresso nei registri.
+ * Il prodotto complesso è scritto per esteso su parti reali e immaginarie separate.
+ */
+#define DEFINISCI_KERNEL_PICCOLO(D, SROTOLA_RIGHE)                                          \
+static void kernel_piccolo_##D(const double* restrict re, const double* restrict im,        \
+                               const complesso_t* restrict v, complesso_t* restrict out) {  \
+    double vr[D], vi[D];                                                                    \
+    _Pragma("GCC unroll 32")                                                                \
+    for (int j = 0; j < D; j++) {                                                           \
+        vr[j] = v[j].parte_reale;                                                           \
+        vi[j] = v[j].parte_immaginaria;                                                     \
+    }                                                                                       \
+    _Pragma(SROTOLA_RIGHE)                                                                  \
+    for (int i = 0; i < D; i++) {                                                           \
+        const double* riga_re = re + i * D;                                                 \
+        const double* riga_im = im + i * D;                                                 \
+        double somma_re = 0.0, somma_im = 0.0;                                              \
+        _Pragma("GCC unroll 32")                                                            \
+        for (int j = 0; j < D; j++) {                                                       \
+            somma_re += riga_re[j] * vr[j] - riga_im[j] * vi[j];                            \
+            somma_im += riga_re[j] * vi[j] + riga_im[j] * vr[j];                            \
+        }                                                                                   \
+        out[i].parte_reale = somma_re;                                                      \
+        out[i].parte_immaginaria = somma_im;                                                \
+        out[i].segno = signbit(somma_im) ? '-' : '+';                                       \
+    }                                                                                       \
+}
+
+DEFINISCI_KERNEL_PICCOLO(2, "GCC unroll 2")
+DEFINISCI_KERNEL_PICCOLO(4, "GCC unroll 4")
+DEFINISCI_KERNEL_PICCOLO(8, "GCC unroll 8")
+DEFINISCI_KERNEL_PICCOLO(16, "GCC unroll 2")
+DEFINISCI_KERNEL_PICCOLO(32, "GCC unroll 1")
+
+/* Tabella dei kernel indicizzata da log2(dimensione) */
+typedef void (*kernel_piccolo_t)(const double*, const double*, const complesso_t*, complesso_t*);
+
+static const kernel_piccolo_t g_kernel[] = {
+    NULL,                   // dimensione 1: non usata (almeno un qubit)
+    kernel_piccolo_2,
+    kernel_piccolo_4,
+    kernel_piccolo_8,
+    kernel_piccolo_16,
+    kernel_piccolo_32
+};
+
+
+/*
+ * Funzione di supporto che ritorna log2(dimensione) se la dimensione ha un kernel, -1 altrimenti.
+ */
+static int indice_kernel(long dimensione) {
+    for (int k = 1; k < (int)(sizeof(g_kernel) / sizeof(g_kernel[0])); k++) {
+        if (dimensione == (1 << k)) return k;
+    }
+    return -1;
+}
+
+int kernel_piccolo_disponibile(long dimensione) {
+    return indice_kernel(dimensione) > 0;
+}
+
+int prepara_matrice_piccola(const matrice_t* m, matrice_piccola_t* p) {
+    if (m == NULL || p == NULL || !kernel_piccolo_disponibile(m->dimensione)) return -1;
+
+    int n = m->dimensione;
+    p->dimensione = n;
+    p->re = (double*)malloc(2 * n * n * sizeof(double));    // Un solo blocco: prima le parti reali, poi le immaginarie
+    if (!p->re) return -1;
+    p->im = p->re + n * n;
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            p->re[i * n + j] = m->dati[i][j].parte_reale;
+            p->im[i * n + j] = m->dati[i][j].parte_immaginaria;
+        }
+    }
+    return 0;
+}
+
+void libera_matrice_piccola(matrice_piccola_t* p) {
+    if (p == NULL) return;
+    free(p->re);        // p->im punta nello stesso blocco
+    p->re = NULL;
+    p->im = NULL;
+    p->dimensione = 0;
+}
+
+void moltiplica_matrice_vettore_piccola(const matrice_piccola_t* p, const complesso_t* v, complesso_t* out) {
+    g_kernel[indice_kernel(p->dimensione)](p->re, p->im, v, out);
+}
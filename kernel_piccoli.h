@@ -0,0 +1,45 @@
+#ifndef KERNEL_PICCOLI_H
+#define KERNEL_PICCOLI_H
+
+#include "matrice.h"
+
+/* Dimensione massima (2^5 = 32) gestita dai kernel specializzati */
+#define DIMENSIONE_MAX_KERNEL_PICCOLO 32
+
+/*
+ * Nuovo tipo che rappresenta una matrice quadrata piccola in forma compatta:
+ * parti reali e immaginarie in due array contigui riga per riga, così che l'intero
+ * operatore (al massimo 2 × 32 × 32 double = 16 KiB) resti nella cache L1.
+ */
+typedef struct {
+    int dimensione;     // Numero di righe e colonne (2, 4, 8, 16 o 32)
+    double* re;         // Parti reali, re[i * dimensione + j]
+    double* im;         // Parti immaginarie, im[i * dimensione + j]
+} matrice_piccola_t;
+
+/*
+ * Verifica se esiste un kernel specializzato per la dimensione indicata.
+ * Ritorna: 1 se la dimensione è una potenza di due tra 2 e 32, 0 altrimenti
+ */
+int kernel_piccolo_disponibile(long dimensione);
+
+/*
+ * Copia una matrice in forma compatta per i kernel specializzati.
+ * Parametri: m → matrice di origine, p → struttura da valorizzare
+ * Ritorna: 0 se tutto ok, -1 se la dimensione non è supportata o l'allocazione fallisce
+ */
+int prepara_matrice_piccola(const matrice_t* m, matrice_piccola_t* p);
+
+/*
+ * Libera la memoria di una matrice compatta.
+ */
+void libera_matrice_piccola(matrice_piccola_t* p);
+
+/*
+ * Moltiplicazione matrice × vettore con il kernel srotolato per la dimensione di p,
+ * eseguita dal thread chiamante senza passare dalla squadra di thread.
+ * Parametri: p → matrice compatta, v → vettore di ingresso, out → vettore risultato (distinto da v)
+ */
+void moltiplica_matrice_vettore_piccola(const matrice_piccola_t* p, const complesso_t* v, complesso_t* out);
+
+#endif
@@ -0,0 +1,410 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kronecker.h"
+#include "thread_matrice.h"
+#include "archivio_operatori.h"
+
+/*
+ * Matrice residua della fattorizzazione in forma compatta: il bit j degli indici di riga e colonna
+ * corrisponde al qubit qubit[j] del circuito. Finché nessun qubit è stato separato il residuo è la
+ * matrice dell'operatore stessa, letta sul posto (m); dopo la prima separazione è in re/im.
+ */
+typedef struct {
+    int numero_qubit;       // Qubit ancora non separati
+    int qubit[32];          // Qubit del circuito corrispondenti ai bit degli indici
+    long dimensione;        // 2^numero_qubit
+    const matrice_t* m;     // Matrice dell'operatore (NULL dopo la prima separazione)
+    double* re;             // Parti reali, re[i * dimensione + j]
+    double* im;             // Parti immaginarie
+} residuo_t;
+
+/* Funzione di supporto: parte reale dell'elemento (i, k) del residuo */
+static inline double residuo_re(const residuo_t* r, long i, long k) {
+    return r->m ? r->m->dati[i][k].parte_reale : r->re[i * r->dimensione + k];
+}
+
+/* Funzione di supporto: parte immaginaria dell'elemento (i, k) del residuo */
+static inline double residuo_im(const residuo_t* r, long i, long k) {
+    return r->m ? r->m->dati[i][k].parte_immaginaria : r->im[i * r->dimensione + k];
+}
+
+
+/* Perno della separazione: elemento di modulo massimo (a parità di modulo il primo nell'ordine delle righe) */
+typedef struct {
+    double modulo;
+    long indice;            // i * dimensione + j
+} perno_t;
+
+/* Dati passati alle parti parallele della separazione di un bit */
+typedef struct {
+    const residuo_t* r;
+    int j;                  // Bit da separare
+    long a0, b0;            // Bit j della riga e della colonna del perno
+    double ur[2][2], ui[2][2];  // Fattore 2x2
+    double* sr;             // Residuo S (h x h)
+    double* si;
+    double soglia;
+} lavoro_separazione_t;
+
+/* Funzione di supporto: inserisce il bit v in posizione j dell'indice x */
+static inline long inserisci_bit(long x, int j, long v) {
+    return ((x >> j) << (j + 1)) | (v << j) | (x & ((1L << j) - 1));
+}
+
+/* Funzione eseguita dalla squadra: perno delle righe [inizio, fine) del residuo */
+static void cerca_perno(void* argomento, long inizio, long fine, void* parziale) {
+    const residuo_t* r = (const residuo_t*)argomento;
+    perno_t* perno = (perno_t*)parziale;
+    for (long i = inizio; i < fine; i++) {
+        for (long k = 0; k < r->dimensione; k++) {
+            double re = residuo_re(r, i, k), im = residuo_im(r, i, k);
+            double m = re * re + im * im;
+            if (m > perno->modulo) {
+                perno->modulo = m;
+                perno->indice = i * r->dimensione + k;
+            }
+        }
+    }
+}
+
+/* Funzione di supporto: combina i perni delle parti (le parti arrivano in ordine, vince il primo massimo) */
+static void combina_perno(void* risultato, const void* parziale) {
+    perno_t* p = (perno_t*)risultato;
+    const perno_t* q = (const perno_t*)parziale;
+    if (q->modulo > p->modulo) *p = *q;
+}
+
+/* Funzione di supporto: combina due esiti con AND logico */
+static void combina_e(void* risultato, const void* parziale) {
+    *(int*)risultato = *(int*)risultato && *(const int*)parziale;
+}
+
+/* Funzione di supporto: combina due massimi */
+static void combina_massimo(void* risultato, const void* parziale) {
+    *(double*)risultato = fmax(*(double*)risultato, *(const double*)parziale);
+}
+
+/* Funzione eseguita dalla squadra: righe [inizio, fine) di S[x][y] = R[x con bit j = a0][y con bit j = b0] / perno */
+static void calcola_residuo(void* argomento, long inizio, long fine) {
+    const lavoro_separazione_t* l = (const lavoro_separazione_t*)argomento;
+    long d = l->r->dimensione, h = d / 2;
+    double pr = l->ur[l->a0][l->b0], pi = l->ui[l->a0][l->b0], pm = pr * pr + pi * pi;
+
+    for (long x = inizio; x < fine; x++) {
+        long i = inserisci_bit(x, l->j, l->a0);
+        for (long y = 0; y < h; y++) {
+            long c = inserisci_bit(y, l->j, l->b0);
+            double re = residuo_re(l->r, i, c), im = residuo_im(l->r, i, c);
+            l->sr[x * h + y] = (re * pr + im * pi) / pm;
+            l->si[x * h + y] = (im * pr - re * pi) / pm;
+        }
+    }
+}
+
+/* Funzione eseguita dalla squadra: verifica le righe [inizio, fine) di R ≈ U ⊗ S, con uscita al primo scarto della parte */
+static void verifica_separazione(void* argomento, long inizio, long fine, void* parziale) {
+    const lavoro_separazione_t* l = (const lavoro_separazione_t*)argomento;
+    long d = l->r->dimensione, h = d / 2;
+    int j = l->j;
+    long basso = (1L << j) - 1;
+
+    for (long i = inizio; i < fine; i++) {
+        int a = (i >> j) & 1;
+        long x = ((i >> (j + 1)) << j) | (i & basso);
+        for (long k = 0; k < d; k++) {
+            int b = (k >> j) & 1;
+            long y = ((k >> (j + 1)) << j) | (k & basso);
+            double s_re = l->sr[x * h + y], s_im = l->si[x * h + y];
+            double dr = residuo_re(l->r, i, k) - (l->ur[a][b] * s_re - l->ui[a][b] * s_im);
+            double di = residuo_im(l->r, i, k) - (l->ur[a][b] * s_im + l->ui[a][b] * s_re);
+            if (fabs(dr) > l->soglia || fabs(di) > l->soglia) {
+                *(int*)parziale = 0;
+                return;
+            }
+        }
+    }
+}
+
+/*
+ * Funzione di supporto che prova a separare il bit j del residuo: R = U ⊗ S con U 2x2 sul bit j.
+ * Il perno (elemento di modulo massimo) fissa la normalizzazione: S vale 1 nella sua posizione.
+ * Parametri: r → residuo (sostituito da S se la separazione riesce), u → fattore 2x2, soglia → errore assoluto ammesso
+ * Ritorna 1 se separato, 0 se non separabile, -1 in caso di errore di allocazione.
+ */
+static int separa_bit(residuo_t* r, int j, complesso_t u[2][2], double soglia) {
+    long d = r->dimensione;
+    perno_t perno = {-1.0, 0};
+    if (riduci_in_parallelo(cerca_perno, combina_perno, r, d, &perno, sizeof(perno)) != 0) return -1;
+    if (perno.modulo <= 0.0) return 0;
+    long i0 = perno.indice / d, j0 = perno.indice % d;
+
+    lavoro_separazione_t lavoro = {r, j, (i0 >> j) & 1, (j0 >> j) & 1, {{0}}, {{0}}, NULL, NULL, soglia};
+    for (int a = 0; a < 2; a++) {
+        for (int b = 0; b < 2; b++) {
+            long i = i0 ^ ((long)(a ^ lavoro.a0) << j), k = j0 ^ ((long)(b ^ lavoro.b0) << j);
+            lavoro.ur[a][b] = residuo_re(r, i, k);
+            lavoro.ui[a][b] = residuo_im(r, i, k);
+        }
+    }
+
+    /* S[x][y] = R[x con bit j = a0][y con bit j = b0] / perno */
+    long h = d / 2;
+    double* sr = (double*)malloc(h * h * sizeof(double));
+    double* si = (double*)malloc(h * h * sizeof(double));
+    lavoro.sr = sr;
+    lavoro.si = si;
+    if (!sr || !si || esegui_in_parallelo(calcola_residuo, &lavoro, h) != 0) {
+        free(sr);
+        free(si);
+        return -1;
+    }
+
+    /* Verifica R[i][k] ≈ U[bit j di i][bit j di k] · S[resto di i][resto di k] */
+    int separabile = 1;
+    if (riduci_in_parallelo(verifica_separazione, combina_e, &lavoro, d, &separabile, sizeof(separabile)) != 0 || !separabile) {
+        free(sr);
+        free(si);
+        return separabile ? -1 : 0;
+    }
+
+    for (int a = 0; a < 2; a++) {
+        for (int b = 0; b < 2; b++) {
+            u[a][b] = (complesso_t){lavoro.ur[a][b], lavoro.ui[a][b], signbit(lavoro.ui[a][b]) ? '-' : '+'};
+        }
+    }
+
+    free(r->re);
+    free(r->im);
+    r->m = NULL;
+    r->re = sr;
+    r->im = si;
+    r->dimensione = h;
+    for (int q = j; q < r->numero_qubit - 1; q++) r->qubit[q] = r->qubit[q + 1];
+    r->numero_qubit--;
+    return 1;
+}
+
+/* Funzione di supporto: 1 se la porta è l'identità entro la soglia */
+static int porta_identita(const porta_t* p, double soglia) {
+    int d = 1 << p->numero_bersagli;
+    for (int b = 0; b < d; b++) {
+        for (int c = 0; c < d; c++) {
+            double re = p->matrice[b][c].parte_reale - (b == c ? 1.0 : 0.0);
+            if (fabs(re) > soglia || fabs(p->matrice[b][c].parte_immaginaria) > soglia) return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Funzione di supporto che scompone il residuo in fattori 2x2 più un fattore finale su al massimo
+ * MAX_QUBIT_PORTA qubit, tutti con i controlli indicati. Omette i fattori identità.
+ * Parametri: r → residuo (consumato), porte → almeno r->numero_qubit + 1 porte, numero_porte → porte prodotte
+ * Ritorna 1 se scomposto, 0 se il fattore finale resta troppo grande, -1 in caso di errore di allocazione.
+ */
+static int scomponi_residuo(residuo_t* r, const int* controlli, int numero_controlli, double soglia,
+                            porta_t* porte, int* numero_porte) {
+    int numero = 0;
+
+    /* Separa un qubit alla volta finché possibile */
+    for (int j = 0; j < r->numero_qubit && r->numero_qubit > 0; ) {
+        complesso_t u[2][2];
+        int qubit = r->qubit[j];
+        int esito = r->numero_qubit == 1 ? 0 : separa_bit(r, j, u, soglia);
+        if (esito < 0) return -1;
+        if (esito == 0) {
+            j++;
+            continue;
+        }
+
+        porta_t* p = &porte[numero++];
+        p->tipo = PORTA_LOCALE;
+        p->numero_bersagli = 1;
+        p->bersagli[0] = qubit;
+        for (int a = 0; a < 2; a++) {
+            for (int b = 0; b < 2; b++) p->matrice[a][b] = u[a][b];
+        }
+    }
+
+    if (r->numero_qubit > MAX_QUBIT_PORTA) return 0;                    // Residuo troppo grande: resta densa
+
+    /* Il residuo diventa una porta locale sui qubit rimasti (l'ultimo qubit non viene mai separato) */
+    porta_t* p = &porte[numero++];
+    p->tipo = PORTA_LOCALE;
+    p->numero_bersagli = r->numero_qubit;
+    for (int j = 0; j < r->numero_qubit; j++) p->bersagli[j] = r->qubit[j];
+    for (long i = 0; i < r->dimensione; i++) {
+        for (long k = 0; k < r->dimensione; k++) {
+            double im = residuo_im(r, i, k);
+            p->matrice[i][k] = (complesso_t){residuo_re(r, i, k), im, signbit(im) ? '-' : '+'};
+        }
+    }
+
+    /* Omette i fattori identità e sceglie per gli altri la forma più efficiente */
+    int tenute = 0;
+    for (int k = 0; k < numero; k++) {
+        if (porta_identita(&porte[k], soglia)) continue;
+        porte[tenute] = porte[k];
+        porte[tenute].numero_controlli = numero_controlli;               // C-(A ⊗ B) = C-A · C-B
+        for (int c = 0; c < numero_controlli; c++) porte[tenute].controlli[c] = controlli[c];
+        semplifica_porta(&porte[tenute], soglia);
+        completa_porta(&porte[tenute]);
+        tenute++;
+    }
+    *numero_porte = tenute;
+    return 1;
+}
+
+/* Dati passati alle parti parallele della ricerca dei qubit di controllo */
+typedef struct {
+    const matrice_t* m;
+    int c;
+    double soglia;
+} lavoro_controllo_t;
+
+/* Funzione eseguita dalla squadra: azzera *parziale se nelle righe [inizio, fine) il qubit non fa da controllo */
+static void verifica_controllo(void* argomento, long inizio, long fine, void* parziale) {
+    const lavoro_controllo_t* l = (const lavoro_controllo_t*)argomento;
+    long d = l->m->dimensione;
+    for (long i = inizio; i < fine; i++) {
+        const complesso_t* riga = l->m->dati[i];
+        for (long k = 0; k < d; k++) {
+            if ((i >> l->c) & (k >> l->c) & 1) continue;                // Blocco attivo: qualsiasi valore
+            double re = riga[k].parte_reale - (i == k ? 1.0 : 0.0);
+            if (fabs(re) > l->soglia || fabs(riga[k].parte_immaginaria) > l->soglia) {
+                *(int*)parziale = 0;
+                return;
+            }
+        }
+    }
+}
+
+/*
+ * Funzione di supporto: 1 se il qubit c fa da controllo per la matrice, cioè se la matrice coincide
+ * con l'identità in tutti gli elementi in cui il bit c della riga o della colonna vale 0.
+ */
+static int qubit_controllo(const matrice_t* m, int c, double soglia) {
+    lavoro_controllo_t lavoro = {m, c, soglia};
+    int controllo = 1;
+    if (riduci_in_parallelo(verifica_controllo, combina_e, &lavoro, m->dimensione, &controllo, sizeof(controllo)) != 0) return 0;
+    return controllo;
+}
+
+/*
+ * Funzione di supporto che riconosce un operatore controllato: trova i qubit di controllo, estrae il
+ * blocco attivo (tutti i controlli a 1) sugli altri qubit e lo scompone come un operatore qualsiasi.
+ * Ritorna 1 se riconosciuto, 0 se non ci sono controlli o il blocco attivo non è scomponibile, -1 in caso di errore.
+ */
+static int scomponi_controllato(const matrice_t* m, int numero_qubit, double soglia, porta_t* porte, int* numero_porte) {
+    int controlli[MAX_CONTROLLI_PORTA], numero_controlli = 0;
+    long maschera = 0;
+
+    /* Resta almeno un bersaglio: con tutti i qubit di controllo (es. CZ) l'ultimo diventa il bersaglio */
+    for (int c = 0; c < numero_qubit && numero_controlli < MAX_CONTROLLI_PORTA; c++) {
+        if (!qubit_controllo(m, c, soglia)) continue;
+        controlli[numero_controlli++] = c;
+        maschera |= 1L << c;
+    }
+    if (numero_controlli == numero_qubit) maschera &= ~(1L << controlli[--numero_controlli]);
+    if (numero_controlli == 0) return 0;
+
+    residuo_t r = {0};
+    for (int q = 0; q < numero_qubit; q++) {
+        if (!(maschera & (1L << q))) r.qubit[r.numero_qubit++] = q;
+    }
+    r.dimensione = 1L << r.numero_qubit;
+    r.re = (double*)malloc(r.dimensione * r.dimensione * sizeof(double));
+    r.im = (double*)malloc(r.dimensione * r.dimensione * sizeof(double));
+    int ret = -1;
+    if (!r.re || !r.im) goto fine;
+
+    for (long x = 0; x < r.dimensione; x++) {
+        long i = maschera;                          // Riga con i controlli a 1 e i bit di x nei qubit del residuo
+        for (int j = 0; j < r.numero_qubit; j++) {
+            if (x & (1L << j)) i |= 1L << r.qubit[j];
+        }
+        for (long y = 0; y < r.dimensione; y++) {
+            long k = maschera;
+            for (int j = 0; j < r.numero_qubit; j++) {
+                if (y & (1L << j)) k |= 1L << r.qubit[j];
+            }
+            r.re[x * r.dimensione + y] = m->dati[i][k].parte_reale;
+            r.im[x * r.dimensione + y] = m->dati[i][k].parte_immaginaria;
+        }
+    }
+
+    ret = scomponi_residuo(&r, controlli, numero_controlli, soglia, porte, numero_porte);
+
+fine:
+    free(r.re);
+    free(r.im);
+    return ret;
+}
+
+/* Funzione eseguita dalla squadra: accumula il modulo massimo delle righe [inizio, fine) della matrice */
+static void massimo_righe(void* argomento, long inizio, long fine, void* parziale) {
+    const matrice_t* m = (const matrice_t*)argomento;
+    double massimo = *(double*)parziale;
+    for (long i = inizio; i < fine; i++) {
+        for (long k = 0; k < m->dimensione; k++) massimo = fmax(massimo, modulo_complesso(m->dati[i][k]));
+    }
+    *(double*)parziale = massimo;
+}
+
+int fattorizza_operatore(operatore_quantistico_t* op, int numero_qubit, double tolleranza) {
+    if (!op || !op->matrice || op->porte || tolleranza < 0.0) return 0;
+    if (numero_qubit < 2 || numero_qubit > 30) return 0;                // Un solo qubit: già una porta locale
+
+    const matrice_t* m = op->matrice;
+    long d = 1L << numero_qubit;
+    if (m->dimensione != d) return 0;
+    for (long i = 0; i < d; i++) {
+        if (!m->dati[i]) return 0;                                      // Matrice a blocchi di righe (simulazione distribuita)
+    }
+
+    int ret = -1;
+    residuo_t r = {0};
+    porta_t* porte = (porta_t*)calloc(numero_qubit + 1, sizeof(porta_t));
+    r.numero_qubit = numero_qubit;
+    r.dimensione = d;
+    r.m = m;                                        // Nessuna copia: la prima separazione legge la matrice
+    if (!porte) goto fine;
+
+    double massimo = 0.0;                           // Modulo massimo, a righe in parallelo
+    if (riduci_in_parallelo(massimo_righe, combina_massimo, (void*)m, d, &massimo, sizeof(massimo)) != 0) goto fine;
+    for (int q = 0; q < numero_qubit; q++) r.qubit[q] = q;
+    double soglia = tolleranza * massimo;
+
+    /* Prima come prodotto di Kronecker, poi come operatore controllato */
+    int numero_porte = 0;
+    ret = scomponi_residuo(&r, NULL, 0, soglia, porte, &numero_porte);
+    if (ret == 0) {
+        memset(porte, 0, (numero_qubit + 1) * sizeof(porta_t));
+        ret = scomponi_controllato(m, numero_qubit, soglia, porte, &numero_porte);
+    }
+    if (ret != 1) goto fine;
+
+    libera_matrice_operatore(op);                   // La matrice densa non serve più
+    op->porte = porte;
+    op->numero_porte = numero_porte;
+    porte = NULL;
+
+fine:
+    free(porte);
+    free(r.re);
+    free(r.im);
+    return ret;
+}
+
+int fattorizza_operatori(dati_input_t* dati, double tolleranza) {
+    if (!dati) return -1;
+
+    int fattorizzati = 0;
+    for (int i = 0; i < dati->numero_operatori; i++) {
+        int esito = fattorizza_operatore(&dati->operatori[i], dati->numero_qubit, tolleranza);
+        if (esito < 0) return -1;
+        fattorizzati += esito;
+    }
+    return fattorizzati;
+}
@@ -0,0 +1,30 @@
+#ifndef KRONECKER_H
+#define KRONECKER_H
+
+#include "lettore_input.h"
+
+/* Tolleranza relativa di default per riconoscere un prodotto di Kronecker */
+#define TOLLERANZA_FATTORIZZAZIONE 1e-9
+
+/*
+ * Prova a scomporre la matrice densa di un operatore nel prodotto di Kronecker di fattori piccoli:
+ * un fattore 2x2 per ogni qubit separabile più, eventualmente, un fattore residuo su al massimo
+ * MAX_QUBIT_PORTA qubit. Un elemento è accettato se differisce dal prodotto dei fattori di al più
+ * tolleranza × (modulo massimo della matrice).
+ * Se la scomposizione riesce l'operatore diventa una sequenza di porte locali (i fattori uguali
+ * all'identità vengono omessi) e la matrice densa viene liberata: l'applicazione passa da O(4^N) a O(N·2^N).
+ * Parametri:
+ * op → operatore con matrice completa (non a blocchi di righe)
+ * numero_qubit → qubit del circuito
+ * tolleranza → tolleranza relativa (negativa: nessuna fattorizzazione)
+ * Ritorna: 1 se l'operatore è stato fattorizzato, 0 se non è fattorizzabile, -1 in caso di errore
+ */
+int fattorizza_operatore(operatore_quantistico_t* op, int numero_qubit, double tolleranza);
+
+/*
+ * Applica fattorizza_operatore a tutti gli operatori con matrice densa.
+ * Ritorna: numero di operatori fattorizzati, -1 in caso di errore
+ */
+int fattorizza_operatori(dati_input_t* dati, double tolleranza);
+
+#endif
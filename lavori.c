@@ -0,0 +1,286 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "lavori.h"
+
+/* Stati di un lavoro */
+enum { LAVORO_IN_CODA, LAVORO_IN_ESECUZIONE, LAVORO_TERMINATO };
+
+/* Futuro: ha il proprio mutex, così resta utilizzabile anche dopo la distruzione del servizio */
+struct qsim_futuro {
+    qsim_contesto_t* ctx;
+    const complesso_t* iniziale;        // NULL: esecuzione da #init
+    complesso_t* finale;
+    qsim_completamento_t completamento;
+    void* argomento;
+    int stato;                          // LAVORO_*
+    int esito;
+    int rilasciato;                     // 1 dopo qsim_rilascia: lo libera l'esecutore
+    pthread_mutex_t mutex;
+    pthread_cond_t terminato;
+    struct qsim_futuro* successivo;     // Lavoro seguente dello stesso contesto
+};
+
+/* Fila dei lavori di un contesto: un solo lavoro per contesto alla volta, nell'ordine di invio */
+typedef struct {
+    qsim_contesto_t* ctx;
+    qsim_futuro_t* primo;
+    qsim_futuro_t* ultimo;
+    int occupata;                       // 1 mentre un esecutore sta eseguendo un lavoro del contesto
+    int thread;                         // Thread della squadra del contesto occupati dal lavoro in esecuzione
+} fila_t;
+
+struct qsim_servizio {
+    pthread_t* esecutori;
+    int numero_esecutori;
+    int limite_thread;                  // Processori disponibili: thread delle squadre in esecuzione al massimo
+    int thread_occupati;                // Thread delle squadre dei lavori in esecuzione
+    int profondita;                     // Lavori in coda al massimo
+    int in_coda;                        // Lavori in coda (esclusi quelli in esecuzione)
+    fila_t** file;                      // File dei contesti con lavori in coda o in esecuzione
+    int numero_file;
+    int capacita_file;
+    int turno;                          // Prossima fila da servire (giro tra i contesti)
+    int chiuso;                         // 1 dopo qsim_distruggi_servizio
+    pthread_mutex_t mutex;              // Protegge code, file e contatori
+    pthread_cond_t lavoro;              // Segnale per gli esecutori: c'è un lavoro eseguibile (o chiusura)
+    pthread_cond_t posto;               // Segnale per chi invia: si è liberato un posto in coda
+};
+
+
+/* Funzione di supporto: fila del contesto, creata se manca. NULL in caso di errore di allocazione (mutex preso). */
+static fila_t* fila_contesto(qsim_servizio_t* s, qsim_contesto_t* ctx) {
+    for (int i = 0; i < s->numero_file; i++) {
+        if (s->file[i]->ctx == ctx) return s->file[i];
+    }
+    if (s->numero_file == s->capacita_file) {
+        int capacita = s->capacita_file ? 2 * s->capacita_file : 8;
+        fila_t** file = (fila_t**)realloc(s->file, capacita * sizeof(fila_t*));
+        if (!file) return NULL;
+        s->file = file;
+        s->capacita_file = capacita;
+    }
+    fila_t* f = (fila_t*)calloc(1, sizeof(fila_t));
+    if (!f) return NULL;
+    f->ctx = ctx;
+    s->file[s->numero_file++] = f;
+    return f;
+}
+
+/* Funzione di supporto: rimuove la fila i, vuota e libera, mantenendo l'ordine del giro (mutex preso) */
+static void rimuovi_fila(qsim_servizio_t* s, int i) {
+    free(s->file[i]);
+    memmove(&s->file[i], &s->file[i + 1], (s->numero_file - i - 1) * sizeof(fila_t*));
+    s->numero_file--;
+    if (s->turno > i) s->turno--;
+    if (s->turno >= s->numero_file) s->turno = 0;
+}
+
+/*
+ * Funzione di supporto: sceglie a turno la prossima fila con un lavoro in coda e nessun lavoro in
+ * esecuzione, a partire da s->turno. Se la squadra del suo contesto non entra nei thread ancora liberi
+ * la fila non viene saltata: si attende la fine di un altro lavoro, così i contesti con squadre grandi
+ * non restano indietro. Un lavoro parte comunque se non ce ne sono altri in esecuzione.
+ * Ritorna la fila, NULL se non ce ne sono o se i thread liberi non bastano (mutex preso).
+ */
+static fila_t* prossima_fila(qsim_servizio_t* s) {
+    for (int k = 0; k < s->numero_file; k++) {
+        int i = (s->turno + k) % s->numero_file;
+        fila_t* f = s->file[i];
+        if (f->primo && !f->occupata) {
+            int thread = qsim_numero_thread(f->ctx);
+            if (s->thread_occupati > 0 && s->thread_occupati + thread > s->limite_thread) return NULL;
+            s->turno = (i + 1) % s->numero_file;
+            f->thread = thread;
+            return f;
+        }
+    }
+    return NULL;
+}
+
+/* Funzione di supporto: esegue il lavoro con l'interfaccia sincrona del contesto. Ritorna l'esito. */
+static int esegui_lavoro(qsim_futuro_t* f) {
+    if (!f->iniziale) return qsim_esegui(f->ctx);
+    return qsim_esegui_batch(f->ctx, &f->iniziale, &f->finale, 1);
+}
+
+/* Funzione eseguita da ogni esecutore: serve le file a turno finché il servizio è aperto o ha lavori */
+static void* funzione_esecutore(void* arg) {
+    qsim_servizio_t* s = (qsim_servizio_t*)arg;
+
+    pthread_mutex_lock(&s->mutex);
+    for (;;) {
+        fila_t* fila;
+        while (!(fila = prossima_fila(s)) && !(s->chiuso && s->in_coda == 0)) {
+            pthread_cond_wait(&s->lavoro, &s->mutex);
+        }
+        if (!fila) break;                           // Chiuso e senza lavori in coda
+
+        qsim_futuro_t* f = fila->primo;
+        fila->primo = f->successivo;
+        if (!fila->primo) fila->ultimo = NULL;
+        fila->occupata = 1;
+        s->thread_occupati += fila->thread;
+        s->in_coda--;
+        pthread_cond_signal(&s->posto);
+        pthread_mutex_unlock(&s->mutex);
+
+        pthread_mutex_lock(&f->mutex);
+        f->stato = LAVORO_IN_ESECUZIONE;
+        pthread_mutex_unlock(&f->mutex);
+
+        int esito = esegui_lavoro(f);
+        if (f->completamento) f->completamento(esito, f->argomento);
+
+        pthread_mutex_lock(&f->mutex);
+        f->esito = esito;
+        f->stato = LAVORO_TERMINATO;
+        int rilasciato = f->rilasciato;
+        pthread_cond_broadcast(&f->terminato);
+        pthread_mutex_unlock(&f->mutex);
+        if (rilasciato) {
+            pthread_mutex_destroy(&f->mutex);
+            pthread_cond_destroy(&f->terminato);
+            free(f);
+        }
+
+        /* Il contesto torna disponibile: un altro esecutore può prenderne il lavoro successivo */
+        pthread_mutex_lock(&s->mutex);
+        fila->occupata = 0;
+        s->thread_occupati -= fila->thread;
+        if (s->in_coda > 0) pthread_cond_broadcast(&s->lavoro);    // Thread liberati: anche altre file possono partire
+        if (!fila->primo) {
+            for (int i = 0; i < s->numero_file; i++) {
+                if (s->file[i] == fila) {
+                    rimuovi_fila(s, i);
+                    break;
+                }
+            }
+        }
+        if (s->chiuso && s->in_coda == 0) pthread_cond_broadcast(&s->lavoro);
+    }
+    pthread_mutex_unlock(&s->mutex);
+    return NULL;
+}
+
+qsim_servizio_t* qsim_crea_servizio(int numero_esecutori, int profondita) {
+    if (numero_esecutori <= 0 || profondita <= 0) return NULL;
+
+    /* Ogni lavoro in esecuzione occupa almeno un thread: oltre i processori gli esecutori resterebbero fermi */
+    long processori = sysconf(_SC_NPROCESSORS_ONLN);
+    int limite_thread = processori > 0 ? (int)processori : 1;
+    if (numero_esecutori > limite_thread) numero_esecutori = limite_thread;
+
+    qsim_servizio_t* s = (qsim_servizio_t*)calloc(1, sizeof(qsim_servizio_t));
+    if (!s) return NULL;
+    s->limite_thread = limite_thread;
+    s->esecutori = (pthread_t*)malloc(numero_esecutori * sizeof(pthread_t));
+    if (!s->esecutori) {
+        free(s);
+        return NULL;
+    }
+    s->profondita = profondita;
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->lavoro, NULL);
+    pthread_cond_init(&s->posto, NULL);
+
+    for (int i = 0; i < numero_esecutori; i++) {
+        if (pthread_create(&s->esecutori[i], NULL, funzione_esecutore, s) != 0) {
+            qsim_distruggi_servizio(s);             // Ferma gli esecutori già creati
+            return NULL;
+        }
+        s->numero_esecutori++;
+    }
+    return s;
+}
+
+qsim_futuro_t* qsim_invia(qsim_servizio_t* s, qsim_contesto_t* ctx, const complesso_t* iniziale, complesso_t* finale,
+                          qsim_completamento_t completamento, void* argomento, int attendi_posto) {
+    if (!s || !ctx || (iniziale && !finale)) return NULL;
+
+    qsim_futuro_t* f = (qsim_futuro_t*)calloc(1, sizeof(qsim_futuro_t));
+    if (!f) return NULL;
+    f->ctx = ctx;
+    f->iniziale = iniziale;
+    f->finale = finale;
+    f->completamento = completamento;
+    f->argomento = argomento;
+    f->stato = LAVORO_IN_CODA;
+    pthread_mutex_init(&f->mutex, NULL);
+    pthread_cond_init(&f->terminato, NULL);
+
+    pthread_mutex_lock(&s->mutex);
+    while (s->in_coda >= s->profondita && attendi_posto && !s->chiuso) {   // Coda piena: attende un posto
+        pthread_cond_wait(&s->posto, &s->mutex);
+    }
+    fila_t* fila = NULL;
+    if (s->in_coda < s->profondita && !s->chiuso) fila = fila_contesto(s, ctx);
+    if (!fila) {
+        if (!s->chiuso && s->in_coda >= s->profondita) errno = EAGAIN;
+        pthread_mutex_unlock(&s->mutex);
+        pthread_mutex_destroy(&f->mutex);
+        pthread_cond_destroy(&f->terminato);
+        free(f);
+        return NULL;
+    }
+
+    if (fila->ultimo) fila->ultimo->successivo = f;
+    else fila->primo = f;
+    fila->ultimo = f;
+    s->in_coda++;
+    if (!fila->occupata) pthread_cond_signal(&s->lavoro);
+    pthread_mutex_unlock(&s->mutex);
+    return f;
+}
+
+int qsim_pronto(qsim_futuro_t* f) {
+    if (!f) return 0;
+    pthread_mutex_lock(&f->mutex);
+    int pronto = f->stato == LAVORO_TERMINATO;
+    pthread_mutex_unlock(&f->mutex);
+    return pronto;
+}
+
+int qsim_attendi(qsim_futuro_t* f) {
+    if (!f) return -1;
+    pthread_mutex_lock(&f->mutex);
+    while (f->stato != LAVORO_TERMINATO) pthread_cond_wait(&f->terminato, &f->mutex);
+    int esito = f->esito;
+    pthread_mutex_unlock(&f->mutex);
+
+    pthread_mutex_destroy(&f->mutex);
+    pthread_cond_destroy(&f->terminato);
+    free(f);
+    return esito;
+}
+
+void qsim_rilascia(qsim_futuro_t* f) {
+    if (!f) return;
+    pthread_mutex_lock(&f->mutex);
+    int terminato = f->stato == LAVORO_TERMINATO;
+    f->rilasciato = 1;
+    pthread_mutex_unlock(&f->mutex);
+    if (terminato) qsim_attendi(f);
+}
+
+void qsim_distruggi_servizio(qsim_servizio_t* s) {
+    if (!s) return;
+
+    pthread_mutex_lock(&s->mutex);
+    s->chiuso = 1;
+    pthread_cond_broadcast(&s->lavoro);
+    pthread_cond_broadcast(&s->posto);              // Chi attende un posto rinuncia
+    pthread_mutex_unlock(&s->mutex);
+
+    for (int i = 0; i < s->numero_esecutori; i++) pthread_join(s->esecutori[i], NULL);
+
+    for (int i = 0; i < s->numero_file; i++) free(s->file[i]);
+    free(s->file);
+    free(s->esecutori);
+    pthread_mutex_destroy(&s->mutex);
+    pthread_cond_destroy(&s->lavoro);
+    pthread_cond_destroy(&s->posto);
+    free(s);
+}
@@ -0,0 +1,75 @@
+#ifndef LAVORI_H
+#define LAVORI_H
+
+#include "qsim.h"
+
+/*
+ * Esecuzione asincrona di simulazioni (libqsim).
+ * Un servizio ha alcuni thread esecutori e una coda limitata di lavori: qsim_invia mette in coda
+ * l'esecuzione di un contesto e ritorna subito un futuro, da interrogare (qsim_pronto), attendere
+ * (qsim_attendi) o abbandonare (qsim_rilascia) lasciando che una funzione di completamento riceva l'esito.
+ * Lavori di contesti diversi vengono eseguiti insieme, ognuno con la squadra del proprio contesto;
+ * i lavori dello stesso contesto uno alla volta, nell'ordine di invio. Gli esecutori servono i contesti
+ * a turno (un lavoro per contesto), così un contesto con molti lavori in coda non ritarda gli altri.
+ * I thread delle squadre dei lavori in esecuzione insieme non superano i processori disponibili:
+ * un lavoro attende che se ne liberino abbastanza, salvo quando è l'unico in esecuzione.
+ * Finché un contesto ha lavori in coda o in esecuzione non va usato direttamente né distrutto.
+ */
+typedef struct qsim_servizio qsim_servizio_t;
+
+/* Futuro di un lavoro inviato al servizio */
+typedef struct qsim_futuro qsim_futuro_t;
+
+/*
+ * Funzione chiamata da un esecutore al termine di un lavoro, prima che il futuro risulti pronto.
+ * Parametri: esito → 0 se l'esecuzione è riuscita, -1 altrimenti; argomento → valore passato a qsim_invia
+ */
+typedef void (*qsim_completamento_t)(int esito, void* argomento);
+
+/*
+ * Crea un servizio.
+ * Parametri:
+ * numero_esecutori → lavori (di contesti diversi) eseguiti insieme al massimo, ridotto ai processori disponibili
+ * profondita → lavori in coda al massimo, esclusi quelli in esecuzione; oltre, qsim_invia attende o rifiuta
+ * Ritorna: puntatore al servizio, NULL se i parametri non sono validi o in caso di errore
+ */
+qsim_servizio_t* qsim_crea_servizio(int numero_esecutori, int profondita);
+
+/*
+ * Mette in coda l'esecuzione del circuito di un contesto compilato, senza attenderne la fine.
+ * Parametri:
+ * ctx → contesto (qsim_compila già chiamata)
+ * iniziale → stato iniziale di qsim_dimensione(ctx) ampiezze, o NULL per eseguire da #init come
+ *            qsim_esegui (lo stato finale resta allora nel contesto)
+ * finale → vettore in cui scrivere lo stato finale (ignorato se iniziale è NULL)
+ * completamento → funzione chiamata al termine, o NULL; argomento → passato a completamento
+ * attendi_posto → 1 per attendere un posto se la coda è piena, 0 per rifiutare subito il lavoro
+ * Iniziale e finale devono restare validi fino al completamento.
+ * Ritorna: futuro del lavoro, NULL se la coda è piena (con attendi_posto = 0), il servizio è in chiusura
+ * o in caso di errore
+ */
+qsim_futuro_t* qsim_invia(qsim_servizio_t* s, qsim_contesto_t* ctx, const complesso_t* iniziale, complesso_t* finale,
+                          qsim_completamento_t completamento, void* argomento, int attendi_posto);
+
+/* Ritorna 1 se il lavoro è terminato (e l'eventuale completamento è già stato chiamato), 0 altrimenti */
+int qsim_pronto(qsim_futuro_t* f);
+
+/*
+ * Attende la fine del lavoro e libera il futuro.
+ * Ritorna: esito del lavoro (0 se riuscito, -1 altrimenti)
+ */
+int qsim_attendi(qsim_futuro_t* f);
+
+/*
+ * Rinuncia al futuro senza attendere: viene liberato dal servizio al termine del lavoro.
+ * L'esito arriva solo alla funzione di completamento.
+ */
+void qsim_rilascia(qsim_futuro_t* f);
+
+/*
+ * Chiude il servizio: rifiuta nuovi lavori, esegue quelli già in coda, attende gli esecutori e libera
+ * le risorse. I futuri non ancora attesi né rilasciati restano validi e pronti, da liberare con qsim_attendi.
+ */
+void qsim_distruggi_servizio(qsim_servizio_t* s);
+
+#endif
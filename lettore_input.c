@@ -1,372 +1,702 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-#include "lettore_input.h"
-
-
-/*
- * Funzione di supporto che dato un file di testo salta whitespace fino al primo carattere
- * Paramentri: file → file su cui bisogna saltare i whitespace
- */
-static void salta_spazi(FILE* file) {
-    int c;
-    while ((c = fgetc(file)) != EOF) {       // Legge caratteri finché non arriva a EOF
-        if (!isspace((unsigned char)c)) {    // Se NON è whitespace (spazio, \n, \t, ...)
-            ungetc(c, file);                 // Rimette indietro il carattere “utile” per farlo rileggere
-            return;                          // Esce lasciando lo stream posizionato sul primo char non-whitespace
-        }
-    }
-}
-
-/*
- * Funzione di supporto che salta caratteri separatori [ ] ( ) , e whitespace 
- * Paramentri: file → file su cui bisogna saltare i separatori e whitespace
- * Risultato: intero che rappresenta il valore del carattere 
- */
-static int salta_separatore(FILE* file) {
-    int c;
-    do {
-        c = fgetc(file);                           // Legge 1 carattere dal file
-    } while (c != EOF &&
-            (isspace((unsigned char)c) ||          // Salta whitespace
-             c == '[' || c == ']' ||               // Salta parentesi quadre
-             c == '(' || c == ')' || c == ','));   // Salta parentesi tonde e virgole
-    return c;                                      // Ritorna il primo carattere “non separatore” oppure EOF
-}
-
-/*
- * Funzione di supporto che legge un numero complesso dato un file
- * Paramentri: 
- * file → file su cui bisogna leggere il numero complesso
- * z → complesso che verrà eventualmente aggiornato 
- * Ritorna 0 se ok, 1 se fallisce.
- * 
- * 0, i) (i, 0)]
- */
-static int leggi_complesso(FILE* file, complesso_t* z) {
-    double re = 0.0, im = 0.0;      // Variabili locali per costruire il complesso
-    char segno = '\0';              // Variabile carattere locale per il segno     
-
-    /* Posizionati sul prossimo carattere non speratore (salta [ ] ( ) , e spazi) */
-    int c = salta_separatore(file);                    // Cerca l’inizio del prossimo numero/segno utile
-    if (c == EOF) return -1;                           // Se finisce il file non si può leggere altro
-   
-    /* Verifica se c'è direttamente la parte immaginaria */
-    if (c == 'i') {                                          // Se il prossimo carattere è i
-        segno = '+';                                         // Aggiorna il segno
-        if (fscanf(file, " %lf", &im) != 1) {                // Prova a leggere eventuali coefficienti di i 
-            im = 1.0;                                        // Se non trova nulla assumiamo 1 come coefficiente
-        }
-        goto termina;                                        // C'è un coefficiente, può terminare
-    } else if (c == '+' || c == '-') {                       // Se invece trova un segno (potrebbe essere della parte reale)
-        segno = c;                                           // Conserva il segno
-        c = fgetc(file);                                     // Prossimo carattere potrebbe essere i
-        if (c == 'i') {                                      // Se è proprio i
-                if (fscanf(file, " %lf", &im) != 1) {        // Prova a leggere eventuali coefficienti di i 
-                    im = 1.0;                                // Se non trova nulla assumiamo 1 come coefficiente
-                 } 
-                 goto termina; 
-        } else {                                             // Altrimenti è la parte reale 
-            ungetc(c, file);                                 // Torna indietro per leggere il valore
-            if (fscanf(file, " %lf", &re) != 1) return -1;   // Se fallisce vuol dire che c'è un input errato 
-            if (segno == '-') re = -re;                      // Se il segno iniziale era negativo corregge il valore reale
-            segno = '\0';                                    // Ripristina il segno
-            goto Parte_immaginaria;                          // Procede per la parte immaginaria
-        }
-    }  
-
-    /* Leggi parte reale */
-    ungetc(c, file);                                         // indietro dell’ultima lettura per non perdere il char trovato
-    if (fscanf(file, " %lf", &re) != 1) return -1;           // Valorizza il reale, se fallisce vuol dire che c'è un input errato
-
-    Parte_immaginaria:
-
-    /* Prova a leggere eventuale parte immaginaria del tipo ± i <numero> */
-    salta_spazi(file);                                 // Salta eventuali spazi tra reale e segno
-    c = fgetc(file);                                   // Legge il carattere successivo (potrebbe essere +, -, oppure altro)
-
-    if (c == '+' || c == '-') {                        // Se c’è + o - allora POTREBBE esserci la parte immaginaria
-        segno = c;                                     // Salviamo il segno per applicarlo alla parte immaginaria
-
-        salta_spazi(file);                             // Salta spazi prima della 'i' (se presenti)
-        c = fgetc(file);                               // Legge il carattere che dovrebbe essere 'i'
-
-        if (c == 'i') {                                // Se trova 'i', allora è proprio un complesso nel formato a±i b
-            if (fscanf(file, " %lf", &im) != 1) {      // Legge il valore della parte immaginaria
-                    im = 1.0;                          // Se non trova nulla assumiamo 1 come coefficiente
-                }                                          
-                if (segno == '-') im = -im;            // Applica il segno: a - i b => immaginaria negativa
-                goto termina;
-        } else {
-            /* Non era un complesso nel formato previsto: ripristina */
-            ungetc(c, file);                           // Rimette indietro il carattere letto “per errore”
-            ungetc(segno, file);                       // Rimette indietro anche il segno, così il flusso resta coerente
-        }
-    } else if (c != EOF) {
-        ungetc(c, file);                               // Se non era + o -, rimettilo indietro: dopo sarà gestito dal chiamante
-    }
-
-    termina: 
-    z->segno = segno;                                  // Scrive il segno nel risultato
-    z->parte_reale = re;                               // Scrive parte reale nel risultato
-    z->parte_immaginaria = im;                         // Scrive parte immaginaria nel risultato
-
-    if ( z->segno == '\0') {                           // Se la parte immaginaria non esiste la rappresentazione in stringhe sarà positiva
-        z->segno = '+';}
-
-    return 0;                                          
-}
-
-
-/*
- * Funzione di supporto che legge da un file lo stato iniziale di un vettore
- * Paramentri: 
- * file → file su cui bisogna leggere lo stato iniziale
- * dati → struttura che verrà valorizzata con i dati letti 
- * Ritorna 0 se ok, 1 se fallisce.
- */
-static int leggi_init(FILE* file, dati_input_t* dati) {
-    int dimensione = 1 << dati->numero_qubit;          // Dimensione del vettore di stato: 2^numero_qubit
-
-    dati->stato_iniziale = calloc(dimensione, sizeof(complesso_t)); // Alloca e azzera il vettore
-    if (!dati->stato_iniziale) return -1;              // Fallimento allocazione
-
-    /* Trova '[' senza rischiare loop infinito su EOF */
-    int c;                                             // variabile temporanea per il posizionamento
-    while ((c = fgetc(file)) != EOF && c != '[') {}    // Consuma input fino alla '[' che apre la lista
-    if (c == EOF) return -1;                           // Se non trovi '[', input errato
-
-    /* File aperto con puntatore posizionato dopo il carattere [*/
-    for (int i = 0; i < dimensione; i++) {             // Legge esattamente 2^n valori (reali o complessi)
-        if (leggi_complesso(file, &dati->stato_iniziale[i]) != 0) return -1; // Riempie ogni posizione, torna -1 in caso di errore
-    }
-    return 0;                                          
-}
-
-
-/*
- * Funzione di supporto che legge dal file la descrizione di un operatore quantistico 
- * Paramentri: 
- * file → file su cui bisogna leggere la descrizione di un operatore quantistico
- * dati → struttura che verrà valorizzata con i dati letti 
- * Ritorna 0 se ok, 1 se fallisce.
- */
-static int leggi_operatore(FILE* file, dati_input_t* dati) {
-    operatore_quantistico_t* tmp = realloc(            // Rialloca l’array per aggiungere 1 operatore
-        dati->operatori,
-        (dati->numero_operatori + 1) * sizeof(operatore_quantistico_t)
-    );
-    if (!tmp) return -1;                               // Se realloc fallisce, non toccare il puntatore originale e ritorna errore
-    dati->operatori = tmp;                             // Aggiorna il puntatore all’array (ora più grande)
-
-    operatore_quantistico_t* op = &dati->operatori[dati->numero_operatori]; // Puntatore al nuovo slot appena aggiunto (l’elemento in coda)
-
-    if (fscanf(file, " %31s", op->nome) != 1) return -1; // Legge il nome dell’operatore (es. H, I, ...) max 31 char
-
-    int dimensione = 1 << dati->numero_qubit;          // Matrice dell’operatore: 2^numero_qubit x 2^numero_qubit
-    op->matrice = crea_matrice(dimensione);            // Alloca la matrice
-    if (!op->matrice) return -1;                       // Se fallisce ritorna -1
-
-    /* Trova '[' */
-    int c;
-    while ((c = fgetc(file)) != EOF && c != '[') {}    // Consuma fino alla '[' che apre la matrice
-    if (c == EOF) return -1;                           // Input errato: manca '['
-
-    for (int i = 0; i < dimensione; i++) {
-        /* Ogni vettore è racchiuso da '(' ... ')' */
-        while ((c = fgetc(file)) != EOF && c != '(') {}  // Cerca l’inizio del vettore '('
-        if (c == EOF) return -1;                         // Ritorna -1 se l'input è errato
-
-        for (int j = 0; j < dimensione; j++) {         // Legge esattamente dimensione (2^numero_qubit) complessi per ogni vettore
-            if (leggi_complesso(file, &op->matrice->dati[i][j]) != 0) return -1; // Salva cella (i,j) elemento j-esimo del i-esimo vettore
-        }
-    }
-
-    dati->numero_operatori++;                          // Ora c’è un operatore in più
-    return 0;
-}
-
-/*
- * Funzione di supporto che legge dal file il circuito da simulare come sequenza di nomi di operatori
- * Paramentri: 
- * file → file su cui bisogna leggere il circuito da simulare
- * dati → struttura che verrà valorizzata con i dati letti 
- * Ritorna 0 se ok, -1 in caso di errore di allocazione.
- */
-static int leggi_circuito(FILE* file, dati_input_t* dati) {
-    char nome[32];                                     // Il nome può essere lungo al massimo 32 caratteri
-
-    while (fscanf(file, " %31s", nome) == 1) {         // Legge nomi uno per volta
-        if (nome[0] == '#') {                          // Se inizia una nuova direttiva, fermati
-            ungetc('#', file);                         // Rimetti '#' nello stream per permettere al loop esterno di rileggerlo
-            return 0;
-        }
-
-        istruzione_circuito_t* tmp = realloc(          // Aggiunge una nuova istruzione al vettore dinamico
-            dati->circuito,
-            (dati->numero_istruzioni + 1) * sizeof(istruzione_circuito_t)
-        );
-        if (!tmp) return -1;
-        dati->circuito = tmp;
-
-        strcpy(dati->circuito[dati->numero_istruzioni].nome_operatore, nome); // Copia nome dell'operatore nell’istruzione
-        dati->numero_istruzioni++;                     // Incrementa contatore istruzioni
-    }
-
-    return 0;                                         
-}
-
-/*
- * Legge e interpreta un file di input testuale aprendo il file in modalità lettura e scansionando direttive.
- * Gestisce le sezioni: #qubits (numero di qubit), #init (stato iniziale), #define (operatori), #circ (circuito),
- * delegando l'analisi sintattica alle funzioni di supporto leggi_init/leggi_operatore/leggi_circuito.
- * Paramentri: 
- * file → file su cui bisogna leggere gli input
- * dati → struttura che verrà valorizzata con i dati letti 
- * Ritorna 0 se tutto ok, -1 in caso di errori (apertura file, formato non valido o fallimenti nelle letture).
- */
-int leggi_input(const char* nome_file, dati_input_t* dati) {
-    FILE* file = fopen(nome_file, "r");                // Apre file in lettura
-    if (!file) {
-        perror(nome_file);                             // Stampa errore di sistema 
-        return -1;
-    }
-
-    char parola[32];
-
-    while (fscanf(file, " %31s", parola) == 1) {       // Legge la prossima “parola” 
-        if (strcmp(parola, "#qubits") == 0) {          // Se #qubits: numero di qubit
-            if (fscanf(file, " %d", &dati->numero_qubit) != 1) { // Legge intero n
-                fclose(file);                          // Chiude il file
-                return -1;
-            }
-        }
-        else if (strcmp(parola, "#init") == 0) {       // Se #init: stato iniziale
-            if (leggi_init(file, dati) != 0) {         // Legge lo stato iniziale
-                fclose(file);                          // Chiude il file
-                return -1;
-            }
-        }
-        else if (strcmp(parola, "#define") == 0) {     // Se #define: definizione operatore
-            if (leggi_operatore(file, dati) != 0) {    // Legge l'operatore
-                fclose(file);                          // Chiude il file
-                return -1;
-            }
-        }
-        else if (strcmp(parola, "#circ") == 0) {       // Se #circ: circuito (sequenza di nomi)
-            if (leggi_circuito(file, dati) != 0) {     // Legge il circuito
-                fclose(file);                          // Chiude il file
-                return -1;
-            }
-        }
-        
-    }
-
-    fclose(file);   // Chiude il file                    
-    return 0;                                          
-} 
-
-/*
- * Cerca un operatore per nome nell’array degli operatori.
- * Parametri: 
- * dati → struttura da cui prendere l'array
- * nome → nome dell'operatore da cercare
- * Ritorna puntatore all’operatore se trovato, NULL altrimenti.
- */
-operatore_quantistico_t* trova_operatore(dati_input_t* dati, const char* nome) {
-
-    for (int i = 0; i < dati->numero_operatori; i++) {
-        if (strcmp(dati->operatori[i].nome, nome) == 0) {
-            return &dati->operatori[i];
-        }
-    }
-
-    return NULL;
-}
-
-/*
- * Funzione che permette di calcolare la dimensione della matrice utilizzata dagli operatori 
- * quantistici definiti in un file testuale.
- * Parametri:
- * file → file testuale su cui bisogna leggere 
- * ritorna → intero che rappresenta la dimensione della matrice in termini di qubits
- */
-int dimensione_operatori(const char* nome_file) {
-
-    FILE* file = fopen(nome_file, "r");                // Apre file in lettura
-    if (!file) {
-        perror(nome_file);                             // Stampa errore di sistema 
-        return -1;
-    }
-
-    /* Trova l'inizio di una matrice */
-    int c;
-    while ((c = fgetc(file)) != EOF && c != '[') {}    // Consuma fino alla '[' che apre la matrice di un operatore
-    if (c == EOF) return -1;                           // Input errato: manca '['
-
-    /* Calcola la dimensione della matrice */
-    int dimensione = 0;
-    while ((c = fgetc(file)) != EOF && c != ']') {   // Consuma fino alla ']' che chiude la matrice dell'operatore
-        if (c == '(') dimensione += 1;
-    }    
-    if (c == EOF) return -1;        // File incompleto, ritorna errore
-
-    fclose(file);            // Chiude il file  
-    return dimensione;       // Ritorna la dimensione della matrice 
-}
-
-/*
- * Libera tutta la memoria allocata dentro in una struttura di tipo dati_input_t.
- * Parametri: dati → struttura da liberare
- */
-void libera_dati_input(dati_input_t* dati) {
-    
-    free(dati->stato_iniziale);     // Libera il vettore dello stato iniziale
-    dati->stato_iniziale = NULL;    // Imposta il puntatore a NULL
-
-    if (dati->operatori) {          // Controlla che l'array di operatori esista
-        for (int i = 0; i < dati->numero_operatori; i++) {
-            distruggi_matrice(dati->operatori[i].matrice);  // Libera la matrice dell'operatore
-            dati->operatori[i].matrice = NULL;              // Imposta il puntatore a NULL 
-        }
-        free(dati->operatori);      // Libera l'array degli operatori
-        dati->operatori = NULL;     // Imposta il puntatore a NULL
-    }
-    dati->numero_operatori = 0;     // Azzeramento del contatore degli operatori
-
-    free(dati->circuito);           // Libera l'array del circuito (istruzioni)
-    dati->circuito = NULL;           // Imposta il puntatore a NULL
-    dati->numero_istruzioni = 0;     // Azzeramento del numero di istruzioni
-
-    dati->numero_qubit = 0;          // Azzeramento del numero di qubit nella struttura
-}
-
-/* Funzione di debug utilizzata nel main per stampe di dati */
-void stampa_dati(dati_input_t dati, int dimensione) {
-
-    printf("Qubit: %d\n", dati.numero_qubit);
-
-    printf("\nStato iniziale:\n");
-    stampa_vettore(dati.stato_iniziale, dimensione);
-
-    printf("\nOperatori definiti: %d\n", dati.numero_operatori);
-    for (int i = 0; i < dati.numero_operatori; i++) {
-        printf("\n#define %s \n", dati.operatori[i].nome);
-        if (dati.operatori[i].matrice) {
-            stampa_matrice(dati.operatori[i].matrice);
-        } else {
-            printf("(matrice NULL)\n");
-        }
-        printf("\n");
-    }
-
-    printf("\nCircuito:\n");
-    printf("#circ ");
-    for (int i = 0; i < dati.numero_istruzioni; i++) {
-        printf("%s", dati.circuito[i].nome_operatore);
-        if (i < dati.numero_istruzioni - 1) printf(" ");
-    }
-    printf("\n\n");
-
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "lettore_input.h"
+#include "memoria.h"
+#include "archivio_operatori.h"
+
+
+/*
+ * Funzione di supporto che dato un file di testo salta whitespace fino al primo carattere
+ * Paramentri: file → file su cui bisogna saltare i whitespace
+ */
+static void salta_spazi(FILE* file) {
+    int c;
+    while ((c = fgetc(file)) != EOF) {       // Legge caratteri finché non arriva a EOF
+        if (!isspace((unsigned char)c)) {    // Se NON è whitespace (spazio, \n, \t, ...)
+            ungetc(c, file);                 // Rimette indietro il carattere “utile” per farlo rileggere
+            return;                          // Esce lasciando lo stream posizionato sul primo char non-whitespace
+        }
+    }
+}
+
+/*
+ * Funzione di supporto che salta caratteri separatori [ ] ( ) , e whitespace 
+ * Paramentri: file → file su cui bisogna saltare i separatori e whitespace
+ * Risultato: intero che rappresenta il valore del carattere 
+ */
+static int salta_separatore(FILE* file) {
+    int c;
+    do {
+        c = fgetc(file);                           // Legge 1 carattere dal file
+    } while (c != EOF &&
+            (isspace((unsigned char)c) ||          // Salta whitespace
+             c == '[' || c == ']' ||               // Salta parentesi quadre
+             c == '(' || c == ')' || c == ','));   // Salta parentesi tonde e virgole
+    return c;                                      // Ritorna il primo carattere “non separatore” oppure EOF
+}
+
+/*
+ * Funzione di supporto che legge un numero complesso dato un file
+ * Paramentri: 
+ * file → file su cui bisogna leggere il numero complesso
+ * z → complesso che verrà eventualmente aggiornato 
+ * Ritorna 0 se ok, 1 se fallisce.
+ * 
+ * 0, i) (i, 0)]
+ */
+static int leggi_complesso(FILE* file, complesso_t* z) {
+    double re = 0.0, im = 0.0;      // Variabili locali per costruire il complesso
+    char segno = '\0';              // Variabile carattere locale per il segno     
+
+    /* Posizionati sul prossimo carattere non speratore (salta [ ] ( ) , e spazi) */
+    int c = salta_separatore(file);                    // Cerca l’inizio del prossimo numero/segno utile
+    if (c == EOF) return -1;                           // Se finisce il file non si può leggere altro
+   
+    /* Verifica se c'è direttamente la parte immaginaria */
+    if (c == 'i') {                                          // Se il prossimo carattere è i
+        segno = '+';                                         // Aggiorna il segno
+        if (fscanf(file, " %lf", &im) != 1) {                // Prova a leggere eventuali coefficienti di i 
+            im = 1.0;                                        // Se non trova nulla assumiamo 1 come coefficiente
+        }
+        goto termina;                                        // C'è un coefficiente, può terminare
+    } else if (c == '+' || c == '-') {                       // Se invece trova un segno (potrebbe essere della parte reale)
+        segno = c;                                           // Conserva il segno
+        c = fgetc(file);                                     // Prossimo carattere potrebbe essere i
+        if (c == 'i') {                                      // Se è proprio i
+                if (fscanf(file, " %lf", &im) != 1) {        // Prova a leggere eventuali coefficienti di i 
+                    im = 1.0;                                // Se non trova nulla assumiamo 1 come coefficiente
+                 } 
+                 goto termina; 
+        } else {                                             // Altrimenti è la parte reale 
+            ungetc(c, file);                                 // Torna indietro per leggere il valore
+            if (fscanf(file, " %lf", &re) != 1) return -1;   // Se fallisce vuol dire che c'è un input errato 
+            if (segno == '-') re = -re;                      // Se il segno iniziale era negativo corregge il valore reale
+            segno = '\0';                                    // Ripristina il segno
+            goto Parte_immaginaria;                          // Procede per la parte immaginaria
+        }
+    }  
+
+    /* Leggi parte reale */
+    ungetc(c, file);                                         // indietro dell’ultima lettura per non perdere il char trovato
+    if (fscanf(file, " %lf", &re) != 1) return -1;           // Valorizza il reale, se fallisce vuol dire che c'è un input errato
+
+    Parte_immaginaria:
+
+    /* Prova a leggere eventuale parte immaginaria del tipo ± i <numero> */
+    salta_spazi(file);                                 // Salta eventuali spazi tra reale e segno
+    c = fgetc(file);                                   // Legge il carattere successivo (potrebbe essere +, -, oppure altro)
+
+    if (c == '+' || c == '-') {                        // Se c’è + o - allora POTREBBE esserci la parte immaginaria
+        segno = c;                                     // Salviamo il segno per applicarlo alla parte immaginaria
+
+        salta_spazi(file);                             // Salta spazi prima della 'i' (se presenti)
+        c = fgetc(file);                               // Legge il carattere che dovrebbe essere 'i'
+
+        if (c == 'i') {                                // Se trova 'i', allora è proprio un complesso nel formato a±i b
+            if (fscanf(file, " %lf", &im) != 1) {      // Legge il valore della parte immaginaria
+                    im = 1.0;                          // Se non trova nulla assumiamo 1 come coefficiente
+                }                                          
+                if (segno == '-') im = -im;            // Applica il segno: a - i b => immaginaria negativa
+                goto termina;
+        } else {
+            /* Non era un complesso nel formato previsto: ripristina */
+            ungetc(c, file);                           // Rimette indietro il carattere letto “per errore”
+            ungetc(segno, file);                       // Rimette indietro anche il segno, così il flusso resta coerente
+        }
+    } else if (c != EOF) {
+        ungetc(c, file);                               // Se non era + o -, rimettilo indietro: dopo sarà gestito dal chiamante
+    }
+
+    termina: 
+    z->segno = segno;                                  // Scrive il segno nel risultato
+    z->parte_reale = re;                               // Scrive parte reale nel risultato
+    z->parte_immaginaria = im;                         // Scrive parte immaginaria nel risultato
+
+    if ( z->segno == '\0') {                           // Se la parte immaginaria non esiste la rappresentazione in stringhe sarà positiva
+        z->segno = '+';}
+
+    return 0;                                          
+}
+
+
+/*
+ * Funzione di supporto che legge da un file lo stato iniziale di un vettore: la lista [ ... ] dei 2^n valori,
+ * oppure |k> per lo stato k della base computazionale (utile oltre i 30 qubit, dove la lista non è praticabile)
+ * Paramentri: 
+ * file → file su cui bisogna leggere lo stato iniziale
+ * dati → struttura che verrà valorizzata con i dati letti 
+ * Ritorna 0 se ok, 1 se fallisce.
+ */
+static int leggi_init(FILE* file, dati_input_t* dati) {
+    long dimensione = 1L << dati->numero_qubit;        // Dimensione del vettore di stato: 2^numero_qubit
+
+    dati->stato_iniziale = alloca_stato(dimensione, 1); // Alloca e azzera il vettore (con pagine grandi se è grande)
+    if (!dati->stato_iniziale) return -1;              // Fallimento allocazione
+
+    return leggi_stato(file, dimensione, dati->stato_iniziale) == 0 ? 0 : -1;   // Manca lo stato: input errato
+}
+
+int leggi_stato(FILE* file, long dimensione, complesso_t* stato) {
+    /* Trova '[' o '|' senza rischiare loop infinito su EOF */
+    int c;                                             // variabile temporanea per il posizionamento
+    while ((c = fgetc(file)) != EOF && c != '[' && c != '|') {}
+    if (c == EOF) return 1;                            // Nessun altro stato
+
+    /* Forma compatta |k>: stato k della base computazionale, senza scrivere 2^n valori */
+    if (c == '|') {
+        long k;
+        if (fscanf(file, "%ld", &k) != 1 || fgetc(file) != '>' || k < 0 || k >= dimensione) return -1;
+        memset(stato, 0, dimensione * sizeof(complesso_t));
+        stato[k] = (complesso_t){1.0, 0.0, '+'};
+        return 0;
+    }
+
+    /* File aperto con puntatore posizionato dopo il carattere [*/
+    for (long i = 0; i < dimensione; i++) {            // Legge esattamente 2^n valori (reali o complessi)
+        if (leggi_complesso(file, &stato[i]) != 0) return -1; // Riempie ogni posizione, torna -1 in caso di errore
+    }
+    return 0;
+}
+
+
+/*
+ * Funzione di supporto che legge dal file la matrice di un operatore, a partire dalla posizione corrente
+ * (subito dopo il nome).
+ * Paramentri: 
+ * file → file su cui bisogna leggere la matrice
+ * op → operatore di cui valorizzare la matrice
+ * dimensione → dimensione della matrice (2^numero_qubit)
+ * riga_inizio, riga_fine → righe della matrice da conservare (le altre vengono lette e scartate)
+ * Ritorna 0 se ok, -1 se fallisce.
+ */
+static int leggi_matrice_operatore(FILE* file, operatore_quantistico_t* op, int dimensione, int riga_inizio, int riga_fine) {
+    if (riga_fine < 0 || riga_fine > dimensione) riga_fine = dimensione;   // -1: tutte le righe
+    op->matrice = crea_matrice_righe(dimensione, riga_inizio, riga_fine);  // Alloca la matrice (solo le righe richieste)
+    if (!op->matrice) return -1;                       // Se fallisce ritorna -1
+
+    /* Trova '[' */
+    int c;
+    while ((c = fgetc(file)) != EOF && c != '[') {}    // Consuma fino alla '[' che apre la matrice
+    if (c == EOF) return -1;                           // Input errato: manca '['
+
+    for (int i = 0; i < dimensione; i++) {
+        /* Ogni vettore è racchiuso da '(' ... ')' */
+        while ((c = fgetc(file)) != EOF && c != '(') {}  // Cerca l’inizio del vettore '('
+        if (c == EOF) return -1;                         // Ritorna -1 se l'input è errato
+
+        for (int j = 0; j < dimensione; j++) {         // Legge esattamente dimensione (2^numero_qubit) complessi per ogni vettore
+            complesso_t scarto;                        // Destinazione degli elementi delle righe non conservate
+            complesso_t* cella = op->matrice->dati[i] ? &op->matrice->dati[i][j] : &scarto;
+            if (leggi_complesso(file, cella) != 0) return -1; // Salva cella (i,j) elemento j-esimo del i-esimo vettore
+        }
+    }
+    return 0;
+}
+
+/*
+ * Funzione di supporto che aggiunge in coda all'array un operatore vuoto (senza nome, matrice né porte).
+ * Paramentri: dati → struttura a cui aggiungere l'operatore
+ * Ritorna il puntatore al nuovo operatore (non ancora conteggiato), NULL se fallisce.
+ */
+static operatore_quantistico_t* aggiungi_operatore(dati_input_t* dati) {
+    operatore_quantistico_t* tmp = realloc(            // Rialloca l’array per aggiungere 1 operatore
+        dati->operatori,
+        (dati->numero_operatori + 1) * sizeof(operatore_quantistico_t)
+    );
+    if (!tmp) return NULL;                             // Se realloc fallisce, non toccare il puntatore originale e ritorna errore
+    dati->operatori = tmp;                             // Aggiorna il puntatore all’array (ora più grande)
+
+    operatore_quantistico_t* op = &dati->operatori[dati->numero_operatori]; // Puntatore al nuovo slot appena aggiunto (l’elemento in coda)
+    op->nome[0] = '\0';
+    op->matrice = NULL;
+    op->posizione = -1;
+    op->porte = NULL;
+    op->numero_porte = 0;
+    op->originale = -1;
+    op->segmento = NULL;
+    return op;
+}
+
+/*
+ * Funzione di supporto che aggiunge un operatore in coda all'array e ne legge il nome.
+ * Paramentri: 
+ * file → file su cui leggere il nome
+ * dati → struttura a cui aggiungere l'operatore
+ * Ritorna il puntatore al nuovo operatore (non ancora conteggiato), NULL se fallisce.
+ */
+static operatore_quantistico_t* nuovo_operatore(FILE* file, dati_input_t* dati) {
+    operatore_quantistico_t* op = aggiungi_operatore(dati);
+    if (!op) return NULL;
+
+    if (fscanf(file, " %31s", op->nome) != 1) return NULL; // Legge il nome dell’operatore (es. H, I, ...) max 31 char
+    return op;
+}
+
+/*
+ * Funzione di supporto che legge dal file la descrizione di un operatore quantistico 
+ * Paramentri: 
+ * file → file su cui bisogna leggere la descrizione di un operatore quantistico
+ * dati → struttura che verrà valorizzata con i dati letti 
+ * riga_inizio, riga_fine → righe della matrice da conservare (le altre vengono lette e scartate)
+ * Ritorna 0 se ok, 1 se fallisce.
+ */
+static int leggi_operatore(FILE* file, dati_input_t* dati, int riga_inizio, int riga_fine) {
+    operatore_quantistico_t* op = nuovo_operatore(file, dati);
+    if (!op) return -1;
+
+    int dimensione = 1 << dati->numero_qubit;          // Matrice dell’operatore: 2^numero_qubit x 2^numero_qubit
+    if (leggi_matrice_operatore(file, op, dimensione, riga_inizio, riga_fine) != 0) return -1;
+
+    dati->numero_operatori++;                          // Ora c’è un operatore in più
+
+    /* Una matrice identica a quella di un operatore precedente non viene tenuta due volte */
+    if (!dati->archivio && !(dati->archivio = crea_archivio_operatori(0))) return -1;
+    return archivia_operatore(dati->archivio, dati, dati->numero_operatori - 1);
+}
+
+/*
+ * Funzione di supporto che registra un operatore senza leggerne la matrice: ne memorizza la posizione
+ * nel file e salta il testo fino alla ']' che chiude la matrice.
+ * Paramentri: 
+ * file → file su cui si trova la definizione
+ * dati → struttura a cui aggiungere l'operatore
+ * Ritorna 0 se ok, -1 se fallisce.
+ */
+static int indicizza_operatore(FILE* file, dati_input_t* dati) {
+    operatore_quantistico_t* op = nuovo_operatore(file, dati);
+    if (!op) return -1;
+
+    op->posizione = ftell(file);                       // La matrice inizia subito dopo il nome
+
+    int c;
+    while ((c = fgetc(file)) != EOF && c != '[') {}    // Apertura della matrice
+    while (c != EOF && (c = fgetc(file)) != EOF && c != ']') {}    // Chiusura: le righe usano solo ( )
+    if (c == EOF) return -1;
+
+    dati->numero_operatori++;
+    return 0;
+}
+
+/*
+ * Funzione di supporto che registra l'ultimo operatore aggiunto come porta con parametro simbolico e, se è
+ * nuovo, il parametro.
+ * Paramentri: dati → struttura con l'operatore, porta → nome della porta, simbolo → nome del parametro,
+ * coefficiente → fattore del parametro nell'angolo
+ * Ritorna 0 se ok, -1 se l'allocazione fallisce.
+ */
+static int aggiungi_parametrico(dati_input_t* dati, const char* porta, const char* simbolo, double coefficiente) {
+    int parametro = 0;
+    while (parametro < dati->numero_parametri && strcmp(dati->parametri[parametro], simbolo) != 0) parametro++;
+    if (parametro == dati->numero_parametri) {         // Parametro nuovo
+        char (*nomi)[32] = realloc(dati->parametri, (dati->numero_parametri + 1) * sizeof(*nomi));
+        if (!nomi) return -1;
+        dati->parametri = nomi;
+        strcpy(dati->parametri[dati->numero_parametri++], simbolo);
+    }
+
+    operatore_parametrico_t* tmp = realloc(dati->parametrici, (dati->numero_parametrici + 1) * sizeof(operatore_parametrico_t));
+    if (!tmp) return -1;
+    dati->parametrici = tmp;
+    operatore_parametrico_t* p = &dati->parametrici[dati->numero_parametrici++];
+    p->operatore = dati->numero_operatori - 1;
+    strcpy(p->porta, porta);
+    p->parametro = parametro;
+    p->coefficiente = coefficiente;
+    return 0;
+}
+
+/*
+ * Funzione di supporto che riconosce una porta predefinita in #circ (es. "H 0", "RX(pi/2) 1", "CNOT 0 1", "C-H 0 1"),
+ * anche con parametro simbolico (es. "RX(theta) 1", registrata in parametrici).
+ * Il nome è una porta solo se è seguito dal numero di qubit che richiede: altrimenti lo stream viene
+ * riportato dopo il nome, che resta il nome di un operatore definito con #define.
+ * La porta viene costruita direttamente nella sua forma interna, una sola volta per ogni combinazione
+ * di nome e qubit, e registrata come operatore con nome canonico (es. "CNOT 0 1").
+ * Paramentri: 
+ * file → file posizionato subito dopo il nome
+ * dati → struttura a cui aggiungere l'operatore
+ * nome → nome letto; se è una porta viene sostituito dal nome canonico
+ * Ritorna 1 se era una porta, 0 se non lo era, -1 in caso di errore (qubit non validi, allocazione).
+ */
+static int leggi_porta(FILE* file, dati_input_t* dati, char nome[32]) {
+    char simbolo[32];                                  // Parametro simbolico della porta, se c'è
+    double coefficiente = 0.0;
+    int numero_argomenti = argomenti_porta(nome);
+    if (numero_argomenti == 0) numero_argomenti = argomenti_porta_simbolica(nome, simbolo, &coefficiente);
+    else simbolo[0] = '\0';
+    if (numero_argomenti == 0) return 0;
+
+    long posizione = ftell(file);                      // Per tornare indietro se non seguono i qubit
+    int qubit[MAX_ARGOMENTI_PORTA];
+    char canonico[96];                                 // Nome seguito dai qubit, deve poi rientrare in 32 caratteri
+    int lunghezza = snprintf(canonico, sizeof(canonico), "%s", nome);
+
+    for (int j = 0; j < numero_argomenti; j++) {
+        char argomento[32];
+        char* fine;
+        if (fscanf(file, " %31s", argomento) != 1) argomento[0] = '\0';
+        long valore = strtol(argomento, &fine, 10);
+
+        if (argomento[0] == '\0' || *fine != '\0') { // Non è un indice di qubit
+            if (j == 0) {                              // Nome di un operatore definito dall'utente
+                fseek(file, posizione, SEEK_SET);
+                return 0;
+            }
+            fprintf(stderr, "Porta %s: attesi %d qubit\n", nome, numero_argomenti);
+            return -1;
+        }
+        qubit[j] = (valore < 0 || valore >= dati->numero_qubit) ? -1 : (int)valore;
+        lunghezza += snprintf(canonico + lunghezza, sizeof(canonico) - lunghezza, " %d", (int)valore);
+    }
+    if (lunghezza >= 32) {
+        fprintf(stderr, "Porta %s: nome troppo lungo\n", nome);
+        return -1;
+    }
+
+    if (trova_operatore(dati, canonico)) {             // Stessa porta sugli stessi qubit: già costruita
+        strcpy(nome, canonico);
+        return 1;
+    }
+
+    porta_t porta;
+    int esito = simbolo[0] ? crea_porta_angolo(nome, 0.0, qubit, dati->numero_qubit, &porta)     // Angolo di ogni punto in parametri.c
+                           : crea_porta(nome, qubit, dati->numero_qubit, &porta);
+    if (esito != 0) {
+        fprintf(stderr, "Porta %s: qubit non validi per un circuito a %d qubit\n", canonico, dati->numero_qubit);
+        return -1;
+    }
+
+    operatore_quantistico_t* op = aggiungi_operatore(dati);
+    if (!op) return -1;
+    op->porte = (porta_t*)malloc(sizeof(porta_t));
+    if (!op->porte) return -1;
+    *op->porte = porta;
+    op->numero_porte = 1;
+    strcpy(op->nome, canonico);
+    dati->numero_operatori++;
+    if (simbolo[0] && aggiungi_parametrico(dati, nome, simbolo, coefficiente) != 0) return -1;
+
+    strcpy(nome, canonico);
+    return 1;
+}
+
+/*
+ * Funzione di supporto che legge dal file il circuito da simulare come sequenza di nomi di operatori
+ * o di porte predefinite con i relativi qubit.
+ * Paramentri: 
+ * file → file su cui bisogna leggere il circuito da simulare
+ * dati → struttura che verrà valorizzata con i dati letti 
+ * Ritorna 0 se ok, -1 in caso di errore (allocazione o porta non valida).
+ */
+static int leggi_circuito(FILE* file, dati_input_t* dati) {
+    char nome[32];                                     // Il nome può essere lungo al massimo 32 caratteri
+
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (isspace(c)) continue;                      // Salta gli spazi tra i nomi
+        ungetc(c, file);                               // Rimetti il carattere nello stream: il loop esterno rilegge la direttiva intera
+        if (c == '#') return 0;                        // Se inizia una nuova direttiva, fermati
+        if (fscanf(file, "%31s", nome) != 1) break;    // Legge nomi uno per volta
+
+        if (leggi_porta(file, dati, nome) < 0) return -1;   // Porta predefinita: nome diventa il nome canonico
+
+        istruzione_circuito_t* tmp = realloc(          // Aggiunge una nuova istruzione al vettore dinamico
+            dati->circuito,
+            (dati->numero_istruzioni + 1) * sizeof(istruzione_circuito_t)
+        );
+        if (!tmp) return -1;
+        dati->circuito = tmp;
+
+        strcpy(dati->circuito[dati->numero_istruzioni].nome_operatore, nome); // Copia nome dell'operatore nell’istruzione
+        dati->numero_istruzioni++;                     // Incrementa contatore istruzioni
+    }
+
+    return 0;                                         
+}
+
+/*
+ * Legge e interpreta un file di input testuale aprendo il file in modalità lettura e scansionando direttive.
+ * Gestisce le sezioni: #qubits (numero di qubit), #init (stato iniziale), #define (operatori), #circ (circuito),
+ * delegando l'analisi sintattica alle funzioni di supporto leggi_init/leggi_operatore/leggi_circuito.
+ * Paramentri: 
+ * file → file su cui bisogna leggere gli input
+ * dati → struttura che verrà valorizzata con i dati letti 
+ * Ritorna 0 se tutto ok, -1 in caso di errori (apertura file, formato non valido o fallimenti nelle letture).
+ */
+static int scansiona_input(const char* nome_file, dati_input_t* dati, int riga_inizio, int riga_fine, int solo_indice);
+
+int leggi_input(const char* nome_file, dati_input_t* dati) {
+    return leggi_input_righe(nome_file, dati, 0, -1);
+}
+
+/*
+ * Come leggi_input, ma delle matrici degli operatori conserva solo le righe [riga_inizio, riga_fine)
+ * (riga_fine = -1 per tutte). Le altre righe restano NULL.
+ * Ritorna 0 se tutto ok, -1 in caso di errori.
+ */
+int leggi_input_righe(const char* nome_file, dati_input_t* dati, int riga_inizio, int riga_fine) {
+    return scansiona_input(nome_file, dati, riga_inizio, riga_fine, 0);
+}
+
+/*
+ * Come leggi_input, ma per ogni #define registra solo il nome e la posizione della matrice nel file,
+ * senza leggerla. Le matrici vengono lette in seguito con carica_operatore.
+ * Ritorna 0 se tutto ok, -1 in caso di errori.
+ */
+int indicizza_input(const char* nome_file, dati_input_t* dati) {
+    return scansiona_input(nome_file, dati, 0, -1, 1);
+}
+
+int leggi_varianti(const char* nome_file, dati_input_t* dati) {
+    FILE* file = fopen(nome_file, "r");                // Apre file in lettura
+    if (!file) {
+        perror(nome_file);                             // Stampa errore di sistema 
+        return -1;
+    }
+
+    /* Il circuito del file -c viene messo da parte: leggi_circuito aggiunge a dati->circuito */
+    istruzione_circuito_t* circuito = dati->circuito;
+    int numero_istruzioni = dati->numero_istruzioni;
+    int ret = 0;
+    char parola[32];
+
+    while (ret == 0 && fscanf(file, " %31s", parola) == 1) {
+        if (strcmp(parola, "#define") == 0) {          // Operatore aggiuntivo
+            ret = leggi_operatore(file, dati, 0, -1);
+        }
+        else if (strcmp(parola, "#circ") == 0) {       // Nuova variante
+            variante_t* tmp = realloc(dati->varianti, (dati->numero_varianti + 1) * sizeof(variante_t));
+            if (!tmp) {
+                ret = -1;
+                break;
+            }
+            dati->varianti = tmp;
+            dati->circuito = NULL;
+            dati->numero_istruzioni = 0;
+            ret = leggi_circuito(file, dati);
+            dati->varianti[dati->numero_varianti++] = (variante_t){dati->circuito, dati->numero_istruzioni};
+        }
+    }
+
+    dati->circuito = circuito;
+    dati->numero_istruzioni = numero_istruzioni;
+    fclose(file);
+    return (ret == 0 && dati->numero_varianti > 0) ? 0 : -1;
+}
+
+int leggi_qubits(const char* nome_file) {
+    FILE* file = fopen(nome_file, "r");                // Apre file in lettura
+    if (!file) {
+        perror(nome_file);                             // Stampa errore di sistema
+        return -1;
+    }
+
+    char parola[32];
+    int numero_qubit = -1;
+    while (fscanf(file, " %31s", parola) == 1) {       // Salta tutto fino a #qubits (anche i valori di #init)
+        if (strcmp(parola, "#qubits") == 0) {
+            if (fscanf(file, " %d", &numero_qubit) != 1 || numero_qubit <= 0) numero_qubit = -1;
+            break;
+        }
+    }
+
+    fclose(file);
+    return numero_qubit;
+}
+
+/*
+ * Legge la matrice di un operatore registrato da indicizza_input.
+ * Parametri:
+ * file → file del circuito, aperto in lettura dal chiamante
+ * numero_qubit → qubit del circuito
+ * op → operatore con posizione valida, la cui matrice verrà allocata e valorizzata
+ * Ritorna 0 se tutto ok, -1 in caso di errori.
+ */
+int carica_operatore(FILE* file, int numero_qubit, operatore_quantistico_t* op) {
+    if (!file || !op || op->posizione < 0 || op->matrice) return -1;
+    if (fseek(file, op->posizione, SEEK_SET) != 0) return -1;
+
+    if (leggi_matrice_operatore(file, op, 1 << numero_qubit, 0, -1) != 0) {
+        distruggi_matrice(op->matrice);
+        op->matrice = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Funzione di supporto comune a leggi_input_righe e indicizza_input: scansiona le direttive del file.
+ * Con solo_indice = 1 le matrici dei #define non vengono lette ma solo indicizzate.
+ * Ritorna 0 se tutto ok, -1 in caso di errori.
+ */
+static int scansiona_input(const char* nome_file, dati_input_t* dati, int riga_inizio, int riga_fine, int solo_indice) {
+    FILE* file = fopen(nome_file, "r");                // Apre file in lettura
+    if (!file) {
+        perror(nome_file);                             // Stampa errore di sistema 
+        return -1;
+    }
+
+    char parola[32];
+
+    while (fscanf(file, " %31s", parola) == 1) {       // Legge la prossima “parola” 
+        if (strcmp(parola, "#qubits") == 0) {          // Se #qubits: numero di qubit
+            if (fscanf(file, " %d", &dati->numero_qubit) != 1 ||  // Legge intero n
+                verifica_memoria(dati->numero_qubit, COPIE_STATO_PORTE) != 0) {   // Prima di allocare lo stato
+                fclose(file);                          // Chiude il file
+                return -1;
+            }
+        }
+        else if (strcmp(parola, "#init") == 0) {       // Se #init: stato iniziale
+            if (leggi_init(file, dati) != 0) {         // Legge lo stato iniziale
+                fclose(file);                          // Chiude il file
+                return -1;
+            }
+        }
+        else if (strcmp(parola, "#define") == 0) {     // Se #define: definizione operatore
+            int esito = solo_indice ? indicizza_operatore(file, dati)                 // Registra solo la posizione
+                                    : leggi_operatore(file, dati, riga_inizio, riga_fine);  // Legge l'operatore
+            if (esito != 0) {
+                fclose(file);                          // Chiude il file
+                return -1;
+            }
+        }
+        else if (strcmp(parola, "#circ") == 0) {       // Se #circ: circuito (sequenza di nomi)
+            if (leggi_circuito(file, dati) != 0) {     // Legge il circuito
+                fclose(file);                          // Chiude il file
+                return -1;
+            }
+        }
+        
+    }
+
+    fclose(file);   // Chiude il file                    
+    return 0;                                          
+} 
+
+/*
+ * Cerca un operatore per nome nell’array degli operatori.
+ * Parametri: 
+ * dati → struttura da cui prendere l'array
+ * nome → nome dell'operatore da cercare
+ * Ritorna puntatore all’operatore se trovato, NULL altrimenti.
+ */
+operatore_quantistico_t* trova_operatore(dati_input_t* dati, const char* nome) {
+
+    for (int i = 0; i < dati->numero_operatori; i++) {
+        if (strcmp(dati->operatori[i].nome, nome) == 0) {
+            int originale = dati->operatori[i].originale;     // Duplicato: si usa l'operatore con la stessa matrice
+            return &dati->operatori[originale >= 0 ? originale : i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Funzione che permette di calcolare la dimensione della matrice utilizzata dagli operatori 
+ * quantistici definiti in un file testuale.
+ * Parametri:
+ * file → file testuale su cui bisogna leggere 
+ * ritorna → intero che rappresenta la dimensione della matrice in termini di qubits
+ */
+int dimensione_operatori(const char* nome_file) {
+
+    FILE* file = fopen(nome_file, "r");                // Apre file in lettura
+    if (!file) {
+        perror(nome_file);                             // Stampa errore di sistema 
+        return -1;
+    }
+
+    /* Trova l'inizio di una matrice */
+    int c;
+    while ((c = fgetc(file)) != EOF && c != '[') {}    // Consuma fino alla '[' che apre la matrice di un operatore
+    if (c == EOF) {                                    // Nessuna matrice: il circuito usa solo porte predefinite
+        fclose(file);
+        return 0;
+    }
+
+    /* Calcola la dimensione della matrice */
+    int dimensione = 0;
+    while ((c = fgetc(file)) != EOF && c != ']') {   // Consuma fino alla ']' che chiude la matrice dell'operatore
+        if (c == '(') dimensione += 1;
+    }    
+    fclose(file);            // Chiude il file  
+    if (c == EOF) return -1;        // File incompleto, ritorna errore
+
+    return dimensione;       // Ritorna la dimensione della matrice 
+}
+
+/*
+ * Libera tutta la memoria allocata dentro in una struttura di tipo dati_input_t.
+ * Parametri: dati → struttura da liberare
+ */
+void libera_dati_input(dati_input_t* dati) {
+    
+    free(dati->stato_iniziale);     // Libera il vettore dello stato iniziale
+    dati->stato_iniziale = NULL;    // Imposta il puntatore a NULL
+
+    if (dati->operatori) {          // Controlla che l'array di operatori esista
+        for (int i = 0; i < dati->numero_operatori; i++) {
+            libera_matrice_operatore(&dati->operatori[i]);  // Libera la matrice dell'operatore (anche se condivisa)
+            free(dati->operatori[i].porte);                 // Libera le porte dell'operatore
+            dati->operatori[i].porte = NULL;
+        }
+        free(dati->operatori);      // Libera l'array degli operatori
+        dati->operatori = NULL;     // Imposta il puntatore a NULL
+    }
+    dati->numero_operatori = 0;     // Azzeramento del contatore degli operatori
+
+    free(dati->circuito);           // Libera l'array del circuito (istruzioni)
+    dati->circuito = NULL;           // Imposta il puntatore a NULL
+    dati->numero_istruzioni = 0;     // Azzeramento del numero di istruzioni
+
+    for (int v = 0; v < dati->numero_varianti; v++) free(dati->varianti[v].istruzioni);   // Libera le varianti
+    free(dati->varianti);
+    dati->varianti = NULL;
+    dati->numero_varianti = 0;
+
+    free(dati->parametrici);        // Libera gli operatori parametrici e i nomi dei parametri
+    dati->parametrici = NULL;
+    dati->numero_parametrici = 0;
+    free(dati->parametri);
+    dati->parametri = NULL;
+    dati->numero_parametri = 0;
+
+    distruggi_archivio_operatori(dati->archivio);
+    dati->archivio = NULL;
+
+    dati->numero_qubit = 0;          // Azzeramento del numero di qubit nella struttura
+}
+
+/* Funzione di debug utilizzata nel main per stampe di dati */
+void stampa_dati(dati_input_t dati, long dimensione) {
+
+    printf("Qubit: %d\n", dati.numero_qubit);
+
+    printf("\nStato iniziale:\n");
+    stampa_vettore(dati.stato_iniziale, dimensione);
+
+    printf("\nOperatori definiti: %d\n", dati.numero_operatori);
+    for (int i = 0; i < dati.numero_operatori; i++) {
+        printf("\n#define %s \n", dati.operatori[i].nome);
+        if (dati.operatori[i].matrice) {
+            stampa_matrice(dati.operatori[i].matrice);
+        } else if (dati.operatori[i].porte) {
+            printf("(%d porte predefinite)\n", dati.operatori[i].numero_porte);
+        } else {
+            printf("(matrice NULL)\n");
+        }
+        printf("\n");
+    }
+
+    printf("\nCircuito:\n");
+    printf("#circ ");
+    for (int i = 0; i < dati.numero_istruzioni; i++) {
+        printf("%s", dati.circuito[i].nome_operatore);
+        if (i < dati.numero_istruzioni - 1) printf(" ");
+    }
+    printf("\n\n");
+
+}
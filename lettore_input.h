@@ -1,67 +1,152 @@
-#ifndef LETTORE_INPUT_H
-#define LETTORE_INPUT_H
-
-#include "matrice.h"
-
-/* Nuovo tipo che rappresenta un operatore quantistico */
-typedef struct {
-    char nome[32];            // Nome simbolico dell’operatore
-    matrice_t* matrice;       // Puntatore alla matrice
-} operatore_quantistico_t;
-
-/* Nuovo tipo che rappresenta un'istruzione del circuito */
-typedef struct {
-    char nome_operatore[32];  // Nome dell’operatore da applicare
-} istruzione_circuito_t;
-
-/* Nuvo tipo che conterrà tutti i dati di input */
-typedef struct {
-    int numero_qubit;                    // Qubits utilizzati dal circuito quantistico (#qubits)
-    complesso_t* stato_iniziale;         // Vettore di dimensione 2^numero_qubit (#init)
-
-    operatore_quantistico_t* operatori;  // Array dinamico di operatori (#define) 
-    int numero_operatori;                // Dimensione array operatori
-
-    istruzione_circuito_t* circuito;     // Array dinamico di istruzioni del circuito (#circ)
-    int numero_istruzioni;               // Dimensione array circuito
-} dati_input_t;
-
-/*
- * Legge e interpreta un file di input testuale aprendo il file in modalità lettura e scansionando direttive.
- * Gestisce le sezioni: #qubits (numero di qubit), #init (stato iniziale), #define (operatori), #circ (circuito),
- * delegando l'analisi sintattica alle funzioni di supporto leggi_init/leggi_operatore/leggi_circuito.
- * Paramentri: 
- * file → file su cui bisogna leggere gli input
- * dati → struttura che verrà valorizzata con i dati letti 
- * Ritorna 0 se tutto ok, -1 in caso di errori (apertura file, formato non valido o fallimenti nelle letture).
- */
-int leggi_input(const char* nome_file, dati_input_t* dati);
-
-/*
- * Funzione che permette di calcolare la dimensione della matrice utilizzata dagli operatori 
- * quantistici definiti in un file testuale.
- * Parametri:
- * file → file testuale su cui bisogna leggere 
- * ritorna → intero che rappresenta la dimensione della matrice in termini di qubits
- */
-int dimensione_operatori(const char* nome_file);
-
-/*
- * Cerca un operatore per nome nell’array degli operatori.
- * Parametri: 
- * dati → struttura da cui prendere l'array
- * nome → nome dell'operatore da cercare
- * Ritorna puntatore all’operatore se trovato, NULL altrimenti.
- */
-operatore_quantistico_t* trova_operatore(dati_input_t* dati, const char* nome);
-
-/*
- * Libera tutta la memoria allocata dentro in una struttura di tipo dati_input_t.
- * Parametri: dati → struttura da liberare
- */
-void libera_dati_input(dati_input_t* dati);
-
-/* Funzione di debug utilizzata nel main per stampe di dati */
-void stampa_dati(dati_input_t dati, int dimensione);
-
-#endif
+#ifndef LETTORE_INPUT_H
+#define LETTORE_INPUT_H
+
+#include <stdio.h>
+#include "matrice.h"
+#include "porte.h"
+
+/* Nuovo tipo che rappresenta un operatore quantistico */
+typedef struct {
+    char nome[32];            // Nome simbolico dell’operatore
+    matrice_t* matrice;       // Puntatore alla matrice, NULL per gli operatori formati da porte
+    long posizione;           // Posizione della matrice nel file (indicizza_input), -1 se già letta
+    porta_t* porte;           // Porte da applicare in sequenza al posto della matrice, NULL se non presenti
+    int numero_porte;         // Dimensione array porte
+    int originale;            // Indice dell'operatore con la stessa matrice (archivio_operatori.h), -1 se non è un duplicato
+    struct segmento_condiviso* segmento;    // Segmento condiviso della matrice (archivio_operatori.h), NULL se in memoria propria
+} operatore_quantistico_t;
+
+/* Nuovo tipo che rappresenta un'istruzione del circuito */
+typedef struct {
+    char nome_operatore[32];  // Nome dell’operatore da applicare
+} istruzione_circuito_t;
+
+/* Nuovo tipo che rappresenta una variante del circuito (un #circ del file delle varianti) */
+typedef struct {
+    istruzione_circuito_t* istruzioni;   // Istruzioni della variante, nell'ordine di #circ
+    int numero_istruzioni;
+} variante_t;
+
+/* Nuovo tipo che rappresenta una porta predefinita con parametro simbolico (es. "RX(theta) 0"): la porta
+ * dell'operatore viene costruita una volta e ne vengono ricalcolati solo i coefficienti per ogni punto (parametri.h) */
+typedef struct {
+    int operatore;            // Indice dell'operatore in operatori (una sola porta)
+    char porta[32];           // Nome della porta con il parametro simbolico, es. "C-RZ(2*gamma)"
+    int parametro;            // Indice del parametro in parametri
+    double coefficiente;      // Angolo = coefficiente * valore del parametro
+} operatore_parametrico_t;
+
+/* Nuvo tipo che conterrà tutti i dati di input */
+typedef struct {
+    int numero_qubit;                    // Qubits utilizzati dal circuito quantistico (#qubits)
+    complesso_t* stato_iniziale;         // Vettore di dimensione 2^numero_qubit (#init)
+
+    operatore_quantistico_t* operatori;  // Array dinamico di operatori (#define) 
+    int numero_operatori;                // Dimensione array operatori
+
+    istruzione_circuito_t* circuito;     // Array dinamico di istruzioni del circuito (#circ)
+    int numero_istruzioni;               // Dimensione array circuito
+
+    variante_t* varianti;                // Varianti del circuito (leggi_varianti), NULL se non lette
+    int numero_varianti;                 // Dimensione array varianti
+
+    operatore_parametrico_t* parametrici; // Operatori che dipendono dai parametri, NULL se il circuito non ne ha
+    int numero_parametrici;              // Dimensione array parametrici
+    char (*parametri)[32];               // Nomi dei parametri simbolici, nell'ordine in cui compaiono in #circ
+    int numero_parametri;                // Dimensione array parametri
+
+    struct archivio_operatori* archivio; // Matrici degli operatori per contenuto (archivio_operatori.h), NULL finché non serve
+} dati_input_t;
+
+/*
+ * Legge e interpreta un file di input testuale aprendo il file in modalità lettura e scansionando direttive.
+ * Gestisce le sezioni: #qubits (numero di qubit), #init (stato iniziale), #define (operatori), #circ (circuito),
+ * delegando l'analisi sintattica alle funzioni di supporto leggi_init/leggi_operatore/leggi_circuito.
+ * Paramentri: 
+ * file → file su cui bisogna leggere gli input
+ * dati → struttura che verrà valorizzata con i dati letti 
+ * Ritorna 0 se tutto ok, -1 in caso di errori (apertura file, formato non valido o fallimenti nelle letture).
+ */
+int leggi_input(const char* nome_file, dati_input_t* dati);
+
+/*
+ * Come leggi_input, ma delle matrici degli operatori conserva solo le righe [riga_inizio, riga_fine)
+ * (riga_fine = -1 per tutte); le altre righe vengono lette e scartate e restano NULL.
+ * Usata nella simulazione distribuita, dove ogni processo tiene solo il proprio blocco di righe.
+ * Ritorna 0 se tutto ok, -1 in caso di errori.
+ */
+int leggi_input_righe(const char* nome_file, dati_input_t* dati, int riga_inizio, int riga_fine);
+
+/*
+ * Come leggi_input, ma per ogni #define registra solo il nome e la posizione della matrice nel file,
+ * senza leggerla (la matrice resta NULL). Legge normalmente le altre direttive, compreso #circ.
+ * Usata dal caricamento in pipeline per conoscere subito il circuito.
+ * Ritorna 0 se tutto ok, -1 in caso di errori.
+ */
+int indicizza_input(const char* nome_file, dati_input_t* dati);
+
+/*
+ * Legge un file di varianti del circuito: ogni direttiva #circ è una variante a sé, con la stessa sintassi
+ * del #circ del file circuito (operatori definiti e porte predefinite). Sono ammesse anche direttive #define,
+ * che si aggiungono agli operatori già letti.
+ * Parametri: nome_file → file delle varianti, dati → struttura con #qubits e operatori già letti
+ * Ritorna 0 se tutto ok, -1 in caso di errori (apertura file, formato non valido, nessuna variante).
+ */
+int leggi_varianti(const char* nome_file, dati_input_t* dati);
+
+/*
+ * Legge il prossimo stato da un flusso di stati: una lista "[ ... ]" di esattamente dimensione valori
+ * (reali o complessi, come in #init) oppure la forma compatta |k> (stato k della base computazionale).
+ * Prima dello stato vengono saltati gli altri caratteri (spazi, separatori, la ']' dello stato precedente).
+ * Parametri: file → flusso aperto in lettura, dimensione → 2^numero_qubit, stato → vettore di dimensione ampiezze da valorizzare
+ * Ritorna: 0 se uno stato è stato letto, 1 se il flusso è finito prima di un nuovo stato, -1 se lo stato non è valido
+ */
+int leggi_stato(FILE* file, long dimensione, complesso_t* stato);
+
+/*
+ * Legge solo il numero di qubit (#qubits) di un file, senza leggere né allocare lo stato iniziale.
+ * Usata dal piano di esecuzione (piano.h), che non deve richiedere la memoria della simulazione.
+ * Parametri: nome_file → file dello stato iniziale
+ * Ritorna: numero di qubit, -1 in caso di errore (apertura file, #qubits mancante o non valido)
+ */
+int leggi_qubits(const char* nome_file);
+
+/*
+ * Legge la matrice di un operatore registrato da indicizza_input.
+ * Parametri:
+ * file → file del circuito, aperto in lettura dal chiamante
+ * numero_qubit → qubit del circuito
+ * op → operatore con posizione valida, la cui matrice verrà allocata e valorizzata
+ * Ritorna 0 se tutto ok, -1 in caso di errori.
+ */
+int carica_operatore(FILE* file, int numero_qubit, operatore_quantistico_t* op);
+
+/*
+ * Funzione che permette di calcolare la dimensione della matrice utilizzata dagli operatori 
+ * quantistici definiti in un file testuale.
+ * Parametri:
+ * file → file testuale su cui bisogna leggere 
+ * ritorna → intero che rappresenta la dimensione della matrice in termini di qubits,
+ * 0 se il file non definisce matrici (circuito formato solo da porte predefinite), -1 in caso di errore
+ */
+int dimensione_operatori(const char* nome_file);
+
+/*
+ * Cerca un operatore per nome nell’array degli operatori.
+ * Parametri: 
+ * dati → struttura da cui prendere l'array
+ * nome → nome dell'operatore da cercare
+ * Ritorna puntatore all’operatore se trovato (l'originale se è un duplicato), NULL altrimenti.
+ */
+operatore_quantistico_t* trova_operatore(dati_input_t* dati, const char* nome);
+
+/*
+ * Libera tutta la memoria allocata dentro in una struttura di tipo dati_input_t.
+ * Parametri: dati → struttura da liberare
+ */
+void libera_dati_input(dati_input_t* dati);
+
+/* Funzione di debug utilizzata nel main per stampe di dati */
+void stampa_dati(dati_input_t dati, long dimensione);
+
+#endif
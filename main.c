@@ -1,199 +1,469 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <unistd.h>
-#include "lettore_input.h"
-#include "thread_matrice.h"
-#include "matrice.h"
-
-
-/* Struttura che raccoglie le opzioni della riga di comando */
-typedef struct {
-    int numero_thread;
-    const char* file_iniziale;
-    const char* file_circuito;
-} opzioni_t;
-
-
-/* Funzione che stampa un messaggio in caso di errore che spiega come passare correttamente gli input all'eseguibile */
-static void stampa_uso(const char* nome_programma) {
-    fprintf(stderr, "Utilizzo corretto del programma:\n%s -t <numero_thread> -i <file_iniziale> -c <file_circuito>\n", nome_programma);
-}
-
-/* Analisi della riga di comando con getopt. Ritorna 0 se ok, -1 se errore */
-static int analisi_argomenti(int argc, char* argv[], opzioni_t* opt) {
-    if (!opt) return -1;
-
-    opt->numero_thread = -1;    // Variabile che conterrà il numero di thread da utilizzare
-    opt->file_iniziale = NULL;  // Puntatore che punterà il file che contiene lo stato iniziale
-    opt->file_circuito = NULL;  // Puntatole che punterà il file che contiene il circuito
-    int c;                      // Variabile che conterrà il valore del carattere 
-    
-    int visto_i = 0, visto_c = 0, visto_t = 0;      // Variabili per verifica di un parametro doppione nel while
-
-    /* Guarda dentro argv[] e trova la prossima opzione (tipo -t, -i, -c). Se l’opzione richiede un argomento 
-       (dopo la lettera c’è : nella stringa "t:i:c:"), getopt mette il relativo valore in optarg */
-    while ((c = getopt(argc, argv, "t:i:c:")) != -1) {
-        
-        switch (c) {
-            case 't': 
-                if (visto_t) return -1;
-                visto_t = 1;
-                opt->numero_thread = atoi(optarg); 
-                break;
-
-            case 'i': 
-                if (visto_i) return -1;
-                visto_i = 1;
-                opt->file_iniziale = optarg; 
-                break;
-
-            case 'c': 
-                if (visto_c) return -1;
-                visto_c = 1;
-                opt->file_circuito = optarg; 
-                break;
-
-            default: return -1;
-        }
-    }
-
-    /* Niente argomenti extra: se l’utente ha scritto argomenti “in più” non riconosciuti,
-       saranno in argv[optind]. (optind è l'indice del prossimo elemento in argv). */
-    if (optind < argc) return -1;
-
-    /* Presenza e validità minima */
-    if (opt->numero_thread <= 0) return -1;
-    if (!opt->file_iniziale || !opt->file_circuito) return -1;
-
-    return 0;
-}
-
-/* Carica e valida i due file nella struttura "dati". Ritorna 0 se ok, -1 se errore. */
-static int carica_input(const opzioni_t* opt, dati_input_t* dati, int* dimensione) {
-    if (!opt || !dati || !dimensione) return -1;
-
-    /* File iniziale: #qubits e #init */
-    if (leggi_input(opt->file_iniziale, dati) != 0) return -1;
-    if (!(dati->numero_qubit > 0 && dati->stato_iniziale != NULL)) return -1;
-
-    /* Dimensione = 2^numero_qubit */
-    *dimensione = 1 << dati->numero_qubit;  // shift a sinistra di numero_qubit posizioni
-
-    /* Verifica compatibilità dimensioni */
-    int dim_operatori = dimensione_operatori(opt->file_circuito);   // Dimensione operatori
-
-    /* Se le due dimensioni non coincidono il circuito non può essere applicato allo stato iniziale */
-    if (*dimensione != dim_operatori) return -1;     
-                                                     
-    /* File circuito: #define e #circ */
-    if (leggi_input(opt->file_circuito, dati) != 0) return -1;
-    if (!(dati->numero_operatori > 0 && dati->circuito != NULL)) return -1;
-
-    return 0;
-}
-
-/* Esegue il circuito: per ogni istruzione fa stato = M * stato. Ritorna 0 se ok, -1 se errore. */
-static int esegui_circuito(const dati_input_t* dati, int dimensione, complesso_t** stato_finale) {
-    if (!dati || dimensione <= 0 || !stato_finale) return -1;
-
-    complesso_t* stato = dati->stato_iniziale;   // Stato iniziale preso da #init
-    if (!stato) return -1;
-
-    for (int i = 0; i < dati->numero_istruzioni; i++) {     // Per ogni istruzione presa da #circ
-        const char* nome_op = dati->circuito[i].nome_operatore;     // Prende il nome dell'operatore
-        operatore_quantistico_t* op = trova_operatore((dati_input_t*)dati, nome_op);    // Lo cerca nell'array che li contiene 
-
-        if (!op || !op->matrice) {                            // Se l'operatore non è stato trovato o la sua matrice non è valida
-            if (stato != dati->stato_iniziale) free(stato);   // Libera eventualmente la memoria e lancia errore
-            return -1;
-        }
-
-        complesso_t* nuovo_stato = moltiplica_matrice_vettore_mt_riuso(op->matrice, stato);     // Puntatore al vettore che conterrà lo stato aggiornato
-        if (!nuovo_stato) {
-            if (stato != dati->stato_iniziale) free(stato);
-            return -1;
-        }
-
-        if (stato != dati->stato_iniziale) free(stato);     // Se lo stato non è quello iniziale, liberiamo la memoria perché non servirà più
-        stato = nuovo_stato;                                // Aggiorniamo lo stato con il nuovo stato
-        
-        //printf("\nStato aggiornato: ");             
-        //stampa_vettore(nuovo_stato, dimensione);    // Stampa di debug
-        //printf("\n");
-    }
-
-    *stato_finale = stato;      // Aggiorniamo lo stato finale con stato calcolato
-    return 0;
-}
-
-
-/* Funzione principale per il calcolo del circuito quantistico */
-int main(int argc, char* argv[]) {
-    int ret = 1;                              // Variabile che conterrà il valore di ritorno
-
-    opzioni_t opt;                            // Struttura che raccoglierà le opzioni della riga di comando 
-    dati_input_t dati = (dati_input_t){0};    // Struttura che raccoglierà i dati in input
-
-    int dimensione = 0;                       // Variabile che conterrà la dimensione della matrice
-    int thread_inizializzati = 0;             // Variabile che conterrà lo stato della squadra dei thread (1 se inizializzata, 0 altrimenti)
-    complesso_t* stato_finale = NULL;         // Puntatore al vettore dello stato finale
-
-    /* Analisi degli argomenti */
-    if (analisi_argomenti(argc, argv, &opt) != 0) {
-        fprintf(stderr, "Errore: argomenti non validi\n");
-        stampa_uso(argv[0]);
-        goto cleanup;
-    }
-
-    /* Caricamento input */
-    if (carica_input(&opt, &dati, &dimensione) != 0) {
-        fprintf(stderr, "Errore: file non leggibili o input non valido, verificare compatibilita' tra file\n");
-        stampa_uso(argv[0]);
-        goto cleanup;
-    }
-
-    /* Limita numero_thread per evitare thread idle:
-     * Se il numero di thread è maggiore alla dimensione della matrice, avremo un overhaed di creazioni (di thread) e thread idle (senza lavoro)
-     * Limitiamo quindi il numero di thread alla dimensione così da dare almeno un lavoro ad ogni thread e limitare il costo. */
-    if (opt.numero_thread > dimensione) opt.numero_thread = dimensione;
-
-    /* Stampa di verifica */
-    //stampa_dati(dati, dimensione);
-   
-    /* Inizializza la squadra di thread */
-    if (inizializza_squadra_thread(opt.numero_thread, dimensione) != 0) {
-        fprintf(stderr, "Errore: impossibile inizializzare la squadra di thread\n");
-        goto cleanup;
-    }
-    thread_inizializzati = 1;   // Aggiorniamo lo stato della squadra
-
-    /* Esecuzione circuito */
-    if (esegui_circuito(&dati, dimensione, &stato_finale) != 0) {
-        fprintf(stderr, "Errore: esecuzione circuito fallita\n");
-        goto cleanup;
-    }
-
-    /* Stampa lo stato finale */
-    printf("\nStato finale:\n");
-    stampa_vettore(stato_finale, dimensione);
-    printf("\n");
-
-    ret = 0;
-
-cleanup:
-    /* Verifica se la squadra già esiste ed eventualmente la distrugge */
-    if (thread_inizializzati) {
-        distruggi_squadra_thread();
-    }
-
-    /* Se lo stato finale NON coincide con lo stato iniziale, è memoria allocata durante il circuito e va liberata */
-    if (stato_finale && stato_finale != dati.stato_iniziale) {
-        free(stato_finale);
-        stato_finale = NULL;
-    }
-
-    /* Liberiamo tutta la memoria allocata per la struttura dei dati */
-    libera_dati_input(&dati);
-
-    return ret;    
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <limits.h>
+#include "qsim.h"
+#include "matrice.h"
+#include "profilo.h"
+#include "distribuito.h"
+#include "kronecker.h"
+#include "rimappatura.h"
+#include "supporto.h"
+#include "cache_unitari.h"
+#include "taratura.h"
+#include "memoria.h"
+#include "prefissi.h"
+#include "flusso.h"
+#include "archivio_operatori.h"
+#include "traccia.h"
+#include "parametri.h"
+#include "riduzione.h"
+
+
+/* Struttura che raccoglie le opzioni della riga di comando */
+typedef struct {
+    int numero_thread;           // QSIM_THREAD_AUTO con -t auto
+    const char* file_iniziale;
+    const char* file_circuito;
+    int profilo;                 // 1 se è stato richiesto --profile
+    const char* file_trace;      // File JSON per il trace (--profile=FILE), NULL se non richiesto
+    int contatori;               // 1 se è stato richiesto --perf
+    int numero_processi;         // Processi della simulazione distribuita (-p), 1 se non richiesta
+    const char* trasporto;       // Trasporto tra i processi (--trasporto), "shm" di default
+    int pipeline;                // 1 se è stato richiesto --pipeline
+    double tolleranza;           // Tolleranza relativa della fattorizzazione di Kronecker (--tolleranza), negativa se disattiva
+    int verboso;                 // 1 se è stato richiesto -v
+    const char* cache;           // Cartella della cache degli unitari fusi (--cache), NULL se non richiesta
+    long limite_cache;           // Dimensione massima della cache in MiB (--cache-max)
+    const char* file_taratura;   // File di taratura per -t auto (--taratura), NULL per quello di default
+    const char* file_varianti;   // File delle varianti del circuito (--varianti), NULL se non richieste
+    int buffer_varianti;         // Stati intermedi conservati al massimo tra le varianti (--buffer-varianti)
+    int flusso;                  // 1 se è stato richiesto --flusso (stati iniziali da stdin)
+    int stadi_flusso;            // Stadi della pipeline del flusso (--flusso=<stadi>), 0 per la scelta automatica
+    int operatori_condivisi;     // 1 se è stato richiesto --condividi-operatori
+    double verifica;             // Frazione delle istruzioni verificate (--verify), 0 se non richiesta
+    int piano;                   // 1 se è stato richiesto --plan (solo il piano di esecuzione, senza simulare)
+    const char* file_traccia;    // File binario degli stati intermedi (--trace), NULL se non richiesto
+    int traccia_ogni;            // Registra ogni k-esima istruzione (--trace-ogni), 0 se non indicato
+    const char* traccia_nomi;    // Operatori dopo cui registrare (--trace-operatori), NULL se non indicati
+    int traccia_comprimi;        // 1 se è stato richiesto --trace-comprimi
+    const char* file_parametri;  // Tabella dei valori dei parametri del circuito (--sweep), NULL se non richiesta
+    double riduzione;            // Tolleranza della riduzione algebrica del circuito (--peephole), negativa se non richiesta
+} opzioni_t;
+
+
+/* Funzione che stampa un messaggio in caso di errore che spiega come passare correttamente gli input all'eseguibile */
+static void stampa_uso(const char* nome_programma) {
+    fprintf(stderr, "Utilizzo corretto del programma:\n"
+                    "%s -t <numero_thread>|auto [--taratura=<file>] -i <file_iniziale> -c <file_circuito>\n"
+                    "    [--pipeline] [--tolleranza=<eps>] [--cache=<cartella> [--cache-max=<MiB>]]\n"
+                    "    [--varianti=<file> [--buffer-varianti=<n>]] [--flusso[=<stadi>]] [--condividi-operatori]\n"
+                    "    [--verify=<frazione>] [--plan]\n"
+                    "    [--trace=<file> [--trace-ogni=<k>] [--trace-operatori=<nomi>] [--trace-comprimi]]\n"
+                    "    [--sweep=<tabella>] [--peephole[=<eps>]] [-v] [-p <numero_processi> [--trasporto=shm|socket]]\n"
+                    "    [--profile[=<file_trace.json>]] [--perf]\n", nome_programma);
+}
+
+/* Analisi della riga di comando con getopt. Ritorna 0 se ok, -1 se errore */
+static int analisi_argomenti(int argc, char* argv[], opzioni_t* opt) {
+    if (!opt) return -1;
+
+    opt->numero_thread = -1;    // Variabile che conterrà il numero di thread da utilizzare
+    opt->file_iniziale = NULL;  // Puntatore che punterà il file che contiene lo stato iniziale
+    opt->file_circuito = NULL;  // Puntatole che punterà il file che contiene il circuito
+    opt->profilo = 0;           // Profilazione disattiva di default
+    opt->file_trace = NULL;     // Nessun file trace di default
+    opt->contatori = 0;         // Contatori hardware disattivi di default
+    opt->numero_processi = 1;   // Un solo processo di default
+    opt->trasporto = "shm";     // Memoria condivisa di default
+    opt->pipeline = 0;          // Caricamento completo prima dell'esecuzione di default
+    opt->tolleranza = TOLLERANZA_FATTORIZZAZIONE;   // Fattorizzazione solo dei prodotti esatti di default
+    opt->verboso = 0;           // Nessun riepilogo delle ottimizzazioni di default
+    opt->cache = NULL;          // Nessuna cache degli unitari di default
+    opt->limite_cache = LIMITE_CACHE_MIB;
+    opt->file_taratura = NULL;  // $HOME/.qsim_taratura di default
+    opt->file_varianti = NULL;  // Un solo circuito di default
+    opt->buffer_varianti = BUFFER_VARIANTI;
+    opt->flusso = 0;            // Un solo stato iniziale (#init) di default
+    opt->stadi_flusso = 0;
+    opt->operatori_condivisi = 0;   // Matrici degli operatori in memoria propria di default
+    opt->verifica = 0.0;        // Nessuna verifica dei kernel di default
+    opt->piano = 0;             // Simulazione completa di default
+    opt->file_traccia = NULL;   // Nessuna traccia degli stati intermedi di default
+    opt->traccia_ogni = 0;
+    opt->traccia_nomi = NULL;
+    opt->traccia_comprimi = 0;
+    opt->file_parametri = NULL; // Circuito senza parametri simbolici di default
+    opt->riduzione = -1.0;      // Circuito eseguito com'è scritto di default
+    int c;                      // Variabile che conterrà il valore del carattere 
+    unsigned char visto[UCHAR_MAX + 1] = {0};   // Opzioni già incontrate, indicizzate per carattere: un doppione è un errore
+
+    /* Opzioni lunghe: il valore restituito da getopt_long è il carattere indicato nell'ultimo campo */
+    static const struct option opzioni_lunghe[] = {
+        {"profile", optional_argument, NULL, 'P'},
+        {"perf", no_argument, NULL, 'H'},
+        {"trasporto", required_argument, NULL, 'T'},
+        {"pipeline", no_argument, NULL, 'L'},
+        {"tolleranza", required_argument, NULL, 'K'},
+        {"cache", required_argument, NULL, 'C'},
+        {"cache-max", required_argument, NULL, 'M'},
+        {"taratura", required_argument, NULL, 'A'},
+        {"varianti", required_argument, NULL, 'V'},
+        {"buffer-varianti", required_argument, NULL, 'B'},
+        {"flusso", optional_argument, NULL, 'F'},
+        {"condividi-operatori", no_argument, NULL, 'O'},
+        {"verify", required_argument, NULL, 'Y'},
+        {"plan", no_argument, NULL, 'N'},
+        {"trace", required_argument, NULL, 'R'},
+        {"trace-ogni", required_argument, NULL, 'E'},
+        {"trace-operatori", required_argument, NULL, 'D'},
+        {"trace-comprimi", no_argument, NULL, 'Z'},
+        {"sweep", required_argument, NULL, 'W'},
+        {"peephole", optional_argument, NULL, 'Q'},
+        {NULL, 0, NULL, 0}
+    };
+
+    /* Guarda dentro argv[] e trova la prossima opzione (tipo -t, -i, -c). Se l’opzione richiede un argomento 
+       (dopo la lettera c’è : nella stringa "t:i:c:"), getopt mette il relativo valore in optarg */
+    while ((c = getopt_long(argc, argv, "t:i:c:p:v", opzioni_lunghe, NULL)) != -1) {
+        
+        if (visto[(unsigned char)c]++) return -1;
+
+        switch (c) {
+            case 't': 
+                /* "auto": numero di thread, grana e kernel scelti dalla taratura */
+                opt->numero_thread = strcmp(optarg, "auto") == 0 ? QSIM_THREAD_AUTO : atoi(optarg);
+                if (opt->numero_thread == 0 && strcmp(optarg, "auto") != 0) opt->numero_thread = -1;
+                break;
+
+            case 'i': 
+                opt->file_iniziale = optarg; 
+                break;
+
+            case 'c': 
+                opt->file_circuito = optarg; 
+                break;
+
+            case 'P':
+                opt->profilo = 1;
+                opt->file_trace = optarg;   // NULL se scritto solo --profile
+                break;
+
+            case 'H':
+                opt->contatori = 1;
+                break;
+
+            case 'p':
+                opt->numero_processi = atoi(optarg);
+                break;
+
+            case 'T':
+                opt->trasporto = optarg;
+                break;
+
+            case 'L':
+                opt->pipeline = 1;
+                break;
+
+            case 'v':
+                opt->verboso = 1;
+                break;
+
+            case 'K': {
+                char* fine;
+                opt->tolleranza = strtod(optarg, &fine);
+                if (fine == optarg || *fine != '\0') return -1;
+                break;
+            }
+
+            case 'C':
+                opt->cache = optarg;
+                break;
+
+            case 'M': {
+                char* fine;
+                opt->limite_cache = strtol(optarg, &fine, 10);
+                if (fine == optarg || *fine != '\0' || opt->limite_cache <= 0) return -1;
+                break;
+            }
+
+            case 'A':
+                opt->file_taratura = optarg;
+                break;
+
+            case 'V':
+                opt->file_varianti = optarg;
+                break;
+
+            case 'B': {
+                char* fine;
+                long n = strtol(optarg, &fine, 10);
+                if (fine == optarg || *fine != '\0' || n < 0 || n > 1 << 20) return -1;
+                opt->buffer_varianti = (int)n;
+                break;
+            }
+
+            case 'F':
+                opt->flusso = 1;
+                if (optarg) {           // --flusso=<stadi>, altrimenti stadi scelti in base ai processori
+                    char* fine;
+                    long n = strtol(optarg, &fine, 10);
+                    if (fine == optarg || *fine != '\0' || n <= 0 || n > MAX_STADI_FLUSSO) return -1;
+                    opt->stadi_flusso = (int)n;
+                }
+                break;
+
+            case 'O':
+                opt->operatori_condivisi = 1;
+                break;
+
+            case 'Y': {
+                char* fine;
+                opt->verifica = strtod(optarg, &fine);
+                if (fine == optarg || *fine != '\0' || !(opt->verifica > 0.0 && opt->verifica <= 1.0)) return -1;
+                break;
+            }
+
+            case 'N':
+                opt->piano = 1;
+                break;
+
+            case 'R':
+                opt->file_traccia = optarg;
+                break;
+
+            case 'E': {
+                char* fine;
+                long n = strtol(optarg, &fine, 10);
+                if (fine == optarg || *fine != '\0' || n <= 0 || n > 1 << 30) return -1;
+                opt->traccia_ogni = (int)n;
+                break;
+            }
+
+            case 'D':
+                if (*optarg == '\0') return -1;
+                opt->traccia_nomi = optarg;
+                break;
+
+            case 'Z':
+                opt->traccia_comprimi = 1;
+                break;
+
+            case 'W':
+                opt->file_parametri = optarg;
+                break;
+
+            case 'Q':
+                opt->riduzione = TOLLERANZA_RIDUZIONE;
+                if (optarg) {           // --peephole=<eps>, altrimenti la tolleranza di default
+                    char* fine;
+                    opt->riduzione = strtod(optarg, &fine);
+                    if (fine == optarg || *fine != '\0' || !(opt->riduzione >= 0.0 && opt->riduzione < 1.0)) return -1;
+                }
+                break;
+
+            default: return -1;
+        }
+    }
+
+    /* Niente argomenti extra: se l’utente ha scritto argomenti “in più” non riconosciuti,
+       saranno in argv[optind]. (optind è l'indice del prossimo elemento in argv). */
+    if (optind < argc) return -1;
+
+    /* Presenza e validità minima. La compatibilità tra le opzioni del contesto è controllata
+       da qsim_verifica_opzioni, qui restano solo le opzioni proprie della riga di comando */
+    if (opt->numero_thread < 0) return -1;
+    if (visto['A'] && opt->numero_thread != QSIM_THREAD_AUTO && !opt->piano) return -1;     // --taratura ha senso solo con -t auto (o con --plan, per i tempi)
+    if (!opt->file_iniziale || !opt->file_circuito) return -1;
+    if (visto['M'] && !opt->cache) return -1;     // --cache-max ha senso solo con --cache
+    if (visto['B'] && !opt->file_varianti) return -1;     // --buffer-varianti ha senso solo con --varianti
+    if ((visto['E'] || visto['D'] || visto['Z']) && !opt->file_traccia) return -1;   // Le sotto-opzioni di --trace hanno senso solo con --trace
+
+    return 0;
+}
+
+/* Funzione principale per il calcolo del circuito quantistico: interfaccia a riga di comando sopra libqsim */
+int main(int argc, char* argv[]) {
+    int ret = 1;                              // Variabile che conterrà il valore di ritorno
+
+    opzioni_t opt;                            // Struttura che raccoglierà le opzioni della riga di comando 
+    qsim_contesto_t* ctx = NULL;              // Contesto della simulazione
+    double inizio_fase = 0.0;                 // Istante di inizio della fase corrente (solo con --profile)
+
+    /* Analisi degli argomenti */
+    if (analisi_argomenti(argc, argv, &opt) != 0) {
+        fprintf(stderr, "Errore: argomenti non validi\n");
+        stampa_uso(argv[0]);
+        goto cleanup;
+    }
+
+    qsim_opzioni_t opzioni;                   // Opzioni del contesto prese dalla riga di comando
+    qsim_opzioni_default(&opzioni);
+    opzioni.numero_thread = opt.numero_thread;
+    opzioni.numero_processi = opt.numero_processi;
+    opzioni.trasporto = opt.trasporto;
+    opzioni.pipeline = opt.pipeline;
+    opzioni.tolleranza = opt.tolleranza;
+    opzioni.contatori = opt.contatori;
+    opzioni.cache = opt.cache;
+    opzioni.limite_cache = opt.limite_cache;
+    opzioni.file_taratura = opt.file_taratura;
+    opzioni.file_varianti = opt.file_varianti;
+    opzioni.buffer_varianti = opt.buffer_varianti;
+    opzioni.flusso = opt.flusso;
+    opzioni.stadi_flusso = opt.stadi_flusso;
+    opzioni.operatori_condivisi = opt.operatori_condivisi;
+    opzioni.file_parametri = opt.file_parametri;
+    opzioni.riduzione = opt.riduzione;
+    opzioni.file_traccia = opt.file_traccia;
+    opzioni.traccia_ogni = opt.traccia_ogni;
+    opzioni.traccia_nomi = opt.traccia_nomi;
+    opzioni.traccia_comprimi = opt.traccia_comprimi;
+    opzioni.verifica = opt.verifica;
+
+    /* Stesso controllo di qsim_crea, fatto prima per distinguere gli argomenti incompatibili dagli errori del contesto */
+    if (qsim_verifica_opzioni(&opzioni, opt.piano, opt.profilo) != 0) {
+        fprintf(stderr, "Errore: argomenti non validi\n");
+        stampa_uso(argv[0]);
+        goto cleanup;
+    }
+
+    if (opt.profilo) profilo_attiva(opt.file_trace);    // Da qui in poi le fasi vengono misurate
+
+    ctx = qsim_crea(&opzioni);
+    if (!ctx) {
+        fprintf(stderr, "Errore: impossibile creare il contesto di simulazione\n");
+        goto cleanup;
+    }
+
+    /* Piano di esecuzione: solo i metadati dei file, nessuna simulazione */
+    if (opt.piano) {
+        if (qsim_pianifica(ctx, opt.file_iniziale, opt.file_circuito, stdout) != 0) {
+            fprintf(stderr, "Errore: file non leggibili o input non valido, verificare compatibilita' tra file\n");
+            goto cleanup;
+        }
+        fflush(stdout);
+        ret = 0;
+        goto cleanup;
+    }
+
+    /* Caricamento input */
+    inizio_fase = profilo_attivo ? profilo_adesso() : 0.0;
+    if (qsim_carica(ctx, opt.file_iniziale, opt.file_circuito) != 0) {
+        fprintf(stderr, "Errore: file non leggibili o input non valido, verificare compatibilita' tra file\n");
+        stampa_uso(argv[0]);
+        goto cleanup;
+    }
+    if (profilo_attivo) profilo_fase("caricamento", inizio_fase, profilo_adesso());
+
+    /* Pipeline, contatori, squadra di thread e traccia (i messaggi di errore specifici vengono stampati dalla libreria) */
+    if (qsim_compila(ctx) != 0) goto cleanup;
+
+    /* Varianti del circuito: tutte eseguite condividendo i prefissi, poi stampate nell'ordine del file */
+    if (opt.file_varianti) {
+        inizio_fase = profilo_attivo ? profilo_adesso() : 0.0;
+        if (qsim_esegui_varianti(ctx) != 0) {
+            fprintf(stderr, "Errore: esecuzione delle varianti del circuito fallita\n");
+            goto cleanup;
+        }
+        if (profilo_attivo) profilo_fase("esecuzione", inizio_fase, profilo_adesso());
+
+        inizio_fase = profilo_attivo ? profilo_adesso() : 0.0;
+        for (int k = 0; k < qsim_numero_varianti(ctx); k++) {
+            printf("\nStato finale (variante %d):\n", k + 1);
+            if (qsim_scrivi_variante(ctx, k, stdout) != 0) {
+                fprintf(stderr, "Errore: impossibile scrivere lo stato finale della variante %d\n", k + 1);
+                goto cleanup;
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+        if (profilo_attivo) profilo_fase("output", inizio_fase, profilo_adesso());
+        ret = 0;
+        goto cleanup;
+    }
+
+    /* Flusso di stati da stdin: ogni stato finale viene scritto appena pronto, nell'ordine di ingresso */
+    if (opt.flusso) {
+        inizio_fase = profilo_attivo ? profilo_adesso() : 0.0;
+        if (qsim_esegui_flusso(ctx, stdin, stdout, NULL) != 0) {
+            fprintf(stderr, "Errore: esecuzione del flusso di stati fallita\n");
+            goto cleanup;
+        }
+        if (profilo_attivo) profilo_fase("flusso", inizio_fase, profilo_adesso());
+        ret = 0;
+        goto cleanup;
+    }
+
+    /* Scansione dei parametri: ogni stato finale viene scritto appena il suo blocco di punti è pronto, nell'ordine della tabella */
+    if (opt.file_parametri) {
+        inizio_fase = profilo_attivo ? profilo_adesso() : 0.0;
+        if (qsim_esegui_parametri(ctx, stdout) != 0) {
+            fprintf(stderr, "Errore: esecuzione della scansione dei parametri fallita\n");
+            goto cleanup;
+        }
+        if (profilo_attivo) profilo_fase("scansione", inizio_fase, profilo_adesso());
+        ret = 0;
+        goto cleanup;
+    }
+
+    /* Esecuzione circuito */
+    inizio_fase = profilo_attivo ? profilo_adesso() : 0.0;
+    if (qsim_esegui(ctx) != 0) {
+        fprintf(stderr, opt.numero_processi > 1 ? "Errore: esecuzione distribuita del circuito fallita\n"
+                                                : "Errore: esecuzione circuito fallita\n");
+        goto cleanup;
+    }
+    if (profilo_attivo) profilo_fase("esecuzione", inizio_fase, profilo_adesso());
+
+    /* Stampa lo stato finale */
+    inizio_fase = profilo_attivo ? profilo_adesso() : 0.0;
+    printf("\nStato finale:\n");
+    if (qsim_scrivi_stato(ctx, stdout) != 0) {
+        fprintf(stderr, "Errore: impossibile scrivere lo stato finale\n");
+        goto cleanup;
+    }
+    printf("\n");
+    fflush(stdout);     // Il tempo di output include la scrittura effettiva
+    if (profilo_attivo) profilo_fase("output", inizio_fase, profilo_adesso());
+
+    ret = 0;
+
+cleanup:
+    /* Attende la scrittura delle ultime istantanee: una traccia incompleta è un errore */
+    if (ctx && qsim_chiudi_traccia(ctx) != 0 && ret == 0) {
+        fprintf(stderr, "Errore: scrittura della traccia %s non riuscita\n", opt.file_traccia);
+        ret = 1;
+    }
+
+    /* Riepilogo della rimappatura dei qubit e del supporto dello stato su stderr (solo con -v) */
+    if (opt.verboso && ret == 0 && !opt.piano) {
+        stampa_rimappatura(stderr);
+        stampa_supporto(stderr);
+        stampa_memoria(stderr);
+        stampa_archivio_operatori(stderr);
+        if (opt.cache) stampa_cache_unitari(stderr);
+        if (opt.numero_thread == QSIM_THREAD_AUTO) stampa_taratura(stderr);
+        if (opt.file_varianti) stampa_prefissi(stderr);
+        if (opt.flusso) stampa_flusso(stderr);
+        if (opt.file_traccia) stampa_traccia(stderr);
+        if (opt.file_parametri) stampa_parametri(stderr);
+        if (opt.riduzione >= 0.0) stampa_riduzione(stderr);
+    }
+
+    /* Riepilogo della verifica dei kernel su stderr (solo con --verify): uno scarto oltre la tolleranza è un errore */
+    if (opt.verifica > 0.0 && ret == 0 && qsim_stampa_verifica(ctx, stderr) > 0) {
+        fprintf(stderr, "Errore: risultati dei kernel diversi dal riferimento\n");
+        ret = 1;
+    }
+
+    /* Ferma caricamento e squadra, stampa il riepilogo dei contatori (solo con --perf) e libera la memoria */
+    qsim_distruggi(ctx);
+
+    /* Riepilogo della profilazione su stderr (solo con --profile) */
+    profilo_termina(stderr);
+
+    return ret;    
+}
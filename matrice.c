@@ -1,159 +1,261 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include "matrice.h"
-
-/*
- * Alloca dinamicamente una matrice quadrata di dimensione N x N
- * Parametri: dimensione → numero di righe/colonne
- * Ritorna: puntatore alla matrice allocata
- */
-matrice_t* crea_matrice(int dimensione) {
-    int i; 
-    /* Alloca dinamicamente memoria per una variabile di tipo matrice_t 
-       e assegna a m l’indirizzo di quella memoria */
-    matrice_t* m = (matrice_t*) malloc(sizeof(matrice_t)); 
-    if (m == NULL) {        
-        return NULL;
-    }
-
-    m->dimensione = dimensione;
-
-    /* Allocazione delle righe */
-    m->dati = (complesso_t**) malloc(dimensione * sizeof(complesso_t*));
-    if (m->dati == NULL) {
-        free(m); // Libera le righe allocate con successo prima di i
-        return NULL;
-    }
-
-    /* Allocazione delle colonne */
-    for (i = 0; i < dimensione; i++) {
-        m->dati[i] = (complesso_t*) malloc(dimensione * sizeof(complesso_t));
-        if (m->dati[i] == NULL) {
-            /* Deallocazione parziale in caso di errore */
-            for (int j = 0; j < i; j++) {
-                free(m->dati[j]);
-            }
-            free(m->dati); // Libera l'array dei puntatori alle righe
-            free(m);       // Libera la struttura m
-            return NULL;
-        }
-    }
-
-    return m;
-}
-
-/*
- * Dealloca tutta la memoria associata a una matrice
- * Parametri: m → matrice da deallocare
- */
-void distruggi_matrice(matrice_t* m) {
-    if (m == NULL) return;
-
-    for (int i = 0; i < m->dimensione; i++) {
-        free(m->dati[i]);   // Dealloca ogni i-esima riga
-    }
-
-    free(m->dati);  // Libera l'array dei puntatori alle righe
-    free(m);        // Libera la struttura m
-}
-
-/*
- * Moltiplicazione tra due matrici quadrate (implementazione sequenziale)
- * Parametri: a, b → matrici da moltiplicare (stessa dimensione)
- * Ritorna: nuova matrice risultato (a · b) 
- * Ogni elemento: risultato[i][j] = somma_{k=0..n-1} a[i][k] * b[k][j]
- */
-matrice_t* moltiplica_matrici(matrice_t* a, matrice_t* b) {
-    if (a == NULL || b == NULL) return NULL;
-    if (a->dimensione != b->dimensione) return NULL;
-
-    int n = a->dimensione;
-    matrice_t* risultato = crea_matrice(n); // Crea la matrice risultato (n x n) già allocata in memoria
-    if (risultato == NULL) return NULL;
-
-    for (int i = 0; i < n; i++) {   // Scorre tutte le celle (i,j) della matrice risultato
-        for (int j = 0; j < n; j++) {  
-            complesso_t somma = {0.0, 0.0, '\0'};  // Accumulatore della somma per la cella (i,j), inizializzato a 0 + 0i
-
-            for (int k = 0; k < n; k++) {  // Calcola il prodotto scalare tra riga i di 'a' e colonna j di 'b'
-                complesso_t prodotto = moltiplica_complessi(a->dati[i][k], b->dati[k][j]);
-                somma = somma_complessi(somma, prodotto);  // somma = somma + prodotto
-            }
-
-            risultato->dati[i][j] = somma;  // Scrive il valore finale calcolato nella cella (i,j) del risultato
-        }
-    }
-
-    return risultato;
-}
-
-
-/*
- * Moltiplicazione matrice × vettore
- * Parametri: m → matrice quadrata, v → vettore di numeri complessi
- * Ritorna: nuovo vettore risultato
- * Ogni elemento: risultato[i] = somma_{j=0..n-1} m[i][j] * v[j]
- */
-complesso_t* moltiplica_matrice_vettore(matrice_t* m, complesso_t* v) {
-    if (m == NULL || v == NULL) return NULL;
-
-    int n = m->dimensione;
-    /* Alloca dinamicamente memoria per un array di n elementi di tipo 
-       complesso_t e restituisce un puntatore al primo elemento */
-    complesso_t* risultato = (complesso_t*) malloc(n * sizeof(complesso_t));  
-                                                                            
-    for (int i = 0; i < n; i++) {
-        complesso_t somma = {0.0, 0.0, '\0'};  // Accumulatore della somma (parte reale, parte immaginaria)
-
-        for (int j = 0; j < n; j++) {
-            complesso_t prodotto = moltiplica_complessi(m->dati[i][j], v[j]);  // prodotto = m[i][j] * v[j] (moltiplicazione tra complessi)
-            somma = somma_complessi(somma, prodotto);  // somma += prodotto (accumula i contributi del prodotto scalare)
-        }
-
-        risultato[i] = somma;  // Scrive l'elemento i-esimo del vettore risultato
-    }
-
-    return risultato; 
-}
-
-/*
- * Stampa una matrice su stdout
- * Parametri: m → matrice quadrata da stampare
- */
-void stampa_matrice(matrice_t* m) {
-    if (m == NULL) return;
-
-    printf("[ ");
-    for (int i = 0; i < m->dimensione; i++) {   // Per ogni riga della matrice
-        printf("(");
-        for (int j = 0; j < m->dimensione; j++) {   // per ogni colonna della matrice
-            stampa_complesso(m->dati[i][j]);
-            if (j + 1 < m->dimensione) printf(",");
-            printf(" ");    
-        }
-        printf(")");
-        if (i + 1 < m->dimensione) printf("\n");
-    }
-    printf(" ]");
-}
-
-/*
- * Stampa un vettore su stdout
- * Parametri: 
- * v → vettore di numeri complessi da stampare
- * n → intero che ne indica la lunghezza
- */
-void stampa_vettore(complesso_t *v, int dimensione) {
-    if (v == NULL) return;
-
-    printf("[ (");
-
-    for (int i = 0; i < dimensione; i++) {  // Per ogni elemento del vettore
-        stampa_complesso(v[i]);
-        if (i < dimensione - 1) {
-            printf(", ");
-        }
-    }
-
-    printf(") ]\n");
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrice.h"
+#include "thread_matrice.h"
+
+#define ELEMENTI_PER_PEZZO 4096     // Elementi del vettore formattati da ogni pezzo di scrivi_vettore
+
+/*
+ * Alloca dinamicamente una matrice quadrata di dimensione N x N
+ * Parametri: dimensione → numero di righe/colonne
+ * Ritorna: puntatore alla matrice allocata
+ */
+matrice_t* crea_matrice(int dimensione) {
+    return crea_matrice_righe(dimensione, 0, dimensione);
+}
+
+/*
+ * Alloca una matrice N x N di cui sono presenti solo le righe [riga_inizio, riga_fine):
+ * le altre righe restano NULL.
+ * Parametri: dimensione → numero di righe/colonne, riga_inizio/riga_fine → righe da allocare
+ * Ritorna: puntatore alla matrice allocata, NULL in caso di errore
+ */
+matrice_t* crea_matrice_righe(int dimensione, int riga_inizio, int riga_fine) {
+    int i; 
+    /* Alloca dinamicamente memoria per una variabile di tipo matrice_t 
+       e assegna a m l’indirizzo di quella memoria */
+    matrice_t* m = (matrice_t*) malloc(sizeof(matrice_t)); 
+    if (m == NULL) {        
+        return NULL;
+    }
+
+    m->dimensione = dimensione;
+
+    /* Allocazione delle righe (azzerate: le righe non assegnate restano NULL) */
+    m->dati = (complesso_t**) calloc(dimensione, sizeof(complesso_t*));
+    if (m->dati == NULL) {
+        free(m); // Libera le righe allocate con successo prima di i
+        return NULL;
+    }
+
+    /* Allocazione delle colonne */
+    for (i = riga_inizio; i < riga_fine; i++) {
+        m->dati[i] = (complesso_t*) malloc(dimensione * sizeof(complesso_t));
+        if (m->dati[i] == NULL) {
+            /* Deallocazione parziale in caso di errore */
+            for (int j = riga_inizio; j < i; j++) {
+                free(m->dati[j]);
+            }
+            free(m->dati); // Libera l'array dei puntatori alle righe
+            free(m);       // Libera la struttura m
+            return NULL;
+        }
+    }
+
+    return m;
+}
+
+/*
+ * Dealloca tutta la memoria associata a una matrice
+ * Parametri: m → matrice da deallocare
+ */
+void distruggi_matrice(matrice_t* m) {
+    if (m == NULL) return;
+
+    for (int i = 0; i < m->dimensione; i++) {
+        free(m->dati[i]);   // Dealloca ogni i-esima riga (NULL se non allocata)
+    }
+
+    free(m->dati);  // Libera l'array dei puntatori alle righe
+    free(m);        // Libera la struttura m
+}
+
+/* Dati passati ai thread per la moltiplicazione tra matrici */
+typedef struct {
+    matrice_t* a;
+    matrice_t* b;
+    matrice_t* risultato;
+} lavoro_matrici_t;
+
+/* Funzione eseguita dalla squadra: calcola le righe [inizio, fine) del prodotto */
+static void moltiplica_righe(void* argomento, long inizio, long fine) {
+    const lavoro_matrici_t* lavoro = (const lavoro_matrici_t*)argomento;
+    matrice_t* a = lavoro->a;
+    matrice_t* b = lavoro->b;
+    int n = a->dimensione;
+
+    for (long i = inizio; i < fine; i++) {   // Scorre tutte le celle (i,j) delle righe assegnate
+        for (int j = 0; j < n; j++) {  
+            complesso_t somma = {0.0, 0.0, '\0'};  // Accumulatore della somma per la cella (i,j), inizializzato a 0 + 0i
+
+            for (int k = 0; k < n; k++) {  // Calcola il prodotto scalare tra riga i di 'a' e colonna j di 'b'
+                complesso_t prodotto = moltiplica_complessi(a->dati[i][k], b->dati[k][j]);
+                somma = somma_complessi(somma, prodotto);  // somma = somma + prodotto
+            }
+
+            lavoro->risultato->dati[i][j] = somma;  // Scrive il valore finale calcolato nella cella (i,j) del risultato
+        }
+    }
+}
+
+/*
+ * Moltiplicazione tra due matrici quadrate
+ * Parametri: a, b → matrici da moltiplicare (stessa dimensione)
+ * Ritorna: nuova matrice risultato (a · b) 
+ * Ogni elemento: risultato[i][j] = somma_{k=0..n-1} a[i][k] * b[k][j]
+ * Le righe del risultato sono indipendenti e vengono suddivise tra i thread della squadra corrente
+ * (nel thread chiamante se non c'è una squadra).
+ */
+matrice_t* moltiplica_matrici(matrice_t* a, matrice_t* b) {
+    if (a == NULL || b == NULL) return NULL;
+    if (a->dimensione != b->dimensione) return NULL;
+
+    int n = a->dimensione;
+    matrice_t* risultato = crea_matrice(n); // Crea la matrice risultato (n x n) già allocata in memoria
+    if (risultato == NULL) return NULL;
+
+    lavoro_matrici_t lavoro = {a, b, risultato};
+    if (esegui_in_parallelo(moltiplica_righe, &lavoro, n) != 0) {
+        distruggi_matrice(risultato);
+        return NULL;
+    }
+
+    return risultato;
+}
+
+
+/*
+ * Moltiplicazione matrice × vettore
+ * Parametri: m → matrice quadrata, v → vettore di numeri complessi
+ * Ritorna: nuovo vettore risultato
+ * Ogni elemento: risultato[i] = somma_{j=0..n-1} m[i][j] * v[j]
+ */
+complesso_t* moltiplica_matrice_vettore(matrice_t* m, complesso_t* v) {
+    if (m == NULL || v == NULL) return NULL;
+
+    int n = m->dimensione;
+    /* Alloca dinamicamente memoria per un array di n elementi di tipo 
+       complesso_t e restituisce un puntatore al primo elemento */
+    complesso_t* risultato = (complesso_t*) malloc(n * sizeof(complesso_t));  
+                                                                            
+    for (int i = 0; i < n; i++) {
+        complesso_t somma = {0.0, 0.0, '\0'};  // Accumulatore della somma (parte reale, parte immaginaria)
+
+        for (int j = 0; j < n; j++) {
+            complesso_t prodotto = moltiplica_complessi(m->dati[i][j], v[j]);  // prodotto = m[i][j] * v[j] (moltiplicazione tra complessi)
+            somma = somma_complessi(somma, prodotto);  // somma += prodotto (accumula i contributi del prodotto scalare)
+        }
+
+        risultato[i] = somma;  // Scrive l'elemento i-esimo del vettore risultato
+    }
+
+    return risultato; 
+}
+
+/*
+ * Stampa una matrice su stdout
+ * Parametri: m → matrice quadrata da stampare
+ */
+void stampa_matrice(matrice_t* m) {
+    if (m == NULL) return;
+
+    printf("[ ");
+    for (int i = 0; i < m->dimensione; i++) {   // Per ogni riga della matrice
+        printf("(");
+        for (int j = 0; j < m->dimensione; j++) {   // per ogni colonna della matrice
+            stampa_complesso(m->dati[i][j]);
+            if (j + 1 < m->dimensione) printf(",");
+            printf(" ");    
+        }
+        printf(")");
+        if (i + 1 < m->dimensione) printf("\n");
+    }
+    printf(" ]");
+}
+
+/*
+ * Stampa un vettore su stdout
+ * Parametri: 
+ * v → vettore di numeri complessi da stampare
+ * n → intero che ne indica la lunghezza
+ */
+void stampa_vettore(complesso_t *v, long dimensione) {
+    if (v == NULL) return;
+
+    printf("[ (");
+
+    for (long i = 0; i < dimensione; i++) {  // Per ogni elemento del vettore
+        stampa_complesso(v[i]);
+        if (i < dimensione - 1) {
+            printf(", ");
+        }
+    }
+
+    printf(") ]\n");
+}
+
+/* Dati passati ai thread per la formattazione di un vettore a pezzi */
+typedef struct {
+    const complesso_t* v;
+    long dimensione;
+    char** testi;               // Testo di ogni pezzo (NULL se l'allocazione è fallita)
+    size_t* lunghezze;          // Lunghezza del testo di ogni pezzo
+} lavoro_formattazione_t;
+
+/* Funzione eseguita dalla squadra: formatta i pezzi [inizio, fine), ognuno con il separatore dopo ogni elemento tranne l'ultimo del vettore */
+static void formatta_pezzi(void* argomento, long inizio, long fine) {
+    const lavoro_formattazione_t* lavoro = (const lavoro_formattazione_t*)argomento;
+
+    for (long p = inizio; p < fine; p++) {
+        long e0 = p * ELEMENTI_PER_PEZZO;
+        long e1 = e0 + ELEMENTI_PER_PEZZO < lavoro->dimensione ? e0 + ELEMENTI_PER_PEZZO : lavoro->dimensione;
+        size_t capacita = (e1 - e0) * 32, lunghezza = 0;
+        char* testo = (char*)malloc(capacita);
+
+        for (long i = e0; i < e1 && testo; i++) {
+            char numero[768];                   // Sufficiente anche per i double più grandi in formato %.5f
+            int n = formatta_complesso(numero, sizeof(numero), lavoro->v[i]);
+            if (n < 0 || (size_t)n >= sizeof(numero)) n = 0;
+            if (lunghezza + n + 2 > capacita) {
+                capacita = 2 * (lunghezza + n + 2);
+                char* nuovo = (char*)realloc(testo, capacita);
+                if (!nuovo) free(testo);
+                testo = nuovo;
+                if (!testo) break;
+            }
+            memcpy(testo + lunghezza, numero, n);
+            lunghezza += n;
+            if (i < lavoro->dimensione - 1) {
+                memcpy(testo + lunghezza, ", ", 2);
+                lunghezza += 2;
+            }
+        }
+        lavoro->testi[p] = testo;
+        lavoro->lunghezze[p] = lunghezza;
+    }
+}
+
+int scrivi_vettore(FILE* out, const complesso_t* v, long dimensione) {
+    if (out == NULL || v == NULL) return -1;
+
+    long pezzi = (dimensione + ELEMENTI_PER_PEZZO - 1) / ELEMENTI_PER_PEZZO;
+    char** testi = (char**)calloc(pezzi > 0 ? pezzi : 1, sizeof(char*));
+    size_t* lunghezze = (size_t*)calloc(pezzi > 0 ? pezzi : 1, sizeof(size_t));
+    lavoro_formattazione_t lavoro = {v, dimensione, testi, lunghezze};
+    int ret = 0;
+
+    if (!testi || !lunghezze || esegui_in_parallelo(formatta_pezzi, &lavoro, pezzi) != 0) ret = -1;
+
+    fprintf(out, "[ (");
+    for (long p = 0; p < pezzi && ret == 0; p++) {
+        if (!testi[p]) ret = -1;                // Memoria esaurita durante la formattazione
+        else if (fwrite(testi[p], 1, lunghezze[p], out) != lunghezze[p]) ret = -1;
+    }
+    fprintf(out, ") ]\n");
+
+    for (long p = 0; testi && p < pezzi; p++) free(testi[p]);
+    free(testi);
+    free(lunghezze);
+    return ret;
+}
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "memoria.h"
+
+#define FILE_MEMINFO "/proc/meminfo"
+#define FILE_MODALITA_THP "/sys/kernel/mm/transparent_hugepage/enabled"
+
+/* Statistiche delle allocazioni del thread chiamante (lette solo da stampa_memoria) */
+static __thread struct {
+    long piccoli;           // Vettori sotto la soglia delle pagine grandi
+    long grandi;            // Vettori segnalati con MADV_HUGEPAGE
+    long normali;           // Vettori sopra la soglia per cui madvise è fallita (pagine normali)
+    long byte_grandi;       // Byte segnalati con MADV_HUGEPAGE
+    long richiesti;         // Byte stimati dall'ultima verifica_memoria
+    long disponibili;       // Byte disponibili all'ultima verifica_memoria (-1 se non determinabile)
+} g_statistiche;
+
+
+complesso_t* alloca_stato(long dimensione, int azzera) {
+    if (dimensione <= 0) return NULL;
+    size_t byte = (size_t)dimensione * sizeof(complesso_t);
+
+    if (byte < (size_t)DIMENSIONE_PAGINA_GRANDE) {
+        g_statistiche.piccoli++;
+        return (complesso_t*)(azzera ? calloc(dimensione, sizeof(complesso_t)) : malloc(byte));
+    }
+
+    void* p = NULL;
+    if (posix_memalign(&p, DIMENSIONE_PAGINA_GRANDE, byte) != 0) return NULL;
+
+    /* Il consiglio va dato prima del primo accesso: le pagine toccate dopo vengono allocate grandi */
+    size_t coperti = byte & ~((size_t)DIMENSIONE_PAGINA_GRANDE - 1);    // Solo pagine grandi intere
+    if (madvise(p, coperti, MADV_HUGEPAGE) == 0) {
+        g_statistiche.grandi++;
+        g_statistiche.byte_grandi += coperti;
+    } else {
+        g_statistiche.normali++;                    // Kernel senza transparent huge page: pagine normali
+    }
+
+    if (azzera) memset(p, 0, byte);
+    return (complesso_t*)p;
+}
+
+long memoria_disponibile(void) {
+    FILE* f = fopen(FILE_MEMINFO, "r");
+    if (f) {
+        char riga[128];
+        long kib = -1;
+        while (fgets(riga, sizeof(riga), f)) {
+            if (sscanf(riga, "MemAvailable: %ld kB", &kib) == 1) break;
+        }
+        fclose(f);
+        if (kib >= 0) return kib * 1024;
+    }
+
+    long pagine = sysconf(_SC_AVPHYS_PAGES);        // Kernel senza MemAvailable: pagine fisiche libere
+    long pagina = sysconf(_SC_PAGESIZE);
+    return (pagine > 0 && pagina > 0) ? pagine * pagina : -1;
+}
+
+int verifica_memoria(int numero_qubit, int copie) {
+    if (numero_qubit <= 0 || numero_qubit > MAX_QUBIT_STATO) {
+        fprintf(stderr, "Errore: numero di qubit non valido (%d), deve essere tra 1 e %d\n", numero_qubit, MAX_QUBIT_STATO);
+        return -1;
+    }
+
+    long richiesti = copie * ((long)sizeof(complesso_t) << numero_qubit);
+    long disponibili = memoria_disponibile();
+    g_statistiche.richiesti = richiesti;
+    g_statistiche.disponibili = disponibili;
+
+    if (disponibili >= 0 && richiesti > disponibili) {
+        fprintf(stderr, "Errore: %d qubit richiedono %.1f MiB (%d vettori di stato), disponibili %.1f MiB\n",
+                numero_qubit, richiesti / 1048576.0, copie, disponibili / 1048576.0);
+        return -1;
+    }
+    return 0;
+}
+
+void stampa_memoria(FILE* out) {
+    fprintf(out, "\n=== Memoria dello stato ===\n");
+    if (g_statistiche.richiesti > 0) {
+        if (g_statistiche.disponibili >= 0) {
+            fprintf(out, "Stima per i vettori di stato: %.1f MiB su %.1f MiB disponibili\n",
+                    g_statistiche.richiesti / 1048576.0, g_statistiche.disponibili / 1048576.0);
+        } else {
+            fprintf(out, "Stima per i vettori di stato: %.1f MiB (memoria disponibile non determinabile)\n",
+                    g_statistiche.richiesti / 1048576.0);
+        }
+    }
+    fprintf(out, "Vettori con pagine grandi: %ld (%.1f MiB), con pagine normali: %ld, sotto la soglia di %ld KiB: %ld\n",
+            g_statistiche.grandi, g_statistiche.byte_grandi / 1048576.0, g_statistiche.normali,
+            DIMENSIONE_PAGINA_GRANDE / 1024, g_statistiche.piccoli);
+
+    /* Modalità del sistema: con "never" il consiglio viene accettato ma ignorato */
+    char modalita[128] = "";
+    FILE* f = fopen(FILE_MODALITA_THP, "r");
+    if (f) {
+        if (!fgets(modalita, sizeof(modalita), f)) modalita[0] = '\0';
+        fclose(f);
+        modalita[strcspn(modalita, "\n")] = '\0';
+    }
+    fprintf(out, "Transparent huge page del sistema: %s\n", modalita[0] ? modalita : "non disponibili");
+}
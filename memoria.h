@@ -0,0 +1,49 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stdio.h>
+#include "complesso.h"
+
+/* Qubit massimi di uno stato: oltre, la sola dimensione in byte di un vettore non sarebbe rappresentabile */
+#define MAX_QUBIT_STATO 50
+
+/* Dimensione di una pagina grande (transparent huge page su x86-64 e arm64 con pagine da 4 KiB) */
+#define DIMENSIONE_PAGINA_GRANDE (2L << 20)
+
+/* Vettori di stato presenti insieme durante l'esecuzione: stato iniziale e stato corrente con le sole porte,
+ * più il risultato di una moltiplicazione quando il circuito contiene matrici dense */
+#define COPIE_STATO_PORTE 2
+#define COPIE_STATO_DENSO 3
+
+/*
+ * Alloca un vettore di stato. I vettori di almeno DIMENSIONE_PAGINA_GRANDE byte vengono allineati alla
+ * pagina grande e segnalati al kernel con madvise(MADV_HUGEPAGE) prima del primo accesso, così le
+ * passate sullo stato usano meno voci del TLB; se il kernel non supporta le pagine grandi restano
+ * pagine normali. La memoria si libera con free().
+ * Parametri: dimensione → numero di ampiezze, azzera → 1 per un vettore inizializzato a zero
+ * Ritorna: puntatore al vettore, NULL in caso di errore di allocazione
+ */
+complesso_t* alloca_stato(long dimensione, int azzera);
+
+/*
+ * Ritorna la memoria disponibile in byte (MemAvailable di /proc/meminfo, altrimenti le pagine fisiche
+ * libere), -1 se non determinabile.
+ */
+long memoria_disponibile(void);
+
+/*
+ * Verifica prima di qualsiasi allocazione che copie vettori di stato di numero_qubit qubit stiano nella
+ * memoria disponibile, e che numero_qubit sia tra 1 e MAX_QUBIT_STATO. Stampa su stderr il motivo del rifiuto.
+ * Parametri: numero_qubit → qubit dello stato, copie → vettori presenti insieme (COPIE_STATO_*)
+ * Ritorna: 0 se tutto ok, -1 se lo stato non può essere simulato
+ */
+int verifica_memoria(int numero_qubit, int copie);
+
+/*
+ * Stampa il riepilogo delle allocazioni dei vettori di stato del thread chiamante (quanti con pagine
+ * grandi, quanti con pagine normali) e la modalità delle transparent huge page del sistema.
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_memoria(FILE* out);
+
+#endif
@@ -0,0 +1,261 @@
+#include <stdlib.h>
+#include <string.h>
+#include "parametri.h"
+#include "porte.h"
+#include "matrice.h"
+#include "memoria.h"
+#include "thread_matrice.h"
+#include "profilo.h"
+
+#define SEPARATORI_TABELLA " \t\r\n,"     // Separatori dei valori in una riga della tabella
+
+/* Riepilogo dell'ultima scansione (per thread, come quello delle varianti) */
+static __thread struct {
+    int punti;
+    int parametri;
+    int parametrici;        // Operatori ricostruiti per ogni punto
+    int operatori;          // Operatori in totale
+    int comuni;             // Istruzioni prima della prima parametrica, eseguite una volta sola
+    int istruzioni;         // Istruzioni del circuito
+    int paralleli;          // Punti eseguiti insieme al massimo
+    double tempo;           // Microsecondi dall'avvio all'ultimo stato scritto
+} g_statistiche;
+
+
+/* Funzione di supporto: indice del parametro con il nome indicato, -1 se il circuito non lo usa */
+static int indice_parametro(const dati_input_t* dati, const char* nome) {
+    for (int k = 0; k < dati->numero_parametri; k++) {
+        if (strcmp(dati->parametri[k], nome) == 0) return k;
+    }
+    return -1;
+}
+
+/* Funzione di supporto: 1 se la riga contiene solo spazi o un commento (#) */
+static int riga_vuota(const char* riga) {
+    riga += strspn(riga, SEPARATORI_TABELLA);
+    return *riga == '\0' || *riga == '#';
+}
+
+int leggi_tabella_parametri(const char* nome_file, const dati_input_t* dati, double** valori, int* numero_punti) {
+    if (!nome_file || !dati || !valori || !numero_punti) return -1;
+    *valori = NULL;
+    *numero_punti = 0;
+
+    FILE* file = fopen(nome_file, "r");
+    if (!file) {
+        perror(nome_file);
+        return -1;
+    }
+
+    int ret = -1;
+    char* riga = NULL;
+    size_t capacita_riga = 0;
+    int* colonne = NULL;            // Per ogni colonna della tabella, l'indice del parametro
+    int numero_colonne = 0;
+    double* tabella = NULL;
+    int punti = 0, capacita = 0;
+    int numero_riga = 0;
+
+    /* Intestazione: i nomi dei parametri, ognuno una sola volta, tutti usati dal circuito */
+    while (getline(&riga, &capacita_riga, file) != -1) {
+        numero_riga++;
+        if (riga_vuota(riga)) continue;
+        colonne = (int*)malloc((strlen(riga) / 2 + 1) * sizeof(int));
+        if (!colonne) goto fine;
+        for (char* nome = strtok(riga, SEPARATORI_TABELLA); nome; nome = strtok(NULL, SEPARATORI_TABELLA)) {
+            int k = indice_parametro(dati, nome);
+            if (k < 0) {
+                fprintf(stderr, "%s: il parametro %s non compare nel circuito\n", nome_file, nome);
+                goto fine;
+            }
+            for (int c = 0; c < numero_colonne; c++) {
+                if (colonne[c] == k) {
+                    fprintf(stderr, "%s: parametro %s ripetuto nell'intestazione\n", nome_file, nome);
+                    goto fine;
+                }
+            }
+            colonne[numero_colonne++] = k;
+        }
+        break;
+    }
+    if (numero_colonne != dati->numero_parametri) {     // Ogni parametro del circuito deve avere un valore
+        for (int k = 0; k < dati->numero_parametri && numero_colonne > 0; k++) {
+            int presente = 0;
+            for (int c = 0; c < numero_colonne; c++) presente |= colonne[c] == k;
+            if (!presente) fprintf(stderr, "%s: manca il parametro %s nell'intestazione\n", nome_file, dati->parametri[k]);
+        }
+        if (numero_colonne == 0) fprintf(stderr, "%s: manca l'intestazione con i nomi dei parametri\n", nome_file);
+        goto fine;
+    }
+
+    /* Un punto per riga */
+    while (getline(&riga, &capacita_riga, file) != -1) {
+        numero_riga++;
+        if (riga_vuota(riga)) continue;
+        if (punti == capacita) {
+            capacita = capacita ? 2 * capacita : 64;
+            double* tmp = (double*)realloc(tabella, (size_t)capacita * numero_colonne * sizeof(double));
+            if (!tmp) goto fine;
+            tabella = tmp;
+        }
+
+        int c = 0;
+        for (char* testo = strtok(riga, SEPARATORI_TABELLA); testo; testo = strtok(NULL, SEPARATORI_TABELLA), c++) {
+            double valore;
+            if (c >= numero_colonne || leggi_angolo(testo, &valore) != 0) {
+                c = -1;
+                break;
+            }
+            tabella[(size_t)punti * numero_colonne + colonne[c]] = valore;
+        }
+        if (c != numero_colonne) {
+            fprintf(stderr, "%s, riga %d: attesi %d valori validi\n", nome_file, numero_riga, numero_colonne);
+            goto fine;
+        }
+        punti++;
+    }
+    if (punti == 0) {
+        fprintf(stderr, "%s: nessun punto nella tabella\n", nome_file);
+        goto fine;
+    }
+
+    *valori = tabella;
+    *numero_punti = punti;
+    tabella = NULL;
+    ret = 0;
+
+fine:
+    free(tabella);
+    free(colonne);
+    free(riga);
+    fclose(file);
+    return ret;
+}
+
+
+/* Dati condivisi dai thread che eseguono i punti di un blocco */
+typedef struct {
+    const dati_input_t* dati;
+    const double* valori;
+    int primo;                      // Primo punto del blocco
+    int inizio;                     // Prima istruzione parametrica: le precedenti sono già in iniziale
+    const complesso_t* iniziale;
+    complesso_t** finali;           // Stati finali dei punti del blocco
+    esegui_punto_t esegui;
+    void* argomento;
+    int errore;                     // 1 se un punto è fallito (aggiornato con operazioni atomiche)
+} lavoro_parametri_t;
+
+/*
+ * Funzione eseguita dalla squadra: esegue i punti [inizio, fine) del blocco. Gli operatori del punto sono una
+ * copia di quelli fissi (stesse matrici e porte) in cui le porte parametriche puntano a copie con i coefficienti
+ * del punto.
+ */
+static void esegui_punti(void* argomento, long inizio, long fine) {
+    lavoro_parametri_t* l = (lavoro_parametri_t*)argomento;
+    const dati_input_t* dati = l->dati;
+
+    operatore_quantistico_t* operatori = (operatore_quantistico_t*)malloc(dati->numero_operatori * sizeof(operatore_quantistico_t));
+    porta_t* porte = (porta_t*)malloc(dati->numero_parametrici * sizeof(porta_t));
+    if (!operatori || !porte) {
+        __atomic_store_n(&l->errore, 1, __ATOMIC_RELAXED);
+        inizio = fine;
+    }
+
+    for (long k = inizio; k < fine && !__atomic_load_n(&l->errore, __ATOMIC_RELAXED); k++) {
+        const double* punto = l->valori + (size_t)(l->primo + k) * dati->numero_parametri;
+        memcpy(operatori, dati->operatori, dati->numero_operatori * sizeof(operatore_quantistico_t));
+
+        int esito = 0;
+        for (int j = 0; j < dati->numero_parametrici && esito == 0; j++) {
+            const operatore_parametrico_t* p = &dati->parametrici[j];
+            porte[j] = *dati->operatori[p->operatore].porte;       // Struttura della porta già calcolata
+            esito = imposta_angolo_porta(&porte[j], p->porta, p->coefficiente * punto[p->parametro]);
+            operatori[p->operatore].porte = &porte[j];
+        }
+        if (esito == 0) esito = l->esegui(l->argomento, operatori, l->inizio, dati->numero_istruzioni, l->iniziale, &l->finali[k]);
+        if (esito != 0) {
+            l->finali[k] = NULL;
+            __atomic_store_n(&l->errore, 1, __ATOMIC_RELAXED);
+        }
+    }
+    free(operatori);
+    free(porte);
+}
+
+/* Funzione di supporto: indice della prima istruzione che usa un operatore parametrico, numero_istruzioni se nessuna */
+static int prima_parametrica(const dati_input_t* dati) {
+    for (int i = 0; i < dati->numero_istruzioni; i++) {
+        operatore_quantistico_t* op = trova_operatore((dati_input_t*)dati, dati->circuito[i].nome_operatore);
+        for (int j = 0; op && j < dati->numero_parametrici; j++) {
+            if (op == &dati->operatori[dati->parametrici[j].operatore]) return i;
+        }
+    }
+    return dati->numero_istruzioni;
+}
+
+int esegui_parametri(const dati_input_t* dati, const double* valori, int numero_punti, const complesso_t* iniziale,
+                     long dimensione, int paralleli, esegui_punto_t esegui, void* argomento, FILE* uscita) {
+    if (!dati || !valori || numero_punti <= 0 || !iniziale || dimensione <= 0 || paralleli <= 0 || !esegui || !uscita) return -1;
+
+    /* Punti in parallelo: ognuno tiene fino a COPIE_STATO_DENSO vettori, oltre allo stato iniziale e a quello comune */
+    long disponibile = memoria_disponibile();
+    if (disponibile > 0) {
+        long massimo = (disponibile / (dimensione * (long)sizeof(complesso_t)) - 2) / COPIE_STATO_DENSO;
+        if (massimo < paralleli) paralleli = massimo > 1 ? (int)massimo : 1;
+    }
+    if (paralleli > numero_punti) paralleli = numero_punti;
+
+    memset(&g_statistiche, 0, sizeof(g_statistiche));
+    g_statistiche.parametri = dati->numero_parametri;
+    g_statistiche.parametrici = dati->numero_parametrici;
+    g_statistiche.operatori = dati->numero_operatori;
+    g_statistiche.istruzioni = dati->numero_istruzioni;
+    g_statistiche.paralleli = paralleli;
+    double avvio = profilo_adesso();
+
+    /* Le istruzioni prima della prima parametrica sono uguali per tutti i punti: eseguite una volta sola */
+    int primo = prima_parametrica(dati);
+    complesso_t* comune = (complesso_t*)iniziale;
+    if (primo > 0 && esegui(argomento, dati->operatori, 0, primo, iniziale, &comune) != 0) return -1;
+    g_statistiche.comuni = primo;
+
+    int ret = 0;
+    complesso_t** finali = (complesso_t**)calloc(paralleli, sizeof(complesso_t*));
+    if (!finali) ret = -1;
+
+    /* Blocchi di paralleli punti: eseguiti insieme, poi scritti nell'ordine della tabella e liberati */
+    for (int p = 0; ret == 0 && p < numero_punti; p += paralleli) {
+        int numero = numero_punti - p < paralleli ? numero_punti - p : paralleli;
+        lavoro_parametri_t lavoro = {dati, valori, p, primo, comune, finali, esegui, argomento, 0};
+        if (esegui_elementi_in_parallelo(esegui_punti, &lavoro, numero) != 0 || lavoro.errore) ret = -1;
+
+        for (int k = 0; k < numero; k++) {
+            if (ret == 0) {
+                fprintf(uscita, "\nStato finale (punto %d):\n", p + k + 1);
+                if (scrivi_vettore(uscita, finali[k], dimensione) != 0 || fprintf(uscita, "\n") < 0 || fflush(uscita) != 0) ret = -1;
+                else g_statistiche.punti++;
+            }
+            if (finali[k] != comune) free(finali[k]);
+            finali[k] = NULL;
+        }
+    }
+
+    g_statistiche.tempo = profilo_adesso() - avvio;
+    free(finali);
+    if (comune != iniziale) free(comune);
+    return ret;
+}
+
+void stampa_parametri(FILE* out) {
+    fprintf(out, "\n=== Scansione dei parametri ===\n");
+    if (g_statistiche.punti == 0) {
+        fprintf(out, "Nessuna scansione eseguita\n");
+        return;
+    }
+    double secondi = g_statistiche.tempo / 1e6;
+    fprintf(out, "Punti: %d in %.3f s (%.1f punti/s), parametri: %d, punti in parallelo: %d\n", g_statistiche.punti,
+            secondi, secondi > 0 ? g_statistiche.punti / secondi : 0.0, g_statistiche.parametri, g_statistiche.paralleli);
+    fprintf(out, "Operatori ricostruiti per punto: %d su %d, istruzioni comuni eseguite una volta: %d su %d\n",
+            g_statistiche.parametrici, g_statistiche.operatori, g_statistiche.comuni, g_statistiche.istruzioni);
+}
@@ -0,0 +1,67 @@
+#ifndef PARAMETRI_H
+#define PARAMETRI_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+
+/*
+ * Scansione dei parametri di un circuito parametrico (--sweep). Il circuito usa porte predefinite con
+ * parametri simbolici (es. "RX(theta) 0", "CPHASE(-2*gamma) 1 2", lettore_input.h); la tabella dei valori ha
+ * una riga di intestazione con i nomi dei parametri e poi un punto per riga:
+ *
+ *   # commento
+ *   theta gamma
+ *   0.1   pi/4
+ *   0.2   -pi/8
+ *
+ * (valori separati da spazi o virgole, nelle forme degli angoli delle porte). Tutto ciò che non dipende dai
+ * parametri viene preparato una volta sola: matrici lette, deduplicate, fattorizzate e fuse, porte fisse e
+ * struttura delle porte parametriche (tipo, qubit, offset), più lo stato dopo le istruzioni che precedono la
+ * prima istruzione parametrica. Per ogni punto vengono ricalcolati solo i coefficienti delle porte
+ * parametriche, in una copia degli operatori del punto, e il punto viene eseguito per intero da un thread
+ * della squadra: i kernel al suo interno usano la stessa squadra con chiamate annidate.
+ */
+
+/*
+ * Esegue le istruzioni [inizio, fine) del circuito a partire da uno stato, senza modificarlo.
+ * Parametri: argomento → dato del chiamante, operatori → operatori da usare (stesso ordine di dati->operatori),
+ * inizio, fine → istruzioni da eseguire, iniziale → stato di partenza, finale → nuovo vettore con lo stato al
+ * termine (liberato con free; può coincidere con iniziale se fine == inizio)
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+typedef int (*esegui_punto_t)(void* argomento, operatore_quantistico_t* operatori, int inizio, int fine,
+                              const complesso_t* iniziale, complesso_t** finale);
+
+/*
+ * Legge la tabella dei valori dei parametri.
+ * Parametri:
+ * nome_file → file della tabella, dati → circuito con i parametri (dati->parametri)
+ * valori → valorizzato con un array di numero_punti * dati->numero_parametri valori (liberato con free),
+ * i valori di ogni punto nell'ordine di dati->parametri
+ * numero_punti → valorizzato con il numero di punti
+ * Ritorna: 0 se tutto ok, -1 in caso di errore (file non leggibile, parametro assente o sconosciuto
+ * nell'intestazione, riga con un numero di valori diverso, valore non valido, nessun punto)
+ */
+int leggi_tabella_parametri(const char* nome_file, const dati_input_t* dati, double** valori, int* numero_punti);
+
+/*
+ * Esegue il circuito per ogni punto della tabella, con i punti divisi tra i thread della squadra corrente
+ * (al massimo paralleli insieme, ridotti se gli stati non stanno in memoria), e scrive su uscita lo stato
+ * finale di ogni punto nell'ordine della tabella, preceduto da "Stato finale (punto k):".
+ * Parametri:
+ * dati → circuito con gli operatori fissi e parametrici, valori, numero_punti → tabella (leggi_tabella_parametri)
+ * iniziale → stato iniziale, dimensione → sua lunghezza, paralleli → punti eseguiti insieme al massimo
+ * esegui → funzione che esegue un tratto di istruzioni, argomento → passato a esegui
+ * Ritorna: 0 se tutto ok, -1 in caso di errore (gli stati finali già scritti restano su uscita)
+ */
+int esegui_parametri(const dati_input_t* dati, const double* valori, int numero_punti, const complesso_t* iniziale,
+                     long dimensione, int paralleli, esegui_punto_t esegui, void* argomento, FILE* uscita);
+
+/*
+ * Stampa il riepilogo dell'ultima scansione del thread chiamante: punti e parametri, operatori ricostruiti
+ * per punto, istruzioni comuni eseguite una volta sola, punti in parallelo e punti al secondo.
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_parametri(FILE* out);
+
+#endif
@@ -0,0 +1,225 @@
+#include <stdlib.h>
+#include <string.h>
+#include "piano.h"
+#include "memoria.h"
+#include "supporto.h"
+
+#define MIB (1024.0 * 1024.0)
+
+/* Costo stimato di un passo dell'esecuzione (un'istruzione densa, un tratto fuso o una sequenza di porte) */
+typedef struct {
+    double flop;
+    double byte;
+    double tempo;       // us, negativo se la taratura non ha il tempo di questo kernel
+} costo_t;
+
+/* Funzione di supporto: flop di una porta applicata a uno stato di dimensione ampiezze (6 per il prodotto
+ * complesso, 8 con la somma; solo le ampiezze con tutti i controlli a 1 vengono toccate) */
+static double flop_porta(const porta_t* p, long dimensione) {
+    double ampiezze = (double)(dimensione >> p->numero_controlli);
+    if (p->tipo == PORTA_LOCALE) return 8.0 * (1 << p->numero_bersagli) * ampiezze;
+    return 6.0 * ampiezze;      // Diagonale o permutazione: una fase per ampiezza
+}
+
+/* Funzione di supporto: scrive in testo una quantità di byte con l'unità più adatta */
+static const char* testo_byte(double byte, char* testo, size_t n) {
+    static const char* unita[] = {"KiB", "MiB", "GiB", "TiB", "PiB"};
+    double valore = byte / 1024.0;
+    int u = 0;
+    while (valore >= 1024.0 && u < 4) {
+        valore /= 1024.0;
+        u++;
+    }
+    snprintf(testo, n, "%.1f %s", valore, unita[u]);
+    return testo;
+}
+
+/* Funzione di supporto: nome della forma interna di una porta */
+static const char* nome_porta(const porta_t* p) {
+    switch (p->tipo) {
+        case PORTA_LOCALE: return "porta locale";
+        case PORTA_DIAGONALE: return "porta diagonale";
+        default: return "porta permutazione";
+    }
+}
+
+/* Funzione di supporto: scrive una riga della tabella, con i costi solo sulla prima istruzione del passo */
+static void scrivi_riga(FILE* out, int i, const char* nome, const char* kernel, const char* fusione, const char* forma,
+                        int thread, const costo_t* costo) {
+    fprintf(out, "%5d  %-24s %-9s %-18s %-24s %6d", i + 1, nome, kernel, fusione, forma, thread);
+    if (!costo) {
+        fprintf(out, " %12s %12s %12s\n", "-", "-", "-");
+        return;
+    }
+    fprintf(out, " %12.4g %12.4g", costo->flop / 1e6, costo->byte / MIB);
+    if (costo->tempo >= 0.0) fprintf(out, " %12.4g\n", costo->tempo / 1000.0);
+    else fprintf(out, " %12s\n", "?");
+}
+
+int scrivi_piano(const dati_input_t* dati, const configurazione_piano_t* c, FILE* out) {
+    if (!dati || !c || !out || dati->numero_qubit <= 0) return -1;
+
+    const long dimensione = 1L << dati->numero_qubit;
+    const double byte_matrice = (double)dimensione * dimensione * sizeof(complesso_t);
+    const double byte_stato = (double)dimensione * sizeof(complesso_t);
+    const int thread = c->kernel_piccoli ? 1 : c->numero_thread;
+    int ret = -1;
+
+    const porta_t** sequenza = NULL;   // Porte di una sequenza, per contarne le passate
+    char* usato = NULL;                 // Matrici usate dal circuito (le sole lette con la pipeline)
+
+    /* Ogni istruzione deve avere un operatore; le porte del circuito danno la lunghezza massima di una sequenza */
+    long porte_circuito = 0;
+    for (int i = 0; i < dati->numero_istruzioni; i++) {
+        operatore_quantistico_t* op = trova_operatore((dati_input_t*)dati, dati->circuito[i].nome_operatore);
+        if (!op) {
+            fprintf(stderr, "Operatore %s non definito\n", dati->circuito[i].nome_operatore);
+            return -1;
+        }
+        if (op->porte) porte_circuito += op->numero_porte;
+    }
+    sequenza = (const porta_t**)malloc((porte_circuito + 1) * sizeof(const porta_t*));
+    usato = (char*)calloc(dati->numero_operatori + 1, 1);
+    if (!sequenza || !usato) goto fine;
+
+    /* Operatori: matrici dense registrate dall'indice e porte predefinite già costruite */
+    int matrici = 0, operatori_porte = 0;
+    double byte_porte = 0.0;
+    for (int k = 0; k < dati->numero_operatori; k++) {
+        const operatore_quantistico_t* op = &dati->operatori[k];
+        if (op->porte) {
+            operatori_porte++;
+            byte_porte += op->numero_porte * sizeof(porta_t);
+        } else {
+            matrici++;
+        }
+    }
+
+    char testo[5][32];
+    fprintf(out, "\n=== Piano di esecuzione ===\n");
+    fprintf(out, "Circuito: %d qubit (%ld ampiezze), %d istruzioni, %d operatori (%d matrici dense", dati->numero_qubit,
+            dimensione, dati->numero_istruzioni, dati->numero_operatori, matrici);
+    if (matrici > 0) fprintf(out, " da %s", testo_byte(byte_matrice, testo[0], sizeof(testo[0])));
+    fprintf(out, ", %d porte predefinite)\n", operatori_porte);
+    if (c->kernel_piccoli) fprintf(out, "Configurazione: kernel specializzati, 1 thread senza squadra");
+    else if (c->grana > 0) fprintf(out, "Configurazione: %d thread, pezzi di %ld elementi", c->numero_thread, c->grana);
+    else fprintf(out, "Configurazione: %d thread, una parte fissa per thread", c->numero_thread);
+    fprintf(out, "%s\n", c->configurazione_tarata ? " (dalla taratura)" : "");
+    if (matrici > 0) fprintf(out, "Matrici: %s%s%s\n", c->pipeline ? "lette durante l'esecuzione (pipeline)" : "lette prima dell'esecuzione",
+            c->operatori_condivisi ? ", in memoria condivisa tra processi" : "",
+            c->fattorizzazione ? ", fattorizzate in porte se prodotti di Kronecker (non noto senza leggerle: contate come dense)" : "");
+    if (matrici > 0 && !c->kernel_piccoli) {
+        fprintf(out, "Le moltiplicazioni dense usano il kernel del supporto finché lo stato ha al massimo 1/%d di ampiezze non nulle (dipende da #init)\n",
+                FRAZIONE_SUPPORTO);
+    }
+
+    fprintf(out, "\n%5s  %-24s %-9s %-18s %-24s %6s %12s %12s %12s\n", "#", "istruzione", "kernel", "fusione", "forma",
+            "thread", "MFLOP", "MiB spostati", "tempo (ms)");
+
+    costo_t totale = {0.0, 0.0, 0.0};
+    int tempo_mancante = 0, tratti_fusi = 0, dense_presenti = 0;
+    char fusione[48];
+
+    for (int i = 0; i < dati->numero_istruzioni; ) {
+        operatore_quantistico_t* op = trova_operatore((dati_input_t*)dati, dati->circuito[i].nome_operatore);
+        costo_t costo = {0.0, 0.0, 0.0};
+
+        if (op->porte) {
+            /* Porte: con la squadra le istruzioni consecutive formate da porte sono una sola sequenza
+             * (esegui_porte_consecutive), con i kernel specializzati ogni istruzione è applicata da sola */
+            int fine_sequenza = i, numero = 0;
+            operatore_quantistico_t* corrente = op;
+            while (corrente && corrente->porte && (fine_sequenza == i || !c->kernel_piccoli)) {
+                for (int k = 0; k < corrente->numero_porte; k++) {
+                    sequenza[numero++] = &corrente->porte[k];
+                    costo.flop += flop_porta(&corrente->porte[k], dimensione);
+                }
+                fine_sequenza++;
+                corrente = fine_sequenza < dati->numero_istruzioni
+                         ? trova_operatore((dati_input_t*)dati, dati->circuito[fine_sequenza].nome_operatore) : NULL;
+            }
+            int passate = passate_sequenza_porte(sequenza, numero, dati->numero_qubit);
+            costo.byte = 2.0 * passate * byte_stato;                    // Lettura e scrittura dello stato a ogni passata
+            costo.tempo = c->tempo_porta > 0.0 ? c->tempo_porta * passate : -1.0;
+
+            if (fine_sequenza - i > 1) snprintf(fusione, sizeof(fusione), "seq. %d-%d (%d p.)", i + 1, fine_sequenza, passate);
+            else snprintf(fusione, sizeof(fusione), passate == 1 ? "%d passata" : "%d passate", passate);
+            for (int k = i; k < fine_sequenza; k++) {
+                operatore_quantistico_t* o = trova_operatore((dati_input_t*)dati, dati->circuito[k].nome_operatore);
+                const char* forma = o->numero_porte == 1 ? nome_porta(&o->porte[0]) : "porte (fattorizzata)";
+                scrivi_riga(out, k, dati->circuito[k].nome_operatore, "porte", fusione, forma, thread, k == i ? &costo : NULL);
+            }
+            i = fine_sequenza;
+        } else {
+            /* Matrice densa: con la cache i tratti di almeno due istruzioni dense consecutive sono un solo unitario */
+            int passo = 1;
+            if (c->cache && !c->pipeline && !c->kernel_piccoli) {
+                while (i + passo < dati->numero_istruzioni) {
+                    operatore_quantistico_t* o = trova_operatore((dati_input_t*)dati, dati->circuito[i + passo].nome_operatore);
+                    if (!o || o->porte) break;
+                    passo++;
+                }
+            }
+            dense_presenti = 1;
+            costo.flop = 8.0 * dimensione * dimensione;
+            costo.byte = byte_matrice + 2.0 * byte_stato;
+            costo.tempo = c->tempo_denso > 0.0 ? c->tempo_denso : -1.0;
+
+            const char* kernel = c->kernel_piccoli ? "piccolo" : (passo > 1 ? "fuso" : "denso");
+            if (passo > 1) {
+                tratti_fusi++;
+                snprintf(fusione, sizeof(fusione), "tratto %d-%d", i + 1, i + passo);
+            } else {
+                snprintf(fusione, sizeof(fusione), "-");
+            }
+            for (int k = i; k < i + passo; k++) {
+                operatore_quantistico_t* o = trova_operatore((dati_input_t*)dati, dati->circuito[k].nome_operatore);
+                usato[o - dati->operatori] = 1;
+                const char* forma = passo > 1 ? "unitario fuso (cache)"
+                                  : c->pipeline ? "densa, letta in pipeline"
+                                  : c->operatori_condivisi ? "densa, condivisa" : "densa";
+                scrivi_riga(out, k, dati->circuito[k].nome_operatore, kernel, fusione, forma, thread, k == i ? &costo : NULL);
+            }
+            i += passo;
+        }
+
+        totale.flop += costo.flop;
+        totale.byte += costo.byte;
+        if (costo.tempo >= 0.0) totale.tempo += costo.tempo;
+        else tempo_mancante = 1;
+    }
+
+    fprintf(out, "\nTotale: %.4g GFLOP, %s spostati, intensità %.2f flop/byte\n", totale.flop / 1e9,
+            testo_byte(totale.byte, testo[0], sizeof(testo[0])), totale.byte > 0.0 ? totale.flop / totale.byte : 0.0);
+    if (c->dimensione_tarata == 0) {
+        fprintf(out, "Tempo stimato: non disponibile (nessuna taratura con i tempi per questo host: eseguire una volta con -t auto)\n");
+    } else {
+        fprintf(out, "Tempo stimato: %s%.4g ms (tempi misurati dalla taratura alla dimensione %ld%s)\n",
+                tempo_mancante ? "almeno " : "", totale.tempo / 1000.0, c->dimensione_tarata,
+                c->dimensione_tarata != dimensione ? ", scalati" : "");
+    }
+
+    /* Memoria di picco: vettori di stato, matrici residenti (tutte quelle dei #define, o solo quelle usate con la
+     * pipeline, che le tiene dopo averle lette), unitari fusi e porte */
+    int residenti = 0;
+    for (int k = 0; k < dati->numero_operatori; k++) {
+        if (!dati->operatori[k].porte && (!c->pipeline || usato[k])) residenti++;
+    }
+    double memoria_stato = (dense_presenti ? COPIE_STATO_DENSO : COPIE_STATO_PORTE) * byte_stato;
+    double memoria_matrici = residenti * byte_matrice, memoria_fusi = tratti_fusi * byte_matrice;
+    double picco = memoria_stato + memoria_matrici + memoria_fusi + byte_porte;
+    fprintf(out, "Memoria di picco stimata: %s (stato %s, matrici %s, unitari fusi %s, porte %s)\n",
+            testo_byte(picco, testo[0], sizeof(testo[0])), testo_byte(memoria_stato, testo[1], sizeof(testo[1])),
+            testo_byte(memoria_matrici, testo[2], sizeof(testo[2])), testo_byte(memoria_fusi, testo[3], sizeof(testo[3])),
+            testo_byte(byte_porte, testo[4], sizeof(testo[4])));
+    long disponibile = memoria_disponibile();
+    if (disponibile < 0) fprintf(out, "Memoria disponibile: non determinabile\n");
+    else fprintf(out, "Memoria disponibile: %s: il circuito %s\n", testo_byte((double)disponibile, testo[0], sizeof(testo[0])),
+                 picco <= (double)disponibile ? "entra in memoria" : "NON entra in memoria");
+    ret = 0;
+
+fine:
+    free(usato);
+    free(sequenza);
+    return ret;
+}
@@ -0,0 +1,40 @@
+#ifndef PIANO_H
+#define PIANO_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+
+/*
+ * Piano di esecuzione di un circuito (--plan), calcolato dai soli metadati: numero di qubit, indice degli
+ * operatori (indicizza_input: porte predefinite già costruite, matrici dense solo registrate) e istruzioni.
+ * Per ogni istruzione riporta le scelte che l'esecuzione farebbe (kernel, tratto fuso o sequenza di porte,
+ * forma in cui l'operatore è tenuto, thread), i flop e i byte spostati stimati e, se il file di taratura ha
+ * i tempi misurati su questo host, il tempo stimato; infine la memoria di picco confrontata con quella disponibile.
+ * Senza leggere le matrici non si può sapere quali sono prodotti di Kronecker né quali sono duplicate, quindi
+ * le matrici dense vengono contate tutte come tali: flop, byte e memoria sono stime per eccesso.
+ */
+
+/* Configurazione dell'esecuzione da pianificare (le stesse scelte di qsim_compila) */
+typedef struct {
+    int numero_thread;          // Thread della squadra
+    long grana;                 // Grana dei job della squadra, 0 per le parti fisse
+    int kernel_piccoli;         // 1 per i kernel specializzati senza squadra
+    int pipeline;               // 1 se le matrici vengono lette durante l'esecuzione
+    int cache;                  // 1 se i tratti di istruzioni dense vengono fusi (--cache)
+    int operatori_condivisi;    // 1 se le matrici stanno in memoria condivisa tra processi
+    int fattorizzazione;        // 1 se le matrici vengono fattorizzate in porte quando possibile
+    double tempo_denso;         // Tempo (us) di una moltiplicazione densa dalla taratura, 0 se non disponibile
+    double tempo_porta;         // Tempo (us) di una passata di porta dalla taratura, 0 se non disponibile
+    long dimensione_tarata;     // Dimensione della taratura da cui vengono i tempi, 0 se nessuna
+    int configurazione_tarata;  // 1 se thread, grana e kernel vengono dalla taratura (-t auto)
+} configurazione_piano_t;
+
+/*
+ * Scrive il piano di esecuzione del circuito.
+ * Parametri: dati → circuito indicizzato (numero_qubit, operatori, circuito), configurazione → scelte
+ * dell'esecuzione, out → file su cui scrivere
+ * Ritorna: 0 se tutto ok, -1 se un operatore del circuito non è definito o in caso di errore di allocazione
+ */
+int scrivi_piano(const dati_input_t* dati, const configurazione_piano_t* configurazione, FILE* out);
+
+#endif
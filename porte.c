@@ -0,0 +1,647 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "porte.h"
+#include "thread_matrice.h"
+
+#define PI_GRECO 3.14159265358979323846
+#define TRATTO_SCAMBIO 256     // Ampiezze copiate per volta negli scambi di qubit (6 KiB)
+#define LUNGHEZZA_PARAMETRO 32 // Caratteri del testo di un parametro tra parentesi, terminatore compreso
+
+/*
+ * Porte predefinite: nome, qubit richiesti come argomenti (controlli compresi), 1 se richiede un parametro
+ * tra parentesi, qubit di controllo e porta controllata (NULL se la porta non ha controlli)
+ */
+static const struct {
+    const char* nome;
+    int qubit;
+    int parametro;
+    int controlli;
+    const char* controllata;
+} g_porte[] = {
+    {"H", 1, 0, 0, NULL}, {"X", 1, 0, 0, NULL}, {"Y", 1, 0, 0, NULL}, {"Z", 1, 0, 0, NULL},
+    {"S", 1, 0, 0, NULL}, {"SDG", 1, 0, 0, NULL}, {"T", 1, 0, 0, NULL}, {"TDG", 1, 0, 0, NULL},
+    {"RX", 1, 1, 0, NULL}, {"RY", 1, 1, 0, NULL}, {"RZ", 1, 1, 0, NULL}, {"PHASE", 1, 1, 0, NULL},
+    {"SWAP", 2, 0, 0, NULL},
+    {"CNOT", 2, 0, 1, "X"}, {"CX", 2, 0, 1, "X"}, {"CZ", 2, 0, 1, "Z"}, {"CPHASE", 2, 1, 1, "PHASE"},
+    {"CCX", 3, 0, 2, "X"}, {"TOFFOLI", 3, 0, 2, "X"}
+};
+
+#define NUMERO_PORTE ((int)(sizeof(g_porte) / sizeof(g_porte[0])))
+
+
+/*
+ * Funzione di supporto che legge un multiplo di un simbolo nelle forme: numero, simbolo, -simbolo/4,
+ * 3*simbolo/2, 0.25simbolo. In simbolo mette il nome (lettere, cifre e '_', non iniziale), "" se c'è solo il numero.
+ * Ritorna 0 se ok, -1 se il testo non ha questa forma.
+ */
+static int leggi_multiplo(const char* testo, double* coefficiente, char simbolo[32]) {
+    const char* s = testo;
+    double segno = 1.0;
+    if (*s == '-') { segno = -1.0; s++; }
+    else if (*s == '+') s++;
+
+    double valore = 1.0;
+    int numero = 0;                                 // 1 se c'è un coefficiente numerico
+    char* fine;
+    double x = strtod(s, &fine);
+    if (fine != s) {
+        valore = x;
+        s = fine;
+        numero = 1;
+        if (*s == '*') s++;                         // 3*pi
+    }
+
+    size_t n = 0;
+    while (isalpha((unsigned char)s[n]) || s[n] == '_' || (n > 0 && isdigit((unsigned char)s[n]))) n++;
+    if (n >= 32 || (n == 0 && !numero)) return -1;
+    memcpy(simbolo, s, n);
+    simbolo[n] = '\0';
+    s += n;
+
+    if (n > 0 && *s == '/') {                       // pi/4
+        x = strtod(s + 1, &fine);
+        if (fine == s + 1 || x == 0.0) return -1;
+        valore /= x;
+        s = fine;
+    }
+
+    if (*s != '\0' || !isfinite(valore)) return -1;
+    *coefficiente = segno * valore;
+    return 0;
+}
+
+int leggi_angolo(const char* testo, double* angolo) {
+    char simbolo[32];
+    double coefficiente;
+    if (leggi_multiplo(testo, &coefficiente, simbolo) != 0) return -1;
+    if (simbolo[0] == '\0') *angolo = coefficiente;
+    else if (strcmp(simbolo, "pi") == 0) *angolo = coefficiente * PI_GRECO;
+    else return -1;
+    return isfinite(*angolo) ? 0 : -1;
+}
+
+/*
+ * Funzione di supporto che separa i prefissi di controllo, il nome della porta e il testo del parametro:
+ * "C-RX(pi/2)" → 1 controllo, "RX", "pi/2" (testo vuoto per le porte senza parametro).
+ * Ritorna l'indice della porta in g_porte, -1 se il nome non è una porta predefinita, le parentesi non
+ * corrispondono alla porta, il parametro è più lungo di LUNGHEZZA_PARAMETRO - 1 caratteri o i controlli sono troppi.
+ */
+static int cerca_porta(const char* nome, int* controlli, char testo[LUNGHEZZA_PARAMETRO]) {
+    *controlli = 0;
+    while (strncmp(nome, "C-", 2) == 0) {           // Un controllo per ogni prefisso
+        (*controlli)++;
+        nome += 2;
+    }
+
+    char base[32];
+    const char* aperta = strchr(nome, '(');
+    size_t lunghezza = aperta ? (size_t)(aperta - nome) : strlen(nome);
+    if (lunghezza == 0 || lunghezza >= sizeof(base)) return -1;
+    memcpy(base, nome, lunghezza);
+    base[lunghezza] = '\0';
+    testo[0] = '\0';
+
+    for (int k = 0; k < NUMERO_PORTE; k++) {
+        if (strcmp(g_porte[k].nome, base) != 0) continue;
+        *controlli += g_porte[k].controlli;
+        if (*controlli > MAX_CONTROLLI_PORTA) return -1;
+        if (!g_porte[k].parametro) return aperta ? -1 : k;
+
+        /* Porta con parametro: il nome deve terminare con "(parametro)" */
+        if (!aperta) return -1;
+        size_t fine = strlen(nome);
+        if (fine < lunghezza + 3 || nome[fine - 1] != ')') return -1;
+
+        size_t n = fine - lunghezza - 2;
+        if (n >= LUNGHEZZA_PARAMETRO) return -1;
+        memcpy(testo, aperta + 1, n);
+        testo[n] = '\0';
+        return k;
+    }
+    return -1;
+}
+
+/*
+ * Funzione di supporto che riconosce una porta con un angolo numerico: "C-RX(pi/2)" → 1 controllo, "RX", pi/2.
+ * Ritorna l'indice della porta in g_porte, -1 se il nome non è una porta predefinita, il parametro non è
+ * valido o i controlli sono troppi.
+ */
+static int analizza_nome(const char* nome, double* parametro, int* controlli) {
+    char testo[LUNGHEZZA_PARAMETRO];
+    int k = cerca_porta(nome, controlli, testo);
+    if (k < 0) return -1;
+    if (g_porte[k].parametro && leggi_angolo(testo, parametro) != 0) return -1;
+    return k;
+}
+
+int argomenti_porta(const char* nome) {
+    double parametro;
+    int controlli;
+    int k = nome ? analizza_nome(nome, &parametro, &controlli) : -1;
+    return k < 0 ? 0 : g_porte[k].qubit - g_porte[k].controlli + controlli;
+}
+
+int argomenti_porta_simbolica(const char* nome, char simbolo[32], double* coefficiente) {
+    char testo[LUNGHEZZA_PARAMETRO];
+    int controlli;
+    int k = (nome && simbolo && coefficiente) ? cerca_porta(nome, &controlli, testo) : -1;
+    if (k < 0 || !g_porte[k].parametro) return 0;
+    if (leggi_multiplo(testo, coefficiente, simbolo) != 0 || simbolo[0] == '\0' || strcmp(simbolo, "pi") == 0) return 0;
+    return g_porte[k].qubit - g_porte[k].controlli + controlli;
+}
+
+/* Funzione di supporto che costruisce e^(i·angolo) */
+static complesso_t esponenziale_immaginario(double angolo) {
+    double im = sin(angolo);
+    return (complesso_t){cos(angolo), im, signbit(im) ? '-' : '+'};
+}
+
+/* Funzione di supporto che costruisce il complesso re + i im (signbit: anche -0.0 prende il segno '-') */
+static complesso_t complesso(double re, double im) {
+    return (complesso_t){re, im, signbit(im) ? '-' : '+'};
+}
+
+void completa_porta(porta_t* p) {
+    int k = p->numero_bersagli;
+
+    for (int b = 0; b < (1 << k); b++) {            // Scostamento dell'ampiezza con indice locale b
+        long offset = 0;
+        for (int j = 0; j < k; j++) {
+            if (b & (1 << j)) offset |= 1L << p->bersagli[j];
+        }
+        p->offset[b] = offset;
+    }
+
+    p->maschera_controlli = 0;
+    for (int j = 0; j < p->numero_controlli; j++) p->maschera_controlli |= 1L << p->controlli[j];
+
+    p->numero_ordinati = k + p->numero_controlli;
+    for (int j = 0; j < k; j++) p->ordinati[j] = p->bersagli[j];
+    for (int j = 0; j < p->numero_controlli; j++) p->ordinati[k + j] = p->controlli[j];
+    for (int j = 1; j < p->numero_ordinati; j++) {  // Ordinamento per inserimento (pochi elementi)
+        int x = p->ordinati[j];
+        int i = j - 1;
+        while (i >= 0 && p->ordinati[i] > x) {
+            p->ordinati[i + 1] = p->ordinati[i];
+            i--;
+        }
+        p->ordinati[i + 1] = x;
+    }
+}
+
+void semplifica_porta(porta_t* p, double soglia) {
+    if (p->tipo != PORTA_LOCALE) return;
+
+    int d = 1 << p->numero_bersagli;
+    int permutazione[1 << MAX_QUBIT_PORTA];
+    int usata[1 << MAX_QUBIT_PORTA] = {0};
+    int identita = 1;
+
+    for (int b = 0; b < d; b++) {                   // Cerca l'unico elemento non nullo della riga b
+        permutazione[b] = -1;
+        for (int c = 0; c < d; c++) {
+            if (modulo_complesso(p->matrice[b][c]) <= soglia) continue;
+            if (permutazione[b] >= 0 || usata[c]) return;   // Più elementi nella riga o nella colonna
+            permutazione[b] = c;
+        }
+        if (permutazione[b] < 0) return;            // Riga nulla: non è invertibile, resta locale
+        usata[permutazione[b]] = 1;
+        if (permutazione[b] != b) identita = 0;
+    }
+
+    for (int b = 0; b < d; b++) {
+        p->fase[b] = p->matrice[b][permutazione[b]];
+        p->permutazione[b] = permutazione[b];
+    }
+    p->tipo = identita ? PORTA_DIAGONALE : PORTA_PERMUTAZIONE;
+}
+
+/* Funzione di supporto che imposta una porta a un qubit locale con matrice [[a, b], [c, d]] */
+static void porta_locale_1(porta_t* p, complesso_t a, complesso_t b, complesso_t c, complesso_t d) {
+    p->tipo = PORTA_LOCALE;
+    p->matrice[0][0] = a;
+    p->matrice[0][1] = b;
+    p->matrice[1][0] = c;
+    p->matrice[1][1] = d;
+}
+
+/*
+ * Funzione di supporto: imposta tipo e coefficienti di una porta a un bersaglio g (nome senza controlli)
+ * con parametro theta. Fase e permutazione devono valere già 1 e l'identità.
+ */
+static void coefficienti_porta_1(porta_t* p, const char* g, double theta) {
+    double c = cos(theta / 2.0), s = sin(theta / 2.0);
+    double r = 1.0 / sqrt(2.0);
+
+    if (strcmp(g, "H") == 0) {
+        porta_locale_1(p, complesso(r, 0.0), complesso(r, 0.0), complesso(r, 0.0), complesso(-r, 0.0));
+    } else if (strcmp(g, "RX") == 0) {
+        porta_locale_1(p, complesso(c, 0.0), complesso(0.0, -s), complesso(0.0, -s), complesso(c, 0.0));
+    } else if (strcmp(g, "RY") == 0) {
+        porta_locale_1(p, complesso(c, 0.0), complesso(-s, 0.0), complesso(s, 0.0), complesso(c, 0.0));
+    } else if (strcmp(g, "X") == 0 || strcmp(g, "Y") == 0) {
+        p->tipo = PORTA_PERMUTAZIONE;
+        p->permutazione[0] = 1;
+        p->permutazione[1] = 0;
+        if (g[0] == 'Y') {                      // Y = [[0, -i], [i, 0]]
+            p->fase[0] = complesso(0.0, -1.0);
+            p->fase[1] = complesso(0.0, 1.0);
+        }
+    } else {                                    // Porte diagonali: cambia solo la fase di |1>
+        p->tipo = PORTA_DIAGONALE;
+        if (strcmp(g, "Z") == 0) p->fase[1] = complesso(-1.0, 0.0);
+        else if (strcmp(g, "S") == 0) p->fase[1] = complesso(0.0, 1.0);
+        else if (strcmp(g, "SDG") == 0) p->fase[1] = complesso(0.0, -1.0);
+        else if (strcmp(g, "T") == 0) p->fase[1] = esponenziale_immaginario(PI_GRECO / 4.0);
+        else if (strcmp(g, "TDG") == 0) p->fase[1] = esponenziale_immaginario(-PI_GRECO / 4.0);
+        else if (strcmp(g, "PHASE") == 0) p->fase[1] = esponenziale_immaginario(theta);
+        else {                                  // RZ = diag(e^(-iθ/2), e^(iθ/2))
+            p->fase[0] = esponenziale_immaginario(-theta / 2.0);
+            p->fase[1] = esponenziale_immaginario(theta / 2.0);
+        }
+    }
+}
+
+/* Funzione di supporto comune a crea_porta e crea_porta_angolo: costruisce la porta k di g_porte */
+static int costruisci_porta(int k, int controlli, double theta, const int* qubit, int numero_qubit, porta_t* p) {
+    int n = g_porte[k].qubit - g_porte[k].controlli;            // Bersagli
+    for (int j = 0; j < controlli + n; j++) {                   // Qubit nell'intervallo e tutti distinti
+        if (qubit[j] < 0 || qubit[j] >= numero_qubit) return -1;
+        for (int i = 0; i < j; i++) {
+            if (qubit[i] == qubit[j]) return -1;
+        }
+    }
+
+    memset(p, 0, sizeof(*p));
+    p->numero_bersagli = n;
+    p->numero_controlli = controlli;
+    for (int j = 0; j < controlli; j++) p->controlli[j] = qubit[j];             // I controlli precedono i bersagli
+    for (int b = 0; b < (1 << n); b++) {            // Di default fase 1 e permutazione identità
+        p->fase[b] = complesso(1.0, 0.0);
+        p->permutazione[b] = b;
+    }
+
+    const char* g = g_porte[k].controllata ? g_porte[k].controllata : g_porte[k].nome;
+    qubit += controlli;
+
+    if (n == 1) {
+        p->bersagli[0] = qubit[0];
+        coefficienti_porta_1(p, g, theta);
+    } else {                                        // SWAP: |01> ↔ |10>
+        p->tipo = PORTA_PERMUTAZIONE;
+        p->bersagli[0] = qubit[0];
+        p->bersagli[1] = qubit[1];
+        p->permutazione[1] = 2;
+        p->permutazione[2] = 1;
+    }
+
+    completa_porta(p);
+    return 0;
+}
+
+int crea_porta(const char* nome, const int* qubit, int numero_qubit, porta_t* p) {
+    double theta = 0.0;
+    int controlli = 0;
+    int k = (nome && qubit && p) ? analizza_nome(nome, &theta, &controlli) : -1;
+    if (k < 0) return -1;
+    return costruisci_porta(k, controlli, theta, qubit, numero_qubit, p);
+}
+
+int crea_porta_angolo(const char* nome, double angolo, const int* qubit, int numero_qubit, porta_t* p) {
+    char testo[LUNGHEZZA_PARAMETRO];
+    int controlli = 0;
+    int k = (nome && qubit && p && isfinite(angolo)) ? cerca_porta(nome, &controlli, testo) : -1;
+    if (k < 0 || !g_porte[k].parametro) return -1;
+    return costruisci_porta(k, controlli, angolo, qubit, numero_qubit, p);
+}
+
+int imposta_angolo_porta(porta_t* p, const char* nome, double angolo) {
+    char testo[LUNGHEZZA_PARAMETRO];
+    int controlli = 0;
+    int k = (p && nome && isfinite(angolo)) ? cerca_porta(nome, &controlli, testo) : -1;
+    if (k < 0 || !g_porte[k].parametro || p->numero_bersagli != 1) return -1;
+
+    const char* g = g_porte[k].controllata ? g_porte[k].controllata : g_porte[k].nome;
+    p->fase[0] = p->fase[1] = complesso(1.0, 0.0);     // Solo i coefficienti: bersagli, controlli e offset restano
+    coefficienti_porta_1(p, g, angolo);
+    return 0;
+}
+
+
+/* Dati passati ai thread per l'applicazione di una porta */
+typedef struct {
+    const porta_t* porta;
+    complesso_t* stato;
+} lavoro_porta_t;
+
+/* Dati passati ai thread per l'applicazione di una sequenza di porte a blocchi dello stato */
+typedef struct {
+    const porta_t* const* porte;    // Porte della sequenza, tutte con bersagli < qubit_blocco
+    int numero_porte;
+    complesso_t* stato;
+    int qubit_blocco;               // Ogni blocco contiene 2^qubit_blocco ampiezze contigue
+} lavoro_blocchi_t;
+
+/*
+ * Funzione di supporto: indice base del gruppo g, ottenuto inserendo uno 0 nelle posizioni dei bersagli
+ * e dei controlli e impostando poi a 1 i bit dei controlli. I gruppi enumerano quindi solo il sottospazio attivo.
+ */
+static inline long indice_base(const porta_t* p, long g) {
+    for (int j = 0; j < p->numero_ordinati; j++) {
+        int s = p->ordinati[j];
+        g = ((g >> s) << (s + 1)) | (g & ((1L << s) - 1));
+    }
+    return g | p->maschera_controlli;
+}
+
+/* Funzione di supporto: numero di gruppi della porta in un vettore di 2^numero_qubit ampiezze */
+static inline long gruppi_porta(const porta_t* p, int numero_qubit) {
+    return 1L << (numero_qubit - p->numero_bersagli - p->numero_controlli);
+}
+
+/*
+ * Funzione di supporto: versione di applica_gruppi_porta per le porte a un qubit, con i coefficienti
+ * in variabili locali e le due ampiezze di ogni coppia (i, i + 2^bersaglio) aggiornate direttamente.
+ */
+static void applica_gruppi_porta_1(const porta_t* p, complesso_t* v, long inizio, long fine) {
+    int t = p->bersagli[0];
+    long passo = 1L << t, basso = passo - 1;
+    int controllata = p->numero_controlli > 0;
+    double a_re, a_im, b_re, b_im, c_re, c_im, d_re, d_im;     // Matrice [[a, b], [c, d]]
+
+    if (p->tipo == PORTA_LOCALE) {
+        a_re = p->matrice[0][0].parte_reale; a_im = p->matrice[0][0].parte_immaginaria;
+        b_re = p->matrice[0][1].parte_reale; b_im = p->matrice[0][1].parte_immaginaria;
+        c_re = p->matrice[1][0].parte_reale; c_im = p->matrice[1][0].parte_immaginaria;
+        d_re = p->matrice[1][1].parte_reale; d_im = p->matrice[1][1].parte_immaginaria;
+    } else if (p->tipo == PORTA_DIAGONALE) {
+        double f0_re = p->fase[0].parte_reale, f0_im = p->fase[0].parte_immaginaria;
+        double f1_re = p->fase[1].parte_reale, f1_im = p->fase[1].parte_immaginaria;
+        int solo_uno = (f0_re == 1.0 && f0_im == 0.0);     // Z, S, T, PHASE: |0> resta invariato
+
+        for (long g = inizio; g < fine; g++) {
+            long i0 = controllata ? indice_base(p, g) : ((g >> t) << (t + 1)) | (g & basso);
+            complesso_t* z1 = &v[i0 + passo];
+            double re = f1_re * z1->parte_reale - f1_im * z1->parte_immaginaria;
+            double im = f1_re * z1->parte_immaginaria + f1_im * z1->parte_reale;
+            z1->parte_reale = re;
+            z1->parte_immaginaria = im;
+            z1->segno = signbit(im) ? '-' : '+';
+            if (solo_uno) continue;
+
+            complesso_t* z0 = &v[i0];
+            re = f0_re * z0->parte_reale - f0_im * z0->parte_immaginaria;
+            im = f0_re * z0->parte_immaginaria + f0_im * z0->parte_reale;
+            z0->parte_reale = re;
+            z0->parte_immaginaria = im;
+            z0->segno = signbit(im) ? '-' : '+';
+        }
+        return;
+    } else {                                        // Permutazione: [[f0, 0], [0, f1]] oppure [[0, f0], [f1, 0]]
+        int scambio = p->permutazione[0] == 1;
+        const complesso_t* f0 = &p->fase[0];
+        const complesso_t* f1 = &p->fase[1];
+        a_re = scambio ? 0.0 : f0->parte_reale; a_im = scambio ? 0.0 : f0->parte_immaginaria;
+        b_re = scambio ? f0->parte_reale : 0.0; b_im = scambio ? f0->parte_immaginaria : 0.0;
+        c_re = scambio ? f1->parte_reale : 0.0; c_im = scambio ? f1->parte_immaginaria : 0.0;
+        d_re = scambio ? 0.0 : f1->parte_reale; d_im = scambio ? 0.0 : f1->parte_immaginaria;
+    }
+
+    for (long g = inizio; g < fine; g++) {
+        long i0 = controllata ? indice_base(p, g) : ((g >> t) << (t + 1)) | (g & basso);
+        complesso_t* z0 = &v[i0];
+        complesso_t* z1 = &v[i0 + passo];
+        double x_re = z0->parte_reale, x_im = z0->parte_immaginaria;
+        double y_re = z1->parte_reale, y_im = z1->parte_immaginaria;
+
+        double r0 = a_re * x_re - a_im * x_im + b_re * y_re - b_im * y_im;
+        double i0_im = a_re * x_im + a_im * x_re + b_re * y_im + b_im * y_re;
+        double r1 = c_re * x_re - c_im * x_im + d_re * y_re - d_im * y_im;
+        double i1_im = c_re * x_im + c_im * x_re + d_re * y_im + d_im * y_re;
+
+        z0->parte_reale = r0;
+        z0->parte_immaginaria = i0_im;
+        z0->segno = signbit(i0_im) ? '-' : '+';
+        z1->parte_reale = r1;
+        z1->parte_immaginaria = i1_im;
+        z1->segno = signbit(i1_im) ? '-' : '+';
+    }
+}
+
+/*
+ * Funzione di supporto che applica la porta ai gruppi [inizio, fine) del vettore v.
+ * Ogni gruppo è formato dalle 2^k ampiezze che differiscono solo nei bit dei bersagli (con tutti i
+ * controlli a 1), quindi gruppi diversi sono indipendenti e possono essere aggiornati sul posto in parallelo.
+ */
+static void applica_gruppi_porta(const porta_t* p, complesso_t* v, long inizio, long fine) {
+    if (p->numero_bersagli == 1) {
+        applica_gruppi_porta_1(p, v, inizio, fine);
+        return;
+    }
+
+    int d = 1 << p->numero_bersagli;
+    double in_re[1 << MAX_QUBIT_PORTA], in_im[1 << MAX_QUBIT_PORTA];
+
+    for (long g = inizio; g < fine; g++) {
+        long base = indice_base(p, g);
+
+        if (p->tipo == PORTA_DIAGONALE) {           // Nessuna dipendenza tra le ampiezze del gruppo
+            for (int b = 0; b < d; b++) {
+                complesso_t* z = &v[base + p->offset[b]];
+                double re = p->fase[b].parte_reale * z->parte_reale - p->fase[b].parte_immaginaria * z->parte_immaginaria;
+                double im = p->fase[b].parte_reale * z->parte_immaginaria + p->fase[b].parte_immaginaria * z->parte_reale;
+                z->parte_reale = re;
+                z->parte_immaginaria = im;
+                z->segno = signbit(im) ? '-' : '+';
+            }
+            continue;
+        }
+
+        for (int c = 0; c < d; c++) {               // Raccoglie il gruppo
+            in_re[c] = v[base + p->offset[c]].parte_reale;
+            in_im[c] = v[base + p->offset[c]].parte_immaginaria;
+        }
+
+        for (int b = 0; b < d; b++) {
+            double re, im;
+            if (p->tipo == PORTA_PERMUTAZIONE) {
+                int c = p->permutazione[b];
+                re = p->fase[b].parte_reale * in_re[c] - p->fase[b].parte_immaginaria * in_im[c];
+                im = p->fase[b].parte_reale * in_im[c] + p->fase[b].parte_immaginaria * in_re[c];
+            } else {
+                re = 0.0;
+                im = 0.0;
+                for (int c = 0; c < d; c++) {
+                    const complesso_t* u = &p->matrice[b][c];
+                    re += u->parte_reale * in_re[c] - u->parte_immaginaria * in_im[c];
+                    im += u->parte_reale * in_im[c] + u->parte_immaginaria * in_re[c];
+                }
+            }
+            complesso_t* z = &v[base + p->offset[b]];
+            z->parte_reale = re;
+            z->parte_immaginaria = im;
+            z->segno = signbit(im) ? '-' : '+';
+        }
+    }
+}
+
+/* Funzione eseguita dalla squadra: applica una porta ai gruppi [inizio, fine) dell'intero stato */
+static void applica_gruppi(void* argomento, long inizio, long fine) {
+    const lavoro_porta_t* lavoro = (const lavoro_porta_t*)argomento;
+    applica_gruppi_porta(lavoro->porta, lavoro->stato, inizio, fine);
+}
+
+/*
+ * Funzione eseguita dalla squadra: per ogni blocco [inizio, fine) applica in sequenza tutte le porte.
+ * Le porte agiscono solo su qubit interni al blocco, quindi il blocco resta in cache per tutta la
+ * sequenza e lo stato viene letto e scritto dalla memoria una sola volta.
+ */
+static void applica_blocchi(void* argomento, long inizio, long fine) {
+    const lavoro_blocchi_t* lavoro = (const lavoro_blocchi_t*)argomento;
+
+    for (long blocco = inizio; blocco < fine; blocco++) {
+        complesso_t* v = lavoro->stato + (blocco << lavoro->qubit_blocco);
+        for (int k = 0; k < lavoro->numero_porte; k++) {
+            const porta_t* p = lavoro->porte[k];
+            applica_gruppi_porta(p, v, 0, gruppi_porta(p, lavoro->qubit_blocco));
+        }
+    }
+}
+
+/* Funzione di supporto: 1 se tutti i bersagli e i controlli della porta sono interni a un blocco di 2^qubit_blocco ampiezze */
+static int porta_nel_blocco(const porta_t* p, int qubit_blocco) {
+    return p->ordinati[p->numero_ordinati - 1] < qubit_blocco;
+}
+
+/*
+ * Funzione di supporto: fine del tratto che inizia con la porta k, cioè la prima porta dopo k che non
+ * può far parte dello stesso passaggio a blocchi. Ritorna k + 1 se la porta k va applicata da sola.
+ */
+static int fine_tratto(const porta_t* const* porte, int k, int numero_porte, int numero_qubit) {
+    int fine = k;
+    if (numero_qubit > QUBIT_BLOCCO) {              // Solo se lo stato non sta già tutto in un blocco
+        while (fine < numero_porte && porta_nel_blocco(porte[fine], QUBIT_BLOCCO)) fine++;
+    }
+    return fine - k >= 2 ? fine : k + 1;
+}
+
+/* Funzione di supporto: 1 se la porta è uno scambio di due qubit (SWAP senza fasi) */
+static int porta_scambio(const porta_t* p) {
+    if (p->tipo != PORTA_PERMUTAZIONE || p->numero_bersagli != 2 || p->numero_controlli > 0) return 0;
+    if (p->permutazione[0] != 0 || p->permutazione[1] != 2 || p->permutazione[2] != 1 || p->permutazione[3] != 3) return 0;
+    for (int b = 0; b < 4; b++) {
+        if (p->fase[b].parte_reale != 1.0 || p->fase[b].parte_immaginaria != 0.0) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Funzione eseguita dalla squadra per lo scambio dei qubit a < b: gli indici con bit a = 1 e bit b = 0
+ * si scambiano con quelli con bit a = 0 e bit b = 1. Per ogni valore degli altri bit alti le ampiezze
+ * coinvolte formano due tratti contigui di 2^a elementi, scambiati per intero: la porzione [inizio, fine)
+ * enumera questi tratti.
+ */
+static void scambia_tratti(void* argomento, long inizio, long fine) {
+    const lavoro_porta_t* lavoro = (const lavoro_porta_t*)argomento;
+    int a = lavoro->porta->ordinati[0], b = lavoro->porta->ordinati[1];
+    long lunghezza = 1L << a;
+    complesso_t* v = lavoro->stato;
+
+    for (long c = inizio; c < fine; c++) {
+        long alto = c << a;                         // Bit sopra a, con i bit a e b ancora da inserire
+        alto = ((alto >> a) << (a + 1)) | (1L << a);                            // Bit a = 1
+        alto = ((alto >> b) << (b + 1)) | (alto & ((1L << b) - 1));             // Bit b = 0
+        complesso_t* x = &v[alto];
+        complesso_t* y = &v[alto - (1L << a) + (1L << b)];
+        for (long i = 0; i < lunghezza; i += TRATTO_SCAMBIO) {    // Scambio a pezzi attraverso un buffer in L1
+            complesso_t tmp[TRATTO_SCAMBIO];
+            size_t byte = (lunghezza - i < TRATTO_SCAMBIO ? lunghezza - i : TRATTO_SCAMBIO) * sizeof(complesso_t);
+            memcpy(tmp, &x[i], byte);
+            memcpy(&x[i], &y[i], byte);
+            memcpy(&y[i], tmp, byte);
+        }
+    }
+}
+
+int passate_sequenza_porte(const porta_t* const* porte, int numero_porte, int numero_qubit) {
+    int passate = 0;
+    for (int k = 0; k < numero_porte; k = fine_tratto(porte, k, numero_porte, numero_qubit)) passate++;
+    return passate;
+}
+
+int applica_sequenza_porte(const porta_t* const* porte, int numero_porte, complesso_t* stato, int numero_qubit) {
+    if ((!porte && numero_porte > 0) || !stato || numero_porte < 0) return -1;
+    for (int k = 0; k < numero_porte; k++) {
+        if (porte[k]->numero_bersagli < 1 || porte[k]->numero_ordinati > numero_qubit) return -1;
+    }
+
+    int k = 0;
+    while (k < numero_porte) {
+        int fine = fine_tratto(porte, k, numero_porte, numero_qubit);
+
+        if (fine - k >= 2) {                        // Una sola passata sullo stato per tutto il tratto
+            lavoro_blocchi_t lavoro = {&porte[k], fine - k, stato, QUBIT_BLOCCO};
+            if (esegui_in_parallelo(applica_blocchi, &lavoro, 1L << (numero_qubit - QUBIT_BLOCCO)) != 0) return -1;
+        } else if (porta_scambio(porte[k])) {       // Scambio di qubit: copia di tratti contigui
+            lavoro_porta_t lavoro = {porte[k], stato};
+            long tratti = 1L << (numero_qubit - 2 - porte[k]->ordinati[0]);
+            if (esegui_in_parallelo(scambia_tratti, &lavoro, tratti) != 0) return -1;
+        } else {                                    // Porta isolata o su un qubit alto: una passata dedicata
+            lavoro_porta_t lavoro = {porte[k], stato};
+            long gruppi = gruppi_porta(porte[k], numero_qubit);
+            if (esegui_in_parallelo(applica_gruppi, &lavoro, gruppi) != 0) return -1;
+        }
+        k = fine;
+    }
+    return 0;
+}
+
+int applica_porte(const porta_t* porte, int numero_porte, complesso_t* stato, int numero_qubit) {
+    if (!porte || !stato || numero_porte < 0) return -1;
+    if (numero_porte == 0) return 0;
+
+    const porta_t** sequenza = (const porta_t**)malloc(numero_porte * sizeof(const porta_t*));
+    if (!sequenza) return -1;
+    for (int k = 0; k < numero_porte; k++) sequenza[k] = &porte[k];
+
+    int ret = applica_sequenza_porte(sequenza, numero_porte, stato, numero_qubit);
+    free(sequenza);
+    return ret;
+}
+
+void applica_porta_righe(const porta_t* p, const complesso_t* stato, complesso_t* out, long riga_inizio, long riga_fine) {
+    int d = 1 << p->numero_bersagli;
+    long maschera = p->offset[d - 1];               // Tutti i bit dei bersagli
+
+    for (long i = riga_inizio; i < riga_fine; i++) {
+        if ((i & p->maschera_controlli) != p->maschera_controlli) {     // Fuori dal sottospazio attivo: invariata
+            out[i - riga_inizio] = stato[i];
+            continue;
+        }
+        long base = i & ~maschera;
+        int b = 0;                                  // Indice locale della riga
+        for (int j = 0; j < p->numero_bersagli; j++) {
+            if (i & (1L << p->bersagli[j])) b |= 1 << j;
+        }
+
+        double re, im;
+        if (p->tipo == PORTA_LOCALE) {
+            re = 0.0;
+            im = 0.0;
+            for (int c = 0; c < d; c++) {
+                const complesso_t* u = &p->matrice[b][c];
+                const complesso_t* z = &stato[base + p->offset[c]];
+                re += u->parte_reale * z->parte_reale - u->parte_immaginaria * z->parte_immaginaria;
+                im += u->parte_reale * z->parte_immaginaria + u->parte_immaginaria * z->parte_reale;
+            }
+        } else {
+            int c = p->tipo == PORTA_PERMUTAZIONE ? p->permutazione[b] : b;
+            const complesso_t* z = &stato[base + p->offset[c]];
+            re = p->fase[b].parte_reale * z->parte_reale - p->fase[b].parte_immaginaria * z->parte_immaginaria;
+            im = p->fase[b].parte_reale * z->parte_immaginaria + p->fase[b].parte_immaginaria * z->parte_reale;
+        }
+        out[i - riga_inizio] = (complesso_t){re, im, signbit(im) ? '-' : '+'};
+    }
+}
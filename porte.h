@@ -0,0 +1,155 @@
+#ifndef PORTE_H
+#define PORTE_H
+
+#include "complesso.h"
+
+/* Numero massimo di qubit su cui agisce una porta (2^3 = 8 ampiezze per gruppo) */
+#define MAX_QUBIT_PORTA 3
+
+/* Numero massimo di qubit di controllo di una porta */
+#define MAX_CONTROLLI_PORTA 8
+
+/* Numero massimo di qubit (controlli e bersagli) indicati come argomenti di una porta in #circ */
+#define MAX_ARGOMENTI_PORTA (MAX_QUBIT_PORTA + MAX_CONTROLLI_PORTA)
+
+/* Blocchi di 2^13 ampiezze (192 KiB): porte consecutive sui qubit 0..12 vengono applicate blocco per blocco in cache L2 */
+#ifndef QUBIT_BLOCCO
+#define QUBIT_BLOCCO 13
+#endif
+
+/*
+ * Forma interna di una porta: determina il kernel usato per applicarla.
+ * Indicando con b l'indice locale (i bit dei qubit bersaglio) di un'ampiezza:
+ * PORTA_LOCALE       → out[b] = somma_c matrice[b][c] * in[c]
+ * PORTA_DIAGONALE    → out[b] = fase[b] * in[b]
+ * PORTA_PERMUTAZIONE → out[b] = fase[b] * in[permutazione[b]]
+ */
+typedef enum {
+    PORTA_LOCALE,
+    PORTA_DIAGONALE,
+    PORTA_PERMUTAZIONE
+} tipo_porta_t;
+
+/*
+ * Nuovo tipo che rappresenta una porta che agisce su pochi qubit dello stato.
+ * Il qubit q corrisponde al bit q dell'indice del vettore di stato (qubit 0 = bit meno significativo);
+ * bersagli[0] è il bit meno significativo dell'indice locale b.
+ * Se la porta ha qubit di controllo agisce solo sulle ampiezze in cui tutti i controlli valgono 1:
+ * i kernel enumerano solo quelle (2^(N - controlli) ampiezze) e lasciano le altre intatte in memoria.
+ */
+typedef struct {
+    tipo_porta_t tipo;                                   // Kernel da usare
+    int numero_bersagli;                                 // Qubit su cui agisce (1..MAX_QUBIT_PORTA)
+    int bersagli[MAX_QUBIT_PORTA];                       // Qubit bersaglio, nell'ordine dell'indice locale
+    int numero_controlli;                                // Qubit di controllo (0..MAX_CONTROLLI_PORTA)
+    int controlli[MAX_CONTROLLI_PORTA];                  // Qubit di controllo, distinti dai bersagli
+    complesso_t matrice[1 << MAX_QUBIT_PORTA][1 << MAX_QUBIT_PORTA];   // Solo PORTA_LOCALE
+    complesso_t fase[1 << MAX_QUBIT_PORTA];              // PORTA_DIAGONALE e PORTA_PERMUTAZIONE
+    int permutazione[1 << MAX_QUBIT_PORTA];              // Solo PORTA_PERMUTAZIONE
+
+    /* Valori derivati, calcolati da completa_porta */
+    long offset[1 << MAX_QUBIT_PORTA];                   // Scostamento nel vettore dell'ampiezza con indice locale b
+    long maschera_controlli;                             // Bit dei qubit di controllo
+    int numero_ordinati;                                 // numero_bersagli + numero_controlli
+    int ordinati[MAX_ARGOMENTI_PORTA];                   // Bersagli e controlli in ordine crescente
+} porta_t;
+
+/*
+ * Verifica se un nome del circuito indica una porta predefinita (es. "H", "RX(pi/4)", "CNOT", "C-C-H").
+ * Ogni prefisso "C-" aggiunge un qubit di controllo, indicato prima dei qubit della porta.
+ * Parametri: nome → nome letto da #circ, eventualmente con il parametro tra parentesi
+ * Ritorna: numero di qubit (controlli compresi) che la porta richiede come argomenti, 0 se non è una
+ * porta predefinita o il parametro non è valido
+ */
+int argomenti_porta(const char* nome);
+
+/*
+ * Legge un angolo nelle forme: numero, pi, -pi/4, 3*pi/2, 0.25pi (come il parametro delle porte in #circ).
+ * Ritorna: 0 se ok, -1 se il testo non è un angolo valido
+ */
+int leggi_angolo(const char* testo, double* angolo);
+
+/*
+ * Verifica se un nome del circuito indica una porta predefinita con parametro simbolico (circuiti
+ * parametrici, parametri.h): l'angolo tra parentesi è un multiplo di un nome, nelle stesse forme degli angoli
+ * con pi (es. "RX(theta)", "C-RZ(-2*gamma)", "PHASE(beta/2)", "RY(0.5phi)").
+ * Parametri: nome → nome letto da #circ, simbolo → valorizzato con il nome del parametro,
+ * coefficiente → valorizzato con il fattore per cui moltiplicare il parametro
+ * Ritorna: numero di qubit (controlli compresi) che la porta richiede come argomenti, 0 se non è una
+ * porta predefinita con parametro simbolico
+ */
+int argomenti_porta_simbolica(const char* nome, char simbolo[32], double* coefficiente);
+
+/*
+ * Costruisce una porta predefinita direttamente nella sua forma interna.
+ * Parametri:
+ * nome → nome della porta (argomenti_porta(nome) > 0)
+ * qubit → qubit passati come argomenti in #circ (argomenti_porta(nome) valori)
+ * numero_qubit → qubit del circuito, per validare gli argomenti
+ * p → porta da valorizzare
+ * Ritorna: 0 se tutto ok, -1 se la porta non esiste o i qubit non sono validi (fuori intervallo o ripetuti)
+ */
+int crea_porta(const char* nome, const int* qubit, int numero_qubit, porta_t* p);
+
+/*
+ * Come crea_porta, per una porta con parametro il cui angolo è dato a parte (il testo tra parentesi del nome,
+ * ad esempio un parametro simbolico, viene ignorato).
+ * Ritorna: 0 se tutto ok, -1 se la porta non esiste, non ha parametro o i qubit non sono validi
+ */
+int crea_porta_angolo(const char* nome, double angolo, const int* qubit, int numero_qubit, porta_t* p);
+
+/*
+ * Ricalcola solo i coefficienti di una porta con parametro già costruita (crea_porta_angolo) per un nuovo
+ * angolo: tipo, bersagli, controlli e valori derivati restano quelli della porta.
+ * Parametri: p → porta da aggiornare, nome → nome con cui è stata costruita, angolo → nuovo angolo
+ * Ritorna: 0 se tutto ok, -1 se nome non indica una porta con parametro
+ */
+int imposta_angolo_porta(porta_t* p, const char* nome, double angolo);
+
+/*
+ * Calcola i valori derivati (offset, maschera dei controlli, qubit ordinati) di una porta di cui sono già
+ * impostati tipo, bersagli, controlli e coefficienti.
+ */
+void completa_porta(porta_t* p);
+
+/*
+ * Converte una porta locale nella forma diagonale o di permutazione con fase quando la sua matrice
+ * ha un solo elemento non nullo (modulo oltre soglia) per riga e per colonna.
+ * Parametri: p → porta da semplificare (i valori derivati vanno ricalcolati con completa_porta), soglia → modulo sotto cui un elemento è nullo
+ */
+void semplifica_porta(porta_t* p, double soglia);
+
+/*
+ * Applica una sequenza di porte allo stato, sul posto, suddividendo il lavoro tra i thread della squadra
+ * (o nel thread chiamante se la squadra non esiste). Costo O(2^numero_qubit) per porta; le porte
+ * consecutive sui qubit bassi vengono raggruppate come in applica_sequenza_porte.
+ * Parametri: porte → porte da applicare nell'ordine, numero_porte → quante, stato → vettore di 2^numero_qubit ampiezze
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int applica_porte(const porta_t* porte, int numero_porte, complesso_t* stato, int numero_qubit);
+
+/*
+ * Applica sul posto una sequenza di porte, anche provenienti da istruzioni diverse.
+ * I tratti di almeno due porte consecutive con tutti i bersagli sotto QUBIT_BLOCCO vengono applicati
+ * blocco per blocco (un blocco di 2^QUBIT_BLOCCO ampiezze resta in cache L2 per tutto il tratto),
+ * distribuendo i blocchi tra i thread della squadra: k porte costano una sola passata sulla memoria.
+ * Le altre porte vengono applicate con una passata ciascuna.
+ * Parametri: porte → puntatori alle porte nell'ordine, numero_porte → quante, stato → vettore di 2^numero_qubit ampiezze
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int applica_sequenza_porte(const porta_t* const* porte, int numero_porte, complesso_t* stato, int numero_qubit);
+
+/*
+ * Conta le passate sullo stato che applica_sequenza_porte eseguirebbe per la sequenza indicata.
+ * Ritorna: numero di passate (un tratto a blocchi conta come una sola passata)
+ */
+int passate_sequenza_porte(const porta_t* const* porte, int numero_porte, int numero_qubit);
+
+/*
+ * Calcola solo le righe [riga_inizio, riga_fine) del risultato di una porta applicata allo stato completo.
+ * Usata nella simulazione distribuita, dove ogni processo calcola il proprio blocco.
+ * Parametri: p → porta, stato → vettore completo, out → riga_fine - riga_inizio ampiezze
+ */
+void applica_porta_righe(const porta_t* p, const complesso_t* stato, complesso_t* out, long riga_inizio, long riga_fine);
+
+#endif
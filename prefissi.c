@@ -0,0 +1,183 @@
+#include <stdlib.h>
+#include <string.h>
+#include "prefissi.h"
+#include "memoria.h"
+
+/* Nodo dell'albero dei prefissi: un'istruzione e i figli nell'ordine di prima comparsa nelle varianti */
+typedef struct nodo {
+    const istruzione_circuito_t* istruzione;    // Istruzione del nodo, NULL per la radice
+    struct nodo* figlio;                        // Primo figlio
+    struct nodo* ultimo_figlio;                 // Ultimo figlio (per aggiungere in coda)
+    struct nodo* fratello;                      // Figlio successivo dello stesso padre
+    int prima_variante;                         // Prima variante che termina nel nodo, -1 se nessuna
+} nodo_t;
+
+/* Dati comuni alla visita dell'albero */
+typedef struct {
+    int* successiva;                    // successiva[v]: prossima variante che termina nello stesso nodo di v, -1 se nessuna
+    long dimensione;
+    int limite_buffer;
+    int buffer_in_uso;                  // Stati intermedi conservati in questo momento
+    esegui_tratto_t esegui;
+    void* argomento;
+    istruzione_circuito_t* percorso;    // Istruzioni dalla radice al nodo corrente
+    complesso_t** finali;
+} visita_t;
+
+/* Statistiche dell'ultima esecuzione di varianti del thread chiamante (lette solo da stampa_prefissi) */
+static __thread struct {
+    int varianti;
+    long istruzioni;        // Istruzioni delle varianti (somma delle lunghezze)
+    long nodi;              // Nodi dell'albero, cioè istruzioni da eseguire condividendo i prefissi
+    long eseguite;          // Istruzioni effettivamente eseguite
+    int buffer_massimi;     // Stati intermedi conservati insieme al massimo
+    int limite_buffer;
+    long ricalcoli;         // Tratti ripartiti da uno stato precedente per il limite dei buffer
+} g_statistiche;
+
+
+/* Funzione di supporto: figlio di n con l'istruzione indicata, creato in coda (da nodi[*usati]) se manca */
+static nodo_t* figlio_con(nodo_t* n, const istruzione_circuito_t* istruzione, nodo_t* nodi, long* usati) {
+    for (nodo_t* f = n->figlio; f; f = f->fratello) {
+        if (strcmp(f->istruzione->nome_operatore, istruzione->nome_operatore) == 0) return f;
+    }
+    nodo_t* f = &nodi[(*usati)++];
+    *f = (nodo_t){istruzione, NULL, NULL, NULL, -1};
+    if (n->ultimo_figlio) n->ultimo_figlio->fratello = f;
+    else n->figlio = f;
+    n->ultimo_figlio = f;
+    return f;
+}
+
+/*
+ * Funzione di supporto: visita il sottoalbero di nodo, la cui istruzione è percorso[profondita - 1]. base è
+ * lo stato dopo le prime profondita_base istruzioni del percorso: le istruzioni successive fino al nodo non
+ * sono ancora state eseguite e lo vengono solo dove serve uno stato (fine di una variante o diramazione).
+ * Ritorna 0 se ok, -1 se errore.
+ */
+static int visita(visita_t* v, const nodo_t* nodo, int profondita, const complesso_t* base, int profondita_base) {
+    /* Catena senza diramazioni né varianti che terminano: si scende allungando il tratto da eseguire */
+    while (nodo->prima_variante < 0 && nodo->figlio && !nodo->figlio->fratello) {
+        nodo = nodo->figlio;
+        v->percorso[profondita++] = *nodo->istruzione;
+    }
+
+    int ramifica = nodo->figlio && nodo->figlio->fratello;
+    int conserva = nodo->figlio && profondita > profondita_base && (ramifica || nodo->prima_variante >= 0) &&
+                   v->buffer_in_uso < v->limite_buffer;
+
+    /* Stato del nodo: serve alle varianti che terminano qui e, se c'è posto, come base per i figli */
+    complesso_t* stato = (complesso_t*)base;
+    if (profondita > profondita_base && (nodo->prima_variante >= 0 || conserva)) {
+        if (v->esegui(v->argomento, &v->percorso[profondita_base], profondita - profondita_base, base, &stato) != 0) return -1;
+        g_statistiche.eseguite += profondita - profondita_base;
+    }
+
+    for (int w = nodo->prima_variante; w >= 0; w = v->successiva[w]) {
+        if (!nodo->figlio && stato != base && v->successiva[w] < 0) {
+            v->finali[w] = stato;                   // Foglia: l'ultima variante prende lo stato senza copia
+            return 0;
+        }
+        v->finali[w] = alloca_stato(v->dimensione, 0);
+        if (!v->finali[w]) {
+            if (stato != base) free(stato);
+            return -1;
+        }
+        memcpy(v->finali[w], stato, v->dimensione * sizeof(complesso_t));
+    }
+    if (!nodo->figlio) {
+        if (stato != base) free(stato);
+        return 0;
+    }
+
+    /* Figli: ripartono dallo stato del nodo se conservato, altrimenti dall'ultima base (ricalcolando il tratto) */
+    const complesso_t* nuova_base = base;
+    int nuova_profondita = profondita_base;
+    if (conserva) {
+        nuova_base = stato;
+        nuova_profondita = profondita;
+        if (++v->buffer_in_uso > g_statistiche.buffer_massimi) g_statistiche.buffer_massimi = v->buffer_in_uso;
+    } else if (stato != base) {
+        free(stato);                                // Calcolato solo per le varianti che terminano qui
+        g_statistiche.ricalcoli++;
+    }
+
+    int ret = 0;
+    for (const nodo_t* f = nodo->figlio; f && ret == 0; f = f->fratello) {
+        if (!conserva && f != nodo->figlio && profondita > profondita_base) g_statistiche.ricalcoli++;
+        v->percorso[profondita] = *f->istruzione;
+        ret = visita(v, f, profondita + 1, nuova_base, nuova_profondita);
+    }
+
+    if (conserva) {
+        v->buffer_in_uso--;
+        free(stato);
+    }
+    return ret;
+}
+
+int esegui_varianti(const variante_t* varianti, int numero_varianti, const complesso_t* iniziale, long dimensione,
+                    int limite_buffer, esegui_tratto_t esegui, void* argomento, complesso_t** finali) {
+    if (!varianti || numero_varianti <= 0 || !iniziale || dimensione <= 0 || limite_buffer < 0 || !esegui || !finali) return -1;
+
+    long totale = 0;
+    int massimo = 0;                                // Lunghezza della variante più lunga
+    for (int w = 0; w < numero_varianti; w++) {
+        totale += varianti[w].numero_istruzioni;
+        if (varianti[w].numero_istruzioni > massimo) massimo = varianti[w].numero_istruzioni;
+        finali[w] = NULL;
+    }
+
+    nodo_t* nodi = (nodo_t*)malloc((totale + 1) * sizeof(nodo_t));
+    int* successiva = (int*)malloc(numero_varianti * sizeof(int));
+    istruzione_circuito_t* percorso = (istruzione_circuito_t*)malloc((massimo + 1) * sizeof(istruzione_circuito_t));
+    int ret = -1;
+    if (!nodi || !successiva || !percorso) goto fine;
+
+    /* Costruzione dell'albero: ogni variante scende lungo il prefisso già inserito e aggiunge il resto */
+    long usati = 1;
+    nodi[0] = (nodo_t){NULL, NULL, NULL, NULL, -1};
+    for (int w = 0; w < numero_varianti; w++) {
+        nodo_t* n = &nodi[0];
+        for (int i = 0; i < varianti[w].numero_istruzioni; i++) n = figlio_con(n, &varianti[w].istruzioni[i], nodi, &usati);
+        successiva[w] = n->prima_variante;
+        n->prima_variante = w;
+    }
+
+    g_statistiche.varianti = numero_varianti;
+    g_statistiche.istruzioni = totale;
+    g_statistiche.nodi = usati - 1;
+    g_statistiche.eseguite = 0;
+    g_statistiche.buffer_massimi = 0;
+    g_statistiche.limite_buffer = limite_buffer;
+    g_statistiche.ricalcoli = 0;
+
+    visita_t v = {successiva, dimensione, limite_buffer, 0, esegui, argomento, percorso, finali};
+    ret = visita(&v, &nodi[0], 0, iniziale, 0);
+
+fine:
+    if (ret != 0) {
+        for (int w = 0; w < numero_varianti; w++) {
+            free(finali[w]);
+            finali[w] = NULL;
+        }
+    }
+    free(nodi);
+    free(successiva);
+    free(percorso);
+    return ret;
+}
+
+void stampa_prefissi(FILE* out) {
+    fprintf(out, "\n=== Varianti del circuito ===\n");
+    if (g_statistiche.varianti == 0) {
+        fprintf(out, "Nessuna variante eseguita\n");
+        return;
+    }
+    fprintf(out, "Varianti: %d, istruzioni in totale: %ld, nodi dell'albero dei prefissi: %ld\n",
+            g_statistiche.varianti, g_statistiche.istruzioni, g_statistiche.nodi);
+    fprintf(out, "Istruzioni eseguite: %ld (%.1f%% delle istruzioni delle varianti)\n", g_statistiche.eseguite,
+            g_statistiche.istruzioni ? 100.0 * g_statistiche.eseguite / g_statistiche.istruzioni : 0.0);
+    fprintf(out, "Stati intermedi conservati al massimo: %d su %d, tratti ricalcolati per il limite: %ld\n",
+            g_statistiche.buffer_massimi, g_statistiche.limite_buffer, g_statistiche.ricalcoli);
+}
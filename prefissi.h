@@ -0,0 +1,43 @@
+#ifndef PREFISSI_H
+#define PREFISSI_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+
+/* Stati intermedi conservati al massimo durante l'esecuzione delle varianti (default) */
+#define BUFFER_VARIANTI 8
+
+/*
+ * Esegue un tratto di istruzioni a partire da uno stato, senza modificarlo.
+ * Parametri: argomento → dato del chiamante, istruzioni → tratto (numero_istruzioni >= 1),
+ * iniziale → stato di partenza, finale → nuovo vettore con lo stato al termine del tratto (liberato con free)
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+typedef int (*esegui_tratto_t)(void* argomento, const istruzione_circuito_t* istruzioni, int numero_istruzioni,
+                               const complesso_t* iniziale, complesso_t** finale);
+
+/*
+ * Esegue una famiglia di varianti dello stesso circuito sullo stesso stato iniziale condividendo i prefissi
+ * comuni. Le sequenze di istruzioni vengono inserite in un albero dei prefissi (trie) visitato in profondità:
+ * ogni prefisso comune viene simulato una sola volta e lo stato nei punti di diramazione viene conservato
+ * finché tutti i rami sono stati eseguiti. Gli stati conservati insieme sono al massimo limite_buffer: con il
+ * limite raggiunto i rami successivi ripartono dall'ultimo stato conservato (più calcolo, memoria limitata).
+ * Parametri:
+ * varianti → sequenze di istruzioni, numero_varianti → quante
+ * iniziale → stato iniziale (non modificato), dimensione → sua lunghezza
+ * limite_buffer → stati intermedi conservati al massimo (>= 0)
+ * esegui → funzione che esegue un tratto, argomento → passato a esegui
+ * finali → numero_varianti puntatori valorizzati con lo stato finale di ogni variante (liberati con free)
+ * Ritorna: 0 se tutto ok, -1 in caso di errore (nessuno stato finale resta allocato)
+ */
+int esegui_varianti(const variante_t* varianti, int numero_varianti, const complesso_t* iniziale, long dimensione,
+                    int limite_buffer, esegui_tratto_t esegui, void* argomento, complesso_t** finali);
+
+/*
+ * Stampa il riepilogo dell'ultima esecuzione di varianti del thread chiamante: istruzioni delle varianti,
+ * nodi dell'albero, istruzioni effettivamente eseguite, stati conservati al massimo e rami ricalcolati.
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_prefissi(FILE* out);
+
+#endif
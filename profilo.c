@@ -0,0 +1,262 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "profilo.h"
+
+#define MAX_EVENTI (1 << 20)       // Limite degli eventi conservati per il file trace
+#define ISTRUZIONI_PIU_LENTE 10    // Istruzioni mostrate nel riepilogo
+
+/* Nuovo tipo che rappresenta un intervallo misurato (evento "X" del formato trace) */
+typedef struct {
+    char nome[32];          // Nome della fase, dell'operatore o del job
+    const char* categoria;  // "fase", "istruzione", "thread"
+    double inizio;          // Istante di inizio in microsecondi
+    double durata;          // Durata in microsecondi
+    int tid;                // 0 per il thread principale, 1..T per i thread della squadra
+    int indice;             // Indice dell'istruzione (-1 se non applicabile)
+} evento_t;
+
+/* Nuovo tipo che raccoglie le statistiche di un thread della squadra */
+typedef struct {
+    double lavoro;           // Tempo totale di calcolo
+    double attesa;           // Tempo totale in attesa di lavoro
+    double sbilanciamento;   // Tempo totale di attesa dell'ultimo thread del job
+    double ultima_fine;      // Fine del calcolo nel job corrente
+    int nel_job;             // 1 se il thread ha calcolato una parte del job corrente
+    unsigned long job;       // Numero di job eseguiti
+} statistiche_thread_t;
+
+int profilo_attivo = 0;
+
+static const char* g_file_trace = NULL;           // File trace da scrivere al termine (NULL se non richiesto)
+static struct timespec g_origine;                 // Istante di attivazione
+
+static pthread_mutex_t g_mutex_eventi = PTHREAD_MUTEX_INITIALIZER;  // Protegge l'array degli eventi
+static evento_t* g_eventi = NULL;
+static int g_numero_eventi = 0;
+static int g_capacita_eventi = 0;
+static int g_eventi_persi = 0;                    // Eventi scartati per superamento del limite
+
+static statistiche_thread_t* g_thread = NULL;     // Statistiche per ogni thread della squadra
+static int g_numero_thread = 0;
+
+
+/*
+ * Funzione di supporto che accoda un evento all'array (con il mutex degli eventi).
+ */
+static void aggiungi_evento(const char* nome, const char* categoria, double inizio, double fine, int tid, int indice) {
+    pthread_mutex_lock(&g_mutex_eventi);
+
+    if (g_numero_eventi == g_capacita_eventi) {    // Array pieno: raddoppia la capacità
+        int nuova = g_capacita_eventi ? 2 * g_capacita_eventi : 1024;
+        evento_t* tmp = (nuova <= MAX_EVENTI) ? realloc(g_eventi, nuova * sizeof(evento_t)) : NULL;
+        if (!tmp) {
+            g_eventi_persi++;
+            pthread_mutex_unlock(&g_mutex_eventi);
+            return;
+        }
+        g_eventi = tmp;
+        g_capacita_eventi = nuova;
+    }
+
+    evento_t* e = &g_eventi[g_numero_eventi++];
+    snprintf(e->nome, sizeof(e->nome), "%s", nome);     // Caratteri speciali gestiti da scrivi_stringa_json
+    e->categoria = categoria;
+    e->inizio = inizio;
+    e->durata = fine - inizio;
+    e->tid = tid;
+    e->indice = indice;
+
+    pthread_mutex_unlock(&g_mutex_eventi);
+}
+
+int profilo_attiva(const char* file_trace) {
+    clock_gettime(CLOCK_MONOTONIC, &g_origine);
+    g_file_trace = file_trace;
+    profilo_attivo = 1;
+    return 0;
+}
+
+double profilo_adesso(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec - g_origine.tv_sec) * 1e6 + (t.tv_nsec - g_origine.tv_nsec) / 1e3;
+}
+
+void profilo_fase(const char* nome, double inizio, double fine) {
+    if (!profilo_attivo) return;
+    aggiungi_evento(nome, "fase", inizio, fine, 0, -1);
+}
+
+void profilo_istruzione(int indice, const char* nome, double inizio, double fine) {
+    if (!profilo_attivo) return;
+    aggiungi_evento(nome, "istruzione", inizio, fine, 0, indice);
+}
+
+int profilo_inizializza_squadra(int numero_thread) {
+    if (!profilo_attivo) return 0;
+
+    free(g_thread);
+    g_thread = (statistiche_thread_t*)calloc(numero_thread, sizeof(statistiche_thread_t));
+    if (!g_thread) {
+        g_numero_thread = 0;
+        return -1;
+    }
+    g_numero_thread = numero_thread;
+    return 0;
+}
+
+void profilo_thread_job(int thread, double inizio_attesa, double inizio_lavoro, double fine_lavoro, int ha_lavorato) {
+    if (!profilo_attivo || thread < 0 || thread >= g_numero_thread) return;
+
+    statistiche_thread_t* s = &g_thread[thread];   // Ogni thread aggiorna solo il proprio slot
+    s->attesa += inizio_lavoro - inizio_attesa;
+    s->lavoro += fine_lavoro - inizio_lavoro;
+    s->ultima_fine = fine_lavoro;
+    s->nel_job = ha_lavorato;
+    s->job++;
+
+    aggiungi_evento("job", "thread", inizio_lavoro, fine_lavoro, thread + 1, -1);
+}
+
+void profilo_chiudi_job_squadra(void) {
+    if (!profilo_attivo) return;
+
+    /* Solo i thread che hanno calcolato una parte del job: chi non ha trovato pezzi liberi (grana > 0) non ha
+     * fatto attendere nessuno */
+    double ultima = 0.0;
+    for (int t = 0; t < g_numero_thread; t++) {    // Istante di fine dell'ultimo thread del job
+        if (g_thread[t].nel_job && g_thread[t].ultima_fine > ultima) ultima = g_thread[t].ultima_fine;
+    }
+    for (int t = 0; t < g_numero_thread; t++) {
+        if (g_thread[t].nel_job) g_thread[t].sbilanciamento += ultima - g_thread[t].ultima_fine;
+        g_thread[t].nel_job = 0;
+    }
+}
+
+
+/*
+ * Funzione di supporto per qsort: ordina gli indici degli eventi istruzione per durata decrescente.
+ */
+static int confronta_durata(const void* a, const void* b) {
+    double da = g_eventi[*(const int*)a].durata;
+    double db = g_eventi[*(const int*)b].durata;
+    return (da < db) - (da > db);
+}
+
+/*
+ * Funzione di supporto che stampa il riepilogo leggibile su out.
+ */
+static void stampa_riepilogo(FILE* out) {
+    fprintf(out, "\n=== Profilo ===\n");
+
+    fprintf(out, "\nFasi:\n");
+    for (int i = 0; i < g_numero_eventi; i++) {
+        if (strcmp(g_eventi[i].categoria, "fase") == 0) {
+            fprintf(out, "  %-26s %12.1f us\n", g_eventi[i].nome, g_eventi[i].durata);
+        }
+    }
+
+    /* Raccoglie gli eventi istruzione */
+    int numero_istruzioni = 0;
+    double totale_istruzioni = 0.0;
+    int* indici = (int*)malloc((g_numero_eventi + 1) * sizeof(int));
+    for (int i = 0; i < g_numero_eventi; i++) {
+        if (strcmp(g_eventi[i].categoria, "istruzione") == 0) {
+            if (indici) indici[numero_istruzioni] = i;
+            numero_istruzioni++;
+            totale_istruzioni += g_eventi[i].durata;
+        }
+    }
+
+    fprintf(out, "\nIstruzioni: %d, totale %.1f us, media %.1f us\n", numero_istruzioni, totale_istruzioni,
+            numero_istruzioni ? totale_istruzioni / numero_istruzioni : 0.0);
+    if (indici && numero_istruzioni > 0) {
+        qsort(indici, numero_istruzioni, sizeof(int), confronta_durata);
+        int mostrate = numero_istruzioni < ISTRUZIONI_PIU_LENTE ? numero_istruzioni : ISTRUZIONI_PIU_LENTE;
+        for (int k = 0; k < mostrate; k++) {
+            evento_t* e = &g_eventi[indici[k]];
+            fprintf(out, "  #%-6d %-24s %12.1f us\n", e->indice, e->nome, e->durata);
+        }
+    }
+    free(indici);
+
+    if (g_numero_thread > 0) {
+        fprintf(out, "\nThread della squadra:\n");
+        fprintf(out, "  %-6s %8s %14s %14s %16s\n", "thread", "job", "lavoro (us)", "attesa (us)", "sbilanc. (us)");
+        for (int t = 0; t < g_numero_thread; t++) {
+            statistiche_thread_t* s = &g_thread[t];
+            fprintf(out, "  %-6d %8lu %14.1f %14.1f %16.1f\n", t, s->job, s->lavoro, s->attesa, s->sbilanciamento);
+        }
+    }
+
+    if (g_eventi_persi > 0) {
+        fprintf(out, "\nAttenzione: %d eventi scartati (limite %d)\n", g_eventi_persi, MAX_EVENTI);
+    }
+}
+
+/*
+ * Funzione di supporto che scrive una stringa JSON tra virgolette: virgolette e backslash vengono preceduti da
+ * un backslash, i caratteri di controllo (sotto 0x20) scritti come \u00XX.
+ */
+static void scrivi_stringa_json(FILE* file, const char* testo) {
+    fputc('"', file);
+    for (const unsigned char* c = (const unsigned char*)testo; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(file, "\\%c", *c);
+        else if (*c < 0x20) fprintf(file, "\\u%04x", *c);
+        else fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+/*
+ * Funzione di supporto che scrive gli eventi nel formato Chrome trace-event (JSON).
+ * Ritorna: 0 se tutto ok, -1 se il file non è scrivibile
+ */
+static int scrivi_trace(const char* nome_file) {
+    FILE* file = fopen(nome_file, "w");
+    if (!file) {
+        perror(nome_file);
+        return -1;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"principale\"}}");
+    for (int t = 0; t < g_numero_thread; t++) {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"squadra %d\"}}", t + 1, t);
+    }
+
+    for (int i = 0; i < g_numero_eventi; i++) {
+        evento_t* e = &g_eventi[i];
+        fprintf(file, ",\n{\"name\":");
+        scrivi_stringa_json(file, e->nome);
+        fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d",
+                e->categoria, e->inizio, e->durata, e->tid);
+        if (e->indice >= 0) fprintf(file, ",\"args\":{\"indice\":%d}", e->indice);
+        fprintf(file, "}");
+    }
+
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+    return 0;
+}
+
+void profilo_termina(FILE* out) {
+    if (!profilo_attivo) return;
+
+    stampa_riepilogo(out);
+    if (g_file_trace) {
+        if (scrivi_trace(g_file_trace) == 0) {
+            fprintf(out, "\nTrace scritto in %s\n", g_file_trace);
+        }
+    }
+
+    free(g_eventi);
+    free(g_thread);
+    g_eventi = NULL;
+    g_thread = NULL;
+    g_numero_eventi = g_capacita_eventi = g_numero_thread = 0;
+    profilo_attivo = 0;
+}
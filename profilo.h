@@ -0,0 +1,69 @@
+#ifndef PROFILO_H
+#define PROFILO_H
+
+#include <stdio.h>
+
+/*
+ * Modulo di profilazione del simulatore.
+ * Registra i tempi delle fasi del programma (caricamento, analisi, esecuzione, output),
+ * il tempo di ogni istruzione del circuito (#circ) e, per ogni thread della squadra,
+ * il tempo di lavoro, di attesa e di sbilanciamento rispetto all'ultimo thread che termina un job.
+ * Quando la profilazione è disattiva ogni punto di misura si riduce al controllo di profilo_attivo.
+ */
+
+/* 1 se la profilazione è attiva, 0 altrimenti (letto direttamente nei punti di misura) */
+extern int profilo_attivo;
+
+/*
+ * Attiva la profilazione. Da chiamare prima di qualunque misura.
+ * Parametri: file_trace → percorso del file JSON (formato Chrome trace-event) da scrivere
+ * al termine, oppure NULL per stampare solo il riepilogo
+ * Ritorna: 0
+ */
+int profilo_attiva(const char* file_trace);
+
+/*
+ * Ritorna l'istante corrente in microsecondi (orologio monotono), relativo all'attivazione.
+ */
+double profilo_adesso(void);
+
+/*
+ * Registra una fase del programma (es. "caricamento", "output") eseguita dal thread principale.
+ * Parametri: nome → nome della fase (stringa costante), inizio/fine → istanti in microsecondi
+ */
+void profilo_fase(const char* nome, double inizio, double fine);
+
+/*
+ * Registra il tempo di esecuzione di un'istruzione del circuito.
+ * Parametri: indice → posizione in #circ, nome → nome dell'operatore, inizio/fine → istanti in microsecondi
+ */
+void profilo_istruzione(int indice, const char* nome, double inizio, double fine);
+
+/*
+ * Prepara le statistiche per una squadra di numero_thread thread.
+ * Ritorna: 0 se tutto ok, -1 in caso di errore di allocazione
+ */
+int profilo_inizializza_squadra(int numero_thread);
+
+/*
+ * Registra l'intervallo di attesa e quello di lavoro di un thread della squadra per un job.
+ * Parametri: thread → indice del thread, inizio_attesa → istante in cui il thread si è messo in attesa,
+ * inizio_lavoro/fine_lavoro → istanti del calcolo assegnato, ha_lavorato → 0 se il thread non ha trovato
+ * nessuna parte del job da calcolare (non conta per lo sbilanciamento)
+ */
+void profilo_thread_job(int thread, double inizio_attesa, double inizio_lavoro, double fine_lavoro, int ha_lavorato);
+
+/*
+ * Chiude un job della squadra accumulando lo sbilanciamento di ogni thread
+ * che ha calcolato una parte del job (tempo tra la fine del thread e la fine dell'ultimo thread del job).
+ * Va chiamata dall'ultimo thread che termina, con il mutex della squadra acquisito.
+ */
+void profilo_chiudi_job_squadra(void);
+
+/*
+ * Stampa il riepilogo (fasi, istruzioni, thread) e, se richiesto, scrive il file trace.
+ * Parametri: out → stream su cui stampare il riepilogo
+ */
+void profilo_termina(FILE* out);
+
+#endif
@@ -0,0 +1,855 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "qsim.h"
+#include "lettore_input.h"
+#include "thread_matrice.h"
+#include "matrice.h"
+#include "profilo.h"
+#include "contatori_hw.h"
+#include "kernel_piccoli.h"
+#include "distribuito.h"
+#include "caricamento_pipeline.h"
+#include "porte.h"
+#include "kronecker.h"
+#include "rimappatura.h"
+#include "supporto.h"
+#include "cache_unitari.h"
+#include "taratura.h"
+#include "memoria.h"
+#include "prefissi.h"
+#include "flusso.h"
+#include "archivio_operatori.h"
+#include "verifica.h"
+#include "piano.h"
+#include "traccia.h"
+#include "parametri.h"
+#include "riduzione.h"
+
+
+/* Stato di un contesto di simulazione: tutto ciò che prima apparteneva al main e ai globali del modulo dei thread */
+struct qsim_contesto {
+    qsim_opzioni_t opzioni;         // Opzioni date alla creazione
+    char* file_circuito;            // Copia del percorso (serve al caricamento in pipeline e ai processi distribuiti)
+    dati_input_t dati;              // Dati letti dai file
+    long dimensione;                // 2^numero_qubit, 0 finché non caricato
+    int compilato;                  // 1 dopo qsim_compila
+    squadra_t* squadra;             // Squadra del contesto, NULL se non serve
+    caricamento_t* caricamento;     // Caricamento in pipeline, attivo solo fino alla fine della prima esecuzione
+    complesso_t* stato_finale;      // Stato finale dell'ultima qsim_esegui (può coincidere con lo stato iniziale)
+    unitario_fuso_t** fusi;         // Unitari dei tratti di istruzioni dense (con la cache), NULL se non fusi
+    int kernel_piccoli;             // 1 per eseguire con i kernel specializzati senza squadra (N <= 5)
+    complesso_t** finali_varianti;  // Stati finali dell'ultima qsim_esegui_varianti, NULL se non eseguita
+    int pianificato;                // 1 dopo qsim_pianifica: ci sono solo i metadati, niente da compilare
+    double* valori_parametri;       // Tabella dei parametri (numero_punti righe di dati.numero_parametri valori), NULL se non letta
+    int numero_punti;               // Righe della tabella dei parametri
+    traccia_t* traccia;             // Traccia degli stati intermedi (--trace), NULL se non richiesta o già chiusa
+    verifica_t* verifica;           // Verifica dei kernel (--verify), NULL se non richiesta
+};
+
+
+/* Carica e valida i due file nella struttura "dati". Ritorna 0 se ok, -1 se errore. */
+static int carica_input(const qsim_opzioni_t* opt, const char* file_iniziale, const char* file_circuito,
+                        dati_input_t* dati, long* dimensione) {
+    if (!opt || !dati || !dimensione) return -1;
+
+    /* File iniziale: #qubits e #init */
+    double t0 = profilo_attivo ? profilo_adesso() : 0.0;
+    if (leggi_input(file_iniziale, dati) != 0) return -1;
+    if (profilo_attivo) profilo_fase("analisi file iniziale", t0, profilo_adesso());
+    if (!(dati->numero_qubit > 0 && (dati->stato_iniziale != NULL || opt->flusso))) return -1;   // Con il flusso #init è facoltativo
+
+    /* Dimensione = 2^numero_qubit */
+    *dimensione = 1L << dati->numero_qubit; // shift a sinistra di numero_qubit posizioni
+
+    /* Verifica compatibilità dimensioni */
+    int dim_operatori = dimensione_operatori(file_circuito);   // Dimensione operatori
+
+    /* Se le due dimensioni non coincidono il circuito non può essere applicato allo stato iniziale
+     * (0: nessuna matrice, il circuito usa solo porte predefinite che vengono validate durante la lettura) */
+    if (dim_operatori < 0 || (dim_operatori != 0 && *dimensione != dim_operatori)) return -1;
+
+    /* Con matrici dense serve un vettore in più per il risultato di ogni moltiplicazione */
+    if (dim_operatori != 0 && verifica_memoria(dati->numero_qubit, COPIE_STATO_DENSO) != 0) return -1;
+
+    /* Simulazione distribuita: ogni processo leggerà solo il proprio blocco di righe degli operatori */
+    if (opt->numero_processi > 1) return 0;
+                                                     
+    /* File circuito: #define e #circ (con --pipeline solo l'indice, le matrici vengono lette durante l'esecuzione) */
+    double t1 = profilo_attivo ? profilo_adesso() : 0.0;
+    if (opt->pipeline) {
+        if (indicizza_input(file_circuito, dati) != 0) return -1;
+        if (profilo_attivo) profilo_fase("indice file circuito", t1, profilo_adesso());
+    } else {
+        /* Archivio condiviso tra processi: va creato prima di leggere i #define (altrimenti ne viene creato uno locale) */
+        if (opt->operatori_condivisi && !(dati->archivio = crea_archivio_operatori(1))) return -1;
+        if (leggi_input(file_circuito, dati) != 0) return -1;
+        if (profilo_attivo) profilo_fase("analisi file circuito", t1, profilo_adesso());
+    }
+
+    /* Varianti del circuito: le matrici che definiscono devono avere la stessa dimensione dello stato */
+    if (opt->file_varianti) {
+        int dim_varianti = dimensione_operatori(opt->file_varianti);
+        if (dim_varianti < 0 || (dim_varianti != 0 && *dimensione != dim_varianti)) return -1;
+        if (leggi_varianti(opt->file_varianti, dati) != 0) return -1;
+    }
+    if (!(dati->numero_operatori > 0 && (dati->circuito != NULL || dati->numero_varianti > 0))) return -1;
+
+    /* Le porte con parametri simbolici hanno un angolo solo nei punti della tabella */
+    if (dati->numero_parametri > 0 && !opt->file_parametri) {
+        fprintf(stderr, "Il circuito ha parametri simbolici (es. %s): serve la tabella dei loro valori (--sweep)\n", dati->parametri[0]);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Ritorna l'operatore dell'istruzione i: dal caricamento in pipeline se attivo (nell'ordine di #circ),
+ * altrimenti cercandolo per nome. NULL se non definito o non caricabile. */
+static operatore_quantistico_t* operatore_istruzione(const dati_input_t* dati, caricamento_t* caricamento, int i) {
+    if (caricamento) return prossimo_operatore(caricamento);
+    return trova_operatore((dati_input_t*)dati, dati->circuito[i].nome_operatore);
+}
+
+/* Esegue il circuito con i kernel specializzati per dimensioni piccole (N <= 5), senza squadra di thread.
+ * Gli operatori usati vengono copiati una sola volta in forma compatta e lo stato alterna tra due buffer.
+ * Gli stati dopo le istruzioni selezionate vanno nella traccia, se non è NULL, e i kernel vengono confrontati con il
+ * riferimento se verifica non è NULL. Ritorna 0 se ok, -1 se errore. */
+static int esegui_circuito_piccolo(const dati_input_t* dati, long dimensione, caricamento_t* caricamento, traccia_t* traccia,
+                                   verifica_t* verifica, const complesso_t* iniziale, complesso_t** stato_finale) {
+    int ret = -1;
+    matrice_piccola_t* compatte = (matrice_piccola_t*)calloc(dati->numero_operatori, sizeof(matrice_piccola_t));
+    complesso_t* buffer[2] = {
+        (complesso_t*)malloc(dimensione * sizeof(complesso_t)),
+        (complesso_t*)malloc(dimensione * sizeof(complesso_t))
+    };
+    if (!compatte || !buffer[0] || !buffer[1]) goto fine;
+
+    complesso_t* stato = (complesso_t*)iniziale;               // Non viene mai modificato: si lavora nei buffer
+    int corrente = 0;                                           // Buffer in cui scrivere il prossimo stato
+
+    for (int i = 0; i < dati->numero_istruzioni; i++) {
+        const char* nome_op = dati->circuito[i].nome_operatore;
+        operatore_quantistico_t* op = operatore_istruzione(dati, caricamento, i);
+        if (!op || (!op->matrice && !op->porte)) goto fine;
+
+        if (op->porte) {                                        // Porte: applicate sul posto al buffer corrente
+            double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+            if (stato == iniziale) {                            // Lo stato iniziale non va modificato
+                memcpy(buffer[corrente], stato, dimensione * sizeof(complesso_t));
+                stato = buffer[corrente];
+                corrente = 1 - corrente;
+            }
+            complesso_t* prima = NULL;                          // Copia per la verifica, se l'istruzione è estratta
+            if (verifica_estrai(verifica) && (prima = alloca_stato(dimensione, 0)) != NULL)
+                memcpy(prima, stato, dimensione * sizeof(complesso_t));
+            if (applica_porte(op->porte, op->numero_porte, stato, dati->numero_qubit) != 0) {
+                free(prima);
+                goto fine;
+            }
+            if (prima) {
+                const porta_t** porte = (const porta_t**)malloc(op->numero_porte * sizeof(const porta_t*));
+                if (porte) {
+                    for (int k = 0; k < op->numero_porte; k++) porte[k] = &op->porte[k];
+                    verifica_porte(verifica, KERNEL_PORTE, porte, op->numero_porte, prima, stato, dati->numero_qubit, i, nome_op);
+                }
+                free(porte);
+                free(prima);
+            }
+            if (profilo_attivo) profilo_istruzione(i, nome_op, inizio, profilo_adesso());
+            if (traccia && traccia_selezionata(traccia, i, nome_op) &&
+                traccia_registra(traccia, i, nome_op, stato, dimensione) != 0) goto fine;
+            continue;
+        }
+
+        matrice_piccola_t* p = &compatte[op - dati->operatori];
+        if (p->re == NULL && prepara_matrice_piccola(op->matrice, p) != 0) goto fine;   // Prima volta che l'operatore viene usato
+
+        double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+
+        moltiplica_matrice_vettore_piccola(p, stato, buffer[corrente]);
+        if (verifica_estrai(verifica))
+            verifica_matrici(verifica, KERNEL_PICCOLO, &op->matrice, 1, stato, buffer[corrente], dimensione, i, nome_op);
+        stato = buffer[corrente];
+        corrente = 1 - corrente;
+
+        if (profilo_attivo) profilo_istruzione(i, nome_op, inizio, profilo_adesso());
+        if (traccia && traccia_selezionata(traccia, i, nome_op) &&
+            traccia_registra(traccia, i, nome_op, stato, dimensione) != 0) goto fine;
+    }
+
+    if (stato == iniziale) {                                    // Circuito vuoto: lo stato finale è quello iniziale
+        *stato_finale = stato;
+    } else {
+        *stato_finale = buffer[1 - corrente];                   // Il buffer con l'ultimo stato passa al chiamante
+        buffer[1 - corrente] = NULL;
+    }
+    ret = 0;
+
+fine:
+    if (compatte) {
+        for (int k = 0; k < dati->numero_operatori; k++) libera_matrice_piccola(&compatte[k]);
+    }
+    free(compatte);
+    free(buffer[0]);
+    free(buffer[1]);
+    return ret;
+}
+
+/* Applica insieme le porte delle istruzioni consecutive formate da porte, a partire dalla i-esima (il cui
+ * operatore op è già stato ottenuto), così che i tratti sui qubit bassi costino una sola passata sullo stato.
+ * Ritorna l'indice della prima istruzione non applicata e in *successivo il suo operatore (NULL se il
+ * circuito è finito), -1 se errore. */
+static int esegui_porte_consecutive(const dati_input_t* dati, caricamento_t* caricamento, const traccia_t* traccia,
+                                    verifica_t* verifica, int i, operatore_quantistico_t* op, complesso_t* stato,
+                                    operatore_quantistico_t** successivo) {
+    int primo = i;
+    int numero = 0, capacita = 0;
+    const porta_t** sequenza = NULL;
+    double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+    if (contatori_attivi) contatori_imposta_operatore((int)(op - dati->operatori));    // Il tratto viene attribuito al primo operatore
+
+    while (op && op->porte) {
+        if (numero + op->numero_porte > capacita) {
+            capacita = 2 * (numero + op->numero_porte);
+            const porta_t** tmp = (const porta_t**)realloc(sequenza, capacita * sizeof(const porta_t*));
+            if (!tmp) {
+                free(sequenza);
+                return -1;
+            }
+            sequenza = tmp;
+        }
+        for (int k = 0; k < op->numero_porte; k++) sequenza[numero++] = &op->porte[k];
+
+        /* Lo stato dopo un'istruzione da tracciare deve esistere: la sequenza si chiude lì */
+        int tracciata = traccia && traccia_selezionata(traccia, i, dati->circuito[i].nome_operatore);
+        op = ++i < dati->numero_istruzioni ? operatore_istruzione(dati, caricamento, i) : NULL;
+        if (!op && i < dati->numero_istruzioni) {   // Operatore non definito o non caricabile
+            free(sequenza);
+            return -1;
+        }
+        if (tracciata) break;
+    }
+
+    long dimensione = 1L << dati->numero_qubit;
+    complesso_t* prima = NULL;                  // Copia dello stato per la verifica, se l'istruzione è estratta
+    if (verifica_estrai(verifica) && (prima = alloca_stato(dimensione, 0)) != NULL)
+        memcpy(prima, stato, dimensione * sizeof(complesso_t));
+
+    int esito = applica_sequenza_rimappata(sequenza, numero, stato, dati->numero_qubit);
+    if (esito == 0 && prima)
+        verifica_porte(verifica, KERNEL_PORTE, sequenza, numero, prima, stato, dati->numero_qubit, primo, dati->circuito[primo].nome_operatore);
+    free(prima);
+    free(sequenza);
+    if (esito != 0) return -1;
+
+    if (profilo_attivo) profilo_istruzione(primo, dati->circuito[primo].nome_operatore, inizio, profilo_adesso());
+    *successivo = op;
+    return i;
+}
+
+/* Confronta con il riferimento la moltiplicazione appena eseguita per l'istruzione i, di operatore op, o per
+ * il tratto fuso di passo istruzioni che inizia da i. Le matrici originali di un tratto fuso vengono prese dal
+ * circuito letto: con il caricamento in pipeline non sono più disponibili e il tratto non viene verificato. */
+static void verifica_denso(verifica_t* verifica, const dati_input_t* dati, caricamento_t* caricamento, int i, int passo,
+                           operatore_quantistico_t* op, int sparso, const complesso_t* stato, const complesso_t* nuovo_stato,
+                           long dimensione) {
+    const char* nome = dati->circuito[i].nome_operatore;
+    if (passo == 1) {
+        verifica_matrici(verifica, sparso ? KERNEL_SUPPORTO : KERNEL_DENSO, &op->matrice, 1, stato, nuovo_stato, dimensione, i, nome);
+        return;
+    }
+    if (caricamento) return;
+
+    matrice_t** matrici = (matrice_t**)malloc(passo * sizeof(matrice_t*));
+    if (!matrici) return;
+    for (int k = 0; k < passo; k++) {
+        operatore_quantistico_t* originale = trova_operatore((dati_input_t*)dati, dati->circuito[i + k].nome_operatore);
+        matrici[k] = originale ? originale->matrice : NULL;
+    }
+    verifica_matrici(verifica, KERNEL_FUSO, matrici, passo, stato, nuovo_stato, dimensione, i, nome);
+    free(matrici);
+}
+
+/* Ritorna 1 se un'istruzione del tratto fuso di numero istruzioni che inizia da i, prima dell'ultima, va
+ * tracciata: il suo stato non esiste con l'unitario fuso, quindi il tratto viene eseguito istruzione per istruzione. */
+static int tratto_tracciato(const dati_input_t* dati, const traccia_t* traccia, int i, int numero) {
+    for (int k = i; k < i + numero - 1; k++) {
+        if (traccia_selezionata(traccia, k, dati->circuito[k].nome_operatore)) return 1;
+    }
+    return 0;
+}
+
+/* Esegue il circuito a partire dallo stato iniziale: per ogni istruzione fa stato = M * stato. Lo stato
+ * finale è un nuovo vettore, oppure iniziale stesso se il circuito è vuoto. Gli operatori arrivano dal
+ * caricamento in pipeline se attivo (caricamento != NULL). Un tratto di istruzioni dense con un unitario
+ * fuso (fusi[i] != NULL, fusi può essere NULL) costa una sola moltiplicazione. Finché lo stato ha poche
+ * ampiezze non nulle le moltiplicazioni usano solo le colonne corrispondenti. Con traccia != NULL gli stati
+ * dopo le istruzioni selezionate vengono registrati (traccia.h); con verifica != NULL una frazione dei kernel
+ * viene confrontata con il riferimento (verifica.h). Ritorna 0 se ok, -1 se errore. */
+static int esegui_circuito(const dati_input_t* dati, long dimensione, caricamento_t* caricamento, unitario_fuso_t* const* fusi,
+                           int kernel_piccoli, traccia_t* traccia, verifica_t* verifica, const complesso_t* iniziale,
+                           complesso_t** stato_finale) {
+    if (!dati || dimensione <= 0 || !iniziale || !stato_finale) return -1;
+    if (traccia) traccia_nuova_esecuzione(traccia);
+
+    /* Per N <= 5 il giro nella squadra di thread di solito costa più del calcolo: si usano i kernel specializzati */
+    if (kernel_piccoli) return esegui_circuito_piccolo(dati, dimensione, caricamento, traccia, verifica, iniziale, stato_finale);
+
+    complesso_t* stato = (complesso_t*)iniziale; // Stato iniziale (da #init o dal chiamante), mai modificato
+
+    supporto_t supporto;                         // Ampiezze non nulle dello stato, finché sono poche
+    if (inizializza_supporto(&supporto, stato, dimensione) != 0) return -1;
+
+    operatore_quantistico_t* op = NULL;          // Operatore dell'istruzione i, se già ottenuto
+
+    for (int i = 0; i < dati->numero_istruzioni; ) {        // Per ogni istruzione presa da #circ
+        const char* nome_op = dati->circuito[i].nome_operatore;     // Prende il nome dell'operatore
+        if (!op) op = operatore_istruzione(dati, caricamento, i);   // Lo cerca nell'array che li contiene (o lo attende dal caricamento)
+
+        if (!op || (!op->matrice && !op->porte)) goto errore;       // Operatore non trovato o matrice non valida
+
+        if (op->porte) {                                    // Porte: aggiornamento sul posto, insieme a quelle delle istruzioni successive
+            if (stato == iniziale) {            // Lo stato iniziale non va modificato: se ne lavora una copia
+                stato = alloca_stato(dimensione, 0);
+                if (!stato) {
+                    stato = (complesso_t*)iniziale;
+                    goto errore;
+                }
+                memcpy(stato, iniziale, dimensione * sizeof(complesso_t));
+            }
+            i = esegui_porte_consecutive(dati, caricamento, traccia, verifica, i, op, stato, &op);
+            if (i < 0) goto errore;
+            aggiorna_supporto(&supporto, stato);            // Le porte possono aver allargato il supporto
+            if (traccia && traccia_selezionata(traccia, i - 1, dati->circuito[i - 1].nome_operatore) &&
+                traccia_registra(traccia, i - 1, dati->circuito[i - 1].nome_operatore, stato, dimensione) != 0) goto errore;
+            continue;
+        }
+
+        double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+        if (contatori_attivi) contatori_imposta_operatore((int)(op - dati->operatori));    // Attribuisce il job all'operatore
+
+        matrice_t* matrice = op->matrice;                   // Matrice dell'istruzione, o unitario del tratto che inizia da i
+        int passo = 1;
+        if (fusi && fusi[i] && !(traccia && tratto_tracciato(dati, traccia, i, fusi[i]->numero_istruzioni))) {
+            matrice = fusi[i]->matrice;
+            passo = fusi[i]->numero_istruzioni;
+        }
+
+        int sparso = supporto_sparso(&supporto);
+        complesso_t* nuovo_stato = sparso                   // Puntatore al vettore che conterrà lo stato aggiornato
+                                 ? moltiplica_supporto(matrice, stato, &supporto)
+                                 : moltiplica_matrice_vettore_mt_riuso(matrice, stato);
+        if (!nuovo_stato) goto errore;
+
+        if (verifica_estrai(verifica))
+            verifica_denso(verifica, dati, caricamento, i, passo, op, sparso, stato, nuovo_stato, dimensione);
+
+        if (stato != iniziale) free(stato);     // Se lo stato non è quello iniziale, liberiamo la memoria perché non servirà più
+        stato = nuovo_stato;                                // Aggiorniamo lo stato con il nuovo stato
+
+        if (profilo_attivo) profilo_istruzione(i, nome_op, inizio, profilo_adesso());
+        if (traccia && traccia_selezionata(traccia, i + passo - 1, dati->circuito[i + passo - 1].nome_operatore) &&
+            traccia_registra(traccia, i + passo - 1, dati->circuito[i + passo - 1].nome_operatore, stato, dimensione) != 0)
+            goto errore;                                    // Stato intermedio (--trace)
+
+        op = NULL;
+        i += passo;
+    }
+
+    libera_supporto(&supporto);
+    *stato_finale = stato;      // Aggiorniamo lo stato finale con stato calcolato
+    return 0;
+
+errore:
+    if (stato != iniziale) free(stato);   // Libera eventualmente la memoria e lancia errore
+    libera_supporto(&supporto);
+    return -1;
+}
+
+
+void qsim_opzioni_default(qsim_opzioni_t* opzioni) {
+    if (!opzioni) return;
+    opzioni->numero_thread = 1;
+    opzioni->numero_processi = 1;
+    opzioni->trasporto = "shm";
+    opzioni->pipeline = 0;
+    opzioni->tolleranza = TOLLERANZA_FATTORIZZAZIONE;
+    opzioni->contatori = 0;
+    opzioni->cache = NULL;
+    opzioni->limite_cache = LIMITE_CACHE_MIB;
+    opzioni->file_taratura = NULL;
+    opzioni->file_varianti = NULL;
+    opzioni->buffer_varianti = BUFFER_VARIANTI;
+    opzioni->flusso = 0;
+    opzioni->stadi_flusso = 0;
+    opzioni->operatori_condivisi = 0;
+    opzioni->file_parametri = NULL;
+    opzioni->riduzione = -1.0;
+    opzioni->file_traccia = NULL;
+    opzioni->traccia_ogni = 0;
+    opzioni->traccia_nomi = NULL;
+    opzioni->traccia_comprimi = 0;
+    opzioni->verifica = 0.0;
+}
+
+int qsim_verifica_opzioni(const qsim_opzioni_t* opzioni, int piano, int profilo) {
+    if (!opzioni || opzioni->numero_thread < 0 || opzioni->numero_processi <= 0 || opzioni->limite_cache < 0) return -1;
+    if (!opzioni->trasporto || !trasporto_disponibile(opzioni->trasporto)) return -1;
+    /* Le varianti, la tabella dei parametri e la riduzione richiedono tutte le matrici in memoria */
+    if (opzioni->file_varianti && (opzioni->pipeline || opzioni->numero_processi > 1 || opzioni->buffer_varianti < 0)) return -1;
+    if (opzioni->file_parametri && (opzioni->pipeline || opzioni->numero_processi > 1 || opzioni->file_varianti ||
+                                    opzioni->flusso || opzioni->contatori)) return -1;
+    if (opzioni->riduzione >= 0.0 && (opzioni->pipeline || opzioni->numero_processi > 1 || opzioni->file_varianti)) return -1;
+    /* Gli stadi del flusso hanno squadre concorrenti, mentre le statistiche per thread della profilazione
+     * descrivono una sola squadra alla volta */
+    if (opzioni->flusso && (opzioni->pipeline || opzioni->numero_processi > 1 || opzioni->file_varianti || opzioni->contatori ||
+                            profilo || opzioni->stadi_flusso < 0 || opzioni->stadi_flusso > MAX_STADI_FLUSSO)) return -1;
+    /* La traccia registra lo stato di #init eseguito dalla squadra del contesto; la riduzione cambierebbe gli
+     * indici delle istruzioni di #circ */
+    if (opzioni->file_traccia && (opzioni->numero_processi > 1 || opzioni->file_varianti || opzioni->flusso ||
+                                  opzioni->file_parametri || opzioni->riduzione >= 0.0 || opzioni->traccia_ogni < 0)) return -1;
+    /* I processi della simulazione distribuita hanno solo una parte dello stato */
+    if (opzioni->verifica < 0.0 || opzioni->verifica > 1.0 || (opzioni->verifica > 0.0 && opzioni->numero_processi > 1)) return -1;
+    /* Il piano legge solo i metadati dei file: nessuno stato da distribuire, registrare, verificare o misurare */
+    if (piano && (opzioni->numero_processi > 1 || opzioni->file_varianti || opzioni->flusso || opzioni->contatori ||
+                  opzioni->verifica > 0.0 || opzioni->file_traccia || opzioni->file_parametri || opzioni->riduzione >= 0.0)) return -1;
+    return 0;
+}
+
+qsim_contesto_t* qsim_crea(const qsim_opzioni_t* opzioni) {
+    if (qsim_verifica_opzioni(opzioni, 0, profilo_attivo) != 0) return NULL;
+
+    qsim_contesto_t* ctx = (qsim_contesto_t*)calloc(1, sizeof(qsim_contesto_t));
+    if (!ctx) return NULL;
+    ctx->opzioni = *opzioni;
+    if (opzioni->verifica > 0.0 && !(ctx->verifica = verifica_crea(opzioni->verifica))) {
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+int qsim_carica(qsim_contesto_t* ctx, const char* file_iniziale, const char* file_circuito) {
+    if (!ctx || !file_iniziale || !file_circuito || ctx->dimensione > 0) return -1;
+
+    ctx->file_circuito = strdup(file_circuito);
+    if (!ctx->file_circuito) return -1;
+
+    long dimensione = 0;
+    if (carica_input(&ctx->opzioni, file_iniziale, file_circuito, &ctx->dati, &dimensione) != 0) return -1;
+    if (ctx->opzioni.file_parametri &&
+        leggi_tabella_parametri(ctx->opzioni.file_parametri, &ctx->dati, &ctx->valori_parametri, &ctx->numero_punti) != 0) return -1;
+    ctx->dimensione = dimensione;
+    return 0;
+}
+
+/* Funzione di supporto: processori disponibili, limite dei thread provati con -t auto */
+static int massimo_thread(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+int qsim_pianifica(qsim_contesto_t* ctx, const char* file_iniziale, const char* file_circuito, FILE* out) {
+    if (!ctx || !file_iniziale || !file_circuito || !out || ctx->dimensione > 0) return -1;
+    const qsim_opzioni_t* opt = &ctx->opzioni;
+    if (qsim_verifica_opzioni(opt, 1, profilo_attivo) != 0) return -1;
+
+    /* Solo #qubits dal file iniziale (niente stato, niente controllo della memoria: il piano la confronta) */
+    int numero_qubit = leggi_qubits(file_iniziale);
+    if (numero_qubit <= 0 || numero_qubit > MAX_QUBIT_STATO) return -1;
+    ctx->dati.numero_qubit = numero_qubit;
+    long dimensione = 1L << numero_qubit;
+
+    int dim_operatori = dimensione_operatori(file_circuito);
+    if (dim_operatori < 0 || (dim_operatori != 0 && dimensione != dim_operatori)) return -1;
+    if (indicizza_input(file_circuito, &ctx->dati) != 0) return -1;     // Porte costruite, matrici solo registrate
+    if (!(ctx->dati.numero_operatori > 0 && ctx->dati.circuito != NULL)) return -1;
+    ctx->dimensione = dimensione;
+    ctx->pianificato = 1;
+
+    /* Le stesse scelte di qsim_compila; con -t auto quelle salvate dalla taratura, se presenti */
+    configurazione_piano_t c;
+    memset(&c, 0, sizeof(c));
+    c.numero_thread = opt->numero_thread == QSIM_THREAD_AUTO ? massimo_thread() : opt->numero_thread;
+    if (c.numero_thread > dimensione) c.numero_thread = dimensione;
+    c.kernel_piccoli = kernel_piccolo_disponibile(dimensione);
+    c.pipeline = opt->pipeline;
+    c.cache = opt->cache != NULL;
+    c.operatori_condivisi = opt->operatori_condivisi && !opt->pipeline;
+    c.fattorizzazione = opt->tolleranza >= 0.0;
+
+    taratura_t tarata;
+    if (stima_taratura(&ctx->dati, dimensione, opt->file_taratura, &tarata, &c.dimensione_tarata) == 0) {
+        c.tempo_denso = tarata.tempo_denso;
+        c.tempo_porta = tarata.tempo_porta;
+        if (opt->numero_thread == QSIM_THREAD_AUTO) {
+            c.numero_thread = tarata.numero_thread;
+            c.grana = tarata.grana;
+            c.kernel_piccoli = tarata.kernel_piccoli;
+            c.configurazione_tarata = 1;
+        }
+    } else {
+        c.dimensione_tarata = 0;
+    }
+    return scrivi_piano(&ctx->dati, &c, out);
+}
+
+int qsim_compila(qsim_contesto_t* ctx) {
+    if (!ctx || ctx->dimensione == 0 || ctx->compilato || ctx->pianificato) return -1;
+    const qsim_opzioni_t* opt = &ctx->opzioni;
+
+    /* Limita numero_thread per evitare thread idle:
+     * Se il numero di thread è maggiore alla dimensione della matrice, avremo un overhaed di creazioni (di thread) e thread idle (senza lavoro)
+     * Limitiamo quindi il numero di thread alla dimensione così da dare almeno un lavoro ad ogni thread e limitare il costo. */
+    int automatico = opt->numero_thread == QSIM_THREAD_AUTO;
+    int numero_thread = automatico ? massimo_thread() : opt->numero_thread;     // Con -t auto: tutti fino alla taratura
+    if (numero_thread > ctx->dimensione) numero_thread = ctx->dimensione;
+    ctx->kernel_piccoli = kernel_piccolo_disponibile(ctx->dimensione);
+
+    /* Riduzione algebrica del circuito: prima dei contatori (che contano gli operatori, comprese le nuove
+     * porte U^k) e della fattorizzazione e della fusione, che lavorano così solo sulle istruzioni rimaste */
+    if (opt->riduzione >= 0.0) {
+        double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+        if (riduci_circuito(&ctx->dati, opt->riduzione) < 0) {
+            fprintf(stderr, "Errore: riduzione del circuito fallita\n");
+            return -1;
+        }
+        if (profilo_attivo) profilo_fase("riduzione del circuito", inizio, profilo_adesso());
+    }
+
+    /* Caricamento in pipeline: le matrici vengono lette mentre la squadra viene creata e il circuito eseguito */
+    if (opt->pipeline && opt->numero_processi == 1) {
+        ctx->caricamento = avvia_caricamento(&ctx->dati, ctx->file_circuito, opt->tolleranza);
+        if (!ctx->caricamento) {
+            fprintf(stderr, "Errore: impossibile avviare il caricamento in pipeline\n");
+            return -1;
+        }
+    }
+
+    /* Contatori hardware: vanno attivati prima di creare la squadra */
+    if (opt->contatori && opt->numero_processi == 1 && contatori_attiva(ctx->dati.numero_operatori) != 0) {
+        fprintf(stderr, "Errore: impossibile attivare i contatori hardware\n");
+        return -1;
+    }
+
+    /* Crea la squadra di thread (non serve per le dimensioni gestite dai kernel specializzati, tranne che per
+     * dividere tra i thread i punti della scansione dei parametri, né nella simulazione distribuita, dove ogni
+     * processo calcola il proprio blocco) */
+    if ((!ctx->kernel_piccoli || opt->file_parametri) && opt->numero_processi == 1) {
+        double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+        ctx->squadra = crea_squadra(numero_thread, ctx->dimensione);
+        if (!ctx->squadra) {
+            fprintf(stderr, "Errore: impossibile inizializzare la squadra di thread\n");
+            return -1;
+        }
+        if (profilo_attivo) profilo_fase("creazione squadra", inizio, profilo_adesso());
+    }
+
+    /* Operatori che sono prodotti di Kronecker: diventano sequenze di porte locali, con la ricerca del perno e
+     * le verifiche divise tra i thread della squadra appena creata (con --pipeline durante il caricamento) */
+    if (!opt->pipeline && opt->numero_processi == 1) {
+        double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+        squadra_t* precedente = imposta_squadra_corrente(ctx->squadra);
+        int fattorizzati = fattorizza_operatori(&ctx->dati, opt->tolleranza);
+        imposta_squadra_corrente(precedente);
+        if (fattorizzati < 0) return -1;
+        if (profilo_attivo) profilo_fase("fattorizzazione", inizio, profilo_adesso());
+    }
+
+    /* Cache degli unitari: i tratti di istruzioni dense vengono mappati dalla cartella o calcolati (con la
+     * squadra) e salvati. Servono le matrici complete e la squadra, quindi niente pipeline, -p o kernel piccoli */
+    if (opt->cache && !opt->pipeline && opt->numero_processi == 1 && ctx->squadra && ctx->dati.numero_istruzioni > 0) {
+        double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+        squadra_t* precedente = imposta_squadra_corrente(ctx->squadra);
+        ctx->fusi = fondi_istruzioni(&ctx->dati, opt->cache, opt->limite_cache);
+        imposta_squadra_corrente(precedente);
+        if (!ctx->fusi) {
+            fprintf(stderr, "Errore: impossibile fondere le istruzioni del circuito\n");
+            return -1;
+        }
+        if (profilo_attivo) profilo_fase("unitari fusi", inizio, profilo_adesso());
+    }
+
+    /* -t auto: numero di thread, grana e variante dei kernel dal file di taratura o da brevi misure, poi la
+     * squadra viene ricreata con la configurazione scelta */
+    if (automatico && opt->numero_processi == 1) {
+        double inizio = profilo_attivo ? profilo_adesso() : 0.0;
+        taratura_t scelta;
+        if (tara_esecuzione(&ctx->dati, ctx->dimensione, massimo_thread(), opt->file_taratura, &scelta) != 0) {
+            fprintf(stderr, "Errore: taratura dell'esecuzione fallita\n");
+            return -1;
+        }
+        ctx->kernel_piccoli = scelta.kernel_piccoli;
+        /* Le squadre di prova della taratura reinizializzano lo stato per thread di profilo e contatori, che
+         * descriverebbe l'ultima di esse: la squadra del contesto viene quindi sempre ricreata (con i thread
+         * scelti, o con quelli di prima se servono i kernel specializzati ma la squadra c'era già) */
+        if (!scelta.kernel_piccoli || ctx->squadra) {
+            int thread_squadra = scelta.kernel_piccoli ? numero_thread_squadra(ctx->squadra) : scelta.numero_thread;
+            distruggi_squadra(ctx->squadra);
+            ctx->squadra = crea_squadra(thread_squadra, ctx->dimensione);
+            if (!ctx->squadra) {
+                fprintf(stderr, "Errore: impossibile inizializzare la squadra di thread\n");
+                return -1;
+            }
+        }
+        imposta_grana_squadra(ctx->squadra, scelta.grana);
+        if (profilo_attivo) profilo_fase("taratura", inizio, profilo_adesso());
+    }
+
+    /* Traccia degli stati intermedi, con la dimensione dello stato di questo contesto */
+    if (opt->file_traccia) {
+        ctx->traccia = traccia_apri(opt->file_traccia, ctx->dati.numero_qubit, opt->traccia_ogni, opt->traccia_nomi,
+                                    opt->traccia_comprimi);
+        if (!ctx->traccia) {
+            fprintf(stderr, "Errore: impossibile aprire il file della traccia %s\n", opt->file_traccia);
+            return -1;
+        }
+    }
+
+    ctx->compilato = 1;
+    return 0;
+}
+
+/* Funzione di supporto: libera lo stato finale dell'esecuzione precedente, se è memoria del contesto */
+static void libera_stato_finale(qsim_contesto_t* ctx) {
+    if (ctx->stato_finale && ctx->stato_finale != ctx->dati.stato_iniziale) free(ctx->stato_finale);
+    ctx->stato_finale = NULL;
+}
+
+/* Funzione di supporto: esegue il circuito da uno stato iniziale con la squadra del contesto. Ritorna 0 se ok, -1 se errore. */
+static int esegui_da(qsim_contesto_t* ctx, const complesso_t* iniziale, complesso_t** stato_finale) {
+    squadra_t* precedente = imposta_squadra_corrente(ctx->squadra);
+    int ret = esegui_circuito(&ctx->dati, ctx->dimensione, ctx->caricamento, ctx->fusi, ctx->kernel_piccoli, ctx->traccia,
+                              ctx->verifica, iniziale, stato_finale);
+    imposta_squadra_corrente(precedente);
+
+    /* Dopo la prima esecuzione tutte le matrici sono state lette: le successive le cercano per nome */
+    if (ctx->caricamento) {
+        int esito = termina_caricamento(ctx->caricamento);
+        ctx->caricamento = NULL;
+        if (esito != 0) {
+            fprintf(stderr, "Errore: caricamento degli operatori fallito\n");
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+int qsim_esegui(qsim_contesto_t* ctx) {
+    if (!ctx || !ctx->compilato) return -1;
+    libera_stato_finale(ctx);
+
+    if (ctx->opzioni.numero_processi > 1) {
+        return esegui_circuito_distribuito(&ctx->dati, ctx->file_circuito, ctx->opzioni.numero_processi,
+                                           ctx->opzioni.trasporto, &ctx->stato_finale);
+    }
+    return esegui_da(ctx, ctx->dati.stato_iniziale, &ctx->stato_finale);
+}
+
+int qsim_esegui_batch(qsim_contesto_t* ctx, const complesso_t* const* iniziali, complesso_t* const* finali, int numero_stati) {
+    if (!ctx || !ctx->compilato || !iniziali || !finali || numero_stati < 0) return -1;
+    if (ctx->opzioni.numero_processi > 1) return -1;       // I processi rileggono il circuito a ogni esecuzione
+
+    for (int k = 0; k < numero_stati; k++) {
+        complesso_t* stato = NULL;
+        if (!iniziali[k] || !finali[k] || esegui_da(ctx, iniziali[k], &stato) != 0) return -1;
+        memcpy(finali[k], stato, ctx->dimensione * sizeof(complesso_t));
+        if (stato != iniziali[k]) free(stato);
+    }
+    return 0;
+}
+
+/* Funzione di supporto per esegui_varianti e esegui_flusso: esegue un tratto di istruzioni con gli operatori
+ * del contesto e la squadra corrente. Un tratto del circuito del contesto usa anche i suoi unitari fusi */
+static int esegui_tratto(void* argomento, const istruzione_circuito_t* istruzioni, int numero_istruzioni,
+                         const complesso_t* iniziale, complesso_t** finale) {
+    qsim_contesto_t* ctx = (qsim_contesto_t*)argomento;
+    dati_input_t tratto = ctx->dati;                // Stessi operatori, circuito limitato al tratto
+    tratto.circuito = (istruzione_circuito_t*)istruzioni;
+    tratto.numero_istruzioni = numero_istruzioni;
+
+    /* Le istruzioni di una variante possono stare fuori dal circuito: gli indirizzi vengono confrontati come
+     * interi prima di calcolare l'indice (la differenza tra puntatori a oggetti diversi non è definita) */
+    unitario_fuso_t* const* fusi = NULL;
+    uintptr_t indirizzo = (uintptr_t)istruzioni;
+    uintptr_t base = (uintptr_t)ctx->dati.circuito;
+    if (ctx->fusi && ctx->dati.circuito && indirizzo >= base &&
+        indirizzo < base + (uintptr_t)ctx->dati.numero_istruzioni * sizeof(istruzione_circuito_t)) {
+        fusi = ctx->fusi + (istruzioni - ctx->dati.circuito);
+    }
+    return esegui_circuito(&tratto, ctx->dimensione, NULL, fusi, ctx->kernel_piccoli, NULL, ctx->verifica, iniziale, finale);
+}
+
+/* Funzione di supporto per esegui_parametri: esegue le istruzioni [inizio, fine) con gli operatori di un punto
+ * della scansione e la squadra corrente (o, da un thread della squadra, con chiamate annidate) */
+static int esegui_punto(void* argomento, operatore_quantistico_t* operatori, int inizio, int fine,
+                        const complesso_t* iniziale, complesso_t** finale) {
+    qsim_contesto_t* ctx = (qsim_contesto_t*)argomento;
+    dati_input_t punto = ctx->dati;                 // Stesso circuito, operatori del punto
+    punto.operatori = operatori;
+    punto.circuito = ctx->dati.circuito + inizio;
+    punto.numero_istruzioni = fine - inizio;
+
+    /* Le porte parametriche non fanno parte dei tratti fusi: nessun tratto attraversa inizio o fine */
+    unitario_fuso_t* const* fusi = ctx->fusi ? ctx->fusi + inizio : NULL;
+    return esegui_circuito(&punto, ctx->dimensione, NULL, fusi, ctx->kernel_piccoli, NULL, ctx->verifica, iniziale, finale);
+}
+
+int qsim_esegui_parametri(qsim_contesto_t* ctx, FILE* uscita) {
+    if (!ctx || !ctx->compilato || !ctx->valori_parametri || !uscita) return -1;
+
+    squadra_t* precedente = imposta_squadra_corrente(ctx->squadra);
+    int paralleli = ctx->squadra ? numero_thread_squadra(ctx->squadra) : 1;    // Un punto per thread
+    int ret = esegui_parametri(&ctx->dati, ctx->valori_parametri, ctx->numero_punti, ctx->dati.stato_iniziale,
+                               ctx->dimensione, paralleli, esegui_punto, ctx, uscita);
+    imposta_squadra_corrente(precedente);
+    return ret;
+}
+
+/* Funzione di supporto: libera gli stati finali dell'esecuzione precedente delle varianti */
+static void libera_finali_varianti(qsim_contesto_t* ctx) {
+    if (!ctx->finali_varianti) return;
+    for (int k = 0; k < ctx->dati.numero_varianti; k++) free(ctx->finali_varianti[k]);
+    free(ctx->finali_varianti);
+    ctx->finali_varianti = NULL;
+}
+
+int qsim_esegui_varianti(qsim_contesto_t* ctx) {
+    if (!ctx || !ctx->compilato || ctx->dati.numero_varianti == 0) return -1;
+    libera_finali_varianti(ctx);
+
+    ctx->finali_varianti = (complesso_t**)calloc(ctx->dati.numero_varianti, sizeof(complesso_t*));
+    if (!ctx->finali_varianti) return -1;
+
+    squadra_t* precedente = imposta_squadra_corrente(ctx->squadra);
+    int ret = esegui_varianti(ctx->dati.varianti, ctx->dati.numero_varianti, ctx->dati.stato_iniziale, ctx->dimensione,
+                              ctx->opzioni.buffer_varianti, esegui_tratto, ctx, ctx->finali_varianti);
+    imposta_squadra_corrente(precedente);
+    if (ret != 0) libera_finali_varianti(ctx);
+    return ret;
+}
+
+int qsim_esegui_flusso(qsim_contesto_t* ctx, FILE* ingresso, FILE* uscita, long* numero_stati) {
+    if (!ctx || !ctx->compilato || !ctx->opzioni.flusso || !ingresso || !uscita) return -1;
+    const dati_input_t* dati = &ctx->dati;
+
+    /* Costo stimato di ogni istruzione per dividerle tra gli stadi: d² per una moltiplicazione densa (anche
+     * di un tratto fuso, le cui istruzioni interne non possono iniziare uno stadio), d per porta */
+    long* costi = (long*)malloc((dati->numero_istruzioni > 0 ? dati->numero_istruzioni : 1) * sizeof(long));
+    if (!costi) return -1;
+    int divisibili = 0;                             // Istruzioni da cui può iniziare uno stadio
+    for (int i = 0; i < dati->numero_istruzioni; ) {
+        operatore_quantistico_t* op = trova_operatore((dati_input_t*)dati, dati->circuito[i].nome_operatore);
+        if (!op || (!op->matrice && !op->porte)) {
+            free(costi);
+            return -1;
+        }
+        int passo = (ctx->fusi && ctx->fusi[i]) ? ctx->fusi[i]->numero_istruzioni : 1;
+        costi[i] = (op->porte && passo == 1) ? op->numero_porte * ctx->dimensione : ctx->dimensione * ctx->dimensione;
+        for (int k = 1; k < passo; k++) costi[i + k] = 0;
+        divisibili++;
+        i += passo;
+    }
+
+    /* Stadi: quelli richiesti o uno per processore; i thread del contesto vengono divisi tra gli stadi */
+    int stadi = ctx->opzioni.stadi_flusso > 0 ? ctx->opzioni.stadi_flusso : massimo_thread();
+    if (stadi > MAX_STADI_FLUSSO) stadi = MAX_STADI_FLUSSO;
+    if (divisibili > 0 && stadi > divisibili) stadi = divisibili;
+    int thread_per_stadio = 0;                      // Kernel piccoli: ogni stadio esegue nel proprio thread
+    if (ctx->squadra) {
+        thread_per_stadio = numero_thread_squadra(ctx->squadra) / stadi;
+        if (thread_per_stadio < 1) thread_per_stadio = 1;
+    }
+
+    /* Ogni coda può contenere CAPACITA_FLUSSO stati e ogni stadio ne tiene due mentre lavora */
+    if (verifica_memoria(dati->numero_qubit, COPIE_STATO_FLUSSO(stadi)) != 0) {
+        free(costi);
+        return -1;
+    }
+
+    squadra_t* precedente = imposta_squadra_corrente(ctx->squadra);    // Formattazione degli stati finali
+    int ret = esegui_flusso(ingresso, uscita, ctx->dimensione, dati->circuito, dati->numero_istruzioni, costi,
+                            stadi, thread_per_stadio, esegui_tratto, ctx, numero_stati);
+    imposta_squadra_corrente(precedente);
+    free(costi);
+    return ret;
+}
+
+int qsim_numero_varianti(const qsim_contesto_t* ctx) {
+    return ctx ? ctx->dati.numero_varianti : 0;
+}
+
+const complesso_t* qsim_stato_variante(const qsim_contesto_t* ctx, int k) {
+    if (!ctx || !ctx->finali_varianti || k < 0 || k >= ctx->dati.numero_varianti) return NULL;
+    return ctx->finali_varianti[k];
+}
+
+int qsim_scrivi_variante(qsim_contesto_t* ctx, int k, FILE* out) {
+    const complesso_t* stato = qsim_stato_variante(ctx, k);
+    if (!stato || !out) return -1;
+    squadra_t* precedente = imposta_squadra_corrente(ctx->squadra);
+    int ret = scrivi_vettore(out, stato, ctx->dimensione);
+    imposta_squadra_corrente(precedente);
+    return ret;
+}
+
+const complesso_t* qsim_stato_finale(const qsim_contesto_t* ctx) {
+    return ctx ? ctx->stato_finale : NULL;
+}
+
+int qsim_scrivi_stato(qsim_contesto_t* ctx, FILE* out) {
+    if (!ctx || !ctx->stato_finale || !out) return -1;
+    squadra_t* precedente = imposta_squadra_corrente(ctx->squadra);
+    int ret = scrivi_vettore(out, ctx->stato_finale, ctx->dimensione);
+    imposta_squadra_corrente(precedente);
+    return ret;
+}
+
+int qsim_numero_qubit(const qsim_contesto_t* ctx) {
+    return ctx && ctx->dimensione > 0 ? ctx->dati.numero_qubit : 0;
+}
+
+long qsim_dimensione(const qsim_contesto_t* ctx) {
+    return ctx ? ctx->dimensione : 0;
+}
+
+int qsim_numero_thread(const qsim_contesto_t* ctx) {
+    return ctx && ctx->squadra ? numero_thread_squadra(ctx->squadra) : 1;
+}
+
+int qsim_chiudi_traccia(qsim_contesto_t* ctx) {
+    if (!ctx) return -1;
+    int ret = traccia_chiudi(ctx->traccia);
+    ctx->traccia = NULL;
+    return ret;
+}
+
+long qsim_stampa_verifica(qsim_contesto_t* ctx, FILE* out) {
+    if (!ctx || !out) return 0;
+    return stampa_verifica(ctx->verifica, out);
+}
+
+void qsim_distruggi(qsim_contesto_t* ctx) {
+    if (!ctx) return;
+
+    /* Ferma il caricamento in pipeline se l'esecuzione si è interrotta prima della fine */
+    if (ctx->caricamento) termina_caricamento(ctx->caricamento);
+
+    traccia_chiudi(ctx->traccia);       // Se il chiamante non l'ha già chiusa con qsim_chiudi_traccia
+    distruggi_squadra(ctx->squadra);
+    libera_stato_finale(ctx);
+    libera_finali_varianti(ctx);
+    libera_unitari_fusi(ctx->fusi, ctx->dati.numero_istruzioni);
+
+    /* Riepilogo dei contatori per operatore su stderr, prima di liberare i nomi */
+    if (ctx->opzioni.contatori) contatori_termina(stderr, &ctx->dati);
+
+    libera_dati_input(&ctx->dati);
+    verifica_distruggi(ctx->verifica);
+    free(ctx->valori_parametri);
+    free(ctx->file_circuito);
+    free(ctx);
+}
@@ -0,0 +1,219 @@
+#ifndef QSIM_H
+#define QSIM_H
+
+#include <stdio.h>
+#include "complesso.h"
+
+/*
+ * Interfaccia della libreria libqsim (libqsim.a / libqsim.so).
+ * Tutto lo stato di una simulazione (dati letti, operatori, squadra di thread, buffer dello stato)
+ * appartiene a un contesto opaco: più contesti possono esistere ed essere eseguiti insieme, da thread
+ * diversi, senza condividere lock. Un singolo contesto va usato da un thread alla volta.
+ * Sequenza d'uso: qsim_crea → qsim_carica → qsim_compila → qsim_esegui (o qsim_esegui_batch, anche
+ * più volte) → qsim_stato_finale → qsim_distruggi.
+ * La profilazione (profilo.h) e i contatori hardware sono diagnostica di processo: vanno attivati
+ * per un solo contesto alla volta. La traccia degli stati intermedi (traccia.h) e la verifica dei kernel
+ * (verifica.h) appartengono invece al contesto.
+ */
+typedef struct qsim_contesto qsim_contesto_t;
+
+/* Valore di numero_thread che affida la scelta alla taratura (-t auto, taratura.h) */
+#define QSIM_THREAD_AUTO 0
+
+/* Opzioni di un contesto, da inizializzare con qsim_opzioni_default */
+typedef struct {
+    int numero_thread;          // Thread della squadra del contesto, QSIM_THREAD_AUTO per la taratura
+    int numero_processi;        // Processi della simulazione distribuita, 1 se non richiesta
+    const char* trasporto;      // Trasporto tra i processi ("shm" o "socket")
+    int pipeline;               // 1 per leggere le matrici durante la prima esecuzione
+    double tolleranza;          // Tolleranza relativa della fattorizzazione di Kronecker, negativa se disattiva
+    int contatori;              // 1 per misurare i contatori hardware (riepilogo su stderr in qsim_distruggi)
+    const char* cache;          // Cartella della cache degli unitari fusi (cache_unitari.h), NULL se disattiva
+    long limite_cache;          // Dimensione massima della cache in MiB
+    const char* file_taratura;  // File di taratura per QSIM_THREAD_AUTO, NULL per quello di default
+    const char* file_varianti;  // File delle varianti del circuito (prefissi.h), NULL se non richieste
+    int buffer_varianti;        // Stati intermedi conservati al massimo durante qsim_esegui_varianti
+    int flusso;                 // 1 per eseguire un flusso di stati con qsim_esegui_flusso (#init diventa facoltativo)
+    int stadi_flusso;           // Stadi della pipeline del flusso, 0 per sceglierli in base ai processori
+    int operatori_condivisi;    // 1 per tenere le matrici degli operatori in memoria condivisa tra processi (archivio_operatori.h)
+    const char* file_parametri; // Tabella dei valori dei parametri del circuito (parametri.h), NULL se non richiesta
+    double riduzione;           // Tolleranza della riduzione algebrica del circuito (riduzione.h), negativa se disattiva
+    const char* file_traccia;   // File della traccia degli stati intermedi del contesto (traccia.h), NULL se non richiesta
+    int traccia_ogni;           // Registra ogni k-esima istruzione (0: solo traccia_nomi, o tutte se anche questo è NULL)
+    const char* traccia_nomi;   // Operatori dopo cui registrare, separati da virgole, NULL per nessuno
+    int traccia_comprimi;       // 1 per comprimere le istantanee della traccia
+    double verifica;            // Frazione delle istruzioni i cui kernel vengono verificati (verifica.h), 0 se disattiva
+} qsim_opzioni_t;
+
+/*
+ * Valorizza le opzioni con i valori di default (1 thread, un processo, memoria condivisa, senza
+ * pipeline, tolleranza TOLLERANZA_FATTORIZZAZIONE, senza contatori, senza cache, limite LIMITE_CACHE_MIB, file di taratura di default,
+ * senza varianti, BUFFER_VARIANTI stati intermedi, senza flusso, operatori in memoria propria, senza tabella dei parametri,
+ * senza riduzione del circuito, senza traccia, senza verifica dei kernel).
+ */
+void qsim_opzioni_default(qsim_opzioni_t* opzioni);
+
+/*
+ * Controlla che le opzioni siano valide e compatibili tra loro. qsim_crea e qsim_pianifica la chiamano
+ * da sole; serve a chi vuole rifiutare una combinazione prima di creare il contesto (come progetto_qsim).
+ * Parametri: opzioni → opzioni da controllare, piano → 1 se il contesto verrà usato solo per qsim_pianifica,
+ * profilo → 1 se la profilazione di processo (profilo.h) è o verrà attivata
+ * Ritorna: 0 se le opzioni sono utilizzabili, -1 altrimenti
+ */
+int qsim_verifica_opzioni(const qsim_opzioni_t* opzioni, int piano, int profilo);
+
+/*
+ * Crea un contesto vuoto.
+ * Parametri: opzioni → opzioni del contesto (copiate; la stringa del trasporto e i percorsi dei file devono restare validi)
+ * Ritorna: puntatore al contesto, NULL se le opzioni non sono valide o in caso di errore di allocazione
+ */
+qsim_contesto_t* qsim_crea(const qsim_opzioni_t* opzioni);
+
+/*
+ * Legge e valida il file dello stato iniziale (#qubits, #init) e il file del circuito (#define, #circ).
+ * Con opzioni.file_varianti legge anche le varianti (il #circ del file del circuito diventa facoltativo).
+ * Con opzioni.flusso #init è facoltativo: gli stati iniziali arrivano da qsim_esegui_flusso.
+ * Un circuito con parametri simbolici richiede opzioni.file_parametri, la cui tabella viene letta qui.
+ * Le matrici identiche di #define diversi vengono tenute una sola volta; con opzioni.operatori_condivisi
+ * vengono mappate da segmenti di memoria condivisa comuni ai processi dello stesso host (non con la pipeline né con -p).
+ * Parametri: ctx → contesto appena creato, file_iniziale, file_circuito → percorsi dei file
+ * Ritorna: 0 se tutto ok, -1 se i file non sono leggibili o non sono compatibili
+ */
+int qsim_carica(qsim_contesto_t* ctx, const char* file_iniziale, const char* file_circuito);
+
+/*
+ * In alternativa a qsim_carica e qsim_compila: legge solo i metadati dei due file (#qubits, indice degli
+ * operatori, #circ) senza allocare lo stato né leggere le matrici, e scrive su out il piano di esecuzione
+ * (piano.h) con le scelte che qsim_compila farebbe con le opzioni del contesto. Con QSIM_THREAD_AUTO la
+ * configurazione viene dal file di taratura senza misure. Il contesto non può poi essere compilato né eseguito.
+ * Non disponibile con le opzioni rifiutate da qsim_verifica_opzioni con piano = 1 (varianti, flusso, simulazione
+ * distribuita, contatori, verifica, traccia, parametri e riduzione).
+ * Parametri: ctx → contesto appena creato, file_iniziale, file_circuito → percorsi dei file, out → file del piano
+ * Ritorna: 0 se tutto ok, -1 se i file non sono leggibili o non sono compatibili
+ */
+int qsim_pianifica(qsim_contesto_t* ctx, const char* file_iniziale, const char* file_circuito, FILE* out);
+
+/*
+ * Prepara l'esecuzione: con opzioni.riduzione >= 0 riduce prima il circuito (coppie inverse, identità e potenze
+ * di porte, riduzione.h; non con la pipeline, le varianti né nella simulazione distribuita), poi
+ * avvia il caricamento in pipeline se richiesto, attiva i contatori e crea la
+ * squadra di thread del contesto (non serve per N <= 5 qubit né per la simulazione distribuita), poi
+ * fattorizza gli operatori densi dividendo il lavoro tra i thread della squadra. Con la cache fonde i
+ * tratti di istruzioni dense consecutive, mappandone l'unitario dalla cartella quando è già presente.
+ * Con QSIM_THREAD_AUTO sceglie infine numero di thread, grana dei job e variante dei kernel (taratura.h).
+ * Con opzioni.file_traccia apre la traccia del contesto per stati di 2^qubit ampiezze: ogni contesto ha la
+ * propria, quindi contesti eseguiti insieme scrivono file diversi (non con la riduzione, le varianti, il
+ * flusso, la tabella dei parametri né nella simulazione distribuita).
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int qsim_compila(qsim_contesto_t* ctx);
+
+/*
+ * Esegue il circuito a partire dallo stato di #init. Lo stato finale resta nel contesto fino
+ * all'esecuzione successiva.
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int qsim_esegui(qsim_contesto_t* ctx);
+
+/*
+ * Esegue il circuito su più stati iniziali, uno dopo l'altro, riusando operatori e squadra.
+ * Non disponibile nella simulazione distribuita.
+ * Parametri:
+ * iniziali → numero_stati vettori di qsim_dimensione(ctx) ampiezze
+ * finali → numero_stati vettori della stessa dimensione in cui scrivere gli stati finali
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int qsim_esegui_batch(qsim_contesto_t* ctx, const complesso_t* const* iniziali, complesso_t* const* finali, int numero_stati);
+
+/*
+ * Esegue tutte le varianti del circuito lette con opzioni.file_varianti a partire dallo stato di #init,
+ * condividendo i prefissi comuni (prefissi.h). Non disponibile con la pipeline né nella simulazione distribuita.
+ * Gli stati finali restano nel contesto fino all'esecuzione successiva delle varianti.
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int qsim_esegui_varianti(qsim_contesto_t* ctx);
+
+/*
+ * Esegue il circuito su un flusso di stati iniziali (uno dopo l'altro nel formato di #init, lista "[ ... ]"
+ * o |k>) fino alla fine di ingresso, scrivendo su uscita ogni stato finale nell'ordine di ingresso,
+ * preceduto da "Stato finale (stato k):". Le istruzioni sono divise in stadi di costo simile, ognuno con i
+ * propri thread (i thread del contesto divisi tra gli stadi), collegati da code senza lock (flusso.h).
+ * Richiede opzioni.flusso; non disponibile con la pipeline, le varianti, i contatori, la profilazione né nella
+ * simulazione distribuita.
+ * Parametri: ingresso → flusso degli stati iniziali, uscita → file degli stati finali
+ * numero_stati → valorizzato con il numero di stati scritti (può essere NULL)
+ * Ritorna: 0 se tutto ok, -1 in caso di errore (gli stati finali già scritti restano su uscita)
+ */
+int qsim_esegui_flusso(qsim_contesto_t* ctx, FILE* ingresso, FILE* uscita, long* numero_stati);
+
+/*
+ * Esegue il circuito parametrico per ogni punto della tabella di opzioni.file_parametri a partire dallo stato di
+ * #init (parametri.h): le parti che non dipendono dai parametri sono preparate una volta sola e i punti vengono
+ * divisi tra i thread della squadra. Scrive su uscita ogni stato finale nell'ordine della tabella, preceduto da
+ * "Stato finale (punto k):". Non disponibile con la pipeline, le varianti, il flusso, i contatori né nella
+ * simulazione distribuita.
+ * Parametri: uscita → file degli stati finali
+ * Ritorna: 0 se tutto ok, -1 in caso di errore (gli stati finali già scritti restano su uscita)
+ */
+int qsim_esegui_parametri(qsim_contesto_t* ctx, FILE* uscita);
+
+/* Ritorna il numero di varianti lette, 0 se non richieste */
+int qsim_numero_varianti(const qsim_contesto_t* ctx);
+
+/*
+ * Ritorna lo stato finale della variante k (nell'ordine del file) dopo qsim_esegui_varianti, NULL se
+ * le varianti non sono state eseguite o k non è valido. Il vettore appartiene al contesto.
+ */
+const complesso_t* qsim_stato_variante(const qsim_contesto_t* ctx, int k);
+
+/*
+ * Come qsim_scrivi_stato, per lo stato finale della variante k.
+ * Ritorna: 0 se tutto ok, -1 se le varianti non sono state eseguite, k non è valido o la scrittura fallisce
+ */
+int qsim_scrivi_variante(qsim_contesto_t* ctx, int k, FILE* out);
+
+/*
+ * Ritorna lo stato finale dell'ultima qsim_esegui (qsim_dimensione(ctx) ampiezze, appartiene al
+ * contesto), NULL se il circuito non è ancora stato eseguito.
+ */
+const complesso_t* qsim_stato_finale(const qsim_contesto_t* ctx);
+
+/*
+ * Scrive lo stato finale dell'ultima qsim_esegui nel formato "[ (a+ib, ...) ]", formattando i numeri
+ * in parallelo con la squadra del contesto.
+ * Parametri: out → file di destinazione
+ * Ritorna: 0 se tutto ok, -1 se il circuito non è stato eseguito o la scrittura fallisce
+ */
+int qsim_scrivi_stato(qsim_contesto_t* ctx, FILE* out);
+
+/* Ritorna il numero di qubit del circuito caricato, 0 se non caricato */
+int qsim_numero_qubit(const qsim_contesto_t* ctx);
+
+/* Ritorna la dimensione del vettore di stato (2^qubit), 0 se non caricato */
+long qsim_dimensione(const qsim_contesto_t* ctx);
+
+/* Ritorna il numero di thread della squadra del contesto (dopo qsim_compila), 1 se il contesto non ha una squadra */
+int qsim_numero_thread(const qsim_contesto_t* ctx);
+
+/*
+ * Attende la scrittura delle ultime istantanee della traccia del contesto e la chiude; il riepilogo
+ * resta al thread chiamante (stampa_traccia). Ritorna: 0 se tutto ok o senza traccia, -1 se la traccia
+ * è incompleta (scrittura fallita).
+ */
+int qsim_chiudi_traccia(qsim_contesto_t* ctx);
+
+/*
+ * Stampa il riepilogo della verifica dei kernel del contesto (opzioni.verifica > 0): confronti, scarto
+ * relativo massimo e confronti oltre la tolleranza per ogni kernel, dalla creazione del contesto.
+ * Parametri: out → file su cui scrivere
+ * Ritorna: numero di confronti oltre la tolleranza (0 se la verifica non è attiva, senza stampare nulla)
+ */
+long qsim_stampa_verifica(qsim_contesto_t* ctx, FILE* out);
+
+/*
+ * Distrugge il contesto: chiude la traccia se è ancora aperta, ferma il caricamento e la squadra, stampa
+ * su stderr il riepilogo dei contatori hardware se erano attivi e libera tutta la memoria.
+ */
+void qsim_distruggi(qsim_contesto_t* ctx);
+
+#endif
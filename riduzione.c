@@ -0,0 +1,523 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "riduzione.h"
+#include "porte.h"
+#include "matrice.h"
+#include "profilo.h"
+
+#define VETTORI_TEST_DENSO 2        // Vettori casuali con cui si prova il prodotto di due operatori densi
+
+/* Riepilogo dell'ultima riduzione (per thread, come quello della rimappatura) */
+static __thread struct {
+    int eseguita;
+    int prima;              // Istruzioni del circuito prima della riduzione
+    int dopo;               // Istruzioni del circuito ridotto
+    int coppie;             // Istruzioni rimosse in coppie con prodotto uguale all'identità
+    int identita;           // Istruzioni rimosse perché uguali all'identità (da sole o come potenze U^k)
+    int assorbite;          // Istruzioni riunite nelle potenze U^k
+    int potenze;            // Porte U^k nel circuito ridotto
+    int scavalcate;         // Combinazioni trovate scavalcando istruzioni che commutano
+    int test;               // Test numerici eseguiti sulle coppie di operatori densi
+    int test_cache;         // Test ripresi dalla cache
+    double tempo;           // Microsecondi della riduzione
+} g_statistiche;
+
+/* Matrice locale di una porta (indici nell'ordine dei suoi bersagli) */
+typedef complesso_t matrice_locale_t[1 << MAX_QUBIT_PORTA][1 << MAX_QUBIT_PORTA];
+
+/* Forma di un operatore ai fini della riduzione */
+typedef enum {
+    FORMA_OPACA,            // Lasciato com'è (porte parametriche, operatori già fattorizzati, non trovati)
+    FORMA_PORTA,            // Una sola porta predefinita
+    FORMA_DENSA             // Matrice densa completa
+} forma_t;
+
+typedef struct {
+    forma_t forma;
+    long qubit;             // Bersagli e controlli della porta (anche parametrica), 0 se non è una porta
+    int diagonale;          // 1 se la porta è diagonale per ogni valore dei suoi coefficienti
+    int identita;           // 1 se l'operatore è l'identità, 0 se no, -1 se non ancora provato
+} info_operatore_t;
+
+/* Esito di un test numerico su una coppia di operatori densi: prima a, poi b */
+typedef struct {
+    int a, b;
+    int inversi;            // 1 se b · a è l'identità
+} test_coppia_t;
+
+/* Istruzione del circuito ridotto */
+typedef struct {
+    int istruzione;         // Istruzione di #circ da cui proviene (ne conserva il nome se potenza = 1)
+    int operatore;          // Indice dell'operatore (già risolto dai duplicati), -1 se non trovato
+    int potenza;            // Istruzioni uguali riunite, 0 quando la voce va rimossa
+} voce_t;
+
+/* Stato di una riduzione */
+typedef struct {
+    dati_input_t* dati;
+    double tolleranza;
+    info_operatore_t* info;
+    test_coppia_t* test;    // Cache dei test sulle coppie dense
+    int numero_test, capacita_test;
+    uint64_t seme;          // Generatore dei vettori casuali (xorshift64)
+} riduzione_t;
+
+
+/* Funzione di supporto: numero complesso con il segno della parte immaginaria coerente */
+static complesso_t complesso(double re, double im) {
+    complesso_t z = {re, im, signbit(im) ? '-' : '+'};
+    return z;
+}
+
+/* Funzione di supporto: valorizza m con la matrice locale della porta p */
+static void matrice_locale(const porta_t* p, matrice_locale_t m) {
+    int d = 1 << p->numero_bersagli;
+    for (int b = 0; b < d; b++) {
+        for (int c = 0; c < d; c++) {
+            if (p->tipo == PORTA_LOCALE) m[b][c] = p->matrice[b][c];
+            else if (p->tipo == PORTA_DIAGONALE) m[b][c] = b == c ? p->fase[b] : complesso(0.0, 0.0);
+            else m[b][c] = c == p->permutazione[b] ? p->fase[b] : complesso(0.0, 0.0);
+        }
+    }
+}
+
+/* Funzione di supporto: r = a · b (r può coincidere con a o b) */
+static void moltiplica_locali(int d, matrice_locale_t a, matrice_locale_t b, matrice_locale_t r) {
+    matrice_locale_t t;
+    for (int i = 0; i < d; i++) {
+        for (int j = 0; j < d; j++) {
+            complesso_t somma = complesso(0.0, 0.0);
+            for (int k = 0; k < d; k++) somma = somma_complessi(somma, moltiplica_complessi(a[i][k], b[k][j]));
+            t[i][j] = somma;
+        }
+    }
+    memcpy(r, t, sizeof(matrice_locale_t));
+}
+
+/* Funzione di supporto: r = u^k per quadrati successivi */
+static void potenza_locale(int d, matrice_locale_t u, int k, matrice_locale_t r) {
+    matrice_locale_t base;
+    memcpy(base, u, sizeof(matrice_locale_t));
+    for (int i = 0; i < d; i++) {
+        for (int j = 0; j < d; j++) r[i][j] = complesso(i == j ? 1.0 : 0.0, 0.0);
+    }
+    for (; k > 0; k >>= 1) {
+        if (k & 1) moltiplica_locali(d, r, base, r);
+        if (k > 1) moltiplica_locali(d, base, base, base);
+    }
+}
+
+/* Funzione di supporto: 1 se ogni elemento di m differisce da quello dell'identità di al più tolleranza */
+static int identita_locale(int d, matrice_locale_t m, double tolleranza) {
+    for (int i = 0; i < d; i++) {
+        for (int j = 0; j < d; j++) {
+            if (!(hypot(m[i][j].parte_reale - (i == j), m[i][j].parte_immaginaria) <= tolleranza)) return 0;
+        }
+    }
+    return 1;
+}
+
+/* Funzione di supporto: 1 se le due porte hanno gli stessi bersagli (in qualsiasi ordine) e gli stessi controlli */
+static int stessi_qubit(const porta_t* a, const porta_t* b) {
+    if (a->numero_bersagli != b->numero_bersagli || a->maschera_controlli != b->maschera_controlli) return 0;
+    long bersagli_a = 0, bersagli_b = 0;
+    for (int j = 0; j < a->numero_bersagli; j++) {
+        bersagli_a |= 1L << a->bersagli[j];
+        bersagli_b |= 1L << b->bersagli[j];
+    }
+    return bersagli_a == bersagli_b;
+}
+
+/* Funzione di supporto: matrice locale della porta b con gli indici nell'ordine dei bersagli della porta a (stessi_qubit) */
+static void matrice_riordinata(const porta_t* a, const porta_t* b, matrice_locale_t m) {
+    int d = 1 << a->numero_bersagli;
+    int indice[1 << MAX_QUBIT_PORTA];           // Indice locale di b corrispondente all'indice locale r di a
+    for (int r = 0; r < d; r++) {
+        indice[r] = 0;
+        for (int j = 0; j < a->numero_bersagli; j++) {
+            if (!(r & (1 << j))) continue;
+            for (int i = 0; i < b->numero_bersagli; i++) {
+                if (b->bersagli[i] == a->bersagli[j]) indice[r] |= 1 << i;
+            }
+        }
+    }
+    matrice_locale_t mb;
+    matrice_locale(b, mb);
+    for (int r = 0; r < d; r++) {
+        for (int c = 0; c < d; c++) m[r][c] = mb[indice[r]][indice[c]];
+    }
+}
+
+/* Funzione di supporto: maschera dei qubit (bersagli e controlli) di una porta */
+static long qubit_porta(const porta_t* p) {
+    long qubit = p->maschera_controlli;
+    for (int j = 0; j < p->numero_bersagli; j++) qubit |= 1L << p->bersagli[j];
+    return qubit;
+}
+
+/*
+ * Funzione di supporto: matrice della porta p, controlli compresi, sui suoi qubit ordinati (al più MAX_QUBIT_PORTA):
+ * sulle ampiezze con tutti i controlli a 1 agisce la matrice locale, sulle altre l'identità.
+ */
+static void matrice_estesa(const porta_t* p, matrice_locale_t m) {
+    int d = 1 << p->numero_ordinati;
+    matrice_locale_t locale;
+    matrice_locale(p, locale);
+    int bersaglio[1 << MAX_QUBIT_PORTA], controlli[1 << MAX_QUBIT_PORTA];
+    for (int r = 0; r < d; r++) {           // Indice locale e bit dei controlli di ogni indice sui qubit ordinati
+        bersaglio[r] = controlli[r] = 0;
+        for (int i = 0; i < p->numero_ordinati; i++) {
+            if (!(r & (1 << i))) continue;
+            for (int j = 0; j < p->numero_bersagli; j++) {
+                if (p->bersagli[j] == p->ordinati[i]) bersaglio[r] |= 1 << j;
+            }
+            if (p->maschera_controlli & (1L << p->ordinati[i])) controlli[r] |= 1 << i;
+        }
+    }
+    int tutti = 0;
+    for (int i = 0; i < p->numero_ordinati; i++) {
+        if (p->maschera_controlli & (1L << p->ordinati[i])) tutti |= 1 << i;
+    }
+    for (int r = 0; r < d; r++) {
+        for (int c = 0; c < d; c++) {
+            if (controlli[r] != controlli[c]) m[r][c] = complesso(0.0, 0.0);
+            else if (controlli[r] == tutti) m[r][c] = locale[bersaglio[r]][bersaglio[c]];
+            else m[r][c] = complesso(bersaglio[r] == bersaglio[c] ? 1.0 : 0.0, 0.0);
+        }
+    }
+}
+
+/*
+ * Funzione di supporto: matrici confrontabili di due porte sugli stessi qubit. Con gli stessi bersagli e controlli
+ * le matrici locali (quella di b nell'ordine dei bersagli di a), altrimenti, se i qubit sono al più
+ * MAX_QUBIT_PORTA, quelle estese con i controlli (es. CZ 0 1 e CZ 1 0).
+ * Ritorna: dimensione delle matrici, 0 se le porte non agiscono sugli stessi qubit o sono troppo grandi
+ */
+static int matrici_confrontabili(const porta_t* a, const porta_t* b, matrice_locale_t ma, matrice_locale_t mb) {
+    if (qubit_porta(a) != qubit_porta(b)) return 0;
+    if (stessi_qubit(a, b)) {
+        matrice_locale(a, ma);
+        matrice_riordinata(a, b, mb);
+        return 1 << a->numero_bersagli;
+    }
+    if (a->numero_ordinati > MAX_QUBIT_PORTA) return 0;
+    matrice_estesa(a, ma);
+    matrice_estesa(b, mb);
+    return 1 << a->numero_ordinati;
+}
+
+/* Funzione di supporto: 1 se l'operatore x è l'identità (risultato conservato nelle informazioni dell'operatore) */
+static int operatore_identita(riduzione_t* r, int x) {
+    info_operatore_t* info = &r->info[x];
+    if (info->identita >= 0) return info->identita;
+
+    const operatore_quantistico_t* op = &r->dati->operatori[x];
+    info->identita = 0;
+    if (info->forma == FORMA_PORTA) {
+        matrice_locale_t m;
+        matrice_locale(op->porte, m);
+        info->identita = identita_locale(1 << op->porte->numero_bersagli, m, r->tolleranza);
+    } else if (info->forma == FORMA_DENSA) {
+        int n = op->matrice->dimensione;
+        info->identita = 1;
+        for (int i = 0; i < n && info->identita; i++) {
+            for (int j = 0; j < n; j++) {
+                complesso_t z = op->matrice->dati[i][j];
+                if (!(hypot(z.parte_reale - (i == j), z.parte_immaginaria) <= r->tolleranza)) {
+                    info->identita = 0;
+                    break;
+                }
+            }
+        }
+    }
+    return info->identita;
+}
+
+/* Funzione di supporto: 1 se le istruzioni con gli operatori a e b possono scambiarsi di posto */
+static int commutano(const riduzione_t* r, int a, int b) {
+    if (a < 0 || b < 0) return 0;
+    const info_operatore_t* ia = &r->info[a];
+    const info_operatore_t* ib = &r->info[b];
+    if (!ia->qubit || !ib->qubit) return 0;                 // Operatori densi: agiscono su tutti i qubit
+    if ((ia->qubit & ib->qubit) == 0) return 1;             // Porte su qubit disgiunti
+    return ia->diagonale && ib->diagonale;                  // Porte diagonali (con i controlli) sulla base computazionale
+}
+
+/* Funzione di supporto: numero pseudo-casuale in [-1, 1) */
+static double casuale(riduzione_t* r) {
+    r->seme ^= r->seme << 13;
+    r->seme ^= r->seme >> 7;
+    r->seme ^= r->seme << 17;
+    return (r->seme >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+/*
+ * Funzione di supporto: 1 se b · a è l'identità, per due operatori densi. Filtro esatto: b deve essere l'aggiunta
+ * di a elemento per elemento (come per ogni coppia di unitari inversi); poi il prodotto viene provato su vettori
+ * casuali x, accettando ‖b·a·x - x‖∞ ≤ tolleranza · ‖x‖₂. L'esito resta nella cache per le coppie successive.
+ * Ritorna 1 o 0 come esito, -1 in caso di errore di allocazione.
+ */
+static int inversi_densi(riduzione_t* r, int a, int b) {
+    for (int k = 0; k < r->numero_test; k++) {
+        if (r->test[k].a == a && r->test[k].b == b) {
+            g_statistiche.test_cache++;
+            return r->test[k].inversi;
+        }
+    }
+
+    if (r->numero_test == r->capacita_test) {
+        r->capacita_test = r->capacita_test ? 2 * r->capacita_test : 16;
+        test_coppia_t* tmp = (test_coppia_t*)realloc(r->test, r->capacita_test * sizeof(test_coppia_t));
+        if (!tmp) return -1;
+        r->test = tmp;
+    }
+    g_statistiche.test++;
+
+    matrice_t* ma = r->dati->operatori[a].matrice;
+    matrice_t* mb = r->dati->operatori[b].matrice;
+    int n = ma->dimensione;
+    int inversi = mb->dimensione == n;
+    for (int i = 0; i < n && inversi; i++) {
+        for (int j = 0; j < n; j++) {
+            complesso_t x = mb->dati[i][j], y = ma->dati[j][i];
+            if (!(hypot(x.parte_reale - y.parte_reale, x.parte_immaginaria + y.parte_immaginaria) <= r->tolleranza)) {
+                inversi = 0;
+                break;
+            }
+        }
+    }
+
+    complesso_t* x = inversi ? (complesso_t*)malloc(n * sizeof(complesso_t)) : NULL;
+    if (inversi && !x) return -1;
+    for (int v = 0; v < VETTORI_TEST_DENSO && inversi; v++) {
+        double norma = 0.0;
+        for (int i = 0; i < n; i++) {
+            x[i] = complesso(casuale(r), casuale(r));
+            norma += x[i].parte_reale * x[i].parte_reale + x[i].parte_immaginaria * x[i].parte_immaginaria;
+        }
+        complesso_t* y = moltiplica_matrice_vettore(ma, x);
+        complesso_t* z = y ? moltiplica_matrice_vettore(mb, y) : NULL;
+        if (!z) {
+            free(y);
+            free(x);
+            return -1;
+        }
+        for (int i = 0; i < n && inversi; i++) {
+            inversi = hypot(z[i].parte_reale - x[i].parte_reale, z[i].parte_immaginaria - x[i].parte_immaginaria) <= r->tolleranza * sqrt(norma);
+        }
+        free(y);
+        free(z);
+    }
+    free(x);
+
+    test_coppia_t* t = &r->test[r->numero_test++];
+    t->a = a;
+    t->b = b;
+    t->inversi = inversi;
+    return inversi;
+}
+
+/*
+ * Funzione di supporto: prova a combinare l'istruzione con l'operatore x con la voce v che la precede.
+ * Aggiorna la potenza della voce (0 se la voce si annulla con x) e i contatori del riepilogo.
+ * Ritorna 1 se x è stata assorbita dalla voce, 0 se va aggiunta come nuova voce, -1 in caso di errore.
+ */
+static int combina(riduzione_t* r, voce_t* v, int x) {
+    int u = v->operatore;
+    if (u < 0) return 0;
+    const operatore_quantistico_t* op_u = &r->dati->operatori[u];
+    const operatore_quantistico_t* op_x = &r->dati->operatori[x];
+
+    if (r->info[u].forma == FORMA_DENSA && r->info[x].forma == FORMA_DENSA) {
+        int esito = inversi_densi(r, u, x);
+        if (esito == 1) {
+            v->potenza = 0;
+            g_statistiche.coppie += 2;
+        }
+        return esito;
+    }
+
+    if (r->info[u].forma != FORMA_PORTA || r->info[x].forma != FORMA_PORTA) return 0;
+    matrice_locale_t mu, muk, mx;
+    int d = matrici_confrontabili(op_u->porte, op_x->porte, mu, mx);
+    if (d == 0) return 0;
+
+    if (u == x) {                               // U^k · U = U^(k+1)
+        potenza_locale(d, mu, v->potenza + 1, muk);
+        if (identita_locale(d, muk, r->tolleranza)) {
+            if (v->potenza == 1) g_statistiche.coppie += 2;
+            else g_statistiche.identita += v->potenza + 1;
+            v->potenza = 0;
+        } else {
+            v->potenza++;
+        }
+        return 1;
+    }
+
+    potenza_locale(d, mu, v->potenza, muk);
+    moltiplica_locali(d, mx, muk, muk);
+    if (identita_locale(d, muk, r->tolleranza)) {   // X · U^k = I
+        g_statistiche.coppie += v->potenza + 1;
+        v->potenza = 0;
+        return 1;
+    }
+    if (v->potenza > 1) {                       // X · U = I: U^k · X = U^(k-1)
+        moltiplica_locali(d, mx, mu, muk);
+        if (identita_locale(d, muk, r->tolleranza)) {
+            g_statistiche.coppie += 2;
+            v->potenza--;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Funzione di supporto: nome dell'operatore U^k, aggiunto agli operatori se non c'è già.
+ * Ritorna 0 se ok, -1 in caso di errore di allocazione.
+ */
+static int operatore_potenza(riduzione_t* r, int u, int k, char nome[32]) {
+    dati_input_t* dati = r->dati;
+    char testo[64];
+    if (snprintf(testo, sizeof(testo), "%s^%d", dati->operatori[u].nome, k) >= 32) {
+        snprintf(testo, sizeof(testo), "op%d ^%d", u, k);   // Lo spazio lo distingue dai nomi di #define
+    }
+    strcpy(nome, testo);
+    if (trova_operatore(dati, nome)) return 0;
+
+    porta_t* p = (porta_t*)malloc(sizeof(porta_t));
+    if (!p) return -1;
+    *p = *dati->operatori[u].porte;
+    matrice_locale_t mu;
+    matrice_locale(p, mu);
+    potenza_locale(1 << p->numero_bersagli, mu, k, p->matrice);
+    p->tipo = PORTA_LOCALE;
+    semplifica_porta(p, r->tolleranza);         // U^k di una porta diagonale o di permutazione resta tale
+    completa_porta(p);
+
+    operatore_quantistico_t* tmp = (operatore_quantistico_t*)realloc(dati->operatori, (dati->numero_operatori + 1) * sizeof(operatore_quantistico_t));
+    if (!tmp) {
+        free(p);
+        return -1;
+    }
+    dati->operatori = tmp;
+    operatore_quantistico_t* op = &dati->operatori[dati->numero_operatori++];
+    strcpy(op->nome, nome);
+    op->matrice = NULL;
+    op->posizione = -1;
+    op->porte = p;
+    op->numero_porte = 1;
+    op->originale = -1;
+    op->segmento = NULL;
+    return 0;
+}
+
+int riduci_circuito(dati_input_t* dati, double tolleranza) {
+    if (!dati || !(tolleranza >= 0.0)) return -1;
+    double avvio = profilo_adesso();
+
+    memset(&g_statistiche, 0, sizeof(g_statistiche));
+    g_statistiche.eseguita = 1;
+    g_statistiche.prima = dati->numero_istruzioni;
+
+    riduzione_t r;
+    memset(&r, 0, sizeof(r));
+    r.dati = dati;
+    r.tolleranza = tolleranza;
+    r.seme = 0x9E3779B97F4A7C15ULL;
+    r.info = (info_operatore_t*)calloc(dati->numero_operatori + 1, sizeof(info_operatore_t));
+    voce_t* voci = (voce_t*)malloc((dati->numero_istruzioni + 1) * sizeof(voce_t));
+    istruzione_circuito_t* circuito = NULL;
+    int numero_voci = 0;
+    int ret = -1;
+    if (!r.info || !voci) goto fine;
+
+    /* Forma di ogni operatore: le porte parametriche cambiano a ogni punto e commutano solo su qubit disgiunti */
+    for (int k = 0; k < dati->numero_operatori; k++) {
+        const operatore_quantistico_t* op = &dati->operatori[k];
+        info_operatore_t* info = &r.info[k];
+        info->identita = -1;
+        if (op->matrice && op->numero_porte == 0) info->forma = FORMA_DENSA;
+        if (!op->matrice && op->porte && op->numero_porte == 1) {
+            info->forma = FORMA_PORTA;
+            info->qubit = qubit_porta(op->porte);
+            info->diagonale = op->porte->tipo == PORTA_DIAGONALE;
+        }
+    }
+    for (int j = 0; j < dati->numero_parametrici; j++) {
+        r.info[dati->parametrici[j].operatore].forma = FORMA_OPACA;
+        r.info[dati->parametrici[j].operatore].diagonale = 0;
+    }
+
+    /* Le voci formano una pila: ogni istruzione prova a combinarsi con le più recenti, scavalcando quelle con cui commuta */
+    for (int i = 0; i < dati->numero_istruzioni; i++) {
+        operatore_quantistico_t* op = trova_operatore(dati, dati->circuito[i].nome_operatore);
+        int x = op ? (int)(op - dati->operatori) : -1;
+        if (x >= 0 && operatore_identita(&r, x)) {
+            g_statistiche.identita++;
+            continue;
+        }
+
+        int esito = 0, j = numero_voci - 1;
+        for (int limite = numero_voci - FINESTRA_RIDUZIONE; x >= 0 && j >= 0 && j > limite; j--) {
+            esito = combina(&r, &voci[j], x);
+            if (esito != 0 || !commutano(&r, voci[j].operatore, x)) break;
+        }
+        if (esito < 0) goto fine;
+        if (esito == 1) {
+            if (j < numero_voci - 1) g_statistiche.scavalcate++;
+            if (voci[j].potenza == 0) {
+                memmove(&voci[j], &voci[j + 1], (numero_voci - j - 1) * sizeof(voce_t));
+                numero_voci--;
+            }
+            continue;
+        }
+        voci[numero_voci].istruzione = i;
+        voci[numero_voci].operatore = x;
+        voci[numero_voci].potenza = 1;
+        numero_voci++;
+    }
+
+    /* Circuito ridotto: le voci con potenza k > 1 diventano la porta U^k */
+    circuito = (istruzione_circuito_t*)malloc((numero_voci + 1) * sizeof(istruzione_circuito_t));
+    if (!circuito) goto fine;
+    for (int k = 0; k < numero_voci; k++) {
+        if (voci[k].potenza == 1) {
+            strcpy(circuito[k].nome_operatore, dati->circuito[voci[k].istruzione].nome_operatore);
+            continue;
+        }
+        if (operatore_potenza(&r, voci[k].operatore, voci[k].potenza, circuito[k].nome_operatore) != 0) goto fine;
+        g_statistiche.potenze++;
+        g_statistiche.assorbite += voci[k].potenza - 1;
+    }
+
+    free(dati->circuito);
+    dati->circuito = circuito;
+    circuito = NULL;
+    ret = dati->numero_istruzioni - numero_voci;
+    dati->numero_istruzioni = numero_voci;
+    g_statistiche.dopo = numero_voci;
+
+fine:
+    g_statistiche.tempo = profilo_adesso() - avvio;
+    free(circuito);
+    free(voci);
+    free(r.info);
+    free(r.test);
+    return ret;
+}
+
+void stampa_riduzione(FILE* out) {
+    fprintf(out, "\n=== Riduzione algebrica del circuito ===\n");
+    if (!g_statistiche.eseguita) {
+        fprintf(out, "Nessuna riduzione eseguita\n");
+        return;
+    }
+    fprintf(out, "Istruzioni: %d prima, %d dopo (%d rimosse): %d in coppie inverse, %d uguali all'identità, %d riunite in %d potenze U^k\n",
+            g_statistiche.prima, g_statistiche.dopo, g_statistiche.prima - g_statistiche.dopo, g_statistiche.coppie,
+            g_statistiche.identita, g_statistiche.assorbite, g_statistiche.potenze);
+    fprintf(out, "Combinazioni oltre istruzioni che commutano: %d, test numerici sulle coppie dense: %d (%d dalla cache), tempo: %.3f ms\n",
+            g_statistiche.scavalcate, g_statistiche.test, g_statistiche.test_cache, g_statistiche.tempo / 1000.0);
+}
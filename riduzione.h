@@ -0,0 +1,39 @@
+#ifndef RIDUZIONE_H
+#define RIDUZIONE_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+
+/* Tolleranza di default per considerare un prodotto di operatori uguale all'identità (--peephole) */
+#define TOLLERANZA_RIDUZIONE 1e-9
+
+/* Istruzioni precedenti esaminate al massimo per trovare quella con cui combinare la corrente */
+#ifndef FINESTRA_RIDUZIONE
+#define FINESTRA_RIDUZIONE 64
+#endif
+
+/*
+ * Riduzione algebrica del circuito (ottimizzazione peephole) sulle istruzioni di #circ già risolte negli operatori.
+ * Ogni istruzione viene confrontata con la precedente con cui non commuta (si scavalcano le porte su qubit
+ * disgiunti e, tra porte diagonali, anche quelle sugli stessi qubit):
+ * - due porte sugli stessi qubit il cui prodotto è l'identità (H H, X X, S SDG, CNOT CNOT) vengono rimosse,
+ *   confrontando le loro matrici locali (al più 8x8);
+ * - due operatori densi vengono rimossi se la seconda matrice è l'aggiunta della prima e il prodotto, provato
+ *   su vettori casuali, restituisce il vettore: il test costa O(4^N) ed è eseguito una volta per coppia di operatori;
+ * - k porte uguali consecutive diventano una sola porta U^k (rimossa se U^k è l'identità, ad esempio T^8);
+ * - le porte e gli operatori densi uguali all'identità vengono rimossi.
+ * Le porte con parametro simbolico (parametri.h) restano come sono. Le nuove porte U^k vengono aggiunte agli
+ * operatori con il nome "<porta>^k" e il circuito viene sostituito da quello ridotto.
+ * Parametri: dati → dati letti, con le matrici complete; tolleranza → scarto massimo ammesso rispetto all'identità
+ * Ritorna: numero di istruzioni rimosse, -1 in caso di errore
+ */
+int riduci_circuito(dati_input_t* dati, double tolleranza);
+
+/*
+ * Stampa il riepilogo dell'ultima riduzione del thread chiamante: istruzioni prima e dopo, rimosse in coppie
+ * inverse, perché uguali all'identità e riunite in potenze, coppie trovate scavalcando istruzioni che commutano
+ * e test numerici sulle coppie dense eseguiti o ripresi dalla cache.
+ */
+void stampa_riduzione(FILE* out);
+
+#endif
@@ -0,0 +1,147 @@
+#include <limits.h>
+#include <stdlib.h>
+#include "rimappatura.h"
+
+/* Statistiche accumulate su tutte le sequenze eseguite dal thread chiamante (lette solo da stampa_rimappatura) */
+static __thread struct {
+    long sequenze;          // Sequenze esaminate (stato più grande di un blocco)
+    long rimappate;         // Sequenze eseguite con la rimappatura
+    long scambi;            // Scambi inseriti, compresi quelli di ritorno
+    long porte_spostate;    // Porte su qubit alti eseguite in posizione bassa
+    long passate_prima;     // Passate sullo stato senza rimappatura
+    long passate_dopo;      // Passate sullo stato con la rimappatura scelta
+} g_statistiche;
+
+
+/* Funzione di supporto: 1 se la porta agisce sul qubit q (come bersaglio o come controllo) */
+static int usa_qubit(const porta_t* p, int q) {
+    for (int j = 0; j < p->numero_ordinati; j++) {
+        if (p->ordinati[j] == q) return 1;
+    }
+    return 0;
+}
+
+/* Funzione di supporto: quante porte della finestra [k, k + FINESTRA_RIMAPPATURA) agiscono sul qubit logico q */
+static int usi_nella_finestra(const porta_t* const* porte, int k, int numero_porte, int q) {
+    int usi = 0;
+    for (int i = k; i < numero_porte && i < k + FINESTRA_RIMAPPATURA; i++) usi += usa_qubit(porte[i], q);
+    return usi;
+}
+
+/* Funzione di supporto: 1 se tutti i bersagli e i controlli della porta sono sotto QUBIT_BLOCCO */
+static int porta_bassa(const porta_t* p) {
+    return p->ordinati[p->numero_ordinati - 1] < QUBIT_BLOCCO;
+}
+
+/*
+ * Funzione di supporto che aggiunge alla sequenza lo scambio delle posizioni fisiche a e b
+ * e aggiorna la permutazione (mappa: logico → fisico, inversa: fisico → logico).
+ * Ritorna 0 se ok, -1 se la porta non può essere costruita.
+ */
+static int aggiungi_scambio(porta_t* fisiche, int* numero, int a, int b, int numero_qubit, int* mappa, int* inversa) {
+    int qubit[2] = {a, b};
+    if (crea_porta("SWAP", qubit, numero_qubit, &fisiche[*numero]) != 0) return -1;
+    (*numero)++;
+
+    int la = inversa[a], lb = inversa[b];
+    mappa[la] = b;
+    mappa[lb] = a;
+    inversa[a] = lb;
+    inversa[b] = la;
+    g_statistiche.scambi++;
+    return 0;
+}
+
+int applica_sequenza_rimappata(const porta_t* const* porte, int numero_porte, complesso_t* stato, int numero_qubit) {
+    if (numero_qubit <= QUBIT_BLOCCO || numero_porte < 2 || numero_qubit > 62) {    // Niente da guadagnare
+        return applica_sequenza_porte(porte, numero_porte, stato, numero_qubit);
+    }
+
+    int ret = -1;
+    int massimo = numero_porte * (MAX_ARGOMENTI_PORTA + 1) + numero_qubit;    // Porte, scambi in andata e di ritorno
+    porta_t* fisiche = (porta_t*)malloc(massimo * sizeof(porta_t));
+    const porta_t** sequenza = (const porta_t**)malloc(massimo * sizeof(const porta_t*));
+    if (!fisiche || !sequenza) goto fine;
+
+    int mappa[64], inversa[64];
+    for (int q = 0; q < numero_qubit; q++) mappa[q] = inversa[q] = q;
+
+    int numero = 0;
+    long scambi_prima = g_statistiche.scambi;
+    long spostate = 0;
+
+    for (int k = 0; k < numero_porte; k++) {
+        const porta_t* p = porte[k];
+
+        /* Porta su un qubit alto che resta usato nella finestra: lo scambia con il qubit basso meno usato */
+        for (int j = 0; j < p->numero_ordinati; j++) {
+            int q = p->ordinati[j];
+            if (mappa[q] < QUBIT_BLOCCO) continue;
+
+            int usi_q = usi_nella_finestra(porte, k, numero_porte, q);
+            if (usi_q < SOGLIA_RIMAPPATURA) continue;
+
+            int scelta = -1, usi_scelta = INT_MAX;
+            for (int f = 0; f < QUBIT_BLOCCO; f++) {
+                int l = inversa[f];
+                if (usa_qubit(p, l)) continue;      // Non può lasciare il blocco un altro qubit della porta
+                int u = usi_nella_finestra(porte, k, numero_porte, l);
+                if (u < usi_scelta) {
+                    usi_scelta = u;
+                    scelta = f;
+                }
+            }
+            if (scelta < 0 || usi_scelta >= usi_q) continue;
+            if (aggiungi_scambio(fisiche, &numero, scelta, mappa[q], numero_qubit, mappa, inversa) != 0) goto fine;
+        }
+
+        /* La porta agisce sulle posizioni fisiche dei suoi qubit */
+        porta_t* f = &fisiche[numero++];
+        *f = *p;
+        for (int j = 0; j < f->numero_bersagli; j++) f->bersagli[j] = mappa[p->bersagli[j]];
+        for (int j = 0; j < f->numero_controlli; j++) f->controlli[j] = mappa[p->controlli[j]];
+        completa_porta(f);
+        if (!porta_bassa(p) && porta_bassa(f)) spostate++;
+    }
+
+    /* Annulla la permutazione: ogni qubit logico torna nella propria posizione */
+    for (int f = 0; f < numero_qubit; f++) {
+        if (inversa[f] != f && aggiungi_scambio(fisiche, &numero, f, mappa[f], numero_qubit, mappa, inversa) != 0) goto fine;
+    }
+
+    for (int k = 0; k < numero; k++) sequenza[k] = &fisiche[k];
+    int passate_prima = passate_sequenza_porte(porte, numero_porte, numero_qubit);
+    int passate_dopo = passate_sequenza_porte(sequenza, numero, numero_qubit);
+
+    g_statistiche.sequenze++;
+    if (passate_dopo < passate_prima) {             // Conviene: si esegue la sequenza rimappata
+        g_statistiche.rimappate++;
+        g_statistiche.porte_spostate += spostate;
+        g_statistiche.passate_prima += passate_prima;
+        g_statistiche.passate_dopo += passate_dopo;
+        ret = applica_sequenza_porte(sequenza, numero, stato, numero_qubit);
+    } else {                                        // Gli scambi costerebbero più di quanto fanno risparmiare
+        g_statistiche.scambi = scambi_prima;
+        g_statistiche.passate_prima += passate_prima;
+        g_statistiche.passate_dopo += passate_prima;
+        ret = applica_sequenza_porte(porte, numero_porte, stato, numero_qubit);
+    }
+
+fine:
+    free(fisiche);
+    free(sequenza);
+    return ret;
+}
+
+void stampa_rimappatura(FILE* out) {
+    fprintf(out, "\n=== Rimappatura qubit ===\n");
+    if (g_statistiche.sequenze == 0) {
+        fprintf(out, "Nessuna sequenza di porte su uno stato più grande di un blocco (2^%d ampiezze)\n", QUBIT_BLOCCO);
+        return;
+    }
+    fprintf(out, "Sequenze di porte rimappate: %ld su %ld\n", g_statistiche.rimappate, g_statistiche.sequenze);
+    fprintf(out, "Scambi di qubit inseriti (compresi quelli di ritorno): %ld\n", g_statistiche.scambi);
+    fprintf(out, "Porte su qubit alti eseguite in posizione bassa: %ld\n", g_statistiche.porte_spostate);
+    fprintf(out, "Passate sullo stato: %ld senza rimappatura, %ld eseguite\n",
+            g_statistiche.passate_prima, g_statistiche.passate_dopo);
+}
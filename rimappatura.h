@@ -0,0 +1,37 @@
+#ifndef RIMAPPATURA_H
+#define RIMAPPATURA_H
+
+#include <stdio.h>
+#include "porte.h"
+
+/* Porte successive esaminate per decidere se portare un qubit alto in una posizione bassa */
+#ifndef FINESTRA_RIMAPPATURA
+#define FINESTRA_RIMAPPATURA 32
+#endif
+
+/* Usi minimi di un qubit alto nella finestra perché convenga lo scambio (costa una passata, più quella di ritorno) */
+#ifndef SOGLIA_RIMAPPATURA
+#define SOGLIA_RIMAPPATURA 3
+#endif
+
+/*
+ * Applica una sequenza di porte come applica_sequenza_porte, ma mantenendo una permutazione tra qubit
+ * logici (quelli del circuito) e posizioni fisiche (bit dell'indice del vettore in memoria).
+ * Quando un qubit alto (posizione >= QUBIT_BLOCCO) viene usato spesso dalle porte successive, la sua
+ * posizione viene scambiata con quella di un qubit basso poco usato, così le porte che lo coinvolgono
+ * rientrano nei passaggi a blocchi in cache. Gli scambi sono passate parallele sullo stato che spostano
+ * tratti contigui di ampiezze. Al termine la permutazione viene annullata, quindi lo stato torna
+ * nell'ordine logico prima di qualunque operatore denso e prima della stampa.
+ * Parametri: porte → puntatori alle porte nell'ordine, numero_porte → quante, stato → vettore di 2^numero_qubit ampiezze
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int applica_sequenza_rimappata(const porta_t* const* porte, int numero_porte, complesso_t* stato, int numero_qubit);
+
+/*
+ * Stampa il riepilogo delle rimappature eseguite (sequenze, scambi inseriti, porte portate in
+ * posizione bassa, passate sullo stato con e senza rimappatura).
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_rimappatura(FILE* out);
+
+#endif
@@ -0,0 +1,132 @@
+#include <math.h>
+#include <stdlib.h>
+#include "supporto.h"
+#include "thread_matrice.h"
+#include "memoria.h"
+
+/* Statistiche accumulate sui circuiti eseguiti dal thread chiamante (lette solo da stampa_supporto) */
+static __thread struct {
+    long sparse;            // Moltiplicazioni eseguite con il kernel sparso
+    long colonne;           // Colonne usate in totale dalle moltiplicazioni sparse
+    long dimensione;        // Dimensione del vettore di stato
+    long aggiornamenti;     // Ricalcoli del supporto dopo le porte
+    int denso;              // 1 se il tracciamento è stato disattivato
+    long supporto_finale;   // Ampiezze non nulle quando il tracciamento è stato disattivato
+} g_statistiche;
+
+/* Dati passati ai thread per la moltiplicazione sparsa */
+typedef struct {
+    const matrice_t* matrice;
+    const complesso_t* vettore;
+    const long* indici;
+    long numero;
+    complesso_t* risultato;
+} lavoro_supporto_t;
+
+
+/* Funzione di supporto: 1 se l'ampiezza è esattamente zero */
+static inline int ampiezza_nulla(const complesso_t* z) {
+    return z->parte_reale == 0.0 && z->parte_immaginaria == 0.0;
+}
+
+/* Funzione di supporto che raccoglie gli indici non nulli e disattiva il tracciamento oltre la soglia */
+static void calcola_supporto(supporto_t* s, const complesso_t* stato) {
+    long limite = s->dimensione / FRAZIONE_SUPPORTO;
+    s->numero = 0;
+    for (long i = 0; i < s->dimensione; i++) {
+        if (ampiezza_nulla(&stato[i])) continue;
+        if (s->numero == limite) {                  // Supporto ormai grande: da qui in poi solo percorso denso
+            s->attivo = 0;
+            g_statistiche.denso = 1;
+            g_statistiche.supporto_finale = limite + 1;
+            return;
+        }
+        s->indici[s->numero++] = i;
+    }
+}
+
+int inizializza_supporto(supporto_t* s, const complesso_t* stato, long dimensione) {
+    if (!s || !stato || dimensione <= 0) return -1;
+
+    s->dimensione = dimensione;
+    s->numero = 0;
+    s->attivo = 1;
+    s->indici = (long*)malloc((dimensione / FRAZIONE_SUPPORTO + 1) * sizeof(long));
+    if (!s->indici) return -1;
+
+    g_statistiche.dimensione = dimensione;
+    calcola_supporto(s, stato);
+    return 0;
+}
+
+void aggiorna_supporto(supporto_t* s, const complesso_t* stato) {
+    if (!s || !s->attivo) return;
+    g_statistiche.aggiornamenti++;
+    calcola_supporto(s, stato);
+}
+
+int supporto_sparso(const supporto_t* s) {
+    return s && s->attivo;
+}
+
+/* Funzione eseguita dalla squadra: calcola le righe [inizio, fine) combinando solo le colonne del supporto */
+static void moltiplica_righe_supporto(void* argomento, long inizio, long fine) {
+    const lavoro_supporto_t* lavoro = (const lavoro_supporto_t*)argomento;
+
+    for (long i = inizio; i < fine; i++) {
+        const complesso_t* riga = lavoro->matrice->dati[i];
+        double re = 0.0, im = 0.0;
+        for (long k = 0; k < lavoro->numero; k++) {
+            long j = lavoro->indici[k];
+            const complesso_t* u = &riga[j];
+            const complesso_t* z = &lavoro->vettore[j];
+            re += u->parte_reale * z->parte_reale - u->parte_immaginaria * z->parte_immaginaria;
+            im += u->parte_reale * z->parte_immaginaria + u->parte_immaginaria * z->parte_reale;
+        }
+        lavoro->risultato[i] = (complesso_t){re, im, signbit(im) ? '-' : '+'};
+    }
+}
+
+complesso_t* moltiplica_supporto(const matrice_t* m, const complesso_t* v, supporto_t* s) {
+    if (!m || !v || !supporto_sparso(s) || m->dimensione != s->dimensione) return NULL;
+
+    complesso_t* risultato = alloca_stato(s->dimensione, 0);
+    if (!risultato) return NULL;
+
+    lavoro_supporto_t lavoro = {m, v, s->indici, s->numero, risultato};
+    if (esegui_in_parallelo(moltiplica_righe_supporto, &lavoro, s->dimensione) != 0) {
+        free(risultato);
+        return NULL;
+    }
+
+    g_statistiche.sparse++;
+    g_statistiche.colonne += s->numero;
+    calcola_supporto(s, risultato);
+    return risultato;
+}
+
+void libera_supporto(supporto_t* s) {
+    if (!s) return;
+    free(s->indici);
+    s->indici = NULL;
+    s->numero = 0;
+    s->attivo = 0;
+}
+
+void stampa_supporto(FILE* out) {
+    fprintf(out, "\n=== Supporto dello stato ===\n");
+    if (g_statistiche.dimensione == 0) {
+        fprintf(out, "Supporto non tracciato (circuito eseguito con i kernel piccoli o distribuito)\n");
+        return;
+    }
+    fprintf(out, "Moltiplicazioni con kernel sparso: %ld (in media %.1f colonne su %ld)\n", g_statistiche.sparse,
+            g_statistiche.sparse ? (double)g_statistiche.colonne / g_statistiche.sparse : 0.0, g_statistiche.dimensione);
+    fprintf(out, "Prodotti complessi evitati: %ld\n",
+            (g_statistiche.sparse * g_statistiche.dimensione - g_statistiche.colonne) * g_statistiche.dimensione);
+    fprintf(out, "Ricalcoli del supporto dopo le porte: %ld\n", g_statistiche.aggiornamenti);
+    if (g_statistiche.denso) {
+        fprintf(out, "Passaggio al percorso denso con più di %ld ampiezze non nulle\n", g_statistiche.supporto_finale - 1);
+    } else {
+        fprintf(out, "Il supporto è rimasto sotto la soglia (1/%d dello stato) per tutto il circuito\n", FRAZIONE_SUPPORTO);
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef SUPPORTO_H
+#define SUPPORTO_H
+
+#include <stdio.h>
+#include "matrice.h"
+
+/* Il kernel sparso viene usato finché le ampiezze non nulle sono al massimo 1/FRAZIONE_SUPPORTO dello stato */
+#ifndef FRAZIONE_SUPPORTO
+#define FRAZIONE_SUPPORTO 8
+#endif
+
+/*
+ * Nuovo tipo che rappresenta il supporto del vettore di stato, cioè l'insieme degli indici delle
+ * ampiezze diverse da zero. Finché il supporto è piccolo (tipicamente subito dopo uno stato iniziale
+ * della base computazionale) le moltiplicazioni combinano solo le colonne dell'operatore corrispondenti
+ * a quegli indici; quando cresce oltre la soglia il tracciamento si ferma e si usa il percorso denso.
+ */
+typedef struct {
+    long* indici;           // Indici delle ampiezze non nulle, in ordine crescente
+    long numero;            // Quanti indici sono validi
+    long dimensione;        // Dimensione del vettore di stato
+    int attivo;             // 1 finché il supporto viene tracciato, 0 dopo il passaggio al percorso denso
+} supporto_t;
+
+/*
+ * Calcola il supporto dello stato iniziale.
+ * Parametri: s → supporto da valorizzare, stato → vettore, dimensione → sua lunghezza
+ * Ritorna: 0 se tutto ok, -1 in caso di errore di allocazione
+ */
+int inizializza_supporto(supporto_t* s, const complesso_t* stato, long dimensione);
+
+/*
+ * Ricalcola il supporto dopo che lo stato è stato modificato sul posto (es. dalle porte).
+ * Se il supporto supera la soglia il tracciamento si disattiva definitivamente.
+ * Parametri: s → supporto, stato → vettore aggiornato
+ */
+void aggiorna_supporto(supporto_t* s, const complesso_t* stato);
+
+/*
+ * Ritorna 1 se conviene il kernel sparso, cioè se il supporto è tracciato ed è sotto la soglia.
+ */
+int supporto_sparso(const supporto_t* s);
+
+/*
+ * Moltiplicazione matrice × vettore che usa solo le colonne della matrice negli indici del supporto:
+ * out[i] = somma_{j nel supporto} m[i][j] · v[j], in O(N · |supporto|) invece di O(N²).
+ * Le righe vengono suddivise tra i thread della squadra. Al termine il supporto viene aggiornato con
+ * quello del risultato (e disattivato se ha superato la soglia).
+ * Parametri: m → matrice quadrata, v → vettore con supporto s, s → supporto di v
+ * Ritorna: nuovo vettore risultato, NULL in caso di errore
+ */
+complesso_t* moltiplica_supporto(const matrice_t* m, const complesso_t* v, supporto_t* s);
+
+/*
+ * Libera la memoria del supporto.
+ */
+void libera_supporto(supporto_t* s);
+
+/*
+ * Stampa il riepilogo delle moltiplicazioni eseguite con il kernel sparso (quante, colonne usate,
+ * prodotti evitati) e dell'istruzione in cui è avvenuto il passaggio al percorso denso.
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_supporto(FILE* out);
+
+#endif
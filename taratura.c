@@ -0,0 +1,402 @@
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include "taratura.h"
+#include "thread_matrice.h"
+#include "kernel_piccoli.h"
+#include "porte.h"
+#include "profilo.h"
+#include "memoria.h"
+
+/* Ogni misura ripete il kernel almeno così tante volte e finché non passa TEMPO_MISURA (us) */
+#define RIPETIZIONI_MINIME 3
+#define RIPETIZIONI_MASSIME 200
+#define TEMPO_MISURA 5000.0
+
+/* Dimensione massima per cui la misura densa usa una matrice casuale quando il circuito non ne ha una caricata;
+ * la matrice viene creata solo se occupa al più 1/FRAZIONE_MEMORIA_PROVA della memoria disponibile, che resta
+ * alle matrici del circuito (4096 righe sono già 384 MiB) */
+#define DIMENSIONE_MATRICE_PROVA 4096
+#define FRAZIONE_MEMORIA_PROVA 8
+
+/* Grane provate per il numero di thread migliore (0, le parti fisse, è sempre provata per prima) */
+static const long g_grane[] = {16, 256, 4096};
+
+/* Esito dell'ultima taratura del thread chiamante (letto solo da stampa_taratura) */
+static __thread struct {
+    int eseguita;
+    taratura_t scelta;
+    int dal_file;           // 1 se letta dal file di taratura
+    int configurazioni;     // Configurazioni misurate
+    double tempo;           // Durata delle misure (us)
+    char carico;            // 'D' solo dense, 'P' solo porte, 'M' misto
+} g_statistiche;
+
+/* Kernel da misurare con una configurazione */
+typedef struct {
+    matrice_t* matrice;             // Matrice densa, NULL se la misura densa non si fa
+    matrice_piccola_t piccola;      // Copia compatta per i kernel specializzati
+    porta_t* porte;                 // Porte locali e diagonali su tutti i qubit
+    int numero_porte;
+    complesso_t* stato;
+    complesso_t* uscita;
+    int numero_qubit;
+    long dimensione;
+    long istruzioni_dense;          // Pesi: istruzioni con matrice densa e porte del circuito
+    long porte_circuito;
+} banco_t;
+
+
+/* Funzione di supporto: tempo minimo (us) di una esecuzione del kernel denso (dense = 1) o delle porte */
+static double misura(banco_t* b, int dense, int kernel_piccoli) {
+    double migliore = -1.0, totale = 0.0;
+    for (int r = 0; r < RIPETIZIONI_MASSIME && (r < RIPETIZIONI_MINIME || totale < TEMPO_MISURA); r++) {
+        double inizio = profilo_adesso();
+        if (dense && kernel_piccoli) {
+            moltiplica_matrice_vettore_piccola(&b->piccola, b->stato, b->uscita);
+        } else if (dense) {
+            complesso_t* risultato = moltiplica_matrice_vettore_mt_riuso(b->matrice, b->stato);
+            if (!risultato) return -1.0;
+            free(risultato);
+        } else if (applica_porte(b->porte, b->numero_porte, b->stato, b->numero_qubit) != 0) {
+            return -1.0;
+        }
+        double durata = profilo_adesso() - inizio;
+        totale += durata;
+        if (migliore < 0.0 || durata < migliore) migliore = durata;
+    }
+    return migliore;
+}
+
+/*
+ * Funzione di supporto: costo stimato (us) del circuito con la configurazione indicata, dalle misure
+ * pesate con il numero di istruzioni dense e di porte. Ritorna il costo, negativo in caso di errore.
+ */
+static double costo_configurazione(banco_t* b, taratura_t* c) {
+    squadra_t* squadra = NULL;
+    if (!c->kernel_piccoli) {
+        squadra = crea_squadra(c->numero_thread, b->dimensione);
+        if (!squadra) return -1.0;
+        imposta_grana_squadra(squadra, c->grana);
+    }
+    squadra_t* precedente = imposta_squadra_corrente(squadra);
+
+    double costo = 0.0;
+    if (b->matrice && b->istruzioni_dense > 0) {
+        double t = misura(b, 1, c->kernel_piccoli);
+        costo = t < 0.0 ? -1.0 : costo + t * b->istruzioni_dense;
+        c->tempo_denso = t;
+    }
+    if (costo >= 0.0 && (b->porte_circuito > 0 || !b->matrice)) {
+        double t = misura(b, 0, c->kernel_piccoli);
+        long peso = b->porte_circuito > 0 ? b->porte_circuito : b->istruzioni_dense * b->numero_porte;
+        costo = t < 0.0 ? -1.0 : costo + t * peso / b->numero_porte;
+        c->tempo_porta = t / b->numero_porte;
+    }
+
+    imposta_squadra_corrente(precedente);
+    distruggi_squadra(squadra);
+    g_statistiche.configurazioni++;
+    return costo;
+}
+
+/* Funzione di supporto: aggiunge ai pesi del banco le istruzioni indicate (quelle senza porte usano una matrice densa,
+ * anche se non ancora letta) */
+static void pesa_istruzioni(banco_t* b, const dati_input_t* dati, const istruzione_circuito_t* istruzioni, int numero) {
+    for (int i = 0; i < numero; i++) {
+        operatore_quantistico_t* op = trova_operatore((dati_input_t*)dati, istruzioni[i].nome_operatore);
+        if (!op) continue;
+        if (op->porte) {
+            b->porte_circuito += op->numero_porte;
+            continue;
+        }
+        b->istruzioni_dense++;
+        if (!b->matrice && op->matrice) b->matrice = op->matrice;
+    }
+}
+
+/* Funzione di supporto: valore pseudocasuale in [-0.5, 0.5) (xorshift64, senza toccare il generatore di rand) */
+static double valore_casuale(uint64_t* seme) {
+    *seme ^= *seme << 13;
+    *seme ^= *seme >> 7;
+    *seme ^= *seme << 17;
+    return (*seme >> 11) * (1.0 / 9007199254740992.0) - 0.5;
+}
+
+/* Funzione di supporto: prepara i kernel da misurare. Ritorna 0 se ok, -1 in caso di errore di allocazione. */
+static int prepara_banco(banco_t* b, const dati_input_t* dati, long dimensione, matrice_t** casuale) {
+    memset(b, 0, sizeof(*b));
+    b->numero_qubit = dati->numero_qubit;
+    b->dimensione = dimensione;
+    *casuale = NULL;
+
+    /* Pesi dal circuito e dalle sue varianti */
+    pesa_istruzioni(b, dati, dati->circuito, dati->numero_istruzioni);
+    for (int v = 0; v < dati->numero_varianti; v++) {
+        pesa_istruzioni(b, dati, dati->varianti[v].istruzioni, dati->varianti[v].numero_istruzioni);
+    }
+    long disponibili = memoria_disponibile();
+    double byte_matrice = (double)dimensione * dimensione * sizeof(complesso_t);
+    if (!b->matrice && b->istruzioni_dense > 0 && dimensione <= DIMENSIONE_MATRICE_PROVA &&
+        (disponibili < 0 || byte_matrice <= (double)disponibili / FRAZIONE_MEMORIA_PROVA)) {
+        *casuale = crea_matrice(dimensione);
+        if (!*casuale) return -1;
+        uint64_t seme = 0x9E3779B97F4A7C15ULL;     // Seme fisso: stessa matrice a ogni taratura
+        for (int i = 0; i < dimensione; i++) {
+            for (int j = 0; j < dimensione; j++) {
+                double re = valore_casuale(&seme), im = valore_casuale(&seme);
+                (*casuale)->dati[i][j] = (complesso_t){re, im, signbit(im) ? '-' : '+'};
+            }
+        }
+        b->matrice = *casuale;
+    }
+    if (b->matrice && kernel_piccolo_disponibile(dimensione) && prepara_matrice_piccola(b->matrice, &b->piccola) != 0) return -1;
+
+    /* Porte: H su ogni qubit (kernel locale) e CZ tra qubit vicini (kernel diagonale) */
+    b->porte = (porta_t*)malloc(2 * b->numero_qubit * sizeof(porta_t));
+    b->stato = alloca_stato(dimensione, 0);        // Come i vettori dell'esecuzione reale
+    b->uscita = alloca_stato(dimensione, 0);
+    if (!b->porte || !b->stato || !b->uscita) return -1;
+    for (int q = 0; q < b->numero_qubit; q++) {
+        int qubit[2] = {q, (q + 1) % b->numero_qubit};
+        if (crea_porta("H", qubit, b->numero_qubit, &b->porte[b->numero_porte]) == 0) b->numero_porte++;
+        if (b->numero_qubit > 1 && crea_porta("CZ", qubit, b->numero_qubit, &b->porte[b->numero_porte]) == 0) b->numero_porte++;
+    }
+    for (long i = 0; i < dimensione; i++) b->stato[i] = (complesso_t){1.0 / dimensione, 0.0, '+'};
+    return b->numero_porte > 0 ? 0 : -1;
+}
+
+/* Funzione di supporto: libera i kernel da misurare */
+static void libera_banco(banco_t* b, matrice_t* casuale) {
+    if (b->piccola.re) libera_matrice_piccola(&b->piccola);
+    distruggi_matrice(casuale);
+    free(b->porte);
+    free(b->stato);
+    free(b->uscita);
+}
+
+/* Funzione di supporto: tipo di circuito pesato nel banco ('D' solo dense, 'P' solo porte, 'M' misto) */
+static char carico_banco(const banco_t* b) {
+    return b->istruzioni_dense == 0 ? 'P' : (b->porte_circuito == 0 ? 'D' : 'M');
+}
+
+/* Funzione di supporto: nome dell'host come compare nel file di taratura (senza spazi) */
+static void nome_host(char* host, size_t n) {
+    snprintf(host, n, "sconosciuto");
+    gethostname(host, n - 1);
+    host[n - 1] = '\0';
+    for (char* p = host; *p; p++) if (*p == ' ' || *p == '\t') *p = '_';
+}
+
+/* Funzione di supporto: percorso del file di taratura. Ritorna 0 se ok, -1 se non determinabile. */
+static int percorso_taratura(const char* file, char* percorso, size_t n) {
+    if (file) return snprintf(percorso, n, "%s", file) < (int)n ? 0 : -1;
+    const char* casa = getenv("HOME");
+    if (!casa || !*casa) return -1;
+    return snprintf(percorso, n, "%s/%s", casa, FILE_TARATURA_DEFAULT) < (int)n ? 0 : -1;
+}
+
+/* Funzione di supporto: cerca nel file l'ultima riga per host, dimensione e carico. Ritorna 1 se trovata. */
+static int leggi_taratura(const char* percorso, const char* host, long dimensione, char carico, taratura_t* esito) {
+    FILE* f = fopen(percorso, "r");
+    if (!f) return 0;
+
+    char riga[512], h[256], variante[16];
+    int t, n, trovata = 0;
+    char c;
+    long d, g;
+    double denso, porta;
+    while (fgets(riga, sizeof(riga), f)) {
+        if (riga[0] == '#') continue;
+        n = sscanf(riga, "%255s %ld %c %d %ld %15s %lf %lf", h, &d, &c, &t, &g, variante, &denso, &porta);
+        if (n != 6 && n != 8) continue;     // Le righe scritte prima dei tempi hanno solo la configurazione
+        if (strcmp(h, host) != 0 || d != dimensione || c != carico || t <= 0 || g < 0) continue;
+        esito->numero_thread = t;
+        esito->grana = g;
+        esito->kernel_piccoli = strcmp(variante, "piccoli") == 0 && kernel_piccolo_disponibile(dimensione);
+        esito->tempo_denso = n == 8 && denso > 0.0 ? denso : 0.0;
+        esito->tempo_porta = n == 8 && porta > 0.0 ? porta : 0.0;
+        trovata = 1;                        // Vale l'ultima riga: una nuova taratura sostituisce le precedenti
+    }
+    fclose(f);
+    return trovata;
+}
+
+/* Funzione di supporto: aggiunge la configurazione al file, con un flock esclusivo durante la scrittura */
+static void scrivi_taratura(const char* percorso, const char* host, long dimensione, char carico, const taratura_t* c) {
+    int fd = open(percorso, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return;
+    if (flock(fd, LOCK_EX) == 0) {
+        char riga[512];
+        int n = 0;
+        off_t inizio = lseek(fd, 0, SEEK_END);
+        if (inizio == 0) {
+            n = snprintf(riga, sizeof(riga), "# host dimensione carico(D/P/M) thread grana variante us_denso us_porta\n");
+        }
+        n += snprintf(riga + n, sizeof(riga) - n, "%s %ld %c %d %ld %s %.3f %.3f\n", host, dimensione, carico,
+                      c->numero_thread, c->grana, c->kernel_piccoli ? "piccoli" : "squadra", c->tempo_denso, c->tempo_porta);
+        ssize_t scritti = n < (int)sizeof(riga) ? write(fd, riga, n) : -1;
+        if (scritti != n) {
+            /* Una riga scritta a metà verrebbe letta come una configurazione diversa: il file torna com'era
+             * e la taratura verrà ripetuta alla prossima esecuzione */
+            if (scritti > 0 && inizio >= 0 && ftruncate(fd, inizio) != 0) {
+                fprintf(stderr, "Attenzione: riga incompleta nel file di taratura %s, va cancellata\n", percorso);
+            } else {
+                fprintf(stderr, "Attenzione: taratura non salvata in %s\n", percorso);
+            }
+        }
+        flock(fd, LOCK_UN);
+    }
+    close(fd);
+}
+
+int tara_esecuzione(const dati_input_t* dati, long dimensione, int massimo_thread, const char* file, taratura_t* esito) {
+    if (!dati || dimensione <= 0 || massimo_thread <= 0 || !esito) return -1;
+    if (massimo_thread > dimensione) massimo_thread = dimensione;
+
+    banco_t b;
+    matrice_t* casuale = NULL;
+    int ret = -1;
+    memset(&g_statistiche, 0, sizeof(g_statistiche));
+    if (prepara_banco(&b, dati, dimensione, &casuale) != 0) goto fine;
+
+    char carico = carico_banco(&b);
+    char host[256], percorso[4096];
+    nome_host(host, sizeof(host));
+    int ha_percorso = percorso_taratura(file, percorso, sizeof(percorso)) == 0;
+    g_statistiche.carico = carico;
+
+    if (ha_percorso && leggi_taratura(percorso, host, dimensione, carico, esito)) {
+        if (esito->numero_thread > massimo_thread) esito->numero_thread = massimo_thread;
+        g_statistiche.dal_file = 1;
+        ret = 0;
+        goto fine;
+    }
+
+    double inizio = profilo_adesso();
+    taratura_t migliore = {1, 0, 0, 0.0, 0.0};
+    double costo_migliore = -1.0;
+
+    /* Kernel specializzati (un solo thread, senza squadra), dove esistono */
+    if (kernel_piccolo_disponibile(dimensione)) {
+        taratura_t c = {1, 0, 1, 0.0, 0.0};
+        costo_migliore = costo_configurazione(&b, &c);
+        if (costo_migliore >= 0.0) migliore = c;
+    }
+
+    /* Numero di thread: potenze di due fino al massimo, più il massimo stesso, con le parti fisse */
+    for (int t = 1; ; t = t * 2 < massimo_thread ? t * 2 : massimo_thread) {
+        taratura_t c = {t, 0, 0, 0.0, 0.0};
+        double costo = costo_configurazione(&b, &c);
+        if (costo < 0.0) goto fine;
+        if (costo_migliore < 0.0 || costo < costo_migliore) {
+            costo_migliore = costo;
+            migliore = c;
+        }
+        if (t == massimo_thread) break;
+    }
+
+    /* Grana, per il numero di thread scelto: pezzi dinamici al posto delle parti fisse */
+    if (!migliore.kernel_piccoli && migliore.numero_thread > 1) {
+        for (size_t k = 0; k < sizeof(g_grane) / sizeof(g_grane[0]); k++) {
+            if (g_grane[k] * migliore.numero_thread > dimensione / 2) break;  // Pezzi troppo grandi per tutti i thread
+            taratura_t c = {migliore.numero_thread, g_grane[k], 0, 0.0, 0.0};
+            double costo = costo_configurazione(&b, &c);
+            if (costo < 0.0) goto fine;
+            if (costo < costo_migliore) {
+                costo_migliore = costo;
+                migliore = c;
+            }
+        }
+    }
+
+    *esito = migliore;
+    g_statistiche.tempo = profilo_adesso() - inizio;
+    if (ha_percorso) scrivi_taratura(percorso, host, dimensione, carico, esito);
+    ret = 0;
+
+fine:
+    if (ret == 0) {
+        g_statistiche.eseguita = 1;
+        g_statistiche.scelta = *esito;
+    }
+    libera_banco(&b, casuale);
+    return ret;
+}
+
+/*
+ * Funzione di supporto: cerca la riga con i tempi per host e carico di dimensione più vicina (in rapporto)
+ * a quella indicata; a parità vale l'ultima. Ritorna 1 se trovata.
+ */
+static int leggi_taratura_vicina(const char* percorso, const char* host, long dimensione, char carico,
+                                 taratura_t* esito, long* dimensione_tarata) {
+    FILE* f = fopen(percorso, "r");
+    if (!f) return 0;
+
+    char riga[512], h[256], variante[16];
+    int t, trovata = 0;
+    char c;
+    long d, g;
+    double denso, porta, distanza_migliore = 0.0;
+    while (fgets(riga, sizeof(riga), f)) {
+        if (riga[0] == '#') continue;
+        if (sscanf(riga, "%255s %ld %c %d %ld %15s %lf %lf", h, &d, &c, &t, &g, variante, &denso, &porta) != 8) continue;
+        if (strcmp(h, host) != 0 || c != carico || d <= 0 || t <= 0 || g < 0 || (denso <= 0.0 && porta <= 0.0)) continue;
+        double distanza = d > dimensione ? (double)d / dimensione : (double)dimensione / d;
+        if (trovata && distanza > distanza_migliore) continue;
+        distanza_migliore = distanza;
+        esito->numero_thread = t;
+        esito->grana = g;
+        esito->kernel_piccoli = strcmp(variante, "piccoli") == 0 && kernel_piccolo_disponibile(dimensione);
+        esito->tempo_denso = denso > 0.0 ? denso : 0.0;
+        esito->tempo_porta = porta > 0.0 ? porta : 0.0;
+        *dimensione_tarata = d;
+        trovata = 1;
+    }
+    fclose(f);
+    return trovata;
+}
+
+int stima_taratura(const dati_input_t* dati, long dimensione, const char* file, taratura_t* esito, long* dimensione_tarata) {
+    if (!dati || dimensione <= 0 || !esito || !dimensione_tarata) return -1;
+
+    banco_t b;                              // Solo per i pesi: nessun vettore viene allocato
+    memset(&b, 0, sizeof(b));
+    pesa_istruzioni(&b, dati, dati->circuito, dati->numero_istruzioni);
+    for (int v = 0; v < dati->numero_varianti; v++) {
+        pesa_istruzioni(&b, dati, dati->varianti[v].istruzioni, dati->varianti[v].numero_istruzioni);
+    }
+
+    char host[256], percorso[4096];
+    nome_host(host, sizeof(host));
+    if (percorso_taratura(file, percorso, sizeof(percorso)) != 0) return -1;
+    if (!leggi_taratura_vicina(percorso, host, dimensione, carico_banco(&b), esito, dimensione_tarata)) return -1;
+
+    /* Tempi riportati alla dimensione richiesta: O(d^2) per la moltiplicazione densa, O(d) per una passata */
+    double rapporto = (double)dimensione / *dimensione_tarata;
+    esito->tempo_denso *= rapporto * rapporto;
+    esito->tempo_porta *= rapporto;
+    if (esito->numero_thread > dimensione) esito->numero_thread = dimensione;
+    return 0;
+}
+
+void stampa_taratura(FILE* out) {
+    fprintf(out, "\n=== Taratura (-t auto) ===\n");
+    if (!g_statistiche.eseguita) {
+        fprintf(out, "Taratura non eseguita\n");
+        return;
+    }
+    const taratura_t* c = &g_statistiche.scelta;
+    if (c->kernel_piccoli) fprintf(out, "Configurazione: kernel specializzati, 1 thread senza squadra\n");
+    else if (c->grana > 0) fprintf(out, "Configurazione: %d thread, pezzi di %ld elementi\n", c->numero_thread, c->grana);
+    else fprintf(out, "Configurazione: %d thread, una parte fissa per thread\n", c->numero_thread);
+    fprintf(out, "Circuito: %s\n", g_statistiche.carico == 'D' ? "solo matrici dense"
+                                 : g_statistiche.carico == 'P' ? "solo porte" : "matrici dense e porte");
+    if (g_statistiche.dal_file) fprintf(out, "Letta dal file di taratura\n");
+    else fprintf(out, "Misurata ora: %d configurazioni in %.1f ms\n", g_statistiche.configurazioni, g_statistiche.tempo / 1000.0);
+}
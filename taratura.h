@@ -0,0 +1,54 @@
+#ifndef TARATURA_H
+#define TARATURA_H
+
+#include <stdio.h>
+#include "lettore_input.h"
+
+/* File di taratura di default, nella cartella indicata da $HOME */
+#define FILE_TARATURA_DEFAULT ".qsim_taratura"
+
+/* Configurazione dell'esecuzione scelta dalla taratura (-t auto) */
+typedef struct {
+    int numero_thread;      // Thread della squadra
+    long grana;             // Grana dei job della squadra (imposta_grana_squadra), 0 per le parti fisse
+    int kernel_piccoli;     // 1 per i kernel specializzati senza squadra (solo N <= 5 qubit)
+    double tempo_denso;     // Tempo misurato (us) di una moltiplicazione densa con questa configurazione, 0 se non misurato
+    double tempo_porta;     // Tempo misurato (us) di una passata di una porta sullo stato, 0 se non misurato
+} taratura_t;
+
+/*
+ * Sceglie numero di thread, grana dei job e variante dei kernel per il circuito. Cerca prima nel file di
+ * taratura una riga per questo host, questa dimensione e questo tipo di circuito (solo matrici dense, solo
+ * porte o misto); se manca esegue brevi misure alla dimensione reale (moltiplicazione densa con la prima
+ * matrice del circuito, porte locali e diagonali su tutti i qubit) pesate con il numero di istruzioni dense
+ * e di porte del circuito, e aggiunge il risultato al file (con un flock, così più processi possono tararsi insieme).
+ * Parametri:
+ * dati → circuito letto, dimensione → 2^numero_qubit
+ * massimo_thread → thread provati al massimo (ad esempio i processori disponibili)
+ * file → file di taratura, NULL per $HOME/FILE_TARATURA_DEFAULT (senza $HOME la taratura non viene salvata)
+ * esito → configurazione scelta
+ * Ritorna: 0 se tutto ok, -1 in caso di errore
+ */
+int tara_esecuzione(const dati_input_t* dati, long dimensione, int massimo_thread, const char* file, taratura_t* esito);
+
+/*
+ * Cerca nel file di taratura, senza eseguire misure, la configurazione per questo host e questo tipo di
+ * circuito con i tempi misurati (righe scritte da tara_esecuzione). Se manca la riga per questa dimensione
+ * usa quella della dimensione più vicina, scalando i tempi (la moltiplicazione densa con il quadrato della
+ * dimensione, le porte con la dimensione).
+ * Parametri:
+ * dati → circuito (basta l'indice degli operatori), dimensione → 2^numero_qubit
+ * file → file di taratura, NULL per $HOME/FILE_TARATURA_DEFAULT
+ * esito → configurazione e tempi trovati, dimensione_tarata → dimensione della riga usata
+ * Ritorna: 0 se trovata, -1 se il file non ha righe con i tempi per questo host e questo tipo di circuito
+ */
+int stima_taratura(const dati_input_t* dati, long dimensione, const char* file, taratura_t* esito, long* dimensione_tarata);
+
+/*
+ * Stampa la configurazione scelta dall'ultima taratura del thread chiamante e la sua provenienza
+ * (file o misure, con il tempo impiegato).
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_taratura(FILE* out);
+
+#endif
@@ -0,0 +1,261 @@
+#!/bin/sh
+# Test di regressione (make test).
+# 1) Esempi di esempi/: ogni coppia init/circ viene eseguita con 1 e 4 thread, senza opzioni, con --verify=1,
+#    con --tolleranza=-1 (senza fattorizzazione) e con entrambe, e lo stato finale viene confrontato con
+#    il finalstate corrispondente.
+# 2) Circuiti casuali densi, di Kronecker e di porte scritti da genera_circuito, eseguiti con --verify=1
+#    (il programma termina con errore se un kernel si discosta dal riferimento) e confrontati con lo stato
+#    finale calcolato dal generatore.
+# 3) Le opzioni che non cambiano il risultato (--pipeline, -p con entrambi i trasporti, -t auto, --trace,
+#    --peephole, --varianti, --flusso, --sweep) su un circuito denso e uno di porte: ogni stato finale viene
+#    confrontato con quello dell'esecuzione semplice del circuito corrispondente; --plan deve stampare il piano
+#    senza simulare.
+# 4) L'interfaccia della libreria (test_libreria): contesti concorrenti con la traccia e futuri.
+# Utilizzo: esegui_test.sh <progetto_qsim> <genera_circuito> <test_libreria>
+
+PROGRAMMA=${1:-./progetto_qsim}
+GENERATORE=${2:-test/genera_circuito}
+LIBRERIA=${3:-test/test_libreria}
+ESEMPI=$(dirname "$0")/../esempi
+
+# Scarto massimo ammesso per ogni ampiezza: lo stato finale viene stampato con 5 decimali
+TOLLERANZA=2e-5
+
+CARTELLA=$(mktemp -d) || exit 1
+trap 'rm -rf "$CARTELLA"' EXIT INT TERM
+
+superati=0
+falliti=0
+
+# Stampa la lista di ampiezze tra la k-esima "[" del file (default la prima) e la "]" successiva, su una sola riga
+vettore() {
+    tr '\r\n' '  ' < "$1" | awk -v k="${2:-1}" '{ if (split($0, parti, "[") > k) { sub(/\].*$/, "", parti[k + 1]); printf "%s", parti[k + 1] } }'
+}
+
+# Confronta le liste di ampiezze di due file (formato a+ib / a-ib), la k1-esima del primo e la k2-esima del
+# secondo (default le prime). Ritorna 0 se coincidono entro TOLLERANZA.
+confronta() {
+    { vettore "$1" "$3"; echo; vettore "$2" "$4"; echo; } | awk -v eps="$TOLLERANZA" '
+        function leggi(riga, re, im,    n, i, t, p, k) {
+            gsub(/[()]/, " ", riga)
+            n = split(riga, voci, ",")
+            k = 0
+            for (i = 1; i <= n; i++) {
+                t = voci[i]
+                gsub(/[ \t]/, "", t)
+                if (t == "") continue
+                k++
+                p = match(t, /[+-]i/)
+                if (p == 0) { re[k] = t + 0; im[k] = 0; continue }
+                re[k] = substr(t, 1, p - 1) + 0
+                im[k] = substr(t, p + 2) + 0
+                if (substr(t, p, 1) == "-") im[k] = -im[k]
+            }
+            return k
+        }
+        NR == 1 { n1 = leggi($0, re1, im1) }
+        NR == 2 { n2 = leggi($0, re2, im2) }
+        END {
+            if (n1 == 0 || n1 != n2) exit 1
+            for (i = 1; i <= n1; i++) {
+                dr = re1[i] - re2[i]; di = im1[i] - im2[i]
+                if (dr > eps || -dr > eps || di > eps || -di > eps) exit 1
+            }
+        }'
+}
+
+# Esegue il programma con gli argomenti dati e confronta lo stato finale con il file atteso
+# Parametri: nome del caso, file atteso, argomenti del programma
+esegui() {
+    nome=$1
+    atteso=$2
+    shift 2
+    if "$PROGRAMMA" "$@" > "$CARTELLA/uscita" 2> "$CARTELLA/errori" && confronta "$CARTELLA/uscita" "$atteso"; then
+        superati=$((superati + 1))
+    else
+        falliti=$((falliti + 1))
+        echo "FALLITO: $nome ($PROGRAMMA $*)"
+        head -n 5 "$CARTELLA/errori"
+    fi
+}
+
+# Esegue il programma una volta e confronta gli stati finali stampati, nell'ordine, con i file attesi; lo
+# standard input viene letto da $INGRESSO (default /dev/null)
+# Parametri: nome del caso, file attesi separati da spazi, argomenti del programma
+esegui_piu() {
+    nome=$1
+    attesi=$2
+    shift 2
+    ok=0
+    if "$PROGRAMMA" "$@" < "${INGRESSO:-/dev/null}" > "$CARTELLA/uscita" 2> "$CARTELLA/errori"; then
+        ok=1
+        k=1
+        for atteso in $attesi; do
+            confronta "$CARTELLA/uscita" "$atteso" $k || ok=0
+            k=$((k + 1))
+        done
+        [ -z "$(vettore "$CARTELLA/uscita" $k)" ] || ok=0
+    fi
+    if [ $ok -eq 1 ]; then
+        superati=$((superati + 1))
+    else
+        falliti=$((falliti + 1))
+        echo "FALLITO: $nome ($PROGRAMMA $*)"
+        head -n 5 "$CARTELLA/errori"
+    fi
+}
+
+# Scrive in $3 il file circuito $1 con il testo $2 aggiunto in fondo alla riga #circ
+estendi_circuito() {
+    sed -e "s|^#circ .*|& $2|" "$1" > "$CARTELLA/esteso"
+    mv "$CARTELLA/esteso" "$3"
+}
+
+# Esecuzione semplice usata come riferimento per un caso senza stato atteso del generatore
+# Parametri: nome del caso, file in cui salvare l'uscita, argomenti del programma
+riferimento() {
+    nome=$1
+    uscita=$2
+    shift 2
+    if "$PROGRAMMA" "$@" > "$uscita" 2> "$CARTELLA/errori" && [ -n "$(vettore "$uscita")" ]; then
+        superati=$((superati + 1))
+    else
+        falliti=$((falliti + 1))
+        echo "FALLITO: $nome ($PROGRAMMA $*)"
+        head -n 5 "$CARTELLA/errori"
+    fi
+}
+
+# Esegue un caso con 1 e 4 thread e con tutte le combinazioni di --verify=1 e --tolleranza=-1
+esegui_varianti() {
+    prefisso=$1
+    atteso=$2
+    iniziale=$3
+    circuito=$4
+    for t in 1 4; do
+        esegui "$prefisso -t $t" "$atteso" -t $t -i "$iniziale" -c "$circuito"
+        esegui "$prefisso -t $t --verify=1" "$atteso" -t $t -i "$iniziale" -c "$circuito" --verify=1
+        esegui "$prefisso -t $t --tolleranza=-1" "$atteso" -t $t -i "$iniziale" -c "$circuito" --tolleranza=-1
+        esegui "$prefisso -t $t --verify=1 --tolleranza=-1" "$atteso" -t $t -i "$iniziale" -c "$circuito" --verify=1 --tolleranza=-1
+    done
+}
+
+# Esempi: init3 è |0> su 10 qubit, quindi H su ogni qubit dà finalstate3 e X X sullo stesso qubit lo lascia
+# invariato (finalstate3nonewlines); circ4 (X X I) lascia invariato lo stato di init4
+echo "#circ H 0 H 1 H 2 H 3 H 4 H 5 H 6 H 7 H 8 H 9" > "$CARTELLA/circ3.txt"
+echo "#circ X 9 X 9 H 0 H 0" > "$CARTELLA/circ3_identita.txt"
+esegui_varianti "esempio 1" "$ESEMPI/finalstate1.txt" "$ESEMPI/init1.txt" "$ESEMPI/circ1.txt"
+esegui_varianti "esempio 2" "$ESEMPI/finalstate2.txt" "$ESEMPI/init2.txt" "$ESEMPI/circ2.txt"
+esegui_varianti "esempio 3" "$ESEMPI/finalstate3.txt" "$ESEMPI/init3.txt" "$CARTELLA/circ3.txt"
+esegui_varianti "esempio 3 (identità)" "$ESEMPI/finalstate3nonewlines.txt" "$ESEMPI/init3.txt" "$CARTELLA/circ3_identita.txt"
+esegui_varianti "esempio 4" "$ESEMPI/init4.txt" "$ESEMPI/init4.txt" "$ESEMPI/circ4.txt"
+
+# Circuiti casuali: dimensioni sotto e sopra i kernel specializzati (N <= 5) e, per le porte, sopra il
+# blocco in cache (13 qubit); i circuiti densi vengono eseguiti anche con la cache degli unitari fusi
+for seme in 1 2 3; do
+    for caso in "denso 3" "denso 7" "kronecker 4" "kronecker 8" "porte 4" "porte 9" "porte 15"; do
+        set -- $caso
+        tipo=$1
+        qubit=$2
+        nome="$tipo $qubit qubit, seme $seme"
+        if ! "$GENERATORE" "$tipo" "$qubit" "$seme" "$CARTELLA/init.txt" "$CARTELLA/circ.txt" "$CARTELLA/atteso.txt"; then
+            falliti=$((falliti + 1))
+            echo "FALLITO: generazione di $nome"
+            continue
+        fi
+        esegui "$nome" "$CARTELLA/atteso.txt" -t 4 -i "$CARTELLA/init.txt" -c "$CARTELLA/circ.txt" --verify=1
+        esegui "$nome --tolleranza=-1" "$CARTELLA/atteso.txt" -t 2 -i "$CARTELLA/init.txt" -c "$CARTELLA/circ.txt" --verify=1 --tolleranza=-1
+        if [ "$tipo" = denso ]; then
+            esegui "$nome --cache" "$CARTELLA/atteso.txt" -t 4 -i "$CARTELLA/init.txt" -c "$CARTELLA/circ.txt" --verify=1 --cache="$CARTELLA/cache"
+        fi
+    done
+done
+
+# Opzioni confrontate con l'esecuzione semplice: un circuito denso abbastanza grande da usare la squadra e uno
+# di porte; la parte parametrica del --sweep viene aggiunta in fondo al circuito e sostituita a mano per ogni punto
+printf 'theta, gamma\n0.3 -0.25\n# punto ignorato\n\n1.25 -pi/4\n' > "$CARTELLA/tabella.txt"
+PARAMETRICA="RX(theta) 0 C-RZ(-2*gamma) 1 2 RY(theta/2) 2 PHASE(gamma) 1"
+PUNTO_1="RX(0.3) 0 C-RZ(0.5) 1 2 RY(0.15) 2 PHASE(-0.25) 1"
+PUNTO_2="RX(1.25) 0 C-RZ(pi/2) 1 2 RY(0.625) 2 PHASE(-pi/4) 1"
+for caso in "denso 7" "porte 10"; do
+    set -- $caso
+    tipo=$1
+    qubit=$2
+    circuito="$tipo $qubit qubit"
+    base=$CARTELLA/$tipo
+    if ! "$GENERATORE" "$tipo" "$qubit" 4 "$base.init" "$base.circ" "$base.atteso"; then
+        falliti=$((falliti + 1))
+        echo "FALLITO: generazione di $circuito"
+        continue
+    fi
+    esegui "$circuito" "$base.atteso" -t 2 -i "$base.init" -c "$base.circ"
+    cp "$CARTELLA/uscita" "$base.semplice"
+
+    esegui "$circuito --pipeline" "$base.semplice" -t 2 -i "$base.init" -c "$base.circ" --pipeline
+    for trasporto in shm socket; do
+        esegui "$circuito -p 3 --trasporto=$trasporto" "$base.semplice" -t 1 -i "$base.init" -c "$base.circ" -p 3 --trasporto=$trasporto
+    done
+    # La prima esecuzione con -t auto tara e salva, la seconda legge il file di taratura
+    esegui "$circuito -t auto" "$base.semplice" -t auto --taratura="$CARTELLA/taratura" -i "$base.init" -c "$base.circ"
+    esegui "$circuito -t auto (taratura salvata)" "$base.semplice" -t auto --taratura="$CARTELLA/taratura" -i "$base.init" -c "$base.circ"
+    esegui "$circuito --trace" "$base.semplice" -t 2 -i "$base.init" -c "$base.circ" --trace="$CARTELLA/traccia.bin"
+    esegui "$circuito --trace-ogni=2 --trace-comprimi" "$base.semplice" -t 2 -i "$base.init" -c "$base.circ" \
+        --trace="$CARTELLA/traccia.bin" --trace-ogni=2 --trace-comprimi
+
+    # --plan: piano con una riga per istruzione, numerate da 1, e nessuno stato finale
+    if "$PROGRAMMA" -t auto --taratura="$CARTELLA/taratura" -i "$base.init" -c "$base.circ" --plan > "$CARTELLA/uscita" 2> "$CARTELLA/errori" &&
+        grep -q "^=== Piano di esecuzione ===" "$CARTELLA/uscita" && ! grep -q "Stato finale" "$CARTELLA/uscita" &&
+        awk '/^Circuito:/ { match($0, /[0-9]+ istruzioni/); n = substr($0, RSTART, RLENGTH) + 0 } /^ +[0-9]+  / { if ($1 != ++righe) exit 1 } END { exit !(n > 0 && righe == n) }' \
+            "$CARTELLA/uscita"; then
+        superati=$((superati + 1))
+    else
+        falliti=$((falliti + 1))
+        echo "FALLITO: $circuito --plan"
+        head -n 5 "$CARTELLA/errori"
+    fi
+
+    # --peephole: coppie che si annullano, T^8 e X X aggiunte al circuito non cambiano lo stato finale
+    sed -e 's/^#circ /#circ H 0 H 0 T 1 T 1 T 1 T 1 T 1 T 1 T 1 T 1 /' "$base.circ" > "$base.identita"
+    estendi_circuito "$base.identita" "X 2 CNOT 0 1 CNOT 0 1 X 2" "$base.identita"
+    esegui "$circuito --peephole" "$base.semplice" -t 2 -i "$base.init" -c "$base.identita" --peephole
+
+    # --varianti: il circuito stesso e lo stesso circuito con due porte in più
+    estendi_circuito "$base.circ" "H 0 CNOT 0 1" "$base.variante"
+    riferimento "$circuito (seconda variante)" "$base.semplice_variante" -t 2 -i "$base.init" -c "$base.variante"
+    grep "^#circ" "$base.circ" > "$base.varianti"
+    grep "^#circ" "$base.variante" >> "$base.varianti"
+    esegui_piu "$circuito --varianti" "$base.semplice $base.semplice_variante" -t 2 -i "$base.init" -c "$base.circ" --varianti="$base.varianti"
+
+    # --flusso: lo stato di #init, |3> e di nuovo lo stato di #init
+    printf '#qubits %s\n#init |3>\n' "$qubit" > "$base.init3"
+    riferimento "$circuito da |3>" "$base.semplice3" -t 2 -i "$base.init3" -c "$base.circ"
+    { echo "[ $(vettore "$base.init") ]"; echo "|3>"; echo "[ $(vettore "$base.init") ]"; } > "$base.flusso"
+    INGRESSO=$base.flusso esegui_piu "$circuito --flusso=2" "$base.semplice $base.semplice3 $base.semplice" -t 2 -i "$base.init" -c "$base.circ" --flusso=2
+
+    # --sweep: due punti della tabella, confrontati con il circuito con i valori sostituiti
+    estendi_circuito "$base.circ" "$PARAMETRICA" "$base.parametrico"
+    estendi_circuito "$base.circ" "$PUNTO_1" "$base.punto1"
+    estendi_circuito "$base.circ" "$PUNTO_2" "$base.punto2"
+    for punto in 1 2; do
+        riferimento "$circuito (punto $punto)" "$base.semplice_punto$punto" -t 2 -i "$base.init" -c "$base.punto$punto"
+    done
+    esegui_piu "$circuito --sweep" "$base.semplice_punto1 $base.semplice_punto2" -t 2 -i "$base.init" -c "$base.parametrico" --sweep="$CARTELLA/tabella.txt"
+done
+
+# Interfaccia della libreria: una riga "ok" o "FALLITO" per caso
+"$GENERATORE" porte 9 5 "$CARTELLA/lib_a.init" "$CARTELLA/lib_a.circ" "$CARTELLA/lib_a.atteso" &&
+    "$GENERATORE" denso 6 5 "$CARTELLA/lib_b.init" "$CARTELLA/lib_b.circ" "$CARTELLA/lib_b.atteso" &&
+    "$LIBRERIA" "$CARTELLA/lib_a.init" "$CARTELLA/lib_a.circ" "$CARTELLA/lib_b.init" "$CARTELLA/lib_b.circ" "$CARTELLA" \
+        > "$CARTELLA/uscita" 2> "$CARTELLA/errori"
+esito=$?
+grep "^FALLITO" "$CARTELLA/uscita"
+superati=$((superati + $(grep -c "^ok" "$CARTELLA/uscita")))
+falliti=$((falliti + $(grep -c "^FALLITO" "$CARTELLA/uscita")))
+if [ $esito -ne 0 ] && ! grep -q "^FALLITO" "$CARTELLA/uscita"; then
+    falliti=$((falliti + 1))
+    echo "FALLITO: $LIBRERIA"
+    head -n 5 "$CARTELLA/errori"
+fi
+
+echo "Test superati: $superati, falliti: $falliti"
+[ "$falliti" -eq 0 ]
@@ -0,0 +1,314 @@
+/*
+ * Generatore di circuiti casuali per i test (make test).
+ * Scrive il file iniziale, il file del circuito e lo stato finale atteso, calcolato con un riferimento
+ * semplice e indipendente dal simulatore (prodotti matrice × vettore e porte applicate ampiezza per ampiezza).
+ *
+ * Utilizzo: genera_circuito <denso|kronecker|porte> <numero_qubit> <seme> <file_iniziale> <file_circuito> <file_atteso>
+ * - denso: operatori unitari densi casuali (Gram-Schmidt su una matrice casuale), con istruzioni consecutive
+ *   che formano tratti fusi dalla cache;
+ * - kronecker: operatori prodotto di Kronecker di porte 2x2 casuali scritti come matrici dense (vengono
+ *   fattorizzati al caricamento), insieme a un operatore denso non fattorizzabile;
+ * - porte: porte predefinite casuali, anche con qubit di controllo (prefisso C-).
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <complex.h>
+
+#define PI_GRECO 3.14159265358979323846
+
+/* Stato del generatore pseudo-casuale (splitmix64): la stessa sequenza su ogni piattaforma */
+static uint64_t g_stato;
+
+/* Funzione di supporto: prossimo numero pseudo-casuale a 64 bit */
+static uint64_t casuale(void) {
+    uint64_t z = (g_stato += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Funzione di supporto: numero uniforme in [a, b) */
+static double uniforme(double a, double b) {
+    return a + (b - a) * (double)(casuale() >> 11) / 9007199254740992.0;
+}
+
+/* Funzione di supporto: intero uniforme in [0, n) */
+static int intero(int n) {
+    return (int)(casuale() % (uint64_t)n);
+}
+
+/* Funzione di supporto: scrive un complesso nel formato dei file di input */
+static void scrivi_complesso(FILE* f, double complex z) {
+    fprintf(f, "%.12f%ci%.12f", creal(z), signbit(cimag(z)) ? '-' : '+', fabs(cimag(z)));
+}
+
+/* Funzione di supporto: scrive "#define nome [ (riga) ... ]" per una matrice d x d */
+static void scrivi_operatore(FILE* f, const char* nome, const double complex* m, int d) {
+    fprintf(f, "#define %s [", nome);
+    for (int i = 0; i < d; i++) {
+        fprintf(f, " (");
+        for (int j = 0; j < d; j++) {
+            if (j > 0) fprintf(f, ", ");
+            scrivi_complesso(f, m[(size_t)i * d + j]);
+        }
+        fprintf(f, ")");
+    }
+    fprintf(f, " ]\n\n");
+}
+
+/* Funzione di supporto: scrive un vettore come lista "[ ... ]" */
+static void scrivi_vettore(FILE* f, const double complex* v, int d) {
+    fprintf(f, "[");
+    for (int i = 0; i < d; i++) {
+        fprintf(f, i > 0 ? ", " : " ");
+        scrivi_complesso(f, v[i]);
+    }
+    fprintf(f, " ]\n");
+}
+
+/* Funzione di supporto: arrotonda come scrivi_complesso, così il riferimento usa i valori letti dal simulatore */
+static double complex arrotonda(double complex z) {
+    char testo[64];
+    snprintf(testo, sizeof(testo), "%.12f %.12f", creal(z), cimag(z));
+    double re, im;
+    sscanf(testo, "%lf %lf", &re, &im);
+    return re + im * I;
+}
+
+/* Funzione di supporto: matrice unitaria d x d casuale (Gram-Schmidt sulle righe di una matrice casuale) */
+static void unitaria_casuale(double complex* m, int d) {
+    for (int i = 0; i < d; i++) {
+        double complex* r = &m[(size_t)i * d];
+        for (int j = 0; j < d; j++) r[j] = uniforme(-1.0, 1.0) + uniforme(-1.0, 1.0) * I;
+        for (int k = 0; k < i; k++) {
+            const double complex* q = &m[(size_t)k * d];
+            double complex p = 0.0;
+            for (int j = 0; j < d; j++) p += conj(q[j]) * r[j];
+            for (int j = 0; j < d; j++) r[j] -= p * q[j];
+        }
+        double norma = 0.0;
+        for (int j = 0; j < d; j++) norma += creal(r[j] * conj(r[j]));
+        norma = sqrt(norma);
+        for (int j = 0; j < d; j++) r[j] /= norma;
+    }
+    for (size_t i = 0; i < (size_t)d * d; i++) m[i] = arrotonda(m[i]);
+}
+
+/* Funzione di supporto: porta 2x2 unitaria casuale (forma di Eulero) */
+static void porta_casuale(double complex u[4]) {
+    double a = uniforme(0.0, 2.0 * PI_GRECO), b = uniforme(0.0, 2.0 * PI_GRECO);
+    double c = uniforme(0.0, 2.0 * PI_GRECO), t = uniforme(0.0, PI_GRECO);
+    u[0] = cexp(I * a) * cos(t);
+    u[1] = cexp(I * b) * sin(t);
+    u[2] = -cexp(I * (c - b)) * sin(t);
+    u[3] = cexp(I * (c - a)) * cos(t);
+}
+
+/* Funzione di supporto: prodotto di Kronecker di n porte 2x2 casuali (la prima sul qubit più alto) */
+static void kronecker_casuale(double complex* m, int n) {
+    int d = 1 << n;
+    for (int i = 0; i < d * d; i++) m[i] = 1.0;
+    for (int q = 0; q < n; q++) {
+        double complex u[4];
+        porta_casuale(u);
+        int bit = n - 1 - q;
+        for (int i = 0; i < d; i++) {
+            for (int j = 0; j < d; j++) m[(size_t)i * d + j] *= u[((i >> bit) & 1) * 2 + ((j >> bit) & 1)];
+        }
+    }
+    for (size_t i = 0; i < (size_t)d * d; i++) m[i] = arrotonda(m[i]);
+}
+
+/* Funzione di supporto: v ← M v */
+static void applica_matrice(const double complex* m, double complex* v, double complex* lavoro, int d) {
+    for (int i = 0; i < d; i++) {
+        double complex s = 0.0;
+        for (int j = 0; j < d; j++) s += m[(size_t)i * d + j] * v[j];
+        lavoro[i] = s;
+    }
+    memcpy(v, lavoro, d * sizeof(double complex));
+}
+
+/* Funzione di supporto: applica la porta 2x2 u al qubit bersaglio, sulle ampiezze con tutti i bit di controlli a 1 */
+static void applica_porta(const double complex u[4], int bersaglio, unsigned controlli, double complex* v, int d) {
+    for (int i = 0; i < d; i++) {
+        if ((i >> bersaglio) & 1 || ((unsigned)i & controlli) != controlli) continue;
+        int k = i | (1 << bersaglio);
+        double complex a = v[i], b = v[k];
+        v[i] = u[0] * a + u[1] * b;
+        v[k] = u[2] * a + u[3] * b;
+    }
+}
+
+/* Funzione di supporto: scambia i qubit a e b */
+static void applica_scambio(int a, int b, double complex* v, int d) {
+    for (int i = 0; i < d; i++) {
+        if (!((i >> a) & 1) || ((i >> b) & 1)) continue;
+        int k = (i & ~(1 << a)) | (1 << b);
+        double complex t = v[i];
+        v[i] = v[k];
+        v[k] = t;
+    }
+}
+
+/* Funzione di supporto: matrice 2x2 della porta predefinita g con angolo theta */
+static void matrice_porta(const char* g, double theta, double complex u[4]) {
+    double c = cos(theta / 2.0), s = sin(theta / 2.0), r = 1.0 / sqrt(2.0);
+    u[0] = 1.0; u[1] = 0.0; u[2] = 0.0; u[3] = 1.0;
+    if (strcmp(g, "H") == 0) { u[0] = r; u[1] = r; u[2] = r; u[3] = -r; }
+    else if (strcmp(g, "X") == 0) { u[0] = 0.0; u[1] = 1.0; u[2] = 1.0; u[3] = 0.0; }
+    else if (strcmp(g, "Y") == 0) { u[0] = 0.0; u[1] = -I; u[2] = I; u[3] = 0.0; }
+    else if (strcmp(g, "Z") == 0) u[3] = -1.0;
+    else if (strcmp(g, "S") == 0) u[3] = I;
+    else if (strcmp(g, "SDG") == 0) u[3] = -I;
+    else if (strcmp(g, "T") == 0) u[3] = cexp(I * PI_GRECO / 4.0);
+    else if (strcmp(g, "TDG") == 0) u[3] = cexp(-I * PI_GRECO / 4.0);
+    else if (strcmp(g, "RX") == 0) { u[0] = c; u[1] = -I * s; u[2] = -I * s; u[3] = c; }
+    else if (strcmp(g, "RY") == 0) { u[0] = c; u[1] = -s; u[2] = s; u[3] = c; }
+    else if (strcmp(g, "RZ") == 0) { u[0] = cexp(-I * theta / 2.0); u[3] = cexp(I * theta / 2.0); }
+    else if (strcmp(g, "PHASE") == 0) u[3] = cexp(I * theta);
+}
+
+/* Funzione di supporto: sceglie k qubit distinti tra n */
+static void qubit_distinti(int* q, int k, int n) {
+    for (int i = 0; i < k; i++) {
+        int ripetuto;
+        do {
+            q[i] = intero(n);
+            ripetuto = 0;
+            for (int j = 0; j < i; j++) ripetuto |= q[j] == q[i];
+        } while (ripetuto);
+    }
+}
+
+/*
+ * Funzione di supporto: scrive in f un circuito di porte predefinite casuali e lo applica a v.
+ * Metà delle porte agiscono sui qubit bassi, così formano sequenze eseguite a blocchi.
+ */
+static void circuito_porte(FILE* f, int n, int numero_porte, double complex* v) {
+    static const char* singole[] = {"H", "X", "Y", "Z", "S", "SDG", "T", "TDG", "RX", "RY", "RZ", "PHASE"};
+    int d = 1 << n;
+
+    fprintf(f, "#circ");
+    for (int p = 0; p < numero_porte; p++) {
+        int q[4];
+        int scelta = intero(10);
+        if (scelta < 6) {                       // Porta singola, con 0, 1 o 2 controlli
+            const char* g = singole[intero(12)];
+            int controlli = intero(n >= 3 ? 3 : n);
+            int basso = intero(2) == 0;
+            do {
+                qubit_distinti(q, controlli + 1, n);
+            } while (basso && q[controlli] >= 4);           // Bersaglio tra i qubit 0..3
+
+            double theta = 0.0;
+            fprintf(f, " ");
+            for (int j = 0; j < controlli; j++) fprintf(f, "C-");
+            fprintf(f, "%s", g);
+            if (strcmp(g, "RX") == 0 || strcmp(g, "RY") == 0 || strcmp(g, "RZ") == 0 || strcmp(g, "PHASE") == 0) {
+                char testo[32];                 // Angolo scritto con 6 cifre e riletto come dal simulatore
+                snprintf(testo, sizeof(testo), "%.6f", uniforme(-2.0 * PI_GRECO, 2.0 * PI_GRECO));
+                theta = atof(testo);
+                fprintf(f, "(%s)", testo);
+            }
+            unsigned maschera = 0;
+            for (int j = 0; j <= controlli; j++) fprintf(f, " %d", q[j]);
+            for (int j = 0; j < controlli; j++) maschera |= 1u << q[j];
+
+            double complex u[4];
+            matrice_porta(g, theta, u);
+            applica_porta(u, q[controlli], maschera, v, d);
+        } else if (scelta < 9 || n < 3) {       // CNOT, CZ o SWAP
+            const char* nomi[] = {"CNOT", "CZ", "SWAP"};
+            int k = intero(3);
+            qubit_distinti(q, 2, n);
+            fprintf(f, " %s %d %d", nomi[k], q[0], q[1]);
+            if (k == 2) {
+                applica_scambio(q[0], q[1], v, d);
+            } else {
+                double complex u[4];
+                matrice_porta(k == 0 ? "X" : "Z", 0.0, u);
+                applica_porta(u, q[1], 1u << q[0], v, d);
+            }
+        } else {                                // Toffoli
+            double complex u[4];
+            qubit_distinti(q, 3, n);
+            fprintf(f, " CCX %d %d %d", q[0], q[1], q[2]);
+            matrice_porta("X", 0.0, u);
+            applica_porta(u, q[2], (1u << q[0]) | (1u << q[1]), v, d);
+        }
+    }
+    fprintf(f, "\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 7) {
+        fprintf(stderr, "Utilizzo: %s <denso|kronecker|porte> <numero_qubit> <seme> <file_iniziale> <file_circuito> <file_atteso>\n", argv[0]);
+        return 1;
+    }
+    const char* tipo = argv[1];
+    int n = atoi(argv[2]);
+    g_stato = strtoull(argv[3], NULL, 10);
+    int porte = strcmp(tipo, "porte") == 0;
+    if (n < 1 || n > (porte ? 20 : 10) || (!porte && strcmp(tipo, "denso") != 0 && strcmp(tipo, "kronecker") != 0)) {
+        fprintf(stderr, "Errore: tipo o numero di qubit non validi\n");
+        return 1;
+    }
+
+    int d = 1 << n;
+    double complex* v = (double complex*)malloc(d * sizeof(double complex));
+    double complex* lavoro = (double complex*)malloc(d * sizeof(double complex));
+    double complex* operatori = porte ? NULL : (double complex*)malloc(3 * (size_t)d * d * sizeof(double complex));
+    FILE* iniziale = fopen(argv[4], "w");
+    FILE* circuito = fopen(argv[5], "w");
+    FILE* atteso = fopen(argv[6], "w");
+    if (!v || !lavoro || (!porte && !operatori) || !iniziale || !circuito || !atteso) {
+        fprintf(stderr, "Errore: impossibile preparare i file del test\n");
+        return 1;
+    }
+
+    /* Stato iniziale: una base casuale o un vettore casuale normalizzato */
+    double norma = 0.0;
+    int base = intero(4) == 0;
+    for (int i = 0; i < d; i++) {
+        v[i] = base ? 0.0 : uniforme(-1.0, 1.0) + uniforme(-1.0, 1.0) * I;
+        norma += creal(v[i] * conj(v[i]));
+    }
+    if (base) v[intero(d)] = 1.0;
+    for (int i = 0; !base && i < d; i++) v[i] = arrotonda(v[i] / sqrt(norma));
+    fprintf(iniziale, "#qubits %d\n\n#init ", n);
+    scrivi_vettore(iniziale, v, d);
+
+    if (porte) {
+        circuito_porte(circuito, n, 60, v);
+    } else {
+        /* Tre operatori (nel circuito kronecker l'ultimo è denso) e una sequenza con ripetizioni consecutive */
+        for (int k = 0; k < 3; k++) {
+            double complex* m = &operatori[(size_t)k * d * d];
+            if (tipo[0] == 'k' && k < 2) kronecker_casuale(m, n);
+            else unitaria_casuale(m, d);
+            char nome[8];
+            snprintf(nome, sizeof(nome), "U%d", k);
+            scrivi_operatore(circuito, nome, m, d);
+        }
+        fprintf(circuito, "#circ");
+        for (int i = 0; i < 8; i++) {
+            int k = intero(3);
+            fprintf(circuito, " U%d", k);
+            applica_matrice(&operatori[(size_t)k * d * d], v, lavoro, d);
+        }
+        fprintf(circuito, "\n");
+    }
+    scrivi_vettore(atteso, v, d);
+
+    int ok = fclose(iniziale) == 0;
+    ok = fclose(circuito) == 0 && ok;
+    ok = fclose(atteso) == 0 && ok;
+    free(v);
+    free(lavoro);
+    free(operatori);
+    return ok ? 0 : 1;
+}
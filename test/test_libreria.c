@@ -0,0 +1,248 @@
+/*
+ * Test dell'interfaccia della libreria libqsim (make test), usata solo attraverso qsim.h e lavori.h.
+ * Su due circuiti di dimensioni diverse:
+ * - due contesti eseguiti insieme da due thread, ognuno con la propria traccia (una compressa): gli stati
+ *   finali devono coincidere con quelli di contesti senza traccia e ogni traccia deve contenere un'istantanea
+ *   per istruzione, con l'ultima uguale allo stato finale del proprio contesto;
+ * - lavori inviati a un servizio con i futuri, da #init e da stati iniziali dati, confrontati con qsim_esegui
+ *   e qsim_esegui_batch di un contesto senza servizio.
+ *
+ * Utilizzo: test_libreria <iniziale_a> <circuito_a> <iniziale_b> <circuito_b> <cartella>
+ * Stampa una riga per caso ("ok: ..." oppure "FALLITO: ...") e termina con errore se almeno un caso è fallito.
+ */
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "qsim.h"
+#include "lavori.h"
+
+/* Scarto massimo ammesso tra due esecuzioni dello stesso circuito con kernel diversi */
+#define TOLLERANZA 1e-9
+
+/* Stati iniziali dati inviati al servizio per ogni contesto */
+#define LAVORI 3
+
+static int g_falliti = 0;
+
+/* Funzione di supporto: stampa l'esito di un caso */
+static void esito(int ok, const char* caso, const char* circuito) {
+    printf("%s: %s (%s)\n", ok ? "ok" : "FALLITO", caso, circuito);
+    if (!ok) g_falliti++;
+}
+
+/* Funzione di supporto: 1 se i due stati coincidono entro TOLLERANZA */
+static int uguali(const complesso_t* a, const complesso_t* b, long dimensione) {
+    if (!a || !b) return 0;
+    for (long i = 0; i < dimensione; i++) {
+        if (!(fabs(a[i].parte_reale - b[i].parte_reale) <= TOLLERANZA &&
+              fabs(a[i].parte_immaginaria - b[i].parte_immaginaria) <= TOLLERANZA)) return 0;
+    }
+    return 1;
+}
+
+/* Funzione di supporto: crea, carica e compila un contesto con 2 thread. Ritorna NULL se errore */
+static qsim_contesto_t* prepara(const char* iniziale, const char* circuito, const char* traccia, int comprimi) {
+    qsim_opzioni_t opzioni;
+    qsim_opzioni_default(&opzioni);
+    opzioni.numero_thread = 2;
+    opzioni.file_traccia = traccia;
+    opzioni.traccia_comprimi = comprimi;
+
+    qsim_contesto_t* ctx = qsim_crea(&opzioni);
+    if (!ctx) return NULL;
+    if (qsim_carica(ctx, iniziale, circuito) != 0 || qsim_compila(ctx) != 0) {
+        qsim_distruggi(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+/*
+ * Funzione di supporto che rilegge una traccia senza conoscere il simulatore: controlla l'intestazione e la
+ * numerazione delle istantanee (una per istruzione, con tutte le istruzioni selezionate) e copia l'ultima in ultima.
+ * Ritorna: numero di istantanee, -1 se il file non è nel formato di traccia.h
+ */
+static long rileggi_traccia(const char* file, int numero_qubit, complesso_t* ultima) {
+    FILE* f = fopen(file, "rb");
+    if (!f) return -1;
+
+    long dimensione = 1L << numero_qubit;
+    long parole = 2 * dimensione;                   // Parole di 64 bit di un'istantanea
+    uint64_t* corrente = (uint64_t*)calloc(parole, sizeof(uint64_t));
+    long istantanee = -1;
+    char magia[8];
+    int32_t qubit, compressione;
+
+    if (!corrente || fread(magia, 1, 8, f) != 8 || memcmp(magia, "QSIMTRC1", 8) != 0 ||
+        fread(&qubit, sizeof(qubit), 1, f) != 1 || fread(&compressione, sizeof(compressione), 1, f) != 1 ||
+        qubit != numero_qubit || (compressione != 0 && compressione != 1)) goto fine;
+
+    for (long k = 0; ; k++) {
+        int32_t esecuzione, istruzione;
+        char nome[32];
+        if (fread(&esecuzione, sizeof(esecuzione), 1, f) != 1) {
+            istantanee = feof(f) ? k : -1;          // Fine del file tra due istantanee
+            break;
+        }
+        if (fread(&istruzione, sizeof(istruzione), 1, f) != 1 || fread(nome, 1, 32, f) != 32) break;
+        if (esecuzione != 0 || istruzione != k) break;
+
+        if (!compressione) {
+            if ((long)fread(corrente, sizeof(uint64_t), parole, f) != parole) break;
+            continue;
+        }
+        /* Gruppi {zeri, letterali}: le parole nulle restano quelle dell'istantanea precedente */
+        long letta = 0;
+        while (letta < parole) {
+            uint32_t zeri, letterali;
+            if (fread(&zeri, sizeof(zeri), 1, f) != 1 || fread(&letterali, sizeof(letterali), 1, f) != 1 ||
+                letta + (long)zeri + (long)letterali > parole) break;
+            letta += zeri;
+            for (uint32_t j = 0; j < letterali; j++, letta++) {
+                uint64_t x;
+                if (fread(&x, sizeof(x), 1, f) != 1) break;
+                corrente[letta] ^= x;
+            }
+        }
+        if (letta != parole) break;
+    }
+
+    for (long i = 0; istantanee > 0 && i < dimensione; i++) {
+        memcpy(&ultima[i].parte_reale, &corrente[2 * i], sizeof(double));
+        memcpy(&ultima[i].parte_immaginaria, &corrente[2 * i + 1], sizeof(double));
+    }
+
+fine:
+    free(corrente);
+    fclose(f);
+    return istantanee;
+}
+
+/* Argomento del thread che esegue un contesto con la traccia */
+typedef struct {
+    qsim_contesto_t* ctx;
+    int esito;
+} esecuzione_t;
+
+static void* esegui_contesto(void* arg) {
+    esecuzione_t* e = (esecuzione_t*)arg;
+    e->esito = qsim_esegui(e->ctx) == 0 && qsim_chiudi_traccia(e->ctx) == 0 ? 0 : -1;
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 6) {
+        fprintf(stderr, "Utilizzo: %s <iniziale_a> <circuito_a> <iniziale_b> <circuito_b> <cartella>\n", argv[0]);
+        return 2;
+    }
+    const char* iniziali[2] = {argv[1], argv[3]};
+    const char* circuiti[2] = {argv[2], argv[4]};
+    char tracce[2][4096];
+    qsim_contesto_t* riferimenti[2] = {NULL, NULL};
+    qsim_contesto_t* tracciati[2] = {NULL, NULL};
+    qsim_contesto_t* serviti[2] = {NULL, NULL};
+
+    /* Riferimento: ogni circuito eseguito da solo, senza traccia */
+    for (int c = 0; c < 2; c++) {
+        riferimenti[c] = prepara(iniziali[c], circuiti[c], NULL, 0);
+        if (!riferimenti[c] || qsim_esegui(riferimenti[c]) != 0) {
+            esito(0, "esecuzione di riferimento", circuiti[c]);
+            goto fine;
+        }
+    }
+
+    /* Due contesti con la propria traccia, eseguiti insieme da due thread */
+    pthread_t thread[2];
+    esecuzione_t esecuzioni[2];
+    int avviati = 0;
+    for (int c = 0; c < 2; c++) {
+        snprintf(tracce[c], sizeof(tracce[c]), "%s/traccia_%d.bin", argv[5], c);
+        tracciati[c] = prepara(iniziali[c], circuiti[c], tracce[c], c);
+        if (!tracciati[c]) {
+            esito(0, "contesto con traccia", circuiti[c]);
+            goto fine;
+        }
+    }
+    for (int c = 0; c < 2; c++) {
+        esecuzioni[c] = (esecuzione_t){tracciati[c], -1};
+        if (pthread_create(&thread[c], NULL, esegui_contesto, &esecuzioni[c]) == 0) avviati++;
+    }
+    for (int c = 0; c < avviati; c++) pthread_join(thread[c], NULL);
+
+    for (int c = 0; c < 2; c++) {
+        long dimensione = qsim_dimensione(tracciati[c]);
+        complesso_t* ultima = (complesso_t*)calloc(dimensione, sizeof(complesso_t));
+        esito(esecuzioni[c].esito == 0 && uguali(qsim_stato_finale(tracciati[c]), qsim_stato_finale(riferimenti[c]), dimensione),
+              c ? "contesti concorrenti con traccia compressa, stato finale" : "contesti concorrenti con traccia, stato finale",
+              circuiti[c]);
+        long istantanee = ultima ? rileggi_traccia(tracce[c], qsim_numero_qubit(tracciati[c]), ultima) : -1;
+        esito(istantanee > 0 && uguali(ultima, qsim_stato_finale(tracciati[c]), dimensione),
+              c ? "traccia compressa, istantanee e ultimo stato" : "traccia, istantanee e ultimo stato", circuiti[c]);
+        free(ultima);
+    }
+
+    /* Futuri: per ogni circuito un lavoro da #init e LAVORI da stati della base |k>, inviati insieme */
+    qsim_servizio_t* servizio = qsim_crea_servizio(2, 4);
+    complesso_t* stati[2][LAVORI][2];               // Stato iniziale e finale di ogni lavoro
+    qsim_futuro_t* futuri[2][LAVORI + 1];
+    memset(stati, 0, sizeof(stati));
+    memset(futuri, 0, sizeof(futuri));
+    for (int c = 0; c < 2 && servizio; c++) {
+        serviti[c] = prepara(iniziali[c], circuiti[c], NULL, 0);
+        long dimensione = qsim_dimensione(riferimenti[c]);
+        for (int k = 0; k < LAVORI; k++) {
+            stati[c][k][0] = (complesso_t*)calloc(dimensione, sizeof(complesso_t));
+            stati[c][k][1] = (complesso_t*)calloc(dimensione, sizeof(complesso_t));
+            if (!stati[c][k][0] || !stati[c][k][1]) continue;
+            for (long i = 0; i < dimensione; i++) stati[c][k][0][i].segno = '+';
+            stati[c][k][0][k % dimensione].parte_reale = 1.0;
+        }
+        if (!serviti[c]) continue;
+        futuri[c][0] = qsim_invia(servizio, serviti[c], NULL, NULL, NULL, NULL, 1);
+        for (int k = 0; k < LAVORI; k++) {
+            if (stati[c][k][0] && stati[c][k][1])
+                futuri[c][k + 1] = qsim_invia(servizio, serviti[c], stati[c][k][0], stati[c][k][1], NULL, NULL, 1);
+        }
+    }
+    for (int c = 0; c < 2; c++) {
+        int ok = servizio && serviti[c];
+        for (int k = 0; k <= LAVORI; k++) {
+            if (!futuri[c][k] || qsim_attendi(futuri[c][k]) != 0) ok = 0;
+        }
+        long dimensione = qsim_dimensione(riferimenti[c]);
+        esito(ok && uguali(qsim_stato_finale(serviti[c]), qsim_stato_finale(riferimenti[c]), dimensione),
+              "futuro da #init", circuiti[c]);
+
+        /* Gli stessi stati iniziali con qsim_esegui_batch sul contesto di riferimento */
+        complesso_t* attesi[LAVORI];
+        int pronti = 1;
+        for (int k = 0; k < LAVORI; k++) {
+            attesi[k] = (complesso_t*)calloc(dimensione, sizeof(complesso_t));
+            if (!attesi[k] || !stati[c][k][0]) pronti = 0;
+        }
+        const complesso_t* da[LAVORI];
+        for (int k = 0; k < LAVORI; k++) da[k] = stati[c][k][0];
+        pronti = pronti && qsim_esegui_batch(riferimenti[c], da, attesi, LAVORI) == 0;
+        for (int k = 0; pronti && k < LAVORI; k++) {
+            if (!uguali(stati[c][k][1], attesi[k], dimensione)) ok = 0;
+        }
+        esito(ok && pronti, "futuri da stati iniziali dati", circuiti[c]);
+        for (int k = 0; k < LAVORI; k++) {
+            free(attesi[k]);
+            free(stati[c][k][0]);
+            free(stati[c][k][1]);
+        }
+    }
+    qsim_distruggi_servizio(servizio);
+
+fine:
+    for (int c = 0; c < 2; c++) {
+        qsim_distruggi(riferimenti[c]);
+        qsim_distruggi(tracciati[c]);
+        qsim_distruggi(serviti[c]);
+    }
+    return g_falliti > 0 ? 1 : 0;
+}
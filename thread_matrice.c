@@ -1,268 +1,610 @@
-#include <pthread.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdio.h>
-#include "thread_matrice.h"
-#include "complesso.h"
-         
-
-/*
- * Nuovo tipo utilizzato per raccogliere i dati assegnati a ciascun thread della squadra.
- * Ogni thread calcola sempre lo stesso intervallo di righe (riga_inizio, riga_fine).
- */
-typedef struct {
-    int riga_inizio;                    // Riga inizio calcolo
-    int riga_fine;                      // Riga fine calcolo
-    unsigned long last_job_visto;       // Id dell'ultimo job eseguito
-} dati_thread_squadra_t;
-
-
-/* Stato della squadra di thread (variabili statiche del modulo) */
-
-static pthread_t* g_thread = NULL;                 // Array dei thread della squadra
-static dati_thread_squadra_t* g_dati = NULL;       // Array contenente i dati di ogni thread
-static int g_numero_thread = 0;                    // Numero thread creati
-static int g_dimensione = 0;                       // Dimensione N (2^qubit)
-
-static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;     // Protegge lo stato condiviso
-static pthread_cond_t g_cond_inizio = PTHREAD_COND_INITIALIZER; // Segnale: lavoro disponibile
-static pthread_cond_t g_cond_fine = PTHREAD_COND_INITIALIZER;   // Segnale: lavoro completato
-
-static int g_lavoro_disponibile = 0;               // 1 se c'è un job da eseguire
-static int g_termina = 0;                          // 1 per dire ai thread di terminare
-static int g_thread_finiti = 0;                    // Quanti thread hanno finito il job corrente
-static unsigned long g_job_id = 0;                 // Identificatore del job corrente (incrementa ad ogni moltiplicazione)
-
-/* Puntatori al job corrente (validi solo durante l’esecuzione di una moltiplicazione) */
-static matrice_t* g_matrice = NULL;
-static complesso_t* g_vettore = NULL;
-static complesso_t* g_risultato = NULL;
-
-
-/*
- * Funzione eseguita da ciascun thread della squadra.
- * Il thread resta vivo: attende lavoro, calcola, segnala fine, torna in attesa.
- */
-static void* funzione_thread_squadra(void* arg) {
-    dati_thread_squadra_t* dati = (dati_thread_squadra_t*)arg;  // cast del tipo di struttura necessario perché la funzione prende void *arg
-
-    while (1) {    // ciclo infinito perché il thread è persistente, non termina dopo il lavoro eseguito, ne attende altri
-        pthread_mutex_lock(&g_mutex);   // Effettua un lock per entrare nella sezione critica 
-
-        // Attende che ci sia lavoro e sia un job nuovo (non già visto da questo thread)
-        // oppure che venga richiesto di terminare          
-        while (((!g_lavoro_disponibile) || (dati->last_job_visto == g_job_id)) && !g_termina) {
-            pthread_cond_wait(&g_cond_inizio, &g_mutex);    // Rilascia g_mutex (unlock) e va in attesa sulla condition g_cond_inizio
-        }                                                   // Il lock è nuovamente acquisito dal thread quando viene risvegliato
-
-        /* Se richiesto, termina il thread */
-        if (g_termina) {
-            pthread_mutex_unlock(&g_mutex);     // Effettua un unlock
-            return NULL;
-        }
-
-        /* Segna che questo thread sta per processare il job corrente */
-        dati->last_job_visto = g_job_id;
-
-        /* Copia locale dei parametri del job, poi rilascia il mutex e calcola */
-        matrice_t* m = g_matrice;           // Matrice da moltiplicare con il vettore
-        complesso_t* v = g_vettore;         // Vettore da moltiplicare con la matrice 
-        complesso_t* out = g_risultato;     // Vettore che conterrà il risultato parzialmente calcolato
-        int n = g_dimensione;               // Dimensione matrice 
-
-        int r0 = dati->riga_inizio;         // Riga da cui inizia il calcolo del thread
-        int r1 = dati->riga_fine;           // Riga che delimita la fine, non verra calcolata dal thread
-
-        pthread_mutex_unlock(&g_mutex);     // Effettua un unlock
-
-        /* Stampa di debug */
-        //fprintf(stderr, "Thread righe (%d,%d) parte: lavoro=%d finiti=%d job=%lu out=%p v=%p\n", r0, r1, g_lavoro_disponibile, g_thread_finiti, g_job_id, (void*)out, (void*)v);
-
-        /* Calcola le righe assegnate */
-        for (int i = r0; i < r1; i++) {
-            complesso_t somma = (complesso_t){0.0, 0.0, '\0'};
-
-            for (int j = 0; j < n; j++) {
-                complesso_t prodotto = moltiplica_complessi(m->dati[i][j], v[j]);
-                somma = somma_complessi(somma, prodotto);
-            }
-
-            out[i] = somma;
-        }
-
-        /* Segnala completamento */
-        pthread_mutex_lock(&g_mutex);   // Rientra in sezione critica per aggiornare il contatore 
-        g_thread_finiti++;              // Dei thread che hanno finito il lavoro
-
-        /* L’ultimo thread che finisce sveglia chi sta aspettando */
-        if (g_thread_finiti == g_numero_thread) {   // g_numero_thread sono i lavori totali per ottenere il risultato finale
-            g_lavoro_disponibile = 0;               // Se è vero non c'è più nulla da fare
-            pthread_cond_signal(&g_cond_fine);      // Sveglia il thread main 
-        }
-
-        pthread_mutex_unlock(&g_mutex);    // Effettua un unlock ed esce dalla sezione critica 
-    }
-}
-
-
-/*
- * Inizializza una squadra di thread riutilizzabili per le moltiplicazioni matrice × vettore.
- * Parametri:
- * numero_thread → numero di thread da creare
- * dimensione → dimensione della matrice e del vettore
- * Ritorna: 0 se tutto ok, -1 in caso di errore
- */
-int inizializza_squadra_thread(int numero_thread, int dimensione) {
-    if (numero_thread <= 0 || dimensione <= 0) return -1;
-    if (g_thread != NULL) return -1;    // Evita doppia inizializzazione 
-
-    g_numero_thread = numero_thread;    // Numero di thread che comporra la squadra
-    g_dimensione = dimensione;          // Dimensione N
-
-    g_thread = (pthread_t*)malloc(numero_thread * sizeof(pthread_t));   // Alloca memoria per array di thread della squadra
-    g_dati = (dati_thread_squadra_t*)malloc(numero_thread * sizeof(dati_thread_squadra_t));     // Alloca memoria per array di dati dei thread
-    if (!g_thread || !g_dati) {     // Se almeno un'allocazione è fallita
-        free(g_thread);             // Libera la memoria e ripristina le variabili
-        free(g_dati);               
-        g_thread = NULL;
-        g_dati = NULL;
-        g_numero_thread = 0;        // Resetta tutte le variabili 
-        g_dimensione = 0;
-        return -1;
-    }
-
-    /* Suddivide le righe tra i thread */
-    int righe_per_thread = dimensione / numero_thread;  
-    int riga_corrente = 0;
-
-    for (int t = 0; t < numero_thread; t++) {   // Assegna ad ogni t-esimo thread il suo intervallo di righe
-        g_dati[t].riga_inizio = riga_corrente;
-
-        if (t == numero_thread - 1) {
-            g_dati[t].riga_fine = dimensione;  // ultimo thread prende eventuali righe rimanenti 
-        } else {
-            g_dati[t].riga_fine = riga_corrente + righe_per_thread;
-        }
-
-        g_dati[t].last_job_visto = 0;   // Inizializza lo stato interno del thread
-
-        riga_corrente = g_dati[t].riga_fine;    // Aggiorna la riga corrente prima di passare alla prossima iterazione
-
-        /*
-         * &g_thread[t]: Destinazione dell'id del thread appena creato;
-         * funzione_thread_squadra: Funzione che verrà eseguita dal thread;
-         * &g_dati[t]: Argomento passato al thread per la funzione, ogni thread riceve l’indirizzo della sua struct diversa per ogni t
-         */
-        if (pthread_create(&g_thread[t], NULL, funzione_thread_squadra, &g_dati[t]) != 0) {
-            /* In caso di errore, chiede terminazione ai thread già creati e fa join */
-            pthread_mutex_lock(&g_mutex);            // Effettua un lock
-            g_termina = 1;                           // Imposta g_termina a 1
-            pthread_cond_broadcast(&g_cond_inizio);  // Sveglia tutti i thread che potrebbero essere bloccati in g_cond_inizio
-            pthread_mutex_unlock(&g_mutex);          // Rilascia il lock così gli altri thread posso vedere g_termina ad 1
-
-            for (int k = 0; k < t; k++) {
-                pthread_join(g_thread[k], NULL);     // Attende che tutti i thread siano terminati prima di procedere
-            }                                        
-
-            free(g_thread);         // Libera la memoria allocata
-            free(g_dati);
-
-            g_thread = NULL;   
-            g_dati = NULL;
-            g_numero_thread = 0;    // Resetta tutte le variabili
-            g_dimensione = 0;
-            g_termina = 0;
-
-            return -1;
-        }
-    }
-
-    return 0;
-}
-
-
-
-/*
- * Funzione per la moltiplicazione matrice × vettore che utilizza una squadra di thread già inizializzata.
- * Parametri:
- * m → matrice quadrata N × N
- * v → vettore di dimensione N
- * Valore di ritorno: puntatore a un nuovo vettore contenente il risultato in caso di successo,
- * oppure NULL in caso di errore
- */
-complesso_t* moltiplica_matrice_vettore_mt_riuso(matrice_t* m, complesso_t* v) {
-
-    /* Controllo parametri */
-    if (m == NULL || v == NULL) return NULL;
-
-    /* Verifica che la squadra esista e che la dimensione sia coerente */
-    if (g_thread == NULL || g_dimensione != m->dimensione) return NULL;
-
-    int dimensione = m->dimensione;
-
-    /* Alloca il vettore risultato */
-    complesso_t* risultato = (complesso_t*)malloc(dimensione * sizeof(complesso_t));
-    if (!risultato) return NULL;
-
-    pthread_mutex_lock(&g_mutex);   // Effettua un lock prima di entrare nella sezione critica 
-
-    /* Imposta il job corrente */
-    g_matrice = m;                  // Matrice m da moltiplicare al vettore v
-    g_vettore = v;                  // Vettore v da moltiplicare a matrice m
-    g_risultato = risultato;        // Risultato della moltiplicazione r = m * v
-
-    /* Nuovo job: incrementa id e reset contatori */
-    g_job_id++;                     // Incrementa contatore dei lavori
-    g_thread_finiti = 0;            // Setta la variabile dei thread che hanno gia finito a 0
-    g_lavoro_disponibile = 1;       // Setta la variabile del lavoro disponibile a 1
-
-    /* Sveglia tutti i thread per iniziare il lavoro */
-    pthread_cond_broadcast(&g_cond_inizio); 
-
-    /* Attende che l’ultimo thread segnali la fine */
-    while (g_lavoro_disponibile) {      // Finché tutte le operazioni non sono terminare attende
-        pthread_cond_wait(&g_cond_fine, &g_mutex);
-    }
-
-    pthread_mutex_unlock(&g_mutex);     // Effettua un unlock ed esce dalla sezione critica
-
-    return risultato;   // Ritorna il risultato
-}
-
-
-/*
- * Distrugge la squadra di thread: segnala terminazione, attende (join) e libera la memoria.
- * Ritorna: 0 se tutto ok, -1 se la squadra non era inizializzata
- */
-int distruggi_squadra_thread(void) {
-    if (g_thread == NULL) return -1;    
-
-    pthread_mutex_lock(&g_mutex);               // Effettua un lock per entrare nella sezione critica
-    g_termina = 1;                              // Setta la variabile di termine a 1
-    pthread_cond_broadcast(&g_cond_inizio);     // Sveglia tutti i thread che potrebbero essere addormentati in g_cond_inizio
-    pthread_mutex_unlock(&g_mutex);             // Effettua un unlock ed esce dalla sezione critica 
-
-    for (int t = 0; t < g_numero_thread; t++) { // Attende tutti i thread della squadra 
-        pthread_join(g_thread[t], NULL);        // NULL indica che non importa il valore di ritorno della funzione pthread_join
-    }
-
-    free(g_thread);         // Libera la memoria occupata dall'allocazione degli array 
-    free(g_dati);           // g_thread e g_dati
-
-    /* Reset delle variabili statiche del modulo */
-    g_thread = NULL;
-    g_dati = NULL;          
-    g_numero_thread = 0;
-    g_dimensione = 0;
-
-    g_matrice = NULL;
-    g_vettore = NULL;
-    g_risultato = NULL;
-
-    g_lavoro_disponibile = 0;
-    g_thread_finiti = 0;
-    g_termina = 0;
-    g_job_id = 0;
-
-    return 0;
-}
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "thread_matrice.h"
+#include "complesso.h"
+#include "profilo.h"
+#include "contatori_hw.h"
+#include "memoria.h"
+         
+
+/*
+ * Nuovo tipo utilizzato per raccogliere i dati assegnati a ciascun thread della squadra.
+ * Con grana 0 ogni thread calcola sempre lo stesso intervallo di righe (riga_inizio, riga_fine); con grana > 0
+ * le righe vengono prese a pezzi dal contatore condiviso della squadra e l'intervallo non viene usato.
+ */
+typedef struct {
+    struct squadra* squadra;            // Squadra a cui appartiene il thread
+    int indice;                         // Posizione del thread nella squadra
+    long riga_inizio;                   // Riga inizio calcolo
+    long riga_fine;                     // Riga fine calcolo
+    unsigned long last_job_visto;       // Id dell'ultimo job eseguito
+} dati_thread_squadra_t;
+
+
+/* Compito inviato alla squadra (avvia_compito): resta in coda finché un thread libero non lo esegue */
+struct compito {
+    funzione_compito_t funzione;
+    void* argomento;
+    int completato;                     // 1 quando la funzione è terminata (protetto dal mutex della squadra)
+    struct compito* successivo;         // Prossimo compito nella coda
+};
+
+/*
+ * Stato di una squadra di thread. Ogni squadra ha il proprio mutex e le proprie condition:
+ * squadre diverse (ad esempio di contesti di simulazione diversi) lavorano senza contendersi alcun lock.
+ */
+struct squadra {
+    pthread_t* thread;                  // Array dei thread della squadra
+    dati_thread_squadra_t* dati;        // Array contenente i dati di ogni thread
+    int numero_thread;                  // Numero thread creati
+    long dimensione;                    // Dimensione N (2^qubit)
+
+    pthread_mutex_t mutex;              // Protegge lo stato condiviso
+    pthread_cond_t cond_inizio;         // Segnale: lavoro disponibile
+    pthread_cond_t cond_fine;           // Segnale: lavoro completato
+    pthread_cond_t cond_compiti;        // Segnale: un compito è stato completato
+
+    long grana;                         // Elementi (o righe) per pezzo, 0: una parte contigua fissa per thread
+    long prossimo;                      // Primo elemento non ancora assegnato del job corrente (con grana > 0)
+
+    int lavoro_disponibile;             // 1 se c'è un job da eseguire
+    int termina;                        // 1 per dire ai thread di terminare
+    int thread_finiti;                  // Quanti thread hanno finito il job corrente
+    unsigned long job_id;               // Identificatore del job corrente (incrementa ad ogni moltiplicazione)
+
+    /* Puntatori al job corrente (validi solo durante l’esecuzione di una moltiplicazione) */
+    matrice_t* matrice;
+    complesso_t* vettore;
+    complesso_t* risultato;
+
+    /* Job generico corrente (esegui_in_parallelo): se funzione != NULL sostituisce la moltiplicazione */
+    funzione_intervallo_t funzione;
+    void* argomento;
+    long numero_elementi;
+
+    /* Coda FIFO dei compiti in attesa di un thread libero */
+    compito_t* primo_compito;
+    compito_t* ultimo_compito;
+};
+
+/* Squadra usata dalle funzioni chiamate da questo thread (una per thread chiamante, NULL se nessuna) */
+static __thread squadra_t* g_squadra_corrente = NULL;
+
+/* Squadra di cui questo thread fa parte (NULL se non è un thread di una squadra) */
+static __thread squadra_t* g_squadra_lavoratore = NULL;
+
+
+/* Funzione di supporto: estrae il primo compito in coda (con il mutex acquisito), NULL se la coda è vuota */
+static compito_t* estrai_compito(squadra_t* s) {
+    compito_t* c = s->primo_compito;
+    if (c) {
+        s->primo_compito = c->successivo;
+        if (!s->primo_compito) s->ultimo_compito = NULL;
+    }
+    return c;
+}
+
+/* Funzione di supporto: esegue un compito estratto dalla coda e lo segna completato (chiamata con il mutex acquisito) */
+static void esegui_compito(squadra_t* s, compito_t* c) {
+    pthread_mutex_unlock(&s->mutex);
+    c->funzione(c->argomento);
+    pthread_mutex_lock(&s->mutex);
+    c->completato = 1;
+    pthread_cond_broadcast(&s->cond_compiti);   // Sveglia chi attende questo (o un altro) compito
+}
+
+
+/* Funzione di supporto: calcola le righe [r0, r1) di out = m · v */
+static void calcola_righe(const matrice_t* m, const complesso_t* v, complesso_t* out, long n, long r0, long r1) {
+    for (long i = r0; i < r1; i++) {
+        complesso_t somma = (complesso_t){0.0, 0.0, '\0'};
+
+        for (long j = 0; j < n; j++) {
+            complesso_t prodotto = moltiplica_complessi(m->dati[i][j], v[j]);
+            somma = somma_complessi(somma, prodotto);
+        }
+
+        out[i] = somma;
+    }
+}
+
+
+/*
+ * Funzione eseguita da ciascun thread della squadra.
+ * Il thread resta vivo: attende lavoro, calcola, segnala fine, torna in attesa.
+ */
+static void* funzione_thread_squadra(void* arg) {
+    dati_thread_squadra_t* dati = (dati_thread_squadra_t*)arg;  // cast del tipo di struttura necessario perché la funzione prende void *arg
+    squadra_t* s = dati->squadra;
+    g_squadra_lavoratore = s;       // Le chiamate annidate da questo thread diventano compiti della stessa squadra
+
+    while (1) {    // ciclo infinito perché il thread è persistente, non termina dopo il lavoro eseguito, ne attende altri
+        double inizio_attesa = profilo_attivo ? profilo_adesso() : 0.0;    // Misure solo con --profile
+
+        pthread_mutex_lock(&s->mutex);  // Effettua un lock per entrare nella sezione critica 
+
+        // Attende che ci sia lavoro e sia un job nuovo (non già visto da questo thread), che ci sia
+        // un compito in coda oppure che venga richiesto di terminare          
+        while (((!s->lavoro_disponibile) || (dati->last_job_visto == s->job_id)) && !s->primo_compito && !s->termina) {
+            pthread_cond_wait(&s->cond_inizio, &s->mutex);  // Rilascia il mutex (unlock) e va in attesa sulla condition cond_inizio
+        }                                                   // Il lock è nuovamente acquisito dal thread quando viene risvegliato
+
+        /* Nessun job nuovo ma un compito in coda: lo esegue e torna ad attendere */
+        if (!s->termina && (!s->lavoro_disponibile || dati->last_job_visto == s->job_id)) {
+            esegui_compito(s, estrai_compito(s));
+            pthread_mutex_unlock(&s->mutex);
+            continue;
+        }
+
+        /* Se richiesto, termina il thread */
+        if (s->termina) {
+            pthread_mutex_unlock(&s->mutex);    // Effettua un unlock
+            contatori_chiudi_thread();     // I descrittori perf appartengono a questo thread
+            return NULL;
+        }
+
+        /* Segna che questo thread sta per processare il job corrente */
+        dati->last_job_visto = s->job_id;
+
+        /* Copia locale dei parametri del job, poi rilascia il mutex e calcola */
+        matrice_t* m = s->matrice;          // Matrice da moltiplicare con il vettore
+        complesso_t* v = s->vettore;        // Vettore da moltiplicare con la matrice 
+        complesso_t* out = s->risultato;    // Vettore che conterrà il risultato parzialmente calcolato
+        long n = s->dimensione;             // Dimensione matrice 
+
+        long r0 = dati->riga_inizio;        // Riga da cui inizia il calcolo del thread
+        long r1 = dati->riga_fine;          // Riga che delimita la fine, non verra calcolata dal thread
+
+        funzione_intervallo_t funzione = s->funzione;   // Job generico: ogni thread prende una parte contigua degli elementi
+        void* argomento = s->argomento;
+        long e0 = s->numero_elementi * dati->indice / s->numero_thread;
+        long e1 = s->numero_elementi * (dati->indice + 1) / s->numero_thread;
+        long grana = s->grana;
+        long totale = funzione ? s->numero_elementi : n;
+
+        pthread_mutex_unlock(&s->mutex);    // Effettua un unlock
+
+        double inizio_lavoro = profilo_attivo ? profilo_adesso() : 0.0;
+        if (contatori_attivi) contatori_inizio_job(dati->indice);
+
+        long righe_calcolate = 0;
+        int ha_lavorato = 0;                // 0 se con grana > 0 gli altri thread hanno preso tutti i pezzi
+        if (grana > 0) {
+            /* Pezzi di grana elementi (o righe) presi a turno dal contatore condiviso: i thread più veloci ne prendono di più */
+            long p0;
+            while ((p0 = __atomic_fetch_add(&s->prossimo, grana, __ATOMIC_RELAXED)) < totale) {
+                long p1 = p0 + grana < totale ? p0 + grana : totale;
+                ha_lavorato = 1;
+                if (funzione) {
+                    funzione(argomento, p0, p1);
+                } else {
+                    calcola_righe(m, v, out, n, p0, p1);
+                    righe_calcolate += p1 - p0;
+                }
+            }
+        } else if (funzione) {
+            if (e0 < e1) funzione(argomento, e0, e1);
+            ha_lavorato = e0 < e1;
+        } else {
+            calcola_righe(m, v, out, n, r0, r1);    // Calcola le righe assegnate
+            righe_calcolate = r1 - r0;
+            ha_lavorato = r0 < r1;
+        }
+
+        if (contatori_attivi) {         // 8 flop per prodotto-somma complesso; letti matrice, vettore e scritto il risultato
+            double righe = righe_calcolate;             // Per i job generici si misurano solo cicli e istruzioni
+            contatori_fine_job(dati->indice, 8.0 * righe * n,
+                               (righe * n + (funzione ? 0 : n) + righe) * sizeof(complesso_t));
+        }
+
+        if (profilo_attivo) {           // Registra attesa e lavoro del thread per questo job
+            profilo_thread_job(dati->indice, inizio_attesa, inizio_lavoro, profilo_adesso(), ha_lavorato);
+        }
+
+        /* Segnala completamento */
+        pthread_mutex_lock(&s->mutex);  // Rientra in sezione critica per aggiornare il contatore 
+        s->thread_finiti++;             // Dei thread che hanno finito il lavoro
+
+        /* L’ultimo thread che finisce sveglia chi sta aspettando */
+        if (s->thread_finiti == s->numero_thread) { // numero_thread sono i lavori totali per ottenere il risultato finale
+            profilo_chiudi_job_squadra();           // Sbilanciamento del job rispetto all'ultimo thread
+            s->lavoro_disponibile = 0;              // Se è vero non c'è più nulla da fare
+            pthread_cond_signal(&s->cond_fine);     // Sveglia il thread che ha avviato il job
+        }
+
+        pthread_mutex_unlock(&s->mutex);   // Effettua un unlock ed esce dalla sezione critica 
+    }
+}
+
+
+/* Funzione di supporto: chiede ai primi numero_avviati thread di terminare, li attende e libera la squadra */
+static void chiudi_squadra(squadra_t* s, int numero_avviati) {
+    pthread_mutex_lock(&s->mutex);              // Effettua un lock per entrare nella sezione critica
+    s->termina = 1;                             // Setta la variabile di termine a 1
+    pthread_cond_broadcast(&s->cond_inizio);    // Sveglia tutti i thread che potrebbero essere addormentati in cond_inizio
+    pthread_mutex_unlock(&s->mutex);            // Effettua un unlock ed esce dalla sezione critica 
+
+    for (int t = 0; t < numero_avviati; t++) {  // Attende tutti i thread della squadra 
+        pthread_join(s->thread[t], NULL);       // NULL indica che non importa il valore di ritorno della funzione pthread_join
+    }
+
+    pthread_mutex_destroy(&s->mutex);
+    pthread_cond_destroy(&s->cond_inizio);
+    pthread_cond_destroy(&s->cond_fine);
+    pthread_cond_destroy(&s->cond_compiti);
+    free(s->thread);        // Libera la memoria occupata dall'allocazione degli array 
+    free(s->dati);
+    free(s);
+}
+
+
+squadra_t* crea_squadra(int numero_thread, long dimensione) {
+    if (numero_thread <= 0 || dimensione <= 0) return NULL;
+
+    squadra_t* s = (squadra_t*)calloc(1, sizeof(squadra_t));
+    if (!s) return NULL;
+    s->numero_thread = numero_thread;   // Numero di thread che comporra la squadra
+    s->dimensione = dimensione;         // Dimensione N
+
+    s->thread = (pthread_t*)malloc(numero_thread * sizeof(pthread_t));   // Alloca memoria per array di thread della squadra
+    s->dati = (dati_thread_squadra_t*)malloc(numero_thread * sizeof(dati_thread_squadra_t));     // Alloca memoria per array di dati dei thread
+    if (!s->thread || !s->dati ||       // Se almeno un'allocazione è fallita
+        profilo_inizializza_squadra(numero_thread) != 0 ||     // Statistiche per thread (solo con --profile)
+        contatori_inizializza_squadra(numero_thread) != 0) {   // Accumulatori dei contatori (solo con --perf)
+        free(s->thread);            // Libera la memoria
+        free(s->dati);
+        free(s);
+        return NULL;
+    }
+
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->cond_inizio, NULL);
+    pthread_cond_init(&s->cond_fine, NULL);
+    pthread_cond_init(&s->cond_compiti, NULL);
+
+    /* Suddivide le righe tra i thread */
+    long righe_per_thread = dimensione / numero_thread;  
+    long riga_corrente = 0;
+
+    for (int t = 0; t < numero_thread; t++) {   // Assegna ad ogni t-esimo thread il suo intervallo di righe
+        s->dati[t].squadra = s;
+        s->dati[t].riga_inizio = riga_corrente;
+
+        if (t == numero_thread - 1) {
+            s->dati[t].riga_fine = dimensione;  // ultimo thread prende eventuali righe rimanenti 
+        } else {
+            s->dati[t].riga_fine = riga_corrente + righe_per_thread;
+        }
+
+        s->dati[t].indice = t;
+        s->dati[t].last_job_visto = 0;  // Inizializza lo stato interno del thread
+
+        riga_corrente = s->dati[t].riga_fine;   // Aggiorna la riga corrente prima di passare alla prossima iterazione
+
+        /*
+         * &s->thread[t]: Destinazione dell'id del thread appena creato;
+         * funzione_thread_squadra: Funzione che verrà eseguita dal thread;
+         * &s->dati[t]: Argomento passato al thread per la funzione, ogni thread riceve l’indirizzo della sua struct diversa per ogni t
+         */
+        if (pthread_create(&s->thread[t], NULL, funzione_thread_squadra, &s->dati[t]) != 0) {
+            chiudi_squadra(s, t);       // In caso di errore termina e attende i thread già creati
+            return NULL;
+        }
+    }
+
+    return s;
+}
+
+
+void distruggi_squadra(squadra_t* s) {
+    if (s == NULL) return;
+    if (g_squadra_corrente == s) g_squadra_corrente = NULL;
+    chiudi_squadra(s, s->numero_thread);
+}
+
+
+void imposta_grana_squadra(squadra_t* s, long grana) {
+    if (s == NULL) return;
+    pthread_mutex_lock(&s->mutex);
+    s->grana = grana > 0 ? grana : 0;
+    pthread_mutex_unlock(&s->mutex);
+}
+
+int numero_thread_squadra(const squadra_t* s) {
+    return s ? s->numero_thread : 0;
+}
+
+squadra_t* imposta_squadra_corrente(squadra_t* s) {
+    squadra_t* precedente = g_squadra_corrente;
+    g_squadra_corrente = s;
+    return precedente;
+}
+
+
+/*
+ * Funzione di supporto che pubblica il job già impostato nella squadra, sveglia i thread e attende
+ * che l'ultimo segnali la fine. Va chiamata con il mutex della squadra acquisito.
+ */
+static void esegui_job(squadra_t* s) {
+    /* Nuovo job: incrementa id e reset contatori */
+    s->job_id++;                    // Incrementa contatore dei lavori
+    s->thread_finiti = 0;           // Setta la variabile dei thread che hanno gia finito a 0
+    s->prossimo = 0;                // Con grana > 0 i pezzi ripartono dal primo elemento
+    s->lavoro_disponibile = 1;      // Setta la variabile del lavoro disponibile a 1
+
+    /* Sveglia tutti i thread per iniziare il lavoro */
+    pthread_cond_broadcast(&s->cond_inizio); 
+
+    /* Attende che l’ultimo thread segnali la fine */
+    while (s->lavoro_disponibile) {     // Finché tutte le operazioni non sono terminare attende
+        pthread_cond_wait(&s->cond_fine, &s->mutex);
+    }
+}
+
+
+/* Dati di una moltiplicazione annidata: le righe vengono divise in compiti della squadra */
+typedef struct {
+    const matrice_t* matrice;
+    const complesso_t* vettore;
+    complesso_t* risultato;
+} moltiplicazione_annidata_t;
+
+/* Funzione di supporto: calcola le righe [inizio, fine) di una moltiplicazione annidata */
+static void moltiplica_righe_annidate(void* argomento, long inizio, long fine) {
+    moltiplicazione_annidata_t* lavoro = (moltiplicazione_annidata_t*)argomento;
+    calcola_righe(lavoro->matrice, lavoro->vettore, lavoro->risultato, lavoro->matrice->dimensione, inizio, fine);
+}
+
+static int esegui_parti_annidate(squadra_t* s, funzione_intervallo_t funzione, void* argomento, long numero_elementi);
+
+/*
+ * Funzione per la moltiplicazione matrice × vettore che utilizza la squadra corrente.
+ * Parametri:
+ * m → matrice quadrata N × N
+ * v → vettore di dimensione N
+ * Valore di ritorno: puntatore a un nuovo vettore contenente il risultato in caso di successo,
+ * oppure NULL in caso di errore
+ */
+complesso_t* moltiplica_matrice_vettore_mt_riuso(matrice_t* m, complesso_t* v) {
+    squadra_t* s = g_squadra_corrente;
+
+    /* Controllo parametri */
+    if (m == NULL || v == NULL) return NULL;
+
+    /* Chiamata da un thread della squadra (ad esempio per un punto della scansione dei parametri, eseguito per
+     * intero da un thread): le righe diventano compiti della stessa squadra, come in esegui_in_parallelo */
+    if (s == NULL && g_squadra_lavoratore && g_squadra_lavoratore->dimensione == m->dimensione) {
+        complesso_t* risultato = alloca_stato(m->dimensione, 0);
+        if (!risultato) return NULL;
+        moltiplicazione_annidata_t lavoro = {m, v, risultato};
+        if (esegui_parti_annidate(g_squadra_lavoratore, moltiplica_righe_annidate, &lavoro, m->dimensione) != 0) {
+            free(risultato);
+            return NULL;
+        }
+        return risultato;
+    }
+
+    /* Verifica che la squadra esista e che la dimensione sia coerente */
+    if (s == NULL || s->dimensione != m->dimensione) return NULL;
+
+    long dimensione = m->dimensione;
+
+    /* Alloca il vettore risultato (con pagine grandi se è grande) */
+    complesso_t* risultato = alloca_stato(dimensione, 0);
+    if (!risultato) return NULL;
+
+    pthread_mutex_lock(&s->mutex);  // Effettua un lock prima di entrare nella sezione critica 
+
+    /* Imposta il job corrente */
+    s->funzione = NULL;             // Job di moltiplicazione, non generico
+    s->matrice = m;                 // Matrice m da moltiplicare al vettore v
+    s->vettore = v;                 // Vettore v da moltiplicare a matrice m
+    s->risultato = risultato;       // Risultato della moltiplicazione r = m * v
+
+    esegui_job(s);
+
+    s->matrice = NULL;
+    s->vettore = NULL;
+    s->risultato = NULL;
+    pthread_mutex_unlock(&s->mutex);    // Effettua un unlock ed esce dalla sezione critica
+
+    return risultato;   // Ritorna il risultato
+}
+
+
+/* Parte di un intervallo eseguita come compito nelle chiamate annidate */
+typedef struct {
+    funzione_intervallo_t funzione;
+    void* argomento;
+    long inizio;
+    long fine;
+} parte_annidata_t;
+
+/* Funzione di supporto: esegue una parte annidata come compito */
+static void esegui_parte_annidata(void* argomento) {
+    parte_annidata_t* parte = (parte_annidata_t*)argomento;
+    parte->funzione(parte->argomento, parte->inizio, parte->fine);
+}
+
+/*
+ * Funzione di supporto per le chiamate annidate (da un thread della squadra): divide l'intervallo in
+ * tante parti quanti sono i thread, ne invia tutte tranne la prima come compiti, esegue la prima e attende
+ * le altre aiutando a svuotare la coda. Se l'allocazione fallisce esegue tutto nel thread chiamante.
+ */
+static int esegui_parti_annidate(squadra_t* s, funzione_intervallo_t funzione, void* argomento, long numero_elementi) {
+    long parti = numero_elementi < s->numero_thread ? numero_elementi : s->numero_thread;
+    parte_annidata_t* dati = (parte_annidata_t*)malloc(parti * sizeof(parte_annidata_t));
+    compito_t** compiti = (compito_t**)calloc(parti, sizeof(compito_t*));
+    if (!dati || !compiti) {
+        free(dati);
+        free(compiti);
+        funzione(argomento, 0, numero_elementi);
+        return 0;
+    }
+
+    for (long p = 0; p < parti; p++) {
+        dati[p] = (parte_annidata_t){funzione, argomento, numero_elementi * p / parti, numero_elementi * (p + 1) / parti};
+        if (p > 0) compiti[p] = avvia_compito(esegui_parte_annidata, &dati[p]);
+    }
+    esegui_parte_annidata(&dati[0]);
+
+    int ret = 0;
+    for (long p = 1; p < parti; p++) {
+        if (compiti[p]) attendi_compito(compiti[p]);
+        else esegui_parte_annidata(&dati[p]);       // Compito non creato: la parte viene eseguita qui
+    }
+    free(dati);
+    free(compiti);
+    return ret;
+}
+
+/*
+ * Esegue funzione(argomento, inizio, fine) suddividendo [0, numero_elementi) tra i thread della squadra
+ * corrente e attende che tutti abbiano finito. Se non c'è una squadra corrente (dimensioni gestite dai
+ * kernel specializzati, processi della simulazione distribuita) la funzione viene eseguita direttamente
+ * dal thread chiamante su tutto l'intervallo.
+ * Ritorna: 0 se tutto ok, -1 in caso di parametri non validi
+ */
+int esegui_in_parallelo(funzione_intervallo_t funzione, void* argomento, long numero_elementi) {
+    squadra_t* s = g_squadra_corrente;
+    if (funzione == NULL || numero_elementi < 0) return -1;
+    if (numero_elementi == 0) return 0;
+
+    if (g_squadra_lavoratore) {         // Chiamata annidata da un thread della squadra: fork-join con i compiti
+        return esegui_parti_annidate(g_squadra_lavoratore, funzione, argomento, numero_elementi);
+    }
+
+    if (s == NULL) {                    // Nessuna squadra: esecuzione sequenziale
+        funzione(argomento, 0, numero_elementi);
+        return 0;
+    }
+
+    pthread_mutex_lock(&s->mutex);      // Stesso protocollo della moltiplicazione
+
+    s->funzione = funzione;
+    s->argomento = argomento;
+    s->numero_elementi = numero_elementi;
+
+    esegui_job(s);
+
+    s->funzione = NULL;
+    s->argomento = NULL;
+    pthread_mutex_unlock(&s->mutex);
+    return 0;
+}
+
+
+int esegui_elementi_in_parallelo(funzione_intervallo_t funzione, void* argomento, long numero_elementi) {
+    squadra_t* s = g_squadra_corrente;
+    if (g_squadra_lavoratore || s == NULL) return esegui_in_parallelo(funzione, argomento, numero_elementi);
+    if (funzione == NULL || numero_elementi < 0) return -1;
+    if (numero_elementi == 0) return 0;
+
+    pthread_mutex_lock(&s->mutex);
+    long grana = s->grana;              // Un elemento per pezzo, qualunque sia la grana scelta dalla taratura
+    s->grana = 1;
+    s->funzione = funzione;
+    s->argomento = argomento;
+    s->numero_elementi = numero_elementi;
+
+    esegui_job(s);
+
+    s->funzione = NULL;
+    s->argomento = NULL;
+    s->grana = grana;
+    pthread_mutex_unlock(&s->mutex);
+    return 0;
+}
+
+
+/* Dati della riduzione passati alle parti */
+typedef struct {
+    funzione_riduzione_t funzione;
+    void* argomento;
+    long numero_elementi;
+    long parti;
+    char* parziali;                     // Un accumulatore per parte
+    size_t dimensione;                  // Byte di ogni accumulatore
+} lavoro_riduzione_t;
+
+/* Funzione eseguita dalla squadra: ogni elemento è una parte della riduzione con il proprio accumulatore */
+static void riduci_parti(void* argomento, long inizio, long fine) {
+    const lavoro_riduzione_t* lavoro = (const lavoro_riduzione_t*)argomento;
+    for (long p = inizio; p < fine; p++) {
+        long e0 = lavoro->numero_elementi * p / lavoro->parti;
+        long e1 = lavoro->numero_elementi * (p + 1) / lavoro->parti;
+        if (e0 < e1) lavoro->funzione(lavoro->argomento, e0, e1, lavoro->parziali + p * lavoro->dimensione);
+    }
+}
+
+/*
+ * Riduzione parallela: le parti sono fisse (una per thread, o una sola senza squadra), ogni accumulatore
+ * parte da una copia del valore iniziale di risultato e gli accumulatori vengono combinati in ordine di
+ * parte, quindi il risultato non dipende dalla velocità dei thread.
+ */
+int riduci_in_parallelo(funzione_riduzione_t funzione, funzione_combina_t combina, void* argomento,
+                        long numero_elementi, void* risultato, size_t dimensione) {
+    if (!funzione || !combina || !risultato || dimensione == 0 || numero_elementi < 0) return -1;
+    if (numero_elementi == 0) return 0;
+
+    squadra_t* s = g_squadra_lavoratore ? g_squadra_lavoratore : g_squadra_corrente;
+    long parti = s ? s->numero_thread : 1;
+    if (parti > numero_elementi) parti = numero_elementi;
+
+    char* parziali = (char*)malloc(parti * dimensione);
+    if (!parziali) return -1;
+    for (long p = 0; p < parti; p++) memcpy(parziali + p * dimensione, risultato, dimensione);
+
+    lavoro_riduzione_t lavoro = {funzione, argomento, numero_elementi, parti, parziali, dimensione};
+    int ret = esegui_in_parallelo(riduci_parti, &lavoro, parti);
+    if (ret == 0) {
+        for (long p = 0; p < parti; p++) combina(risultato, parziali + p * dimensione);
+    }
+    free(parziali);
+    return ret;
+}
+
+
+compito_t* avvia_compito(funzione_compito_t funzione, void* argomento) {
+    if (!funzione) return NULL;
+
+    compito_t* c = (compito_t*)malloc(sizeof(compito_t));
+    if (!c) return NULL;
+    *c = (compito_t){funzione, argomento, 0, NULL};
+
+    squadra_t* s = g_squadra_lavoratore ? g_squadra_lavoratore : g_squadra_corrente;
+    if (!s) {                           // Nessuna squadra: il compito viene eseguito subito
+        funzione(argomento);
+        c->completato = 1;
+        return c;
+    }
+
+    pthread_mutex_lock(&s->mutex);
+    if (s->ultimo_compito) s->ultimo_compito->successivo = c;
+    else s->primo_compito = c;
+    s->ultimo_compito = c;
+    pthread_cond_signal(&s->cond_inizio);       // Basta un thread libero
+    pthread_mutex_unlock(&s->mutex);
+    return c;
+}
+
+
+int attendi_compito(compito_t* c) {
+    if (!c) return -1;
+
+    squadra_t* s = g_squadra_lavoratore ? g_squadra_lavoratore : g_squadra_corrente;
+    if (s) {
+        pthread_mutex_lock(&s->mutex);
+        while (!c->completato) {
+            compito_t* altro = estrai_compito(s);
+            if (altro) esegui_compito(s, altro);    // Aiuta: nessun thread resta fermo se ci sono compiti in coda
+            else pthread_cond_wait(&s->cond_compiti, &s->mutex);
+        }
+        pthread_mutex_unlock(&s->mutex);
+    }
+
+    free(c);
+    return 0;
+}
@@ -1,30 +1,123 @@
-#ifndef THREAD_MATRICE_H
-#define THREAD_MATRICE_H
-#include "matrice.h"
-
-/*
- * Inizializza una squadra di thread riutilizzabili per le moltiplicazioni matrice × vettore.
- * Parametri:
- * numero_thread → numero di thread da creare
- * dimensione → dimensione della matrice e del vettore
- * Ritorna: 0 se tutto ok, -1 in caso di errore
- */
-int inizializza_squadra_thread(int numero_thread, int dimensione);
-
-/*
- * Funzione per la moltiplicazione matrice × vettore che utilizza una squadra di thread già inizializzata.
- * Parametri:
- * m → matrice quadrata N × N
- * v → vettore di dimensione N
- * Valore di ritorno: puntatore a un nuovo vettore contenente il risultato in caso di successo,
- * oppure NULL in caso di errore
- */
-complesso_t* moltiplica_matrice_vettore_mt_riuso(matrice_t* m, complesso_t* v);
-
-/*
- * Distrugge la squadra di thread: segnala terminazione, attende (join) e libera la memoria.
- * Ritorna: 0 se tutto ok, -1 se la squadra non era inizializzata
- */
-int distruggi_squadra_thread(void);
-
-#endif
+#ifndef THREAD_MATRICE_H
+#define THREAD_MATRICE_H
+#include <stddef.h>
+#include "matrice.h"
+
+/*
+ * Squadra di thread riutilizzabili per le moltiplicazioni matrice × vettore e per i job generici.
+ * Il tipo è opaco: ogni squadra ha i propri thread, il proprio mutex e il proprio job corrente,
+ * quindi più squadre (ad esempio di contesti di simulazione diversi) possono lavorare insieme.
+ */
+typedef struct squadra squadra_t;
+
+/*
+ * Crea una squadra di thread riutilizzabili.
+ * Parametri:
+ * numero_thread → numero di thread da creare
+ * dimensione → dimensione della matrice e del vettore
+ * Ritorna: puntatore alla squadra, NULL in caso di errore
+ */
+squadra_t* crea_squadra(int numero_thread, long dimensione);
+
+/*
+ * Distrugge la squadra di thread: segnala terminazione, attende (join) e libera la memoria.
+ * Se era la squadra corrente del thread chiamante, il thread chiamante resta senza squadra.
+ */
+void distruggi_squadra(squadra_t* s);
+
+/*
+ * Sceglie come i job della squadra vengono divisi tra i thread.
+ * Parametri: s → squadra, grana → 0 per una parte contigua fissa per thread (default), oppure numero di
+ * elementi (righe per le moltiplicazioni) dei pezzi che i thread prendono uno alla volta finché ce ne sono
+ */
+void imposta_grana_squadra(squadra_t* s, long grana);
+
+/* Ritorna il numero di thread della squadra, 0 se s è NULL */
+int numero_thread_squadra(const squadra_t* s);
+
+/*
+ * Imposta la squadra usata da moltiplica_matrice_vettore_mt_riuso e da esegui_in_parallelo quando
+ * vengono chiamate dal thread corrente (l'impostazione vale solo per il thread chiamante).
+ * Parametri: s → squadra, NULL per eseguire nel thread chiamante
+ * Ritorna: la squadra corrente precedente, da ripristinare al termine
+ */
+squadra_t* imposta_squadra_corrente(squadra_t* s);
+
+/*
+ * Funzione per la moltiplicazione matrice × vettore che utilizza la squadra corrente.
+ * Parametri:
+ * m → matrice quadrata N × N
+ * v → vettore di dimensione N
+ * Valore di ritorno: puntatore a un nuovo vettore contenente il risultato in caso di successo,
+ * oppure NULL in caso di errore (anche se non c'è una squadra corrente della dimensione giusta). Da un thread
+ * della squadra le righe vengono divise in compiti della stessa squadra.
+ */
+complesso_t* moltiplica_matrice_vettore_mt_riuso(matrice_t* m, complesso_t* v);
+
+/* Tipo di una funzione eseguita dalla squadra su una parte [inizio, fine) di un intervallo di elementi */
+typedef void (*funzione_intervallo_t)(void* argomento, long inizio, long fine);
+
+/*
+ * Esegue funzione(argomento, inizio, fine) suddividendo [0, numero_elementi) tra i thread della squadra
+ * corrente e attende che tutti abbiano finito. Senza squadra la funzione viene eseguita dal thread chiamante.
+ * Se chiamata da un thread della squadra (chiamate annidate, ad esempio dentro un job o un compito) non può
+ * avviare un nuovo job: divide invece l'intervallo in compiti, ne esegue una parte e attende le altre aiutando
+ * gli altri thread (fork-join annidato).
+ * Parametri:
+ * funzione → funzione da eseguire su ogni parte
+ * argomento → puntatore passato alla funzione
+ * numero_elementi → dimensione dell'intervallo da suddividere
+ * Ritorna: 0 se tutto ok, -1 in caso di parametri non validi
+ */
+int esegui_in_parallelo(funzione_intervallo_t funzione, void* argomento, long numero_elementi);
+
+/*
+ * Come esegui_in_parallelo, ma i thread prendono un elemento alla volta (qualunque sia la grana della squadra),
+ * finché ce ne sono: per elementi lunghi e indipendenti, come i punti della scansione dei parametri, dentro i
+ * quali le chiamate alla squadra (anche moltiplica_matrice_vettore_mt_riuso) diventano annidate.
+ * Ritorna: 0 se tutto ok, -1 in caso di parametri non validi
+ */
+int esegui_elementi_in_parallelo(funzione_intervallo_t funzione, void* argomento, long numero_elementi);
+
+/* Tipo di una funzione di riduzione: accumula in parziale il contributo degli elementi [inizio, fine) */
+typedef void (*funzione_riduzione_t)(void* argomento, long inizio, long fine, void* parziale);
+
+/* Tipo della funzione che combina un accumulatore parziale nel risultato */
+typedef void (*funzione_combina_t)(void* risultato, const void* parziale);
+
+/*
+ * Riduzione parallela su [0, numero_elementi): ogni thread accumula una parte contigua in una copia
+ * del valore iniziale di risultato, poi le copie vengono combinate nel risultato in ordine di parte
+ * (il risultato è deterministico). Usa la squadra corrente, anche da chiamate annidate.
+ * Parametri:
+ * funzione → accumula una parte, combina → combina un parziale nel risultato
+ * argomento → puntatore passato a funzione
+ * risultato → valore iniziale (elemento neutro), sovrascritto con il risultato
+ * dimensione → byte del risultato e di ogni accumulatore
+ * Ritorna: 0 se tutto ok, -1 in caso di parametri non validi o errore di allocazione
+ */
+int riduci_in_parallelo(funzione_riduzione_t funzione, funzione_combina_t combina, void* argomento,
+                        long numero_elementi, void* risultato, size_t dimensione);
+
+/* Compito inviato alla squadra, da attendere con attendi_compito */
+typedef struct compito compito_t;
+
+/* Tipo della funzione eseguita da un compito */
+typedef void (*funzione_compito_t)(void* argomento);
+
+/*
+ * Mette in coda un compito per la squadra corrente (o per la squadra del thread chiamante, se è un suo
+ * thread): lo esegue il primo thread libero. Senza squadra il compito viene eseguito subito.
+ * I compiti vanno attesi prima di distruggere la squadra.
+ * Ritorna: handle del compito, NULL in caso di errore di allocazione
+ */
+compito_t* avvia_compito(funzione_compito_t funzione, void* argomento);
+
+/*
+ * Attende il completamento del compito, eseguendo nel frattempo i compiti ancora in coda (così un
+ * compito può avviarne e attenderne altri senza bloccare la squadra), e libera l'handle.
+ * Ritorna: 0 se tutto ok, -1 se c è NULL
+ */
+int attendi_compito(compito_t* c);
+
+#endif
@@ -0,0 +1,252 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "traccia.h"
+#include "coda.h"
+#include "memoria.h"
+
+#define BUFFER_TRACCIA 2            // Doppio buffer: uno in scrittura mentre l'esecuzione riempie l'altro
+#define AMPIEZZE_BLOCCO 4096        // Ampiezze convertite alla volta dallo scrittore
+
+/* Stato copiato dall'esecuzione, in attesa di essere scritto */
+typedef struct {
+    complesso_t* stato;
+    int32_t esecuzione;
+    int32_t istruzione;
+    char nome[32];
+} istantanea_t;
+
+/* Traccia aperta (una per contesto) */
+struct traccia {
+    FILE* file;
+    long dimensione;
+    int ogni;                       // Ogni quante istruzioni registrare, 0 per nessuna
+    char* nomi;                     // Copia dei nomi, separati da '\0' al posto delle virgole
+    char** elenco;                  // Puntatori ai nomi in nomi
+    int numero_nomi;
+    int comprimi;
+    uint64_t* precedente;           // Parole dell'istantanea precedente (solo con la compressione)
+    istantanea_t buffer[BUFFER_TRACCIA];
+    coda_spsc_t libere;             // Buffer liberi: dallo scrittore all'esecuzione
+    coda_spsc_t piene;              // Buffer da scrivere: dall'esecuzione allo scrittore
+    pthread_t scrittore;
+    int32_t esecuzione;             // Esecuzione corrente (-1 prima della prima)
+    int errore;                     // 1 dopo una scrittura fallita (scritto solo dallo scrittore)
+    int code;                       // 1 dopo l'inizializzazione delle due code
+    long istantanee;                // Istantanee scritte (dallo scrittore)
+    double byte_scritti;            // Byte scritti nel file per le istantanee (dallo scrittore)
+    double byte_stati;              // Byte delle ampiezze registrate, 16 per ampiezza (dall'esecuzione)
+};
+
+/* Riepilogo dell'ultima traccia chiusa dal thread chiamante (letto solo da stampa_traccia) */
+static __thread struct {
+    int aperta;
+    long istantanee;
+    double byte_stati;
+    double byte_scritti;
+    long attese;                    // Registrazioni che hanno atteso un buffer libero
+} g_statistiche;
+
+
+/* Funzione di supporto: scrive un gruppo della forma compressa. Ritorna 0 se ok, -1 se la scrittura fallisce. */
+static int scrivi_gruppo(traccia_t* t, uint32_t zeri, uint32_t numero, const uint64_t* letterali) {
+    uint32_t testa[2] = {zeri, numero};
+    if (fwrite(testa, sizeof(uint32_t), 2, t->file) != 2) return -1;
+    if (numero > 0 && fwrite(letterali, sizeof(uint64_t), numero, t->file) != numero) return -1;
+    t->byte_scritti += sizeof(testa) + (double)numero * sizeof(uint64_t);
+    return 0;
+}
+
+/* Funzione di supporto: scrive un'istantanea nel file. Ritorna 0 se ok, -1 se la scrittura fallisce. */
+static int scrivi_istantanea(traccia_t* t, const istantanea_t* s) {
+    int32_t testa[2] = {s->esecuzione, s->istruzione};
+    if (fwrite(testa, sizeof(int32_t), 2, t->file) != 2 || fwrite(s->nome, 1, sizeof(s->nome), t->file) != sizeof(s->nome)) return -1;
+    t->byte_scritti += sizeof(testa) + sizeof(s->nome);
+
+    const long dimensione = t->dimensione;
+    if (!t->comprimi) {
+        double blocco[2 * AMPIEZZE_BLOCCO];
+        for (long inizio = 0; inizio < dimensione; inizio += AMPIEZZE_BLOCCO) {
+            long n = dimensione - inizio < AMPIEZZE_BLOCCO ? dimensione - inizio : AMPIEZZE_BLOCCO;
+            for (long k = 0; k < n; k++) {
+                blocco[2 * k] = s->stato[inizio + k].parte_reale;
+                blocco[2 * k + 1] = s->stato[inizio + k].parte_immaginaria;
+            }
+            if (fwrite(blocco, sizeof(double), 2 * n, t->file) != (size_t)(2 * n)) return -1;
+        }
+        t->byte_scritti += 16.0 * dimensione;
+        return 0;
+    }
+
+    /* Compressione: XOR con l'istantanea precedente, poi gruppi di parole nulle e parole letterali */
+    uint64_t letterali[2 * AMPIEZZE_BLOCCO];
+    uint32_t zeri = 0, numero = 0;
+    for (long j = 0; j < 2 * dimensione; j++) {
+        double valore = (j & 1) ? s->stato[j >> 1].parte_immaginaria : s->stato[j >> 1].parte_reale;
+        uint64_t parola;
+        memcpy(&parola, &valore, sizeof(parola));
+        uint64_t differenza = parola ^ t->precedente[j];
+        t->precedente[j] = parola;
+
+        if (differenza == 0) {
+            if (numero > 0 || zeri == UINT32_MAX) {      // Chiude il gruppo prima di una nuova serie di zeri
+                if (scrivi_gruppo(t, zeri, numero, letterali) != 0) return -1;
+                zeri = numero = 0;
+            }
+            zeri++;
+        } else {
+            letterali[numero++] = differenza;
+            if (numero == 2 * AMPIEZZE_BLOCCO) {
+                if (scrivi_gruppo(t, zeri, numero, letterali) != 0) return -1;
+                zeri = numero = 0;
+            }
+        }
+    }
+    if ((zeri > 0 || numero > 0) && scrivi_gruppo(t, zeri, numero, letterali) != 0) return -1;
+    return 0;
+}
+
+/* Funzione eseguita dal thread scrittore: scrive i buffer pieni nell'ordine e li rimette tra i liberi.
+ * Dopo un errore continua a restituire i buffer senza scrivere, così l'esecuzione non si blocca. */
+static void* funzione_scrittore(void* arg) {
+    traccia_t* t = (traccia_t*)arg;
+    void* elemento;
+    while (coda_spsc_estrai(&t->piene, &elemento) == 0) {
+        istantanea_t* s = (istantanea_t*)elemento;
+        if (!t->errore) {
+            if (scrivi_istantanea(t, s) != 0) t->errore = 1;
+            else t->istantanee++;
+        }
+        coda_spsc_inserisci(&t->libere, s);
+    }
+    return NULL;
+}
+
+/* Funzione di supporto: libera le risorse della traccia (il thread scrittore deve essere terminato) */
+static int libera_traccia(traccia_t* t) {
+    int ret = 0;
+    if (t->file && fclose(t->file) != 0) ret = -1;
+    for (int k = 0; k < BUFFER_TRACCIA; k++) free(t->buffer[k].stato);
+    free(t->precedente);
+    free(t->nomi);
+    free(t->elenco);
+    if (t->code) {
+        coda_spsc_distruggi(&t->libere);
+        coda_spsc_distruggi(&t->piene);
+    }
+    free(t);
+    return ret;
+}
+
+/* Funzione di supporto: divide i nomi separati da virgole. Ritorna 0 se ok, -1 in caso di errore di allocazione. */
+static int dividi_nomi(traccia_t* t, const char* nomi) {
+    t->nomi = strdup(nomi);
+    t->elenco = (char**)malloc((strlen(nomi) + 1) * sizeof(char*));
+    if (!t->nomi || !t->elenco) return -1;
+    for (char* inizio = t->nomi; inizio; ) {
+        char* virgola = strchr(inizio, ',');
+        if (virgola) *virgola = '\0';
+        if (*inizio) t->elenco[t->numero_nomi++] = inizio;
+        inizio = virgola ? virgola + 1 : NULL;
+    }
+    return 0;
+}
+
+traccia_t* traccia_apri(const char* file, int numero_qubit, int ogni, const char* nomi, int comprimi) {
+    if (!file || numero_qubit <= 0 || numero_qubit > MAX_QUBIT_STATO || ogni < 0) return NULL;
+
+    traccia_t* t = (traccia_t*)calloc(1, sizeof(traccia_t));
+    if (!t) return NULL;
+    t->dimensione = 1L << numero_qubit;
+    t->ogni = (ogni == 0 && !nomi) ? 1 : ogni;
+    t->comprimi = comprimi;
+    t->esecuzione = -1;
+    if (nomi && dividi_nomi(t, nomi) != 0) goto errore;
+
+    for (int k = 0; k < BUFFER_TRACCIA; k++) {
+        t->buffer[k].stato = alloca_stato(t->dimensione, 0);
+        if (!t->buffer[k].stato) goto errore;
+    }
+    if (comprimi && !(t->precedente = (uint64_t*)calloc(2 * t->dimensione, sizeof(uint64_t)))) goto errore;
+
+    t->file = fopen(file, "wb");
+    if (!t->file) {
+        perror(file);
+        goto errore;
+    }
+    int32_t intestazione[2] = {numero_qubit, comprimi ? 1 : 0};
+    if (fwrite("QSIMTRC1", 1, 8, t->file) != 8 || fwrite(intestazione, sizeof(int32_t), 2, t->file) != 2) goto errore;
+
+    if (coda_spsc_inizializza(&t->libere, BUFFER_TRACCIA) != 0) goto errore;
+    if (coda_spsc_inizializza(&t->piene, BUFFER_TRACCIA) != 0) {
+        coda_spsc_distruggi(&t->libere);
+        goto errore;
+    }
+    t->code = 1;
+    for (int k = 0; k < BUFFER_TRACCIA; k++) coda_spsc_inserisci(&t->libere, &t->buffer[k]);   // Prima dello scrittore
+
+    if (pthread_create(&t->scrittore, NULL, funzione_scrittore, t) != 0) goto errore;
+    return t;
+
+errore:
+    libera_traccia(t);
+    return NULL;
+}
+
+int traccia_selezionata(const traccia_t* t, int istruzione, const char* nome) {
+    if (t->ogni > 0 && (istruzione + 1) % t->ogni == 0) return 1;
+    for (int k = 0; k < t->numero_nomi; k++) {
+        const char* e = t->elenco[k];
+        if (strcmp(e, nome) == 0) return 1;
+        size_t n = strlen(e);               // Nome di porta senza qubit: vale per tutti i qubit
+        if (!strchr(e, ' ') && strncmp(nome, e, n) == 0 && nome[n] == ' ') return 1;
+    }
+    return 0;
+}
+
+void traccia_nuova_esecuzione(traccia_t* t) {
+    t->esecuzione++;
+}
+
+int traccia_registra(traccia_t* t, int istruzione, const char* nome, const complesso_t* stato, long dimensione) {
+    if (dimensione != t->dimensione) return -1;     // I buffer hanno la dimensione data all'apertura
+    void* elemento;
+    if (coda_spsc_estrai(&t->libere, &elemento) != 0) return -1;
+    istantanea_t* s = (istantanea_t*)elemento;
+    memcpy(s->stato, stato, t->dimensione * sizeof(complesso_t));
+    s->esecuzione = t->esecuzione < 0 ? 0 : t->esecuzione;
+    s->istruzione = istruzione;
+    memset(s->nome, 0, sizeof(s->nome));
+    strncpy(s->nome, nome, sizeof(s->nome) - 1);
+    t->byte_stati += 16.0 * t->dimensione;
+    coda_spsc_inserisci(&t->piene, s);
+    return 0;
+}
+
+int traccia_chiudi(traccia_t* t) {
+    if (!t) return 0;
+    coda_spsc_chiudi(&t->piene);
+    pthread_join(t->scrittore, NULL);
+
+    int ret = t->errore ? -1 : 0;
+    g_statistiche.aperta = 1;
+    g_statistiche.istantanee = t->istantanee;
+    g_statistiche.byte_stati = t->byte_stati;
+    g_statistiche.byte_scritti = t->byte_scritti;
+    g_statistiche.attese = t->libere.attese_vuota;
+    if (libera_traccia(t) != 0) ret = -1;
+    return ret;
+}
+
+void stampa_traccia(FILE* out) {
+    fprintf(out, "\n=== Traccia degli stati ===\n");
+    if (!g_statistiche.aperta) {
+        fprintf(out, "Traccia non attiva\n");
+        return;
+    }
+    fprintf(out, "Istantanee scritte: %ld, stati: %.1f KiB, scritti: %.1f KiB (%.1f%% degli stati)\n", g_statistiche.istantanee,
+            g_statistiche.byte_stati / 1024.0, g_statistiche.byte_scritti / 1024.0,
+            g_statistiche.byte_stati > 0.0 ? 100.0 * g_statistiche.byte_scritti / g_statistiche.byte_stati : 0.0);
+    fprintf(out, "Attese dell'esecuzione per un buffer libero: %ld\n", g_statistiche.attese);
+}
@@ -0,0 +1,77 @@
+#ifndef TRACCIA_H
+#define TRACCIA_H
+
+#include <stdio.h>
+#include "complesso.h"
+
+/*
+ * Traccia degli stati intermedi (--trace). Dopo ogni istruzione selezionata (ogni k-esima e/o quelle con
+ * uno dei nomi indicati) l'esecuzione copia lo stato in uno dei due buffer della traccia (doppio buffer:
+ * due code senza lock coda_spsc_t, una dei buffer liberi e una di quelli pieni) e prosegue subito; un thread
+ * scrittore svuota i buffer pieni nel file e li rimette tra i liberi. L'esecuzione attende solo se entrambi i
+ * buffer sono ancora da scrivere. Un'istruzione selezionata chiude la sequenza di porte o il tratto fuso in
+ * cui si trova, così lo stato registrato è sempre quello subito dopo l'istruzione.
+ *
+ * Formato del file (interi e double nell'ordine dei byte dell'host):
+ * intestazione: "QSIMTRC1" (8 byte), int32 numero_qubit, int32 compressione (0 o 1)
+ * ogni istantanea: int32 esecuzione (da 0, una per esecuzione del circuito), int32 istruzione (indice in
+ * #circ, da 0), char nome[32] (nome dell'operatore, completato con zeri), poi le 2^N ampiezze come coppie
+ * (parte reale, parte immaginaria) di double:
+ * - senza compressione: 16 * 2^N byte
+ * - con compressione: le 2 * 2^N parole di 64 bit in XOR con quelle dell'istantanea precedente (zero per la
+ *   prima), in gruppi {uint32 zeri, uint32 letterali, letterali parole} fino a coprirle tutte: gli stati
+ *   sparsi e le istruzioni che cambiano poche ampiezze occupano pochi byte.
+ * Ogni traccia appartiene a un contesto (qsim.h), che la apre in qsim_compila con la propria dimensione:
+ * contesti diversi possono registrare insieme, ognuno nel proprio file. Quando la traccia è disattiva ogni
+ * punto di registrazione si riduce al controllo di un puntatore NULL.
+ */
+
+/* Traccia aperta: file, buffer, code e thread scrittore (opaca) */
+typedef struct traccia traccia_t;
+
+/*
+ * Apre il file della traccia, alloca i due buffer e avvia il thread scrittore.
+ * Parametri:
+ * file → percorso del file da scrivere, numero_qubit → qubit degli stati
+ * ogni → registra ogni ogni-esima istruzione (0 per nessuna; se anche nomi è NULL vale 1)
+ * nomi → nomi degli operatori da registrare separati da virgole (un nome senza qubit, es. "H", indica
+ * tutte le porte con quel nome), NULL per nessuno
+ * comprimi → 1 per la compressione descritta sopra
+ * Ritorna: la traccia, NULL in caso di errore (file non scrivibile, allocazione, creazione del thread)
+ */
+traccia_t* traccia_apri(const char* file, int numero_qubit, int ogni, const char* nomi, int comprimi);
+
+/*
+ * Ritorna 1 se lo stato dopo l'istruzione indicata va registrato, 0 altrimenti.
+ * Parametri: istruzione → indice in #circ, nome → nome del suo operatore
+ */
+int traccia_selezionata(const traccia_t* t, int istruzione, const char* nome);
+
+/*
+ * Segna l'inizio di una nuova esecuzione del circuito (numera le istantanee successive).
+ */
+void traccia_nuova_esecuzione(traccia_t* t);
+
+/*
+ * Copia lo stato in un buffer libero (attendendo se non ce ne sono) e lo passa al thread scrittore.
+ * Da chiamare da un solo thread alla volta per traccia (le code tra esecuzione e scrittore sono SPSC).
+ * Parametri: istruzione → indice in #circ, nome → nome dell'operatore, stato → dimensione ampiezze
+ * Ritorna: 0 se tutto ok, -1 se dimensione non è quella con cui la traccia è stata aperta (niente viene copiato)
+ */
+int traccia_registra(traccia_t* t, int istruzione, const char* nome, const complesso_t* stato, long dimensione);
+
+/*
+ * Attende che il thread scrittore abbia scritto le istantanee rimaste, chiude il file e libera le risorse
+ * (t può essere NULL). Il riepilogo della traccia resta al thread chiamante per stampa_traccia.
+ * Ritorna: 0 se tutto ok, -1 se una scrittura è fallita (la traccia è incompleta)
+ */
+int traccia_chiudi(traccia_t* t);
+
+/*
+ * Stampa il riepilogo dell'ultima traccia chiusa dal thread chiamante: istantanee scritte, byte degli stati
+ * e byte scritti, attese dell'esecuzione per un buffer libero.
+ * Parametri: out → file su cui scrivere
+ */
+void stampa_traccia(FILE* out);
+
+#endif
@@ -0,0 +1,395 @@
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include "trasporto.h"
+
+#define GIRI_PRIMA_DI_CEDERE 1024      // Tentativi di attesa attiva prima di cedere la CPU
+
+
+/*
+ * Funzione di supporto che crea la struttura comune del trasporto copiando i confini.
+ */
+static trasporto_t* crea_base(int numero_processi, long dimensione, const long* confini) {
+    if (numero_processi <= 0 || dimensione <= 0 || confini == NULL) return NULL;
+
+    trasporto_t* t = (trasporto_t*)calloc(1, sizeof(trasporto_t));
+    if (!t) return NULL;
+
+    t->confini = (long*)malloc((numero_processi + 1) * sizeof(long));
+    if (!t->confini) {
+        free(t);
+        return NULL;
+    }
+    memcpy(t->confini, confini, (numero_processi + 1) * sizeof(long));
+    t->numero_processi = numero_processi;
+    t->dimensione = dimensione;
+    return t;
+}
+
+/*
+ * Funzione di supporto che libera la struttura comune del trasporto.
+ */
+static void distruggi_base(trasporto_t* t) {
+    free(t->confini);
+    free(t->privato);
+    free(t);
+}
+
+
+/* ===================== Trasporto a memoria condivisa ===================== */
+
+/* Stato del trasporto a memoria condivisa (la mappatura è ereditata dai figli con la fork) */
+typedef struct {
+    void* mappa;               // Inizio della mappatura condivisa
+    size_t byte;               // Dimensione della mappatura
+    long* pubblicato;          // Ultimo passo pubblicato da ogni processo (nella mappatura)
+    complesso_t* vettori;      // Due vettori completi, indicizzati dalla parità del passo (nella mappatura)
+} memoria_condivisa_t;
+
+static int shm_apri(trasporto_t* t, int rank) {
+    (void)t;
+    (void)rank;
+    return 0;                  // La mappatura è già presente nello spazio di indirizzamento del figlio
+}
+
+static int shm_pubblica(trasporto_t* t, int rank, long passo, const complesso_t* blocco, const char* destinatari) {
+    (void)destinatari;         // Tutti leggono dalla stessa mappatura
+    memoria_condivisa_t* s = (memoria_condivisa_t*)t->privato;
+    long inizio = t->confini[rank];
+    long righe = t->confini[rank + 1] - inizio;
+
+    memcpy(&s->vettori[(passo & 1) * t->dimensione + inizio], blocco, righe * sizeof(complesso_t));
+    __atomic_store_n(&s->pubblicato[rank], passo, __ATOMIC_RELEASE);   // Il blocco è visibile prima del contatore
+    return 0;
+}
+
+static const complesso_t* shm_attendi(trasporto_t* t, int rank, long passo, int sorgente) {
+    (void)rank;
+    memoria_condivisa_t* s = (memoria_condivisa_t*)t->privato;
+
+    int giri = 0;
+    while (__atomic_load_n(&s->pubblicato[sorgente], __ATOMIC_ACQUIRE) < passo) {
+        if (++giri >= GIRI_PRIMA_DI_CEDERE) {     // Attesa lunga: lascia la CPU agli altri processi
+            sched_yield();
+            giri = 0;
+        }
+    }
+    return &s->vettori[(passo & 1) * t->dimensione + t->confini[sorgente]];
+}
+
+static void shm_chiudi(trasporto_t* t, int rank) {
+    (void)t;
+    (void)rank;
+}
+
+static void shm_distruggi(trasporto_t* t) {
+    memoria_condivisa_t* s = (memoria_condivisa_t*)t->privato;
+    if (s && s->mappa) munmap(s->mappa, s->byte);
+    distruggi_base(t);
+}
+
+trasporto_t* crea_trasporto_memoria_condivisa(int numero_processi, long dimensione, const long* confini) {
+    trasporto_t* t = crea_base(numero_processi, dimensione, confini);
+    if (!t) return NULL;
+
+    memoria_condivisa_t* s = (memoria_condivisa_t*)calloc(1, sizeof(memoria_condivisa_t));
+    if (!s) {
+        distruggi_base(t);
+        return NULL;
+    }
+    t->privato = s;
+
+    size_t byte_contatori = ((numero_processi * sizeof(long) + 63) / 64) * 64;   // I vettori partono allineati alla linea di cache
+    s->byte = byte_contatori + 2 * (size_t)dimensione * sizeof(complesso_t);
+    s->mappa = mmap(NULL, s->byte, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (s->mappa == MAP_FAILED) {
+        s->mappa = NULL;
+        distruggi_base(t);
+        return NULL;
+    }
+    s->pubblicato = (long*)s->mappa;
+    s->vettori = (complesso_t*)((char*)s->mappa + byte_contatori);
+    for (int p = 0; p < numero_processi; p++) s->pubblicato[p] = -1;
+
+    t->nome = "shm";
+    t->apri = shm_apri;
+    t->pubblica = shm_pubblica;
+    t->attendi = shm_attendi;
+    t->chiudi = shm_chiudi;
+    t->distruggi = shm_distruggi;
+    return t;
+}
+
+
+/* ========================= Trasporto a socket Unix ========================= */
+
+/* Intestazione di ogni messaggio: segue il blocco di 'quanti' complessi (0 per il solo avviso del passo) */
+typedef struct {
+    long passo;
+    int sorgente;
+    long quanti;
+} intestazione_t;
+
+/* Stato del trasporto a socket */
+typedef struct {
+    int* fd;                   // fd[i * P + j]: estremo del processo i verso il processo j (-1 se chiuso)
+
+    /* Stato del lato di un processo, valorizzato da apri */
+    int rank;
+    complesso_t* ricevuti;     // Due vettori completi per i blocchi ricevuti, indicizzati dalla parità del passo
+    long* arrivato;            // arrivato[parità * P + sorgente]: ultimo passo ricevuto
+    int errore;                // 1 se il ricevitore ha incontrato un errore
+    int ricevitore_attivo;     // 1 se il thread ricevitore è stato creato
+    pthread_t ricevitore;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} socket_privato_t;
+
+
+/*
+ * Funzione di supporto che scrive (o legge) esattamente 'byte' byte gestendo le operazioni parziali.
+ * Ritorna: 0 se tutto ok, -1 in caso di errore o chiusura del socket
+ */
+static int scrivi_tutto(int fd, const void* dati, size_t byte) {
+    const char* p = (const char*)dati;
+    while (byte > 0) {
+        ssize_t n = send(fd, p, byte, MSG_NOSIGNAL);     // Nessun SIGPIPE se il processo remoto è terminato
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        byte -= n;
+    }
+    return 0;
+}
+
+static int leggi_tutto(int fd, void* dati, size_t byte) {
+    char* p = (char*)dati;
+    while (byte > 0) {
+        ssize_t n = read(fd, p, byte);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        byte -= n;
+    }
+    return 0;
+}
+
+/*
+ * Thread ricevitore: attende i messaggi da tutti gli altri processi e li copia nel vettore
+ * della parità corrispondente, mentre il thread principale del processo calcola.
+ * Termina quando tutti gli altri processi hanno chiuso il proprio lato.
+ */
+static void* funzione_ricevitore(void* arg) {
+    trasporto_t* t = (trasporto_t*)arg;
+    socket_privato_t* s = (socket_privato_t*)t->privato;
+    int P = t->numero_processi;
+
+    struct pollfd* attesa = (struct pollfd*)malloc(P * sizeof(struct pollfd));
+    int* mittente = (int*)malloc(P * sizeof(int));
+    if (!attesa || !mittente) {
+        free(attesa);
+        free(mittente);
+        pthread_mutex_lock(&s->mutex);
+        s->errore = 1;
+        pthread_cond_broadcast(&s->cond);
+        pthread_mutex_unlock(&s->mutex);
+        return NULL;
+    }
+
+    int aperti = 0;
+    for (int j = 0; j < P; j++) {
+        if (j == s->rank) continue;
+        attesa[aperti].fd = s->fd[s->rank * P + j];
+        attesa[aperti].events = POLLIN;
+        mittente[aperti] = j;
+        aperti++;
+    }
+
+    while (aperti > 0) {
+        if (poll(attesa, aperti, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int k = 0; k < aperti; k++) {
+            if (!(attesa[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            intestazione_t h;
+            int ok = leggi_tutto(attesa[k].fd, &h, sizeof(h)) == 0;
+            if (ok && (h.sorgente != mittente[k] ||
+                       (h.quanti != 0 && h.quanti != t->confini[h.sorgente + 1] - t->confini[h.sorgente]))) {
+                ok = 0;                                     // Messaggio incoerente con i confini
+            }
+            if (ok && h.quanti > 0) {
+                complesso_t* dest = &s->ricevuti[(h.passo & 1) * t->dimensione + t->confini[h.sorgente]];
+                ok = leggi_tutto(attesa[k].fd, dest, h.quanti * sizeof(complesso_t)) == 0;
+            }
+
+            if (!ok) {                                      // Chiusura del processo remoto (o errore): smette di ascoltarlo
+                attesa[k] = attesa[aperti - 1];
+                mittente[k] = mittente[aperti - 1];
+                aperti--;
+                k--;
+                continue;
+            }
+
+            pthread_mutex_lock(&s->mutex);
+            s->arrivato[(h.passo & 1) * P + h.sorgente] = h.passo;
+            pthread_cond_broadcast(&s->cond);
+            pthread_mutex_unlock(&s->mutex);
+        }
+    }
+
+    /* Da qui in poi nessun blocco può più arrivare: chi attende ancora deve essere sbloccato */
+    pthread_mutex_lock(&s->mutex);
+    s->errore = 1;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+
+    free(attesa);
+    free(mittente);
+    return NULL;
+}
+
+static int socket_apri(trasporto_t* t, int rank) {
+    socket_privato_t* s = (socket_privato_t*)t->privato;
+    int P = t->numero_processi;
+
+    /* Il processo tiene solo i propri estremi */
+    for (int i = 0; i < P; i++) {
+        for (int j = 0; j < P; j++) {
+            if (i != rank && s->fd[i * P + j] >= 0) {
+                close(s->fd[i * P + j]);
+                s->fd[i * P + j] = -1;
+            }
+        }
+    }
+
+    s->rank = rank;
+    s->errore = 0;
+    s->ricevuti = (complesso_t*)malloc(2 * (size_t)t->dimensione * sizeof(complesso_t));
+    s->arrivato = (long*)malloc(2 * P * sizeof(long));
+    if (!s->ricevuti || !s->arrivato) return -1;
+    for (int k = 0; k < 2 * P; k++) s->arrivato[k] = -1;
+
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    if (pthread_create(&s->ricevitore, NULL, funzione_ricevitore, t) != 0) return -1;
+    s->ricevitore_attivo = 1;
+    return 0;
+}
+
+static int socket_pubblica(trasporto_t* t, int rank, long passo, const complesso_t* blocco, const char* destinatari) {
+    socket_privato_t* s = (socket_privato_t*)t->privato;
+    int P = t->numero_processi;
+
+    intestazione_t h;
+    memset(&h, 0, sizeof(h));
+    h.passo = passo;
+    h.sorgente = rank;
+    long righe = t->confini[rank + 1] - t->confini[rank];
+
+    for (int k = 1; k < P; k++) {
+        int j = (rank + k) % P;                 // Ordine ruotato: i processi non scrivono tutti allo stesso destinatario
+        int fd = s->fd[rank * P + j];
+        h.quanti = (!destinatari || destinatari[j]) ? righe : 0;
+        if (scrivi_tutto(fd, &h, sizeof(h)) != 0) return -1;
+        if (h.quanti > 0 && scrivi_tutto(fd, blocco, h.quanti * sizeof(complesso_t)) != 0) return -1;
+    }
+    return 0;
+}
+
+static const complesso_t* socket_attendi(trasporto_t* t, int rank, long passo, int sorgente) {
+    (void)rank;
+    socket_privato_t* s = (socket_privato_t*)t->privato;
+    int slot = (passo & 1) * t->numero_processi + sorgente;
+
+    pthread_mutex_lock(&s->mutex);
+    while (s->arrivato[slot] < passo && !s->errore) {
+        pthread_cond_wait(&s->cond, &s->mutex);
+    }
+    int pronto = s->arrivato[slot] >= passo;
+    pthread_mutex_unlock(&s->mutex);
+
+    if (!pronto) return NULL;
+    return &s->ricevuti[(passo & 1) * t->dimensione + t->confini[sorgente]];
+}
+
+static void socket_chiudi(trasporto_t* t, int rank) {
+    socket_privato_t* s = (socket_privato_t*)t->privato;
+    int P = t->numero_processi;
+
+    /* Chiude il lato di scrittura: il ricevitore remoto vede la fine del flusso */
+    for (int j = 0; j < P; j++) {
+        if (j != rank && s->fd[rank * P + j] >= 0) shutdown(s->fd[rank * P + j], SHUT_WR);
+    }
+    if (s->ricevitore_attivo) pthread_join(s->ricevitore, NULL);    // Finisce quando tutti hanno chiuso
+    s->ricevitore_attivo = 0;
+
+    for (int j = 0; j < P; j++) {
+        if (s->fd[rank * P + j] >= 0) close(s->fd[rank * P + j]);
+        s->fd[rank * P + j] = -1;
+    }
+    free(s->ricevuti);
+    free(s->arrivato);
+    s->ricevuti = NULL;
+    s->arrivato = NULL;
+}
+
+static void socket_distruggi(trasporto_t* t) {
+    socket_privato_t* s = (socket_privato_t*)t->privato;
+    if (s && s->fd) {
+        int P = t->numero_processi;
+        for (int k = 0; k < P * P; k++) {
+            if (s->fd[k] >= 0) close(s->fd[k]);
+        }
+        free(s->fd);
+    }
+    distruggi_base(t);
+}
+
+trasporto_t* crea_trasporto_socket(int numero_processi, long dimensione, const long* confini) {
+    trasporto_t* t = crea_base(numero_processi, dimensione, confini);
+    if (!t) return NULL;
+
+    socket_privato_t* s = (socket_privato_t*)calloc(1, sizeof(socket_privato_t));
+    if (!s) {
+        distruggi_base(t);
+        return NULL;
+    }
+    t->privato = s;
+
+    int P = numero_processi;
+    s->fd = (int*)malloc(P * P * sizeof(int));
+    if (!s->fd) {
+        distruggi_base(t);
+        return NULL;
+    }
+    for (int k = 0; k < P * P; k++) s->fd[k] = -1;
+
+    t->nome = "socket";
+    t->apri = socket_apri;
+    t->pubblica = socket_pubblica;
+    t->attendi = socket_attendi;
+    t->chiudi = socket_chiudi;
+    t->distruggi = socket_distruggi;
+
+    for (int i = 0; i < P; i++) {                // Una coppia di socket per ogni coppia di processi
+        for (int j = i + 1; j < P; j++) {
+            int coppia[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, coppia) != 0) {
+                socket_distruggi(t);
+                return NULL;
+            }
+            s->fd[i * P + j] = coppia[0];
+            s->fd[j * P + i] = coppia[1];
+        }
+    }
+    return t;
+}
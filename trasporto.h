@@ -0,0 +1,60 @@
+#ifndef TRASPORTO_H
+#define TRASPORTO_H
+
+#include "complesso.h"
+
+/*
+ * Trasporto usato dalla simulazione distribuita per scambiare i blocchi del vettore di stato
+ * tra i processi. Ogni processo (rank) possiede le righe [confini[rank], confini[rank + 1])
+ * e ad ogni passo pubblica il proprio blocco e attende quelli degli altri.
+ * Il trasporto viene creato dal processo padre prima della fork e aperto da ogni processo figlio.
+ * Le implementazioni locali sono la memoria condivisa e i socket Unix; altre (es. rete)
+ * possono essere aggiunte fornendo le stesse funzioni.
+ */
+typedef struct trasporto trasporto_t;
+
+struct trasporto {
+    const char* nome;            // Nome dell'implementazione (per i messaggi)
+    int numero_processi;         // Processi che partecipano allo scambio
+    long dimensione;             // Dimensione del vettore completo
+    long* confini;               // numero_processi + 1 confini delle righe assegnate
+    void* privato;               // Stato interno dell'implementazione
+
+    /*
+     * Operazioni del processo figlio rank (dopo la fork).
+     * apri → prepara il lato del processo, ritorna 0 se ok, -1 se errore
+     * pubblica → rende disponibile il blocco del processo per il passo indicato ai processi con
+     *            destinatari[j] != 0 (a tutti se destinatari è NULL); gli altri ricevono solo l'avviso
+     *            che il passo è stato raggiunto
+     * attendi → attende il blocco (o l'avviso) della sorgente per il passo indicato e ne ritorna l'indirizzo
+     *           (valido fino alla pubblicazione del passo + 2), NULL in caso di errore; il contenuto è
+     *           significativo solo se il processo era tra i destinatari
+     * chiudi → rilascia le risorse del lato del processo
+     */
+    int (*apri)(trasporto_t* t, int rank);
+    int (*pubblica)(trasporto_t* t, int rank, long passo, const complesso_t* blocco, const char* destinatari);
+    const complesso_t* (*attendi)(trasporto_t* t, int rank, long passo, int sorgente);
+    void (*chiudi)(trasporto_t* t, int rank);
+
+    /* Operazione del processo padre: libera il trasporto dopo la terminazione dei figli */
+    void (*distruggi)(trasporto_t* t);
+};
+
+/*
+ * Crea il trasporto a memoria condivisa: due vettori completi (uno per la parità del passo)
+ * in una mappatura condivisa e un contatore di passo pubblicato per ogni processo.
+ * Il blocco viene scritto una sola volta nella mappatura, quindi i destinatari non cambiano il lavoro.
+ * Parametri: numero_processi, dimensione → come nella struttura, confini → numero_processi + 1 indici (copiati)
+ * Ritorna: puntatore al trasporto, NULL in caso di errore
+ */
+trasporto_t* crea_trasporto_memoria_condivisa(int numero_processi, long dimensione, const long* confini);
+
+/*
+ * Crea il trasporto a socket Unix: una coppia di socket per ogni coppia di processi.
+ * Ogni processo invia il proprio blocco ai destinatari e la sola intestazione agli altri processi,
+ * e un thread ricevitore raccoglie i blocchi in arrivo mentre il processo calcola.
+ * Parametri e valore di ritorno come crea_trasporto_memoria_condivisa.
+ */
+trasporto_t* crea_trasporto_socket(int numero_processi, long dimensione, const long* confini);
+
+#endif
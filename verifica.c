@@ -0,0 +1,146 @@
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "verifica.h"
+#include "memoria.h"
+
+static const char* g_nomi_kernel[NUMERO_KERNEL] = {"denso", "supporto", "fuso", "porte", "piccolo"};
+
+/* Verifica di un contesto; i campi sotto il mutex possono essere aggiornati da più thread (flusso di stati) */
+struct verifica {
+    double frazione;            // Frazione delle istruzioni verificate, in (0, 1]
+    pthread_mutex_t mutex;
+    uint64_t seme;              // Stato del generatore pseudo-casuale (xorshift64)
+    struct {
+        long confronti;
+        long falliti;           // Confronti oltre TOLLERANZA_VERIFICA
+        double scarto_massimo;
+        int istruzione;         // Istruzione dello scarto massimo
+        char nome[32];          // Suo operatore
+    } kernel[NUMERO_KERNEL];
+    long errori;                // Confronti non eseguiti per mancanza di memoria
+};
+
+
+verifica_t* verifica_crea(double frazione) {
+    if (!(frazione > 0.0 && frazione <= 1.0)) return NULL;
+    verifica_t* v = (verifica_t*)calloc(1, sizeof(verifica_t));
+    if (!v) return NULL;
+    v->frazione = frazione;
+    v->seme = 0x9E3779B97F4A7C15ULL;
+    pthread_mutex_init(&v->mutex, NULL);
+    return v;
+}
+
+void verifica_distruggi(verifica_t* v) {
+    if (!v) return;
+    pthread_mutex_destroy(&v->mutex);
+    free(v);
+}
+
+int verifica_estrai(verifica_t* v) {
+    if (!v) return 0;
+    pthread_mutex_lock(&v->mutex);
+    v->seme ^= v->seme << 13;
+    v->seme ^= v->seme >> 7;
+    v->seme ^= v->seme << 17;
+    uint64_t estratto = v->seme;
+    pthread_mutex_unlock(&v->mutex);
+    return (estratto >> 11) * (1.0 / 9007199254740992.0) < v->frazione;    // 53 bit in [0, 1)
+}
+
+/* Funzione di supporto: registra il confronto tra calcolato e riferimento */
+static void registra(verifica_t* v, kernel_verificato_t kernel, const complesso_t* calcolato, const complesso_t* riferimento,
+                     long dimensione, int istruzione, const char* nome) {
+    double massimo = 0.0, scarto = 0.0;
+    for (long i = 0; i < dimensione; i++) {
+        double modulo = hypot(riferimento[i].parte_reale, riferimento[i].parte_immaginaria);
+        double diff = hypot(calcolato[i].parte_reale - riferimento[i].parte_reale,
+                            calcolato[i].parte_immaginaria - riferimento[i].parte_immaginaria);
+        if (modulo > massimo) massimo = modulo;
+        if (!(diff <= scarto)) scarto = diff;   // Un NaN resta come scarto
+    }
+    double relativo = massimo > 0.0 ? scarto / massimo : scarto;
+
+    pthread_mutex_lock(&v->mutex);
+    v->kernel[kernel].confronti++;
+    if (!(relativo <= TOLLERANZA_VERIFICA)) v->kernel[kernel].falliti++;
+    if (v->kernel[kernel].confronti == 1 || !(relativo <= v->kernel[kernel].scarto_massimo)) {
+        v->kernel[kernel].scarto_massimo = relativo;
+        v->kernel[kernel].istruzione = istruzione;
+        snprintf(v->kernel[kernel].nome, sizeof(v->kernel[kernel].nome), "%s", nome ? nome : "?");
+    }
+    pthread_mutex_unlock(&v->mutex);
+}
+
+static void registra_errore(verifica_t* v) {
+    pthread_mutex_lock(&v->mutex);
+    v->errori++;
+    pthread_mutex_unlock(&v->mutex);
+}
+
+void verifica_matrici(verifica_t* v, kernel_verificato_t kernel, matrice_t* const* matrici, int numero,
+                      const complesso_t* iniziale, const complesso_t* calcolato, long dimensione, int istruzione,
+                      const char* nome) {
+    if (!v || kernel < 0 || kernel >= NUMERO_KERNEL || !matrici || numero <= 0 || !iniziale || !calcolato) return;
+
+    complesso_t* riferimento = (complesso_t*)iniziale;
+    for (int k = 0; k < numero; k++) {
+        complesso_t* successivo = matrici[k] ? moltiplica_matrice_vettore(matrici[k], riferimento) : NULL;
+        if (riferimento != iniziale) free(riferimento);
+        riferimento = successivo;
+        if (!riferimento) {
+            registra_errore(v);
+            return;
+        }
+    }
+    registra(v, kernel, calcolato, riferimento, dimensione, istruzione, nome);
+    free(riferimento);
+}
+
+void verifica_porte(verifica_t* v, kernel_verificato_t kernel, const porta_t* const* porte, int numero,
+                    const complesso_t* iniziale, const complesso_t* calcolato, int numero_qubit, int istruzione,
+                    const char* nome) {
+    if (!v || kernel < 0 || kernel >= NUMERO_KERNEL || !porte || numero < 0 || !iniziale || !calcolato) return;
+
+    long dimensione = 1L << numero_qubit;
+    complesso_t* buffer[2] = {alloca_stato(dimensione, 0), alloca_stato(dimensione, 0)};
+    if (!buffer[0] || !buffer[1]) {
+        free(buffer[0]);
+        free(buffer[1]);
+        registra_errore(v);
+        return;
+    }
+
+    /* Una porta alla volta su tutte le righe, alternando i due buffer */
+    memcpy(buffer[0], iniziale, dimensione * sizeof(complesso_t));
+    int corrente = 0;
+    for (int k = 0; k < numero; k++) {
+        applica_porta_righe(porte[k], buffer[corrente], buffer[1 - corrente], 0, dimensione);
+        corrente = 1 - corrente;
+    }
+    registra(v, kernel, calcolato, buffer[corrente], dimensione, istruzione, nome);
+    free(buffer[0]);
+    free(buffer[1]);
+}
+
+long stampa_verifica(verifica_t* v, FILE* out) {
+    if (!v) return 0;
+    long falliti = 0;
+    pthread_mutex_lock(&v->mutex);
+    fprintf(out, "\n=== Verifica dei kernel (frazione %g, tolleranza %g) ===\n", v->frazione, TOLLERANZA_VERIFICA);
+    for (int k = 0; k < NUMERO_KERNEL; k++) {
+        if (v->kernel[k].confronti == 0) continue;
+        fprintf(out, "%-9s confronti: %6ld, scarto relativo massimo: %.3e (%.1f ulp) all'istruzione %d (%s), oltre la tolleranza: %ld\n",
+                g_nomi_kernel[k], v->kernel[k].confronti, v->kernel[k].scarto_massimo, v->kernel[k].scarto_massimo / DBL_EPSILON,
+                v->kernel[k].istruzione + 1, v->kernel[k].nome, v->kernel[k].falliti);
+        falliti += v->kernel[k].falliti;
+    }
+    if (v->errori > 0) fprintf(out, "Confronti non eseguiti per mancanza di memoria: %ld\n", v->errori);
+    if (falliti > 0) fprintf(out, "Attenzione: %ld confronti oltre la tolleranza\n", falliti);
+    pthread_mutex_unlock(&v->mutex);
+    return falliti;
+}
@@ -0,0 +1,84 @@
+#ifndef VERIFICA_H
+#define VERIFICA_H
+
+#include <stdio.h>
+#include "matrice.h"
+#include "porte.h"
+
+/*
+ * Verifica differenziale dei kernel ottimizzati durante l'esecuzione (--verify).
+ * Per una frazione estratta a caso delle istruzioni il risultato del kernel usato viene ricalcolato con
+ * un riferimento semplice e sequenziale: moltiplica_matrice_vettore di matrice.c per le matrici dense (per
+ * un tratto fuso, le matrici originali una dopo l'altra), applica_porta_righe su tutto lo stato, una porta
+ * alla volta, per le porte. Per ogni kernel vengono registrati lo scarto relativo massimo
+ * (max |calcolato - riferimento| / max |riferimento|) e l'istruzione in cui si è verificato.
+ * Frazione e risultati appartengono a un oggetto verifica_t del contesto di libqsim (opzione verifica di
+ * qsim_opzioni_t): contesti diversi vengono verificati, o no, ognuno per conto proprio. Quando la verifica
+ * è disattiva ogni punto di controllo si riduce al controllo del puntatore NULL.
+ */
+
+/* Scarto relativo oltre il quale un confronto viene segnalato come fallito */
+#ifndef TOLLERANZA_VERIFICA
+#define TOLLERANZA_VERIFICA 1e-9
+#endif
+
+/* Kernel confrontati con il riferimento */
+typedef enum {
+    KERNEL_DENSO,       // moltiplica_matrice_vettore_mt_riuso: righe divise tra i thread della squadra
+    KERNEL_SUPPORTO,    // moltiplica_supporto: solo le colonne del supporto dello stato
+    KERNEL_FUSO,        // Unitario fuso dalla cache al posto di un tratto di matrici dense
+    KERNEL_PORTE,       // Porte consecutive applicate con rimappatura dei qubit e a blocchi
+    KERNEL_PICCOLO,     // Kernel specializzati per N <= 5 qubit
+    NUMERO_KERNEL
+} kernel_verificato_t;
+
+/* Verifica di un contesto: frazione, generatore pseudo-casuale e risultati per kernel */
+typedef struct verifica verifica_t;
+
+/*
+ * Crea la verifica di un contesto. I kernel possono essere eseguiti da più thread insieme (flusso di stati,
+ * scansione dei parametri): estrazioni e risultati sono protetti da un mutex della verifica.
+ * Parametri: frazione → frazione delle istruzioni da verificare, in (0, 1]
+ * Ritorna: puntatore alla verifica, NULL se la frazione non è valida o in caso di errore di allocazione
+ */
+verifica_t* verifica_crea(double frazione);
+
+/*
+ * Estrae se l'istruzione corrente va verificata, con probabilità pari alla frazione (generatore
+ * pseudo-casuale della verifica con seme fisso, quindi la stessa esecuzione verifica le stesse istruzioni).
+ * Ritorna: 1 se va verificata, 0 altrimenti (sempre 0 con v NULL)
+ */
+int verifica_estrai(verifica_t* v);
+
+/*
+ * Confronta il risultato di un kernel con quello delle matrici applicate in ordine con moltiplica_matrice_vettore.
+ * Parametri:
+ * v → verifica in cui registrare il confronto
+ * kernel → kernel che ha prodotto calcolato, matrici → numero matrici applicate nell'ordine del circuito
+ * iniziale → stato prima dell'istruzione, calcolato → stato prodotto dal kernel, dimensione → loro lunghezza
+ * istruzione → indice dell'istruzione nel circuito, nome → nome del suo operatore
+ */
+void verifica_matrici(verifica_t* v, kernel_verificato_t kernel, matrice_t* const* matrici, int numero,
+                      const complesso_t* iniziale, const complesso_t* calcolato, long dimensione, int istruzione,
+                      const char* nome);
+
+/*
+ * Come verifica_matrici, con riferimento le porte applicate una alla volta con applica_porta_righe.
+ * Parametri: porte → numero porte nell'ordine di applicazione, numero_qubit → qubit dello stato
+ */
+void verifica_porte(verifica_t* v, kernel_verificato_t kernel, const porta_t* const* porte, int numero,
+                    const complesso_t* iniziale, const complesso_t* calcolato, int numero_qubit, int istruzione,
+                    const char* nome);
+
+/*
+ * Stampa per ogni kernel i confronti eseguiti, lo scarto relativo massimo (anche in unità di
+ * arrotondamento, DBL_EPSILON) con l'istruzione in cui si è verificato e i confronti oltre TOLLERANZA_VERIFICA.
+ * Parametri: v → verifica del contesto, out → file su cui scrivere
+ * Ritorna: numero di confronti oltre la tolleranza
+ */
+long stampa_verifica(verifica_t* v, FILE* out);
+
+/* Libera la verifica (v può essere NULL) */
+void verifica_distruggi(verifica_t* v);
+
+#endif